@@ -58,7 +58,7 @@ columnSystemCtx::columnSystemCtx(PetscInt my_nmax, string my_prefix) : nmax(my_n
   rhs  = new PetscScalar[nmax];
   work = new PetscScalar[nmax];
 
-  resetColumn();
+  resetColumn(nmax);
 
   indicesValid = false;
 
@@ -74,14 +74,15 @@ columnSystemCtx::~columnSystemCtx() {
 }
 
 
-//! Zero all entries.
-PetscErrorCode columnSystemCtx::resetColumn() {
+//! Zero all entries in rows 0, ..., n-1.
+PetscErrorCode columnSystemCtx::resetColumn(PetscInt n) {
   PetscErrorCode ierr;
-  ierr = PetscMemzero(Lp,   (nmax-1)*sizeof(PetscScalar)); CHKERRQ(ierr);
-  ierr = PetscMemzero(U,    (nmax-1)*sizeof(PetscScalar)); CHKERRQ(ierr);
-  ierr = PetscMemzero(D,    (nmax)*sizeof(PetscScalar)); CHKERRQ(ierr);
-  ierr = PetscMemzero(rhs,  (nmax)*sizeof(PetscScalar)); CHKERRQ(ierr);
-  ierr = PetscMemzero(work, (nmax)*sizeof(PetscScalar)); CHKERRQ(ierr);
+  const PetscInt m = PetscMin(n, nmax - 1); // number of entries in U and L
+  ierr = PetscMemzero(Lp,   (m)*sizeof(PetscScalar)); CHKERRQ(ierr);
+  ierr = PetscMemzero(U,    (m)*sizeof(PetscScalar)); CHKERRQ(ierr);
+  ierr = PetscMemzero(D,    (n)*sizeof(PetscScalar)); CHKERRQ(ierr);
+  ierr = PetscMemzero(rhs,  (n)*sizeof(PetscScalar)); CHKERRQ(ierr);
+  ierr = PetscMemzero(work, (n)*sizeof(PetscScalar)); CHKERRQ(ierr);
   return 0;
 }
 
@@ -138,6 +139,12 @@ PetscScalar columnSystemCtx::ddratio(const PetscInt n) const {
 }
 
 
+//! Sets column indices and clears rows 0, ..., ks of the system.
+/*!
+Rows above ks are not used by the solver, so they are left alone (clearing
+all nmax rows in every column costs more than the rest of the setup in thin
+ice).
+ */
 PetscErrorCode columnSystemCtx::setIndicesAndClearThisColumn(
                   PetscInt my_i, PetscInt my_j, PetscInt my_ks) {
   if (indicesValid) {  SETERRQ(PETSC_COMM_SELF, 3,
@@ -146,7 +153,7 @@ PetscErrorCode columnSystemCtx::setIndicesAndClearThisColumn(
   j = my_j;
   ks = my_ks;
 
-  resetColumn();
+  resetColumn(PetscMin(ks + 1, nmax));
   
   indicesValid = true;
   return 0;
@@ -403,3 +410,290 @@ PetscErrorCode columnSystemCtx::viewColumnInfoMFile(char *filename, PetscScalar
   return 0;
 }
 
+
+
+columnSystemBatch::columnSystemBatch(PetscInt my_nmax, int my_width)
+  : m_nmax(my_nmax), m_width(my_width), m_size(0) {
+  if (m_nmax < 1 || m_width < 1) {
+    PetscPrintf(PETSC_COMM_WORLD,
+      "columnSystemBatch ERROR: nmax and width have to be positive\n");
+    PISMEnd();
+  }
+
+  const PetscInt N = m_nmax * m_width;
+  m_L     = new PetscScalar[N];
+  m_D     = new PetscScalar[N];
+  m_U     = new PetscScalar[N];
+  m_rhs   = new PetscScalar[N];
+  m_work  = new PetscScalar[N];
+  m_pivot = new PetscScalar[N];
+  m_x     = new PetscScalar[N];
+
+  m_n.resize(m_width);
+  m_i.resize(m_width);
+  m_j.resize(m_width);
+
+  clear();
+}
+
+
+columnSystemBatch::~columnSystemBatch() {
+  delete [] m_L;
+  delete [] m_D;
+  delete [] m_U;
+  delete [] m_rhs;
+  delete [] m_work;
+  delete [] m_pivot;
+  delete [] m_x;
+}
+
+
+//! Removes all systems from the batch.
+void columnSystemBatch::clear() {
+  for (int l = 0; l < m_width; ++l) {
+    m_n[l] = 0;
+    m_i[l] = -1;
+    m_j[l] = -1;
+  }
+  m_size = 0;
+}
+
+
+//! Copies rows 0, ..., n-1 of an assembled system into the next free lane.
+/*!
+The system is marked as solved, so that the next column can be set up.
+ */
+PetscErrorCode columnSystemBatch::add(columnSystemCtx &system, PetscInt n) {
+  if (full()) { SETERRQ(PETSC_COMM_SELF, 1, "columnSystemBatch is full"); }
+  if (n < 1 || n > m_nmax || n > system.nmax) {
+    SETERRQ1(PETSC_COMM_SELF, 2, "invalid system size n = %d in columnSystemBatch", n);
+  }
+#if (PISM_DEBUG==1)
+  if (!system.indicesValid) {
+    SETERRQ(PETSC_COMM_SELF, 3, "column indices not valid in columnSystemBatch::add()");
+  }
+#endif
+
+  const int l = m_size, W = m_width;
+
+  m_L[l] = 0.0;
+  for (PetscInt k = 1; k < n; ++k)
+    m_L[k*W + l] = system.L[k];
+
+  for (PetscInt k = 0; k < n - 1; ++k)
+    m_U[k*W + l] = system.U[k];
+  m_U[(n-1)*W + l] = 0.0;       // U[n-1] is not used by the solver
+
+  for (PetscInt k = 0; k < n; ++k) {
+    m_D[k*W + l]   = system.D[k];
+    m_rhs[k*W + l] = system.rhs[k];
+  }
+
+  m_n[l] = n;
+  m_i[l] = system.i;
+  m_j[l] = system.j;
+  ++m_size;
+
+  system.indicesValid = false;
+
+  return 0;
+}
+
+
+//! Solves all the systems in the batch.
+/*!
+This does not stop at a zero pivot: use pivot_error() to check each lane.
+ */
+PetscErrorCode columnSystemBatch::solve() {
+  const int W = m_width;
+  PetscInt N = 0;
+
+  for (int l = 0; l < W; ++l)
+    N = PetscMax(N, m_n[l]);
+
+  if (N == 0)
+    return 0;
+
+  // pad shorter systems (and empty lanes) with identity rows
+  for (int l = 0; l < W; ++l) {
+    for (PetscInt k = m_n[l]; k < N; ++k) {
+      m_L[k*W + l]   = 0.0;
+      m_D[k*W + l]   = 1.0;
+      m_U[k*W + l]   = 0.0;
+      m_rhs[k*W + l] = 0.0;
+    }
+  }
+
+  // forward elimination; m_pivot holds the pivots ("b" in
+  // columnSystemCtx::solveTridiagonalSystem())
+  for (int l = 0; l < W; ++l) {
+    m_pivot[l] = m_D[l];
+    m_x[l]     = m_rhs[l] / m_pivot[l];
+  }
+  for (PetscInt k = 1; k < N; ++k) {
+    const PetscInt r = k*W, p = r - W;
+    for (int l = 0; l < W; ++l) {
+      m_work[r + l]  = m_U[p + l] / m_pivot[p + l];
+      m_pivot[r + l] = m_D[r + l] - m_L[r + l] * m_work[r + l];
+      m_x[r + l]     = (m_rhs[r + l] - m_L[r + l] * m_x[p + l]) / m_pivot[r + l];
+    }
+  }
+
+  // back substitution
+  for (PetscInt k = N - 2; k >= 0; --k) {
+    const PetscInt r = k*W, q = r + W;
+    for (int l = 0; l < W; ++l)
+      m_x[r + l] -= m_work[q + l] * m_x[q + l];
+  }
+
+  return 0;
+}
+
+
+//! \brief Returns zero on success and the (one-based) position of the first
+//! zero pivot otherwise, like columnSystemCtx::solveTridiagonalSystem().
+PetscErrorCode columnSystemBatch::pivot_error(int lane) const {
+  for (PetscInt k = 0; k < m_n[lane]; ++k) {
+    if (m_pivot[k*m_width + lane] == 0.0)
+      return k + 1;
+  }
+  return 0;
+}
+
+
+//! Copies the solution in lane `lane` (`n` values, see add()) into `x`.
+PetscErrorCode columnSystemBatch::get_solution(int lane, PetscScalar *x) const {
+  if (lane < 0 || lane >= m_size) {
+    SETERRQ1(PETSC_COMM_SELF, 1, "invalid lane %d in columnSystemBatch", lane);
+  }
+
+  for (PetscInt k = 0; k < m_n[lane]; ++k)
+    x[k] = m_x[k*m_width + lane];
+
+  return 0;
+}
+
+
+//! \brief Copies the system in lane `lane` (and its column indices) back
+//! into `system`, for viewing and error reporting.
+/*!
+Only the matrix and the right-hand side are copied: other column-dependent
+data viewed by `system` corresponds to the last column it was set up for.
+ */
+PetscErrorCode columnSystemBatch::get_system(int lane, columnSystemCtx &system) const {
+  if (lane < 0 || lane >= m_size) {
+    SETERRQ1(PETSC_COMM_SELF, 1, "invalid lane %d in columnSystemBatch", lane);
+  }
+
+  const PetscInt n = m_n[lane];
+
+  for (PetscInt k = 1; k < n; ++k)
+    system.L[k] = m_L[k*m_width + lane];
+  for (PetscInt k = 0; k < n - 1; ++k)
+    system.U[k] = m_U[k*m_width + lane];
+  for (PetscInt k = 0; k < n; ++k) {
+    system.D[k]   = m_D[k*m_width + lane];
+    system.rhs[k] = m_rhs[k*m_width + lane];
+  }
+
+  system.i  = m_i[lane];
+  system.j  = m_j[lane];
+  system.ks = n - 1;
+
+  return 0;
+}
+
+
+columnSystemGrid::columnSystemGrid(IceGrid &grid, bool storage) {
+  m_storage = storage;
+
+  if (storage == false) {
+    m_Mz = grid.Mz_fine;
+    m_z  = &grid.zlevels_fine;
+    m_dz = grid.dz_fine;
+
+    dz_minus.assign(m_Mz, m_dz);
+    dz_plus.assign(m_Mz, m_dz);
+    dz_layer.assign(m_Mz, m_dz);
+    G_minus.assign(m_Mz, 1.0);
+    G_plus.assign(m_Mz, 1.0);
+    c_minus.assign(m_Mz, 0.5);
+    c_plus.assign(m_Mz, 0.5);
+    return;
+  }
+
+  m_Mz = grid.Mz;
+  m_z  = &grid.zlevels;
+  m_dz = grid.zlevels[1] - grid.zlevels[0];
+
+  const vector<double> &zlevels = grid.zlevels;
+
+  dz_minus.resize(m_Mz);
+  dz_plus.resize(m_Mz);
+  dz_layer.resize(m_Mz);
+  G_minus.resize(m_Mz);
+  G_plus.resize(m_Mz);
+  c_minus.resize(m_Mz);
+  c_plus.resize(m_Mz);
+
+  for (PetscInt k = 0; k < m_Mz; ++k) {
+    // extend the grid symmetrically at both ends
+    dz_plus[k]  = (k < m_Mz - 1) ? zlevels[k+1] - zlevels[k] : zlevels[k] - zlevels[k-1];
+    dz_minus[k] = (k > 0)        ? zlevels[k] - zlevels[k-1] : dz_plus[k];
+
+    const PetscScalar h = 0.5 * (dz_minus[k] + dz_plus[k]);
+    dz_layer[k] = h;
+    G_minus[k]  = PetscSqr(m_dz) / (dz_minus[k] * h);
+    G_plus[k]   = PetscSqr(m_dz) / (dz_plus[k] * h);
+    c_minus[k]  = dz_minus[k] / (dz_minus[k] + dz_plus[k]);
+    c_plus[k]   = dz_plus[k] / (dz_minus[k] + dz_plus[k]);
+  }
+}
+
+
+//! Gets values of `f` in the column `i,j` at all the levels of this grid.
+/*!
+Interpolates from the storage grid unless this is the storage grid; see
+IceModelVec3::getValColumn().
+ */
+PetscErrorCode columnSystemGrid::get_column(IceModelVec3 &f, PetscInt i, PetscInt j,
+                                            PetscInt ks, PetscScalar *result) const {
+  PetscErrorCode ierr;
+
+  if (m_storage == false) {
+    ierr = f.getValColumn(i, j, ks, result); CHKERRQ(ierr);
+    return 0;
+  }
+
+  PetscScalar *column;
+  ierr = f.getInternalColumn(i, j, &column); CHKERRQ(ierr);
+  for (PetscInt k = 0; k < m_Mz; ++k)
+    result[k] = column[k];
+
+  return 0;
+}
+
+
+//! Sets values of `f` in the column `i,j` from `values` at all the levels of this grid.
+PetscErrorCode columnSystemGrid::set_column(IceModelVec3 &f, PetscInt i, PetscInt j,
+                                            PetscScalar *values) const {
+  PetscErrorCode ierr;
+
+  if (m_storage == false) {
+    ierr = f.setValColumnPL(i, j, values); CHKERRQ(ierr);
+  } else {
+    ierr = f.setInternalColumn(i, j, values); CHKERRQ(ierr);
+  }
+
+  return 0;
+}
+
+
+//! Gets a map-plane star stencil of `f` at level `k` of this grid.
+PetscErrorCode columnSystemGrid::plane_star(IceModelVec3 &f, PetscInt i, PetscInt j, PetscInt k,
+                                            planeStar<PetscScalar> *star) const {
+  if (m_storage == false)
+    return f.getPlaneStar_fine(i, j, k, star);
+
+  return f.getPlaneStar(i, j, k, star);
+}
@@ -20,8 +20,11 @@
 #define __columnSystem_hh
 
 #include <string>
+#include <vector>
 #include <petsc.h>
 
+#include "PISMColumnList.hh"
+
 // use namespace std BUT remove trivial namespace browser from doxygen-erated HTML source browser
 /// @cond NAMESPACE_BROWSER
 using namespace std;
@@ -39,8 +42,13 @@ Derived classes will actually set up instances of the system.
 The sequence requires setting the column-independent (public) data members,
 calling the initAllColumns() routine, and then setting up and solving
 the system in each column.
+
+Derived classes also provide an assembleThisColumn() method which sets up the
+system without solving it, so that systems from several columns can be
+solved together by columnSystemBatch.
  */
 class columnSystemCtx {
+  friend class columnSystemBatch;
 
 public:
   columnSystemCtx(PetscInt my_nmax, string my_prefix);
@@ -72,7 +80,131 @@ protected:
   string      prefix;
 private:
   bool        indicesValid;
-  PetscErrorCode resetColumn();
+  PetscErrorCode resetColumn(PetscInt n);
+};
+
+//! \brief Solves tridiagonal systems assembled in several columns at once.
+/*!
+Systems set up by columnSystemCtx instances (see assembleThisColumn() in
+derived classes) are copied into "lanes" of a batch by add(); solve() then
+solves all of them together using the same algorithm as
+columnSystemCtx::solveTridiagonalSystem(), producing identical results.
+
+Coefficients are stored interleaved: row \c k of the system in lane \c l is
+at index \c k*width()+l. This way the loops over lanes in solve() have unit
+stride and no branches and can be vectorized by the compiler; the default
+width covers the widest SIMD registers (8 doubles).
+
+Only occupied rows are touched: add() copies the \c n rows of a system and
+solve() pads shorter systems with identity rows up to the size of the largest
+system in the batch.
+
+Use like this:
+\code
+  columnSystemBatch batch(Mz);
+  for (each column) {
+    system.setIndicesAndClearThisColumn(i,j,ks);
+    [set up the column]
+    system.assembleThisColumn();
+    batch.add(system, ks+1);
+    if (batch.full() || last column) {
+      batch.solve();
+      for (int l = 0; l < batch.size(); ++l) {
+        [check batch.pivot_error(l), then use batch.get_solution(l, x)]
+      }
+      batch.clear();
+    }
+  }
+\endcode
+ */
+class columnSystemBatch {
+public:
+  columnSystemBatch(PetscInt my_nmax, int my_width = default_width);
+  ~columnSystemBatch();
+
+  static const int default_width = 8;
+
+  //! Maximum number of systems in a batch.
+  int width() const { return m_width; }
+  //! Number of systems added since the last clear().
+  int size() const { return m_size; }
+  bool full() const { return m_size == m_width; }
+
+  void clear();
+  PetscErrorCode add(columnSystemCtx &system, PetscInt n);
+  PetscErrorCode solve();
+
+  PetscErrorCode pivot_error(int lane) const;
+  PetscErrorCode get_solution(int lane, PetscScalar *x) const;
+  PetscErrorCode get_system(int lane, columnSystemCtx &system) const;
+
+protected:
+  PetscInt m_nmax;
+  int m_width, m_size;
+  // interleaved coefficients, right-hand sides, pivots and solutions
+  PetscScalar *m_L, *m_D, *m_U, *m_rhs, *m_work, *m_pivot, *m_x;
+  // system size and column indices in each lane
+  std::vector<PetscInt> m_n, m_i, m_j;
+};
+
+//! \brief Vertical grid in the ice used by column systems (energy and age).
+/*!
+By default column systems use the fine, equally-spaced grid
+(IceGrid::zlevels_fine): values are interpolated from the storage grid to it
+and back. If `storage` is true, they use the storage grid (IceGrid::zlevels)
+directly, avoiding the interpolation; this grid is not equally-spaced in
+general.
+
+Systems use the spacings below to set up finite-difference approximations on
+the grid. On the fine grid every spacing is equal to dz() and the ratios
+are equal to 1 and 1/2 exactly, so that these approximations produce the
+same coefficients as the ones written for an equally-spaced grid.
+
+At level \f$k\f$ let \f$h_- = z_k - z_{k-1}\f$, \f$h_+ = z_{k+1} - z_k\f$ and
+\f$h = (h_- + h_+)/2\f$. Then
+- dz_minus[k] \f$= h_-\f$ and dz_plus[k] \f$= h_+\f$,
+- dz_layer[k] \f$= h\f$ is the thickness of the layer represented by level
+  \f$k\f$ (at the base the grid is extended by one level below zero,
+  symmetrically, as in basal Neumann boundary conditions),
+- G_minus[k] \f$= \Delta z^2 / (h_- h)\f$ and G_plus[k] \f$= \Delta z^2 / (h_+ h)\f$
+  scale the coefficients of the second derivative, written for the spacing
+  \f$\Delta z\f$ = dz(),
+- c_minus[k] \f$= h_- / (h_- + h_+)\f$ and c_plus[k] \f$= h_+ / (h_- + h_+)\f$
+  are the weights of the forward and the backward differences, respectively,
+  making up the (second-order) centered first derivative.
+ */
+class columnSystemGrid {
+public:
+  columnSystemGrid(IceGrid &grid, bool storage);
+
+  //! True if this is the storage grid.
+  bool storage() const { return m_storage; }
+  //! Number of levels.
+  PetscInt Mz() const { return m_Mz; }
+  //! Height of level `k` above the base of the ice.
+  PetscScalar z(PetscInt k) const { return (*m_z)[k]; }
+  //! Heights of all levels.
+  const vector<double>& levels() const { return *m_z; }
+  //! Reference spacing (the fine grid spacing or the storage grid spacing at the base).
+  PetscScalar dz() const { return m_dz; }
+
+  //! Index of the level just below the ice surface in the column `c`.
+  PetscInt ks(const PISMColumnList::Column &c) const
+  { return m_storage ? c.ks : c.fks; }
+
+  PetscErrorCode get_column(IceModelVec3 &f, PetscInt i, PetscInt j, PetscInt ks,
+                            PetscScalar *result) const;
+  PetscErrorCode set_column(IceModelVec3 &f, PetscInt i, PetscInt j,
+                            PetscScalar *values) const;
+  PetscErrorCode plane_star(IceModelVec3 &f, PetscInt i, PetscInt j, PetscInt k,
+                            planeStar<PetscScalar> *star) const;
+
+  vector<PetscScalar> dz_minus, dz_plus, dz_layer, G_minus, G_plus, c_minus, c_plus;
+protected:
+  bool m_storage;
+  PetscInt m_Mz;
+  PetscScalar m_dz;
+  const vector<double> *m_z;
 };
 
 #endif	/* __columnSystem_hh */
@@ -0,0 +1,180 @@
+// Copyright (C) 2004-2011 Jed Brown, Ed Bueler and Constantine Khroulev
+//
+// This file is part of PISM.
+//
+// PISM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 2 of the License, or (at your option) any later
+// version.
+//
+// PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License
+// along with PISM; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include <petsc.h>
+#include "pism_const.hh"
+#include "iceModelVec.hh"
+#include "ageSystem.hh"
+
+ageSystemCtx::ageSystemCtx(PetscInt my_Mz, string my_prefix)
+      : columnSystemCtx(my_Mz, my_prefix) { // size of system is Mz
+  Mz = my_Mz;
+  initAllDone = false;
+  // set values so we can check if init was called on all
+  dx = -1.0;
+  dy = -1.0;
+  dtAge = -1.0;
+  u = NULL;
+  v = NULL;
+  w = NULL;
+  tau3 = NULL;
+  vgrid = NULL;
+}
+
+
+PetscErrorCode ageSystemCtx::initAllColumns() {
+  // check whether each parameter & pointer got set
+  if (dx <= 0.0) { SETERRQ(PETSC_COMM_SELF, 2,"un-initialized dx in ageSystemCtx"); }
+  if (dy <= 0.0) { SETERRQ(PETSC_COMM_SELF, 3,"un-initialized dy in ageSystemCtx"); }
+  if (dtAge <= 0.0) { SETERRQ(PETSC_COMM_SELF, 4,"un-initialized dtAge in ageSystemCtx"); }
+  if (vgrid == NULL) { SETERRQ(PETSC_COMM_SELF, 5,"un-initialized pointer vgrid in ageSystemCtx"); }
+  if (vgrid->Mz() != Mz) { SETERRQ(PETSC_COMM_SELF, 10,"vgrid and ageSystemCtx sizes do not match"); }
+  if (u == NULL) { SETERRQ(PETSC_COMM_SELF, 6,"un-initialized pointer u in ageSystemCtx"); }
+  if (v == NULL) { SETERRQ(PETSC_COMM_SELF, 7,"un-initialized pointer v in ageSystemCtx"); }
+  if (w == NULL) { SETERRQ(PETSC_COMM_SELF, 8,"un-initialized pointer w in ageSystemCtx"); }
+  if (tau3 == NULL) { SETERRQ(PETSC_COMM_SELF, 9,"un-initialized pointer tau3 in ageSystemCtx"); }
+  // derived constants
+  nu_minus.resize(Mz);
+  nu_plus.resize(Mz);
+  for (PetscInt k = 0; k < Mz; ++k) {
+    nu_minus[k] = dtAge / vgrid->dz_minus[k];
+    nu_plus[k]  = dtAge / vgrid->dz_plus[k];
+  }
+  initAllDone = true;
+  return 0;
+}
+
+//! Conservative first-order upwind scheme with implicit in the vertical: one column solve.
+/*!
+The PDE being solved is
+    \f[ \frac{\partial \tau}{\partial t} + \frac{\partial}{\partial x}\left(u \tau\right) + \frac{\partial}{\partial y}\left(v \tau\right) + \frac{\partial}{\partial z}\left(w \tau\right) = 1. \f]
+This PDE has the conservative form identified in the comments on IceModel::ageStep().
+
+Let
+    \f[ \mathcal{U}(x,y_{i+1/2}) = x \, \begin{Bmatrix} y_i, \quad x \ge 0 \\ y_{i+1}, \quad x \le 0 \end{Bmatrix}. \f]
+Note that the two cases agree when \f$x=0\f$, so there is no conflict.  This is
+part of the upwind rule, and \f$x\f$ will be the cell-boundary (finite volume sense)
+value of the velocity.  Our discretization of the PDE uses this upwind notation 
+to build an explicit scheme for the horizontal terms and an implicit scheme for
+the vertical terms, as follows.
+
+Let
+    \f[ A_{i,j,k}^n \approx \tau(x_i,y_j,z_k) \f]
+be the numerical approximation of the exact value on the grid.  The scheme is
+\f{align*}{
+  \frac{A_{ijk}^{n+1} - A_{ijk}^n}{\Delta t} &+ \frac{\mathcal{U}(u_{i+1/2},A_{i+1/2,j,k}^n) - \mathcal{U}(u_{i-1/2},A_{i-1/2,j,k}^n)}{\Delta x} + \frac{\mathcal{U}(v_{j+1/2},A_{i,j+1/2,k}^n) - \mathcal{U}(v_{j-1/2},A_{i,j-1/2,k}^n)}{\Delta y} \\
+    &\qquad \qquad + \frac{\mathcal{U}(w_{k+1/2},A_{i,j,k+1/2}^{n+1}) - \mathcal{U}(w_{k-1/2},A_{i,j,k-1/2}^{n+1})}{\Delta z} = 1.
+  \f}
+Here velocity components \f$u,v,w\f$ are all evaluated at time \f$t_n\f$, so
+\f$u_{i+1/2} = u_{i+1/2,j,k}^n\f$ in more detail, and so on for all the other
+velocity values.  Note that this discrete form
+is manifestly conservative, in that, for example, the same term at \f$u_{i+1/2}\f$
+is used both in updating \f$A_{i,j,k}^{n+1}\f$ and \f$A_{i+1,j,k}^{n+1}\f$.
+
+Rewritten as a system of equations in the vertical index, let
+   \f[ \Phi_k = \Delta t - \frac{\Delta t}{\Delta x} \left[\mathcal{U}(u_{i+1/2},A_{i+1/2,j,k}^n) - \mathcal{U}(u_{i-1/2},A_{i-1/2,j,k}^n)\right] - \frac{\Delta t}{\Delta y} \left[\mathcal{U}(v_{j+1/2},A_{i,j+1/2,k}^n) - \mathcal{U}(v_{j-1/2},A_{i,j-1/2,k}^n)\right]. \f]
+Let \f$\nu = \Delta t / \Delta z\f$ (on a grid that is not equally-spaced
+\f$\Delta z\f$ is the spacing on the upwind side of level \f$k\f$) and for slight simplification denote \f$w_\pm = w_{k\pm 1/2}\f$.  The equation determining the unknown
+new age values in the column, denoted \f$a_k = A_{i,j,k}^{n+1}\f$, is
+   \f[ a_k + \nu \left[\mathcal{U}(w_+,a_{k+1/2}) - \mathcal{U}(w_-,a_{k-1/2})\right] = A_{ijk}^n + \Phi_k. \f]
+This is perhaps easiest to understand as four cases:
+\f{align*}{
+w_+\ge 0, w_-\ge 0:  && (-\nu w_-) a_{k-1} + (1 + \nu w_+) a_k + (0) a_{k+1} &= A_{ijk}^n + \Phi_k, \\
+w_+\ge 0, w_- < 0:   && (0) a_{k-1} + (1 + \nu w_+ - \nu w_-) a_k + (0) a_{k+1} &= A_{ijk}^n + \Phi_k, \\
+w_+ < 0,  w_-\ge 0:  && (-\nu w_-) a_{k-1} + (1) a_k + (+\nu w_+) a_{k+1} &= A_{ijk}^n + \Phi_k, \\
+w_+ < 0,  w_- < 0:   && (0) a_{k-1} + (1 - \nu w_-) a_k + (+\nu w_+) a_{k+1} &= A_{ijk}^n + \Phi_k.
+ \f}
+These equation form a tridiagonal system, i.e. the bandwidth does not exceed three.
+In every case the on-diagonal coefficient is greater than or equal to one,
+while the off-diagonal coefficients are always negative.  The coefficients
+approximately sum to one in each case, but only up to errors of size \f$O(\Delta z)\f$.
+These facts APPARENTLY imply that the method has a maximum principle \ref MortonMayers.
+
+
+FIXME:  THE COMMENT ABOVE HAS BEEN UPDATED TO THE 'CONSERVATIVE' FORM, BUT THE
+CODE STILL REFLECTS THE OLD SCHEME.
+
+FIXME:  CARE MUST BE TAKEN TO MAINTAIN CONSERVATISM AT SURFACE.
+ */
+PetscErrorCode ageSystemCtx::solveThisColumn(PetscScalar **x, PetscErrorCode &pivoterrorindex) {
+  PetscErrorCode ierr;
+
+  ierr = assembleThisColumn(); CHKERRQ(ierr);
+
+  // solve it
+  pivoterrorindex = solveTridiagonalSystem(ks+1,x);
+  return 0;
+}
+
+
+//! Set up the system solved by solveThisColumn() without solving it.
+PetscErrorCode ageSystemCtx::assembleThisColumn() {
+  PetscErrorCode ierr;
+  if (!initAllDone) {  SETERRQ(PETSC_COMM_SELF, 2,
+     "assembleThisColumn() should only be called after initAllColumns() in ageSystemCtx"); }
+
+  // set up system: 0 <= k < ks
+  for (PetscInt k = 0; k < ks; k++) {
+    planeStar<PetscScalar> ss;  // note ss.ij = tau[k]
+    ierr = vgrid->plane_star(*tau3, i, j, k, &ss); CHKERRQ(ierr);
+    // do lowest-order upwinding, explicitly for horizontal
+    rhs[k] =  (u[k] < 0) ? u[k] * (ss.e -  ss.ij) / dx
+                         : u[k] * (ss.ij  - ss.w) / dx;
+    rhs[k] += (v[k] < 0) ? v[k] * (ss.n -  ss.ij) / dy
+                         : v[k] * (ss.ij  - ss.s) / dy;
+    // note it is the age eqn: dage/dt = 1.0 and we have moved the hor.
+    //   advection terms over to right:
+    rhs[k] = ss.ij + dtAge * (1.0 - rhs[k]);
+
+    // do lowest-order upwinding, *implicitly* for vertical (using the
+    // spacing on the upwind side)
+    PetscScalar AA = (w[k] >= 0.0 ? nu_minus[k] : nu_plus[k]) * w[k];
+    if (k > 0) {
+      if (AA >= 0) { // upward velocity
+        L[k] = - AA;
+        D[k] = 1.0 + AA;
+        U[k] = 0.0;
+      } else { // downward velocity; note  -AA >= 0
+        L[k] = 0.0;
+        D[k] = 1.0 - AA;
+        U[k] = + AA;
+      }
+    } else { // k == 0 case
+      // note L[0] not an allocated location
+      if (AA > 0) { // if strictly upward velocity apply boundary condition:
+                    // age = 0 because ice is being added to base
+        D[0] = 1.0;
+        U[0] = 0.0;
+        rhs[0] = 0.0;
+      } else { // downward velocity; note  -AA >= 0
+        D[0] = 1.0 - AA;
+        U[0] = + AA;
+        // keep rhs[0] as is
+      }
+    }
+  }  // done "set up system: 0 <= k < ks"
+      
+  // surface b.c. at ks
+  if (ks>0) {
+    L[ks] = 0;
+    D[ks] = 1.0;   // ignore U[ks]
+    rhs[ks] = 0.0;  // age zero at surface
+  }
+
+  return 0;
+}
@@ -22,6 +22,7 @@
 #include "LocalInterpCtx.hh"
 #include "IceGrid.hh"
 #include "pism_options.hh"
+#include "PISMColumnChunks.hh"
 
 bool IceModelVec3BTU::good_init() {
   return ((n_levels >= 2) && (Lbz > 0.0) && (v != PETSC_NULL));
@@ -60,6 +61,7 @@ PetscErrorCode IceModelVec3BTU::create(IceGrid &mygrid, const char my_short_name
   } else {
     ierr = DMCreateGlobalVector(da, &v); CHKERRQ(ierr);
   }
+  grid->add_vec(this);
 
   vars[0].init_3d(name, mygrid, zlevels);
   vars[0].dimensions["z"] = "zb";
@@ -360,7 +362,6 @@ PetscErrorCode PISMBedThermalUnit::update(PetscReal my_t, PetscReal my_dt) {
 
   PetscReal dzb;
   temp.get_spacing(dzb);
-  const PetscInt  k0  = Mbz - 1;          // Tb[k0] = ice/bed interface temp, at z=0
 
 #if (PISM_DEBUG==1)
   for (PetscInt k = 0; k < Mbz; k++) { // working upward from base
@@ -371,28 +372,26 @@ PetscErrorCode PISMBedThermalUnit::update(PetscReal my_t, PetscReal my_dt) {
 
   const PetscReal bed_R  = bed_D * my_dt / (dzb * dzb);
 
-  PetscScalar *Tbold;
-  vector<PetscScalar> Tbnew(Mbz);
+  // columns are processed in chunks, possibly by several threads at once;
+  // see PISMColumnChunks
+  PISMColumnChunks chunks(config, grid.xm * grid.ym);
+  vector<PetscErrorCode> errors(chunks.size(), 0);
 
   ierr = temp.begin_access(); CHKERRQ(ierr);
   ierr = ghf->begin_access(); CHKERRQ(ierr);
   ierr = bedtoptemp->begin_access(); CHKERRQ(ierr);
-  for (PetscInt   i = grid.xs; i < grid.xs+grid.xm; ++i) {
-    for (PetscInt j = grid.ys; j < grid.ys+grid.ym; ++j) {
-
-      ierr = temp.getInternalColumn(i,j,&Tbold); CHKERRQ(ierr); // Tbold actually points into temp memory
-      Tbold[k0] = (*bedtoptemp)(i,j);  // sets Dirichlet explicit-in-time b.c. at top of bedrock column
 
-      const PetscReal Tbold_negone = Tbold[1] + 2 * (*ghf)(i,j) * dzb / bed_k;
-      Tbnew[0] = Tbold[0] + bed_R * (Tbold_negone - 2 * Tbold[0] + Tbold[1]);
-      for (PetscInt k = 1; k < k0; k++) { // working upward from base
-        Tbnew[k] = Tbold[k] + bed_R * (Tbold[k-1] - 2 * Tbold[k] + Tbold[k+1]);
-      }
-      Tbnew[k0] = (*bedtoptemp)(i,j);
+#if (PISM_USE_OPENMP==1)
+#pragma omp parallel for schedule(dynamic, 1) num_threads(chunks.threads())
+#endif
+  for (int c = 0; c < chunks.size(); ++c) {
+    errors[c] = update_columns(chunks.begin(c), chunks.end(c), dzb, bed_R);
+  }
 
-      ierr = temp.setInternalColumn(i,j,&Tbnew[0]); CHKERRQ(ierr); // copy from Tbnew into temp memory
-    }
+  for (int c = 0; c < chunks.size(); ++c) {
+    CHKERRQ(errors[c]);
   }
+
   ierr = bedtoptemp->end_access(); CHKERRQ(ierr);
   ierr = ghf->end_access(); CHKERRQ(ierr);
   ierr = temp.end_access(); CHKERRQ(ierr);
@@ -401,6 +400,40 @@ PetscErrorCode PISMBedThermalUnit::update(PetscReal my_t, PetscReal my_dt) {
 }
 
 
+//! Take a step of the bedrock heat equation in columns `begin`, ..., `end - 1`
+//! (numbered row by row within the owned part of the grid).
+/*!
+  Called by update(), possibly by several threads at once (processing
+  different columns).
+ */
+PetscErrorCode PISMBedThermalUnit::update_columns(unsigned int begin, unsigned int end,
+                                                  PetscReal dzb, PetscReal bed_R) {
+  PetscErrorCode ierr;
+  const PetscInt  k0  = Mbz - 1;          // Tb[k0] = ice/bed interface temp, at z=0
+
+  PetscScalar *Tbold;
+  vector<PetscScalar> Tbnew(Mbz);
+
+  for (unsigned int n = begin; n < end; ++n) {
+    const PetscInt i = grid.xs + n / grid.ym, j = grid.ys + n % grid.ym;
+
+    ierr = temp.getInternalColumn(i,j,&Tbold); CHKERRQ(ierr); // Tbold actually points into temp memory
+    Tbold[k0] = (*bedtoptemp)(i,j);  // sets Dirichlet explicit-in-time b.c. at top of bedrock column
+
+    const PetscReal Tbold_negone = Tbold[1] + 2 * (*ghf)(i,j) * dzb / bed_k;
+    Tbnew[0] = Tbold[0] + bed_R * (Tbold_negone - 2 * Tbold[0] + Tbold[1]);
+    for (PetscInt k = 1; k < k0; k++) { // working upward from base
+      Tbnew[k] = Tbold[k] + bed_R * (Tbold[k-1] - 2 * Tbold[k] + Tbold[k+1]);
+    }
+    Tbnew[k0] = (*bedtoptemp)(i,j);
+
+    ierr = temp.setInternalColumn(i,j,&Tbnew[0]); CHKERRQ(ierr); // copy from Tbnew into temp memory
+  }
+
+  return 0;
+}
+
+
 /*! Computes the heat flux from the bedrock thermal layer upward into the
 ice/bedrock interface:
   \f[G_0 = -k_b \frac{\partial T_b}{\partial z}\big|_{z=0}.\f]
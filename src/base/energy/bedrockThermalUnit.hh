@@ -122,6 +122,9 @@ protected:
   virtual PetscErrorCode bootstrap();
   virtual PetscErrorCode regrid();
 
+  virtual PetscErrorCode update_columns(unsigned int begin, unsigned int end,
+                                        PetscReal dzb, PetscReal bed_R);
+
   IceModelVec3BTU  temp;     //!< storage for bedrock thermal layer temperature;
                              //!    part of state; units K; equally-spaced layers;
                              //!    This IceModelVec is only created if Mbz > 1.
@@ -24,9 +24,11 @@
 #include "pism_petsc32_compat.hh"
 
 enthSystemCtx::enthSystemCtx(const NCConfigVariable &config,
-                             IceModelVec3 &my_Enth3, int my_Mz, string my_prefix)
-      : columnSystemCtx(my_Mz, my_prefix) {  // <- critical: sets size of sys
-  Mz = my_Mz;
+                             IceModelVec3 &my_Enth3, const columnSystemGrid &my_vgrid,
+                             string my_prefix)
+      : columnSystemCtx(my_vgrid.Mz(), my_prefix) {  // <- critical: sets size of sys
+  Mz = my_vgrid.Mz();
+  vgrid = &my_vgrid;
 
   // set some values so we can check if init was called
   nuEQ     = -1.0;
@@ -66,15 +68,23 @@ enthSystemCtx::~enthSystemCtx() {
 }
 
 
+//! Set column-independent parameters; the reference spacing dzEQ is columnSystemGrid::dz().
 PetscErrorCode enthSystemCtx::initAllColumns(PetscScalar my_dx,  PetscScalar my_dy, 
-                                             PetscScalar my_dtTemp,  PetscScalar my_dzEQ) {
+                                             PetscScalar my_dtTemp) {
   dx     = my_dx;
   dy     = my_dy;
   dtTemp = my_dtTemp;
-  dzEQ   = my_dzEQ;
+  dzEQ   = vgrid->dz();
   nuEQ     = dtTemp / dzEQ;
   iceRcold = (ice_K / ice_rho) * dtTemp / PetscSqr(dzEQ);
   iceRtemp = (ice_K0 / ice_rho) * dtTemp / PetscSqr(dzEQ);
+
+  nu_minus.resize(Mz);
+  nu_plus.resize(Mz);
+  for (PetscInt k = 0; k < Mz; ++k) {
+    nu_minus[k] = dtTemp / vgrid->dz_minus[k];
+    nu_plus[k]  = dtTemp / vgrid->dz_plus[k];
+  }
   return 0;
 }
 
@@ -206,7 +216,8 @@ its value from the value computed in assemble_R().
 
 The boundary condition is combined with the partial differential equation by the
 technique of introducing an imaginary point at \f$z=-\Delta z\f$ and then
-eliminating it.
+eliminating it. (Here \f$\Delta z\f$ is the spacing between the two lowest
+levels of the grid.)
 
 The error in the pure conductive and smooth conductivity case is \f$O(\Delta z^2)\f$.
 
@@ -229,20 +240,20 @@ PetscErrorCode enthSystemCtx::setBasalHeatFlux(PetscScalar hf) {
   const PetscScalar
     Rc = R[0],
     Rr = R[1],
-    Rminus = Rc,
-    Rplus  = 0.5 * (Rc + Rr);
+    Rminus = Rc * vgrid->G_minus[0],
+    Rplus  = 0.5 * (Rc + Rr) * vgrid->G_plus[0];
   a0 = 1.0 + Rminus + Rplus;  // = D[0]
   a1 = - Rminus - Rplus;      // = U[0]
   // next line says 
   //   (E(+dz) - E(-dz)) / (2 dz) = Y
   // or equivalently
   //   E(-dz) = E(+dz) + X
-  const PetscScalar X = - 2.0 * dzEQ * Y;
+  const PetscScalar X = - 2.0 * vgrid->dz_plus[0] * Y;
   // zero vertical velocity contribution
   b = Enth[0] + Rminus * X;   // = rhs[0]
   if (!ismarginal) {
     planeStar<PetscScalar> ss;
-    ierr = Enth3->getPlaneStar_fine(i,j,0,&ss); CHKERRQ(ierr);
+    ierr = vgrid->plane_star(*Enth3, i, j, 0, &ss); CHKERRQ(ierr);
     const PetscScalar UpEnthu = (u[0] < 0) ? u[0] * (ss.e -  ss.ij) / dx :
                                              u[0] * (ss.ij  - ss.w) / dx;
     const PetscScalar UpEnthv = (v[0] < 0) ? v[0] * (ss.n -  ss.ij) / dy :
@@ -266,6 +277,8 @@ In the case of conservation of energy [\ref AschwandenBuelerKhroulevBlatter],
   \f[ u=E \qquad \text{ and } \qquad D = \frac{K}{\rho} \qquad \text{ and } \qquad K = \frac{k}{c}. \f]
 Thus
   \f[ R = \frac{k \Delta t}{\rho c \Delta z^2}. \f]
+Here \f$\Delta z\f$ is the reference spacing columnSystemGrid::dz(); if the grid
+is not equally spaced, assembleThisColumn() scales these values using actual spacings.
  */
 PetscErrorCode enthSystemCtx::assemble_R() {
 
@@ -285,10 +298,32 @@ PetscErrorCode enthSystemCtx::assemble_R() {
 the new values of the ice enthalpy. */
 PetscErrorCode enthSystemCtx::solveThisColumn(PetscScalar **x, PetscErrorCode &pivoterrorindex) {
   PetscErrorCode ierr;
+
+  ierr = assembleThisColumn(); CHKERRQ(ierr);
+
+  // solve it; note drainage is not addressed yet and post-processing may occur
+  pivoterrorindex = solveTridiagonalSystem(ks+1, x);
+
+  // air above
+  for (PetscInt k = ks+1; k < Mz; k++) {
+    (*x)[k] = Enth_ks;
+  }
+
+  return 0;
+}
+
+
+/*! \brief Set up the system solved by solveThisColumn() without solving it.
+
+Values above the surface of the ice (equal to the surface enthalpy) are
+not a part of the system.
+ */
+PetscErrorCode enthSystemCtx::assembleThisColumn() {
+  PetscErrorCode ierr;
 #if (PISM_DEBUG==1)
   ierr = checkReadyToSolve(); CHKERRQ(ierr);
   if ((gsl_isnan(a0)) || (gsl_isnan(a1)) || (gsl_isnan(b))) {
-    SETERRQ(PETSC_COMM_SELF, 1, "solveThisColumn() should only be called after\n"
+    SETERRQ(PETSC_COMM_SELF, 1, "assembleThisColumn() should only be called after\n"
                "  setting basal boundary condition in enthSystemCtx"); }
 #endif
   // k=0 equation is already established
@@ -297,28 +332,37 @@ PetscErrorCode enthSystemCtx::solveThisColumn(PetscScalar **x, PetscErrorCode &p
   U[0] = a1;
   rhs[0] = b;
 
-  // generic ice segment in k location (if any; only runs if ks >= 2)
+  // generic ice segment in k location (if any; only runs if ks >= 2); the
+  // vertical advection term combines the upwinded first derivative (weight
+  // 1 - lambda) and the centered one (weight lambda); see columnSystemGrid
+  // regarding spacings
+  const vector<PetscScalar>
+    &G_minus = vgrid->G_minus, &G_plus = vgrid->G_plus,
+    &c_minus = vgrid->c_minus, &c_plus = vgrid->c_plus;
   for (PetscInt k = 1; k < ks; k++) {
     const PetscScalar
-        Rminus = 0.5 * (R[k-1] + R[k]  ),
-        Rplus  = 0.5 * (R[k]   + R[k+1]);
+        Rminus = 0.5 * (R[k-1] + R[k]  ) * G_minus[k],
+        Rplus  = 0.5 * (R[k]   + R[k+1]) * G_plus[k];
     L[k] = - Rminus;
     D[k] = 1.0 + Rminus + Rplus;
     U[k] = - Rplus;
-    const PetscScalar AA = nuEQ * w[k];
+    const PetscScalar
+      AAminus = nu_minus[k] * w[k],
+      AAplus  = nu_plus[k] * w[k],
+      AAc     = AAminus * c_plus[k] - AAplus * c_minus[k]; // zero if equally spaced
     if (w[k] >= 0.0) {  // velocity upward
-      L[k] -= AA * (1.0 - lambda/2.0);
-      D[k] += AA * (1.0 - lambda);
-      U[k] += AA * (lambda/2.0);
+      L[k] -= AAminus * (1.0 - lambda * c_minus[k]);
+      D[k] += AAminus * (1.0 - lambda) + lambda * AAc;
+      U[k] += AAplus * (lambda * c_minus[k]);
     } else {            // velocity downward
-      L[k] -= AA * (lambda/2.0);
-      D[k] -= AA * (1.0 - lambda);
-      U[k] += AA * (1.0 - lambda/2.0);
+      L[k] -= AAminus * (lambda * c_plus[k]);
+      D[k] -= AAplus * (1.0 - lambda) - lambda * AAc;
+      U[k] += AAplus * (1.0 - lambda * c_plus[k]);
     }
     rhs[k] = Enth[k];
     if (!ismarginal) {
       planeStar<PetscScalar> ss;
-      ierr = Enth3->getPlaneStar_fine(i,j,k,&ss); CHKERRQ(ierr);
+      ierr = vgrid->plane_star(*Enth3, i, j, k, &ss); CHKERRQ(ierr);
       const PetscScalar UpEnthu = (u[k] < 0) ? u[k] * (ss.e -  ss.ij) / dx :
                                                u[k] * (ss.ij  - ss.w) / dx;
       const PetscScalar UpEnthv = (v[k] < 0) ? v[k] * (ss.n -  ss.ij) / dy :
@@ -333,22 +377,12 @@ PetscErrorCode enthSystemCtx::solveThisColumn(PetscScalar **x, PetscErrorCode &p
   if (ks < Mz-1) U[ks] = 0.0;
   rhs[ks] = Enth_ks;
 
-  // solve it; note drainage is not addressed yet and post-processing may occur
-  pivoterrorindex = solveTridiagonalSystem(ks+1, x);
-
-  // air above
-  for (PetscInt k = ks+1; k < Mz; k++) {
-    (*x)[k] = Enth_ks;
-  }
-
 #if (PISM_DEBUG==1)
-  if (pivoterrorindex == 0) {
-    // if success, mark column as done by making scheme params and b.c. coeffs invalid
-    lambda  = -1.0;
-    a0 = GSL_NAN;
-    a1 = GSL_NAN;
-    b  = GSL_NAN;
-  }
+  // mark column as done by making scheme params and b.c. coeffs invalid
+  lambda  = -1.0;
+  a0 = GSL_NAN;
+  a1 = GSL_NAN;
+  b  = GSL_NAN;
 #endif
   return 0;
 }
@@ -31,6 +31,9 @@ class IceModelVec3;
 See the page documenting \ref bombproofenth.  The top of
 the ice has a Dirichlet condition.  
 
+The system uses the vertical grid given by a columnSystemGrid: the fine,
+equally-spaced grid or the storage grid.
+
 FIXME:  IS THIS THE RIGHT STRUCTURE?:  The boundary condition at the bottom of the
 ice depends on various cases, and these cases are not decided here.  Instead, 
 the user of this class sets the lowest-level (z=0) equation.
@@ -38,11 +41,12 @@ the user of this class sets the lowest-level (z=0) equation.
 class enthSystemCtx : public columnSystemCtx {
 
 public:
-  enthSystemCtx(const NCConfigVariable &config, IceModelVec3 &my_Enth3, int my_Mz, string my_prefix);
+  enthSystemCtx(const NCConfigVariable &config, IceModelVec3 &my_Enth3,
+                const columnSystemGrid &my_vgrid, string my_prefix);
   virtual ~enthSystemCtx();
 
   PetscErrorCode initAllColumns(PetscScalar my_dx, PetscScalar my_dy, 
-                                PetscScalar my_dtTemp, PetscScalar my_dzEQ);
+                                PetscScalar my_dtTemp);
 
   PetscErrorCode initThisColumn(bool my_ismarginal,
                                 PetscScalar my_lambda,
@@ -57,6 +61,7 @@ public:
   PetscErrorCode viewConstants(PetscViewer viewer, bool show_col_dependent);
   PetscErrorCode viewSystem(PetscViewer viewer) const;
 
+  PetscErrorCode assembleThisColumn();
   PetscErrorCode solveThisColumn(PetscScalar **x, PetscErrorCode &pivoterrorindex);
 
 public:
@@ -72,6 +77,8 @@ protected:
   PetscScalar  ice_rho, ice_c, ice_k, ice_K, ice_K0,
                dx, dy, dtTemp, dzEQ, nuEQ, iceK, iceRcold, iceRtemp;
   IceModelVec3 *Enth3;
+  const columnSystemGrid *vgrid;
+  vector<PetscScalar> nu_minus, nu_plus; // dtTemp / dz_minus and dtTemp / dz_plus at each level
   PetscScalar  lambda, Enth_ks, a0, a1, b;
   bool         ismarginal;
   vector<PetscScalar> R; // value of k \Delta t / (\rho c \Delta x^2) in
@@ -34,7 +34,6 @@ tempSystemCtx::tempSystemCtx(PetscInt my_Mz, string my_prefix)
   dx = -1;
   dy = -1;
   dtTemp = -1;
-  dzEQ = -1;
   ice_rho = -1;
   ice_c_p = -1;
   ice_k = -1;
@@ -44,6 +43,7 @@ tempSystemCtx::tempSystemCtx(PetscInt my_Mz, string my_prefix)
   w = NULL;
   Sigma = NULL;
   T3 = NULL;
+  vgrid = NULL;
 }
 
 
@@ -52,7 +52,8 @@ PetscErrorCode tempSystemCtx::initAllColumns() {
   if (dx <= 0.0) { SETERRQ(PETSC_COMM_SELF, 2,"un-initialized dx in tempSystemCtx"); }
   if (dy <= 0.0) { SETERRQ(PETSC_COMM_SELF, 3,"un-initialized dy in tempSystemCtx"); }
   if (dtTemp <= 0.0) { SETERRQ(PETSC_COMM_SELF, 4,"un-initialized dtTemp in tempSystemCtx"); }
-  if (dzEQ <= 0.0) { SETERRQ(PETSC_COMM_SELF, 5,"un-initialized dzEQ in tempSystemCtx"); }
+  if (vgrid == NULL) { SETERRQ(PETSC_COMM_SELF, 5,"un-initialized pointer vgrid in tempSystemCtx"); }
+  if (vgrid->Mz() != Mz) { SETERRQ(PETSC_COMM_SELF, 6,"vgrid and tempSystemCtx sizes do not match"); }
   if (ice_rho <= 0.0) { SETERRQ(PETSC_COMM_SELF, 7,"un-initialized ice_rho in tempSystemCtx"); }
   if (ice_c_p <= 0.0) { SETERRQ(PETSC_COMM_SELF, 8,"un-initialized ice_c_p in tempSystemCtx"); }
   if (ice_k <= 0.0) { SETERRQ(PETSC_COMM_SELF, 9,"un-initialized ice_k in tempSystemCtx"); }
@@ -63,10 +64,16 @@ PetscErrorCode tempSystemCtx::initAllColumns() {
   if (Sigma == NULL) { SETERRQ(PETSC_COMM_SELF, 18,"un-initialized pointer Sigma in tempSystemCtx"); }
   if (T3 == NULL) { SETERRQ(PETSC_COMM_SELF, 19,"un-initialized pointer T3 in tempSystemCtx"); }
   // set derived constants
-  nuEQ = dtTemp / dzEQ;
+  dzEQ = vgrid->dz();
   rho_c_I = ice_rho * ice_c_p;
   iceK = ice_k / rho_c_I;
   iceR = iceK * dtTemp / PetscSqr(dzEQ);
+  nu_minus.resize(Mz);
+  nu_plus.resize(Mz);
+  for (PetscInt k = 0; k < Mz; ++k) {
+    nu_minus[k] = dtTemp / vgrid->dz_minus[k];
+    nu_plus[k]  = dtTemp / vgrid->dz_plus[k];
+  }
   // done
   initAllDone = true;
   return 0;
@@ -113,15 +120,27 @@ PetscErrorCode tempSystemCtx::setBasalBoundaryValuesThisColumn(
 
 
 PetscErrorCode tempSystemCtx::solveThisColumn(PetscScalar **x, PetscErrorCode &pivoterrorindex) {
+  PetscErrorCode ierr;
+
+  ierr = assembleThisColumn(); CHKERRQ(ierr);
+
+  // solve it; note melting not addressed yet
+  pivoterrorindex = solveTridiagonalSystem(ks+1,x);
+  return 0;
+}
+
+
+//! Set up the system solved by solveThisColumn() without solving it.
+PetscErrorCode tempSystemCtx::assembleThisColumn() {
 
   if (!initAllDone) {  SETERRQ(PETSC_COMM_SELF, 2,
-     "solveThisColumn() should only be called after initAllColumns() in tempSystemCtx"); }
+     "assembleThisColumn() should only be called after initAllColumns() in tempSystemCtx"); }
   if (!schemeParamsValid) {  SETERRQ(PETSC_COMM_SELF, 3,
-     "solveThisColumn() should only be called after setSchemeParamsThisColumn() in tempSystemCtx"); }
+     "assembleThisColumn() should only be called after setSchemeParamsThisColumn() in tempSystemCtx"); }
   if (!surfBCsValid) {  SETERRQ(PETSC_COMM_SELF, 3,
-     "solveThisColumn() should only be called after setSurfaceBoundaryValuesThisColumn() in tempSystemCtx"); }
+     "assembleThisColumn() should only be called after setSurfaceBoundaryValuesThisColumn() in tempSystemCtx"); }
   if (!basalBCsValid) {  SETERRQ(PETSC_COMM_SELF, 3,
-     "solveThisColumn() should only be called after setBasalBoundaryValuesThisColumn() in tempSystemCtx"); }
+     "assembleThisColumn() should only be called after setBasalBoundaryValuesThisColumn() in tempSystemCtx"); }
 
   Mask M;
 
@@ -138,6 +157,9 @@ PetscErrorCode tempSystemCtx::solveThisColumn(PetscScalar **x, PetscErrorCode &p
       rhs[0] = Ts; 
     }
   } else { // ks > 0; there is ice
+    // spacing between the two lowest levels and the corresponding R
+    const PetscScalar dz0 = vgrid->dz_plus[0],
+      R0 = iceR * vgrid->G_plus[0];
     // for w, always difference *up* from base, but make it implicit
     if (M.ocean(mask)) {
       // just apply Dirichlet condition to base of column of ice in an ice shelf
@@ -147,7 +169,7 @@ PetscErrorCode tempSystemCtx::solveThisColumn(PetscScalar **x, PetscErrorCode &p
       rhs[0] = Tshelfbase; // set by PISMOceanCoupler
     } else { 
       // there is *grounded* ice; from FV across interface
-      rhs[0] = T[0] + dtTemp * (Rb / (rho_c_I * dzEQ));
+      rhs[0] = T[0] + dtTemp * (Rb / (rho_c_I * dz0));
       if (!isMarginal) {
         rhs[0] += dtTemp * 0.5 * Sigma[0]/ rho_c_I;
         planeStar<PetscScalar> ss;
@@ -160,35 +182,44 @@ PetscErrorCode tempSystemCtx::solveThisColumn(PetscScalar **x, PetscErrorCode &p
       }
       // vertical upwinding
       // L[0] = 0.0;  (is not an allocated location!) 
-      D[0] = 1.0 + 2.0 * iceR;
-      U[0] = - 2.0 * iceR;
+      D[0] = 1.0 + 2.0 * R0;
+      U[0] = - 2.0 * R0;
       if (w[0] < 0.0) { // velocity downward: add velocity contribution
-        const PetscScalar AA = dtTemp * w[0] / (2.0 * dzEQ);
+        const PetscScalar AA = dtTemp * w[0] / (2.0 * dz0);
         D[0] -= AA;
         U[0] += AA;
       }
       // apply geothermal flux G0 here
-      rhs[0] += 2.0 * dtTemp * G0 / (rho_c_I * dzEQ);
+      rhs[0] += 2.0 * dtTemp * G0 / (rho_c_I * dz0);
     }
   }
 
-  // generic ice segment; build 1:ks-1 eqns
+  // generic ice segment; build 1:ks-1 eqns; see columnSystemGrid regarding
+  // spacings
   for (PetscInt k = 1; k < ks; k++) {
     planeStar<PetscScalar> ss;
-    T3->getPlaneStar_fine(i,j,k,&ss);
+    vgrid->plane_star(*T3, i, j, k, &ss);
     const PetscScalar UpTu = (u[k] < 0) ? u[k] * (ss.e -  ss.ij) / dx :
                                           u[k] * (ss.ij  - ss.w) / dx;
     const PetscScalar UpTv = (v[k] < 0) ? v[k] * (ss.n -  ss.ij) / dy :
                                           v[k] * (ss.ij  - ss.s) / dy;
-    const PetscScalar AA = nuEQ * w[k];      
+    const PetscScalar
+      Rminus = iceR * vgrid->G_minus[k],
+      Rplus  = iceR * vgrid->G_plus[k];
+    const PetscScalar
+      c_minus = vgrid->c_minus[k],
+      c_plus  = vgrid->c_plus[k],
+      AAminus = nu_minus[k] * w[k],
+      AAplus  = nu_plus[k] * w[k],
+      AAc     = AAminus * c_plus - AAplus * c_minus; // zero if equally spaced
     if (w[k] >= 0.0) {  // velocity upward
-      L[k] = - iceR - AA * (1.0 - lambda/2.0);
-      D[k] = 1.0 + 2.0 * iceR + AA * (1.0 - lambda);
-      U[k] = - iceR + AA * (lambda/2.0);
+      L[k] = - Rminus - AAminus * (1.0 - lambda * c_minus);
+      D[k] = 1.0 + (Rminus + Rplus) + (AAminus * (1.0 - lambda) + lambda * AAc);
+      U[k] = - Rplus + AAplus * (lambda * c_minus);
     } else {  // velocity downward
-      L[k] = - iceR - AA * (lambda/2.0);
-      D[k] = 1.0 + 2.0 * iceR - AA * (1.0 - lambda);
-      U[k] = - iceR + AA * (1.0 - lambda/2.0);
+      L[k] = - Rminus - AAminus * (lambda * c_plus);
+      D[k] = 1.0 + (Rminus + Rplus) - (AAplus * (1.0 - lambda) - lambda * AAc);
+      U[k] = - Rplus + AAplus * (1.0 - lambda * c_plus);
     }
     rhs[k] = T[k];
     if (!isMarginal) {
@@ -209,8 +240,6 @@ PetscErrorCode tempSystemCtx::solveThisColumn(PetscScalar **x, PetscErrorCode &p
   surfBCsValid = false;
   basalBCsValid = false;
 
-  // solve it; note melting not addressed yet
-  pivoterrorindex = solveTridiagonalSystem(ks+1,x);
   return 0;
 }
 
@@ -58,6 +58,7 @@ public:
   PetscErrorCode setBasalBoundaryValuesThisColumn(
                      PetscScalar my_G0, PetscScalar my_Tshelfbase, PetscScalar my_Rb);
 
+  PetscErrorCode assembleThisColumn();
   PetscErrorCode solveThisColumn(PetscScalar **x, PetscErrorCode &pivoterrorindex);  
 
 public:
@@ -65,7 +66,6 @@ public:
   PetscScalar  dx,
                dy,
                dtTemp,
-               dzEQ,
                ice_rho,
                ice_c_p,
                ice_k;
@@ -76,16 +76,18 @@ public:
                *w,
                *Sigma;
   IceModelVec3 *T3;
+  const columnSystemGrid *vgrid; // vertical grid; has to have my_Mz levels
 
 protected: // used internally
   PetscInt    Mz;
   PetscScalar lambda, Ts, G0, Tshelfbase, Rb;
   PismMask    mask;
   bool        isMarginal;
-  PetscScalar nuEQ,
+  PetscScalar dzEQ,
               rho_c_I,
               iceK,
               iceR;
+  vector<PetscScalar> nu_minus, nu_plus; // dtTemp / dz_minus and dtTemp / dz_plus at each level
   bool        initAllDone,
               indicesValid,
               schemeParamsValid,
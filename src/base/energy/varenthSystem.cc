@@ -24,9 +24,10 @@
 #include "NCVariable.hh"
 
 varenthSystemCtx::varenthSystemCtx(const NCConfigVariable &config,
-                                     IceModelVec3 &my_Enth3, int my_Mz,
+                                     IceModelVec3 &my_Enth3,
+                                     const columnSystemGrid &my_vgrid,
                                      string my_prefix, EnthalpyConverter *my_EC)
-  : enthSystemCtx(config, my_Enth3, my_Mz, my_prefix), EC(my_EC),
+  : enthSystemCtx(config, my_Enth3, my_vgrid, my_prefix), EC(my_EC),
     ice_thickness(0) {
 
   if (config.get_flag("use_temperature_dependent_thermal_conductivity"))
@@ -72,7 +73,7 @@ PetscErrorCode varenthSystemCtx::assemble_R() {
   for (PetscInt k = 0; k <= ks; k++) {
     if (Enth[k] < Enth_s[k]) {
       // cold case
-      const PetscScalar depth = ice_thickness - k * dzEQ;
+      const PetscScalar depth = ice_thickness - vgrid->z(k);
       PetscScalar T;
       ierr = EC->getAbsTemp(Enth[k], EC->getPressureFromDepth(depth), // FIXME: issue #15
                             T); CHKERRQ(ierr);
@@ -33,7 +33,8 @@ class varenthSystemCtx : public enthSystemCtx {
 
 public:
   varenthSystemCtx(const NCConfigVariable &config, IceModelVec3 &my_Enth3,
-                    int my_Mz, string my_prefix, EnthalpyConverter *EC);
+                   const columnSystemGrid &my_vgrid, string my_prefix,
+                   EnthalpyConverter *EC);
   virtual ~varenthSystemCtx() {}
 
   PetscScalar k_from_T(PetscScalar T);
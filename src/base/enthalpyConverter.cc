@@ -17,6 +17,7 @@
 // Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include <petsc.h>  // for PetscErrorPrintf, etc.
+#include <typeinfo>
 #include "pism_const.hh"
 #include "enthalpyConverter.hh"
 #include "NCVariable.hh"
@@ -322,3 +323,155 @@ PetscErrorCode EnthalpyConverter::getEnthAtWaterFraction(
   return 0;
 }
 
+
+//! Returns true if "_column" methods can use inlined formulas.
+/*!
+Derived classes may re-implement any of the scalar methods, so in derived
+classes "_column" methods call scalar methods.
+ */
+bool EnthalpyConverter::inline_column_methods() const {
+  return typeid(*this) == typeid(EnthalpyConverter);
+}
+
+//! Computes pressures at levels `z[0], ..., z[n-1]` in ice of thickness `thickness`.
+/*!
+Uses depths "thickness - z[k]"; see getPressureFromDepth().
+ */
+void EnthalpyConverter::getPressureFromDepth_column(int n, double thickness, const double *z,
+                                                    double *p) const {
+  if (inline_column_methods()) {
+    for (int k = 0; k < n; ++k) {
+      const double depth = thickness - z[k];
+      p[k] = (depth <= 0.0) ? p_air : p_air + rho_i * g * depth;
+    }
+  } else {
+    for (int k = 0; k < n; ++k)
+      p[k] = getPressureFromDepth(thickness - z[k]);
+  }
+}
+
+//! Column version of getEnthalpyCTS(); `p` and `E_s` may be the same array.
+void EnthalpyConverter::getEnthalpyCTS_column(int n, const double *p, double *E_s) const {
+  if (inline_column_methods()) {
+    for (int k = 0; k < n; ++k)
+      E_s[k] = c_i * ((T_melting - beta * p[k]) - T_0);
+  } else {
+    for (int k = 0; k < n; ++k)
+      E_s[k] = getEnthalpyCTS(p[k]);
+  }
+}
+
+void EnthalpyConverter::getCTS_column(int n, const double *E, const double *p,
+                                      double *result) const {
+  if (inline_column_methods()) {
+    for (int k = 0; k < n; ++k)
+      result[k] = E[k] / (c_i * ((T_melting - beta * p[k]) - T_0));
+  } else {
+    for (int k = 0; k < n; ++k)
+      result[k] = getCTS(E[k], p[k]);
+  }
+}
+
+/*!
+Returns 1 if at least one of the values of enthalpy exceeds that of liquid
+water; all the temperatures are computed in any case. See getAbsTemp().
+ */
+PetscErrorCode EnthalpyConverter::getAbsTemp_column(int n, const double *E, const double *p,
+                                                    double *T) const {
+  int liquified = 0;
+
+  if (inline_column_methods()) {
+    for (int k = 0; k < n; ++k) {
+      const double
+        T_m = T_melting - beta * p[k],
+        E_s = c_i * (T_m - T_0),
+        E_l = E_s + L;
+      T[k] = (E[k] < E_s) ? (E[k] / c_i) + T_0 : T_m;
+      liquified += (E[k] >= E_l);
+    }
+  } else {
+    for (int k = 0; k < n; ++k) {
+      if (getAbsTemp(E[k], p[k], T[k]) != 0)
+        liquified += 1;
+    }
+  }
+
+  return liquified > 0 ? 1 : 0;
+}
+
+/*!
+Returns 1 if at least one of the values of enthalpy exceeds that of liquid
+water (like getAbsTemp_column()).
+ */
+PetscErrorCode EnthalpyConverter::getPATemp_column(int n, const double *E, const double *p,
+                                                   double *T_pa) const {
+  int liquified = 0;
+
+  if (inline_column_methods()) {
+    liquified = getAbsTemp_column(n, E, p, T_pa);
+    for (int k = 0; k < n; ++k)
+      T_pa[k] = T_pa[k] - (T_melting - beta * p[k]) + T_melting;
+  } else {
+    for (int k = 0; k < n; ++k) {
+      if (getPATemp(E[k], p[k], T_pa[k]) != 0)
+        liquified += 1;
+    }
+  }
+
+  return liquified > 0 ? 1 : 0;
+}
+
+/*!
+Returns 1 if at least one of the values of enthalpy exceeds that of liquid
+water; all the water fractions are computed in any case. See getWaterFraction().
+ */
+PetscErrorCode EnthalpyConverter::getWaterFraction_column(int n, const double *E, const double *p,
+                                                          double *omega) const {
+  int liquified = 0;
+
+  if (inline_column_methods()) {
+    for (int k = 0; k < n; ++k) {
+      const double
+        E_s = c_i * ((T_melting - beta * p[k]) - T_0),
+        E_l = E_s + L;
+      omega[k] = (E[k] >= E_l) ? 1.0 : ((E[k] <= E_s) ? 0.0 : (E[k] - E_s) / L);
+      liquified += (E[k] >= E_l);
+    }
+  } else {
+    for (int k = 0; k < n; ++k) {
+      if (getWaterFraction(E[k], p[k], omega[k]) != 0)
+        liquified += 1;
+    }
+  }
+
+  return liquified > 0 ? 1 : 0;
+}
+
+//! Column version of getEnthPermissive(); `omega` may be NULL, meaning zero liquid fraction.
+PetscErrorCode EnthalpyConverter::getEnthPermissive_column(int n, const double *T,
+                                                           const double *omega,
+                                                           const double *p, double *E) const {
+  PetscErrorCode ierr;
+
+  if (inline_column_methods()) {
+#if (PISM_DEBUG==1)
+    for (int k = 0; k < n; ++k) {
+      if (T[k] <= 0.0) {
+        SETERRQ1(PETSC_COMM_SELF, 1,"\n\nT = %f <= 0 is not a valid absolute temperature\n\n",T[k]);
+      }
+    }
+#endif
+    for (int k = 0; k < n; ++k) {
+      const double
+        T_m = T_melting - beta * p[k],
+        w   = (omega != NULL) ? PetscMax(0.0, PetscMin(omega[k], 1.0)) : 0.0;
+      // T >= T_m(p) is replaced with T = T_m(p)
+      E[k] = (T[k] < T_m) ? c_i * (T[k] - T_0) : c_i * (T_m - T_0) + w * L;
+    }
+  } else {
+    for (int k = 0; k < n; ++k) {
+      ierr = getEnthPermissive(T[k], (omega != NULL) ? omega[k] : 0.0, p[k], E[k]); CHKERRQ(ierr);
+    }
+  }
+  return 0;
+}
@@ -52,9 +52,24 @@ The three methods that get the enthalpy from temperatures and liquid fractions,
 namely getEnth(), getEnthPermissive(), getEnthAtWaterFraction(), are more strict
 about error checking.  They call SETERRQ() if their arguments are invalid.
 
+Methods with names ending in "_column" apply the method of the same name to
+arrays of \c n values (levels in a column), for example
+\code
+  EC.getPressureFromDepth_column(ks + 1, H, &grid.zlevels[0], p);
+  ierr = EC.getWaterFraction_column(ks + 1, E, p, omega); CHKERRQ(ierr);
+\endcode
+In this class they inline the formulas, so the loops over levels can be
+vectorized; results are identical to those of the scalar methods. In derived
+classes they call the (virtual) scalar methods, so derived classes do not need
+to re-implement them. Error codes are the ones of the scalar methods; the
+value 1 returned by getAbsTemp_column(), getPATemp_column() and
+getWaterFraction_column() means that at least one of the values corresponds to
+liquid water (all the values are computed in this case).
+
 This class is documented by [\ref AschwandenBuelerKhroulevBlatter].
 */
 class EnthalpyConverter {
+  friend class IceFlowLawKernels;
 public:
   EnthalpyConverter(const NCConfigVariable &config);
   virtual ~EnthalpyConverter() {}
@@ -82,7 +97,23 @@ public:
   virtual PetscReal c_from_T(PetscReal /*T*/)
   { return c_i; }
 
+  void           getPressureFromDepth_column(int n, double thickness, const double *z,
+                                             double *p) const;
+  void           getEnthalpyCTS_column(int n, const double *p, double *E_s) const;
+  void           getCTS_column(int n, const double *E, const double *p, double *result) const;
+
+  PetscErrorCode getAbsTemp_column(int n, const double *E, const double *p, double *T) const;
+  PetscErrorCode getPATemp_column(int n, const double *E, const double *p, double *T_pa) const;
+
+  PetscErrorCode getWaterFraction_column(int n, const double *E, const double *p,
+                                         double *omega) const;
+
+  PetscErrorCode getEnthPermissive_column(int n, const double *T, const double *omega,
+                                          const double *p, double *E) const;
+
 protected:
+  bool inline_column_methods() const;
+
   double T_melting, L, c_i, rho_i, g, p_air, beta, T_tol;
   double T_0;
   bool   do_cold_ice_methods;
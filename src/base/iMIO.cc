@@ -91,6 +91,13 @@ PetscErrorCode  IceModel::writeFiles(string default_filename) {
 		      prof_output_name.c_str());
     CHKERRQ(ierr);
 
+    grid.profiler->set_value("ghost_updates",
+                             "number of ghost updates of fields on this processor",
+                             "count", grid.ghost_updates);
+    grid.profiler->set_value("ghost_updates_elided",
+                             "number of ghost updates skipped because ghosts were up to date",
+                             "count", grid.ghost_updates_elided);
+
     ierr = grid.profiler->save_report(prof_output_name); CHKERRQ(ierr);
   }
 #endif
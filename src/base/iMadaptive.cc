@@ -201,6 +201,17 @@ PetscErrorCode IceModel::determineTimeStep(const bool doTemperatureCFL) {
         adaptReasonFlag = 'c';
       }
     }
+    if (config.get_flag("do_age") && config.get_flag("age_semi_lagrangian") &&
+        (gmaxu > 0.0 || gmaxv > 0.0)) {
+      // IceModel::step() updates the age once departure points could be half
+      // way to the edge of the halo of tau3_sl; this step keeps them in the
+      // halo until then (even if the 3D CFL condition is not used)
+      const PetscReal dt_from_age = 0.5 * ageSemiLagrangianMaxTimeStep();
+      if (dt_from_age < dt) {
+        dt = dt_from_age;
+        adaptReasonFlag = 'a';
+      }
+    }
     if (btu) {
       PetscReal btu_dt;
       bool restrict;
@@ -18,177 +18,13 @@
 
 #include <petscdmda.h>
 #include "iceModelVec.hh"
-#include "columnSystem.hh"
+#include "ageSystem.hh"
 #include "iceModel.hh"
 #include "PISMStressBalance.hh"
 #include "IceGrid.hh"
 #include "pism_options.hh"
-
-//! Tridiagonal linear system for vertical column of age (pure advection) problem.
-class ageSystemCtx : public columnSystemCtx {
-
-public:
-  ageSystemCtx(PetscInt my_Mz, string my_prefix);
-  PetscErrorCode initAllColumns();
-
-  PetscErrorCode solveThisColumn(PetscScalar **x, PetscErrorCode &pivoterrorindex);  
-
-public:
-  // constants which should be set before calling initForAllColumns()
-  PetscScalar  dx,
-               dy,
-               dtAge,
-               dzEQ;
-  // pointers which should be set before calling initForAllColumns()
-  PetscScalar  *u,
-               *v,
-               *w;
-  IceModelVec3 *tau3;
-
-protected: // used internally
-  PetscScalar nuEQ;
-  bool        initAllDone;
-};
-
-
-ageSystemCtx::ageSystemCtx(PetscInt my_Mz, string my_prefix)
-      : columnSystemCtx(my_Mz, my_prefix) { // size of system is Mz
-  initAllDone = false;
-  // set values so we can check if init was called on all
-  dx = -1.0;
-  dy = -1.0;
-  dtAge = -1.0;
-  dzEQ = -1.0;
-  u = NULL;
-  v = NULL;
-  w = NULL;
-  tau3 = NULL;
-}
-
-
-PetscErrorCode ageSystemCtx::initAllColumns() {
-  // check whether each parameter & pointer got set
-  if (dx <= 0.0) { SETERRQ(PETSC_COMM_SELF, 2,"un-initialized dx in ageSystemCtx"); }
-  if (dy <= 0.0) { SETERRQ(PETSC_COMM_SELF, 3,"un-initialized dy in ageSystemCtx"); }
-  if (dtAge <= 0.0) { SETERRQ(PETSC_COMM_SELF, 4,"un-initialized dtAge in ageSystemCtx"); }
-  if (dzEQ <= 0.0) { SETERRQ(PETSC_COMM_SELF, 5,"un-initialized dzEQ in ageSystemCtx"); }
-  if (u == NULL) { SETERRQ(PETSC_COMM_SELF, 6,"un-initialized pointer u in ageSystemCtx"); }
-  if (v == NULL) { SETERRQ(PETSC_COMM_SELF, 7,"un-initialized pointer v in ageSystemCtx"); }
-  if (w == NULL) { SETERRQ(PETSC_COMM_SELF, 8,"un-initialized pointer w in ageSystemCtx"); }
-  if (tau3 == NULL) { SETERRQ(PETSC_COMM_SELF, 9,"un-initialized pointer tau3 in ageSystemCtx"); }
-  nuEQ = dtAge / dzEQ; // derived constant
-  initAllDone = true;
-  return 0;
-}
-
-//! Conservative first-order upwind scheme with implicit in the vertical: one column solve.
-/*!
-The PDE being solved is
-    \f[ \frac{\partial \tau}{\partial t} + \frac{\partial}{\partial x}\left(u \tau\right) + \frac{\partial}{\partial y}\left(v \tau\right) + \frac{\partial}{\partial z}\left(w \tau\right) = 1. \f]
-This PDE has the conservative form identified in the comments on IceModel::ageStep().
-
-Let
-    \f[ \mathcal{U}(x,y_{i+1/2}) = x \, \begin{Bmatrix} y_i, \quad x \ge 0 \\ y_{i+1}, \quad x \le 0 \end{Bmatrix}. \f]
-Note that the two cases agree when \f$x=0\f$, so there is no conflict.  This is
-part of the upwind rule, and \f$x\f$ will be the cell-boundary (finite volume sense)
-value of the velocity.  Our discretization of the PDE uses this upwind notation 
-to build an explicit scheme for the horizontal terms and an implicit scheme for
-the vertical terms, as follows.
-
-Let
-    \f[ A_{i,j,k}^n \approx \tau(x_i,y_j,z_k) \f]
-be the numerical approximation of the exact value on the grid.  The scheme is
-\f{align*}{
-  \frac{A_{ijk}^{n+1} - A_{ijk}^n}{\Delta t} &+ \frac{\mathcal{U}(u_{i+1/2},A_{i+1/2,j,k}^n) - \mathcal{U}(u_{i-1/2},A_{i-1/2,j,k}^n)}{\Delta x} + \frac{\mathcal{U}(v_{j+1/2},A_{i,j+1/2,k}^n) - \mathcal{U}(v_{j-1/2},A_{i,j-1/2,k}^n)}{\Delta y} \\
-    &\qquad \qquad + \frac{\mathcal{U}(w_{k+1/2},A_{i,j,k+1/2}^{n+1}) - \mathcal{U}(w_{k-1/2},A_{i,j,k-1/2}^{n+1})}{\Delta z} = 1.
-  \f}
-Here velocity components \f$u,v,w\f$ are all evaluated at time \f$t_n\f$, so
-\f$u_{i+1/2} = u_{i+1/2,j,k}^n\f$ in more detail, and so on for all the other
-velocity values.  Note that this discrete form
-is manifestly conservative, in that, for example, the same term at \f$u_{i+1/2}\f$
-is used both in updating \f$A_{i,j,k}^{n+1}\f$ and \f$A_{i+1,j,k}^{n+1}\f$.
-
-Rewritten as a system of equations in the vertical index, let
-   \f[ \Phi_k = \Delta t - \frac{\Delta t}{\Delta x} \left[\mathcal{U}(u_{i+1/2},A_{i+1/2,j,k}^n) - \mathcal{U}(u_{i-1/2},A_{i-1/2,j,k}^n)\right] - \frac{\Delta t}{\Delta y} \left[\mathcal{U}(v_{j+1/2},A_{i,j+1/2,k}^n) - \mathcal{U}(v_{j-1/2},A_{i,j-1/2,k}^n)\right]. \f]
-Let \f$\nu = \Delta t / \Delta z\f$ and for slight simplification denote \f$w_\pm = w_{k\pm 1/2}\f$.  The equation determining the unknown
-new age values in the column, denoted \f$a_k = A_{i,j,k}^{n+1}\f$, is
-   \f[ a_k + \nu \left[\mathcal{U}(w_+,a_{k+1/2}) - \mathcal{U}(w_-,a_{k-1/2})\right] = A_{ijk}^n + \Phi_k. \f]
-This is perhaps easiest to understand as four cases:
-\f{align*}{
-w_+\ge 0, w_-\ge 0:  && (-\nu w_-) a_{k-1} + (1 + \nu w_+) a_k + (0) a_{k+1} &= A_{ijk}^n + \Phi_k, \\
-w_+\ge 0, w_- < 0:   && (0) a_{k-1} + (1 + \nu w_+ - \nu w_-) a_k + (0) a_{k+1} &= A_{ijk}^n + \Phi_k, \\
-w_+ < 0,  w_-\ge 0:  && (-\nu w_-) a_{k-1} + (1) a_k + (+\nu w_+) a_{k+1} &= A_{ijk}^n + \Phi_k, \\
-w_+ < 0,  w_- < 0:   && (0) a_{k-1} + (1 - \nu w_-) a_k + (+\nu w_+) a_{k+1} &= A_{ijk}^n + \Phi_k.
- \f}
-These equation form a tridiagonal system, i.e. the bandwidth does not exceed three.
-In every case the on-diagonal coefficient is greater than or equal to one,
-while the off-diagonal coefficients are always negative.  The coefficients
-approximately sum to one in each case, but only up to errors of size \f$O(\Delta z)\f$.
-These facts APPARENTLY imply that the method has a maximum principle \ref MortonMayers.
-
-
-FIXME:  THE COMMENT ABOVE HAS BEEN UPDATED TO THE 'CONSERVATIVE' FORM, BUT THE
-CODE STILL REFLECTS THE OLD SCHEME.
-
-FIXME:  CARE MUST BE TAKEN TO MAINTAIN CONSERVATISM AT SURFACE.
- */
-PetscErrorCode ageSystemCtx::solveThisColumn(PetscScalar **x, PetscErrorCode &pivoterrorindex) {
-  PetscErrorCode ierr;
-  if (!initAllDone) {  SETERRQ(PETSC_COMM_SELF, 2,
-     "solveThisColumn() should only be called after initAllColumns() in ageSystemCtx"); }
-
-  // set up system: 0 <= k < ks
-  for (PetscInt k = 0; k < ks; k++) {
-    planeStar<PetscScalar> ss;  // note ss.ij = tau[k]
-    ierr = tau3->getPlaneStar_fine(i,j,k,&ss); CHKERRQ(ierr);
-    // do lowest-order upwinding, explicitly for horizontal
-    rhs[k] =  (u[k] < 0) ? u[k] * (ss.e -  ss.ij) / dx
-                         : u[k] * (ss.ij  - ss.w) / dx;
-    rhs[k] += (v[k] < 0) ? v[k] * (ss.n -  ss.ij) / dy
-                         : v[k] * (ss.ij  - ss.s) / dy;
-    // note it is the age eqn: dage/dt = 1.0 and we have moved the hor.
-    //   advection terms over to right:
-    rhs[k] = ss.ij + dtAge * (1.0 - rhs[k]);
-
-    // do lowest-order upwinding, *implicitly* for vertical
-    PetscScalar AA = nuEQ * w[k];
-    if (k > 0) {
-      if (AA >= 0) { // upward velocity
-        L[k] = - AA;
-        D[k] = 1.0 + AA;
-        U[k] = 0.0;
-      } else { // downward velocity; note  -AA >= 0
-        L[k] = 0.0;
-        D[k] = 1.0 - AA;
-        U[k] = + AA;
-      }
-    } else { // k == 0 case
-      // note L[0] not an allocated location
-      if (AA > 0) { // if strictly upward velocity apply boundary condition:
-                    // age = 0 because ice is being added to base
-        D[0] = 1.0;
-        U[0] = 0.0;
-        rhs[0] = 0.0;
-      } else { // downward velocity; note  -AA >= 0
-        D[0] = 1.0 - AA;
-        U[0] = + AA;
-        // keep rhs[0] as is
-      }
-    }
-  }  // done "set up system: 0 <= k < ks"
-      
-  // surface b.c. at ks
-  if (ks>0) {
-    L[ks] = 0;
-    D[ks] = 1.0;   // ignore U[ks]
-    rhs[ks] = 0.0;  // age zero at surface
-  }
-
-  // solve it
-  pivoterrorindex = solveTridiagonalSystem(ks+1,x);
-  return 0;
-}
-
+#include "PISMColumnList.hh"
+#include "PISMColumnChunks.hh"
 
 //! Take a semi-implicit time-step for the age equation.
 /*!
@@ -222,104 +58,425 @@ stability condition from the vertical velocity; CFL is only for the horizontal
 velocity.  We use a finely-spaced, equally-spaced vertical grid in the
 calculation.  Note that the IceModelVec3 methods getValColumn...() and
 setValColumn..() interpolate back and forth between this fine grid and
-the storage grid.  The storage grid may or may not be equally-spaced.  See
-ageSystemCtx::solveThisColumn() for the actual method.
+the storage grid.  The storage grid may or may not be equally-spaced.  If
+`grid_storage_column_systems` is set, the storage grid is used directly
+instead (see columnSystemGrid).  See ageSystemCtx::solveThisColumn() for the
+actual method.
+
+Icy columns are processed by ageColumns(), in chunks which may be handled by
+several threads (see PISMColumnChunks). Systems are assembled one column at a
+time and solved in batches of columns (see columnSystemBatch). Age is set to
+zero in ice-free columns without visiting them in ageColumns().
  */
 PetscErrorCode IceModel::ageStep() {
   PetscErrorCode  ierr;
 
-  // set up fine grid in ice
-  PetscInt    fMz = grid.Mz_fine;
-  PetscScalar fdz = grid.dz_fine;
-
-  PetscScalar *x;  
-  x = new PetscScalar[fMz]; // space for solution
+  // vertical grid in ice used by column systems
+  columnSystemGrid vgrid(grid, config.get_flag("grid_storage_column_systems"));
+  const PetscInt Mz = vgrid.Mz();
 
   bool viewOneColumn;
   ierr = PISMOptionsIsSet("-view_sys", viewOneColumn); CHKERRQ(ierr);
 
-  ageSystemCtx system(fMz, "age"); // linear system to solve in each column
-  system.dx    = grid.dx;
-  system.dy    = grid.dy;
-  system.dtAge = dt_TempAge;
-  system.dzEQ  = fdz;
-  // pointers to values in current column
-  system.u     = new PetscScalar[fMz];
-  system.v     = new PetscScalar[fMz];
-  system.w     = new PetscScalar[fMz];
-  // system needs access to tau3 for planeStar()
-  system.tau3  = &tau3;
-  // this checks that all needed constants and pointers got set
-  ierr = system.initAllColumns(); CHKERRQ(ierr);
+  // icy columns come first; see PISMColumnList. Only these need the column
+  // solver; age is zero in all the others.
+  const vector<PISMColumnList::Column> &cols = columns->owned();
+  PISMColumnChunks chunks(config, columns->icy_count());
+
+  // each thread uses its own system
+  vector<ageSystemCtx*> systems(chunks.threads());
+  for (int t = 0; t < chunks.threads(); ++t) {
+    ageSystemCtx *system = new ageSystemCtx(Mz, "age"); // linear system to solve in each column
+    system->dx    = grid.dx;
+    system->dy    = grid.dy;
+    system->dtAge = dt_TempAge;
+    system->vgrid = &vgrid;
+    // pointers to values in current column
+    system->u     = new PetscScalar[Mz];
+    system->v     = new PetscScalar[Mz];
+    system->w     = new PetscScalar[Mz];
+    // system needs access to tau3 for planeStar()
+    system->tau3  = &tau3;
+    // this checks that all needed constants and pointers got set
+    ierr = system->initAllColumns(); CHKERRQ(ierr);
+
+    systems[t] = system;
+  }
 
   IceModelVec3 *u3, *v3, *w3;
   ierr = stress_balance->get_3d_velocity(u3, v3, w3); CHKERRQ(ierr); 
 
-  ierr = vH.begin_access(); CHKERRQ(ierr);
   ierr = tau3.begin_access(); CHKERRQ(ierr);
   ierr = u3->begin_access(); CHKERRQ(ierr);
   ierr = v3->begin_access(); CHKERRQ(ierr);
   ierr = w3->begin_access(); CHKERRQ(ierr);
   ierr = vWork3d.begin_access(); CHKERRQ(ierr);
 
-  for (PetscInt i=grid.xs; i<grid.xs+grid.xm; ++i) {
-    for (PetscInt j=grid.ys; j<grid.ys+grid.ym; ++j) {
-      // this should *not* be replaced by a call to grid.kBelowHeight()
-      const PetscInt  fks = static_cast<PetscInt>(floor(vH(i,j)/fdz));
+  // columns are processed in chunks, possibly by several threads at once;
+  // see PISMColumnChunks
+  vector<PetscErrorCode> errors(chunks.size(), 0);
+
+#if (PISM_USE_OPENMP==1)
+#pragma omp parallel for schedule(dynamic, 1) num_threads(chunks.threads())
+#endif
+  for (int c = 0; c < chunks.size(); ++c) {
+    errors[c] = ageColumns(chunks.begin(c), chunks.end(c), vgrid, u3, v3, w3, viewOneColumn,
+                           *systems[PISMColumnChunks::thread()]);
+  }
+
+  for (int c = 0; c < chunks.size(); ++c) {
+    CHKERRQ(errors[c]);
+  }
+
+  for (unsigned int n = columns->icy_count(); n < cols.size(); ++n) {
+    ierr = vWork3d.setColumn(cols[n].i, cols[n].j, 0.0); CHKERRQ(ierr);
+  }
 
+  ierr = tau3.end_access();  CHKERRQ(ierr);
+  ierr = u3->end_access();  CHKERRQ(ierr);
+  ierr = v3->end_access();  CHKERRQ(ierr);
+  ierr = w3->end_access();  CHKERRQ(ierr);
+  ierr = vWork3d.end_access();  CHKERRQ(ierr);
+
+  for (int t = 0; t < chunks.threads(); ++t) {
+    ageSystemCtx *system = systems[t];
+    delete [] system->u;  delete [] system->v;  delete [] system->w;
+    delete system;
+  }
+
+  // age is zero above the level ks + 2 in every column; see the comment in
+  // IceModel::energyStep()
+  const PetscInt levels = columns->max_ks() + 3;
+  ierr = tau3.beginGhostCommTransfer(vWork3d, levels); CHKERRQ(ierr);
+  ierr = tau3.endGhostCommTransfer(vWork3d, levels); CHKERRQ(ierr);
+
+  return 0;
+}
+
+
+//! Update the age in owned columns `begin`, ..., `end - 1`.
+/*!
+Called by ageStep(), possibly by several threads at once (processing
+different columns); `system` has to be private to the calling thread. Fields
+used here have to be accessible (see begin_access()).
+ */
+PetscErrorCode IceModel::ageColumns(unsigned int begin, unsigned int end,
+                                    const columnSystemGrid &vgrid,
+                                    IceModelVec3 *u3, IceModelVec3 *v3, IceModelVec3 *w3,
+                                    bool viewOneColumn, ageSystemCtx &system) {
+  PetscErrorCode  ierr;
+
+  const PetscInt Mz = vgrid.Mz();
+
+  PetscScalar *x;  
+  x = new PetscScalar[Mz]; // space for solution
+
+  // systems are solved in batches; when viewing a column each batch contains
+  // one system so that everything viewed corresponds to the same column
+  columnSystemBatch batch(Mz, viewOneColumn ? 1 : columnSystemBatch::default_width);
+  vector<unsigned int> lane_column(batch.width()); // column index in each lane
+
+  const vector<PISMColumnList::Column> &cols = columns->owned();
+
+  for (unsigned int n = begin; n < end; ++n) {
+    {
+      const PetscInt i = cols[n].i, j = cols[n].j, fks = vgrid.ks(cols[n]);
       if (fks == 0) { // if no ice, set the entire column to zero age
         ierr = vWork3d.setColumn(i,j,0.0); CHKERRQ(ierr);
       } else { // general case: solve advection PDE; start by getting 3D velocity ...
 
-	ierr = u3->getValColumn(i,j,fks,system.u); CHKERRQ(ierr);
-	ierr = v3->getValColumn(i,j,fks,system.v); CHKERRQ(ierr);
-	ierr = w3->getValColumn(i,j,fks,system.w); CHKERRQ(ierr);
+        ierr = vgrid.get_column(*u3, i, j, fks, system.u); CHKERRQ(ierr);
+        ierr = vgrid.get_column(*v3, i, j, fks, system.v); CHKERRQ(ierr);
+        ierr = vgrid.get_column(*w3, i, j, fks, system.w); CHKERRQ(ierr);
 
         ierr = system.setIndicesAndClearThisColumn(i,j,fks); CHKERRQ(ierr);
 
-        // solve the system for this column; call checks that params set
-        PetscErrorCode pivoterr;
-        ierr = system.solveThisColumn(&x,pivoterr); CHKERRQ(ierr);
+        // set up the system for this column; call checks that params set
+        ierr = system.assembleThisColumn(); CHKERRQ(ierr);
+
+        lane_column[batch.size()] = n;
+        ierr = batch.add(system, fks + 1); CHKERRQ(ierr);
+      }
+    }
+
+    if (batch.full() || n + 1 == end) {
+      ierr = batch.solve(); CHKERRQ(ierr);
+
+      for (int l = 0; l < batch.size(); ++l) {
+        const PetscInt i = cols[lane_column[l]].i, j = cols[lane_column[l]].j,
+          fks = vgrid.ks(cols[lane_column[l]]);
+
+        PetscErrorCode pivoterr = batch.pivot_error(l);
 
         if (pivoterr != 0) {
           ierr = PetscPrintf(PETSC_COMM_SELF,
             "\n\ntridiagonal solve of ageSystemCtx in ageStep() FAILED at (%d,%d)\n"
                 " with zero pivot position %d; viewing system to m-file ... \n",
             i, j, pivoterr); CHKERRQ(ierr);
+          ierr = batch.get_system(l, system); CHKERRQ(ierr);
           ierr = system.reportColumnZeroPivotErrorMFile(pivoterr); CHKERRQ(ierr);
           SETERRQ(grid.com, 1,"PISM ERROR in ageStep()\n");
         }
+
+        ierr = batch.get_solution(l, x); CHKERRQ(ierr);
+
         if (viewOneColumn && issounding(i,j)) {
           ierr = PetscPrintf(PETSC_COMM_SELF,
             "\n\nin ageStep(): viewing ageSystemCtx at (i,j)=(%d,%d) to m-file ... \n\n",
             i, j); CHKERRQ(ierr);
-          ierr = system.viewColumnInfoMFile(x, fMz); CHKERRQ(ierr);
+          ierr = batch.get_system(l, system); CHKERRQ(ierr);
+          ierr = system.viewColumnInfoMFile(x, Mz); CHKERRQ(ierr);
         }
 
         // x[k] contains age for k=0,...,ks, but set age of ice above (and at) surface to zero years
-        for (PetscInt k=fks+1; k<fMz; k++) {
+        for (PetscInt k=fks+1; k<Mz; k++) {
           x[k] = 0.0;
         }
-        
+
         // put solution in IceModelVec3
-        ierr = vWork3d.setValColumnPL(i,j,x); CHKERRQ(ierr);
+        ierr = vgrid.set_column(vWork3d, i, j, x); CHKERRQ(ierr);
       }
+
+      batch.clear();
     }
   }
 
-  ierr = vH.end_access(); CHKERRQ(ierr);
-  ierr = tau3.end_access();  CHKERRQ(ierr);
-  ierr = u3->end_access();  CHKERRQ(ierr);
-  ierr = v3->end_access();  CHKERRQ(ierr);
-  ierr = w3->end_access();  CHKERRQ(ierr);
-  ierr = vWork3d.end_access();  CHKERRQ(ierr);
-
   delete [] x;  
-  delete [] system.u;  delete [] system.v;  delete [] system.w;
 
-  ierr = tau3.beginGhostCommTransfer(vWork3d); CHKERRQ(ierr);
-  ierr = tau3.endGhostCommTransfer(vWork3d); CHKERRQ(ierr);
+  return 0;
+}
+
+
+
+//! Maximum time step of the semi-Lagrangian age method.
+/*!
+Departure points have to be in the halo of tau3_sl, leaving one grid cell for
+the interpolation. Uses the maximum horizontal velocities computed by
+computeMax3DVelocities().
+ */
+PetscReal IceModel::ageSemiLagrangianMaxTimeStep() {
+  const PetscReal cells = tau3_sl.get_stencil_width() - 1,
+    speed = PetscMax(gmaxu / grid.dx, gmaxv / grid.dy); // grid cells per second
+
+  if (speed <= 0.0)
+    return config.get("maximum_time_step_years", "years", "seconds");
+
+  return cells / speed;
+}
+
+
+//! Take a semi-Lagrangian time-step for the age equation.
+/*!
+This is an alternative to ageStep() (see the configuration flag
+`age_semi_lagrangian`). The age \f$\tau\f$ satisfies \f$d\tau/dt = 1\f$ along
+trajectories of ice particles, so the new age at a grid point \f$P\f$ is
+  \f[ \tau^{n+1}(P) = \tau^n(P_d) + \Delta t, \f]
+where \f$P_d = P - \mathbf{u}(P) \Delta t\f$ is the departure point of the
+trajectory arriving at \f$P\f$ (traced using the current 3D velocity) and
+\f$\tau^n(P_d)\f$ is found by (tri)linear interpolation. This method is
+unconditionally stable, so the age can be updated on a time step
+(dt_Age) that is much longer than the energy time step.
+
+Departure points have to be in the halo of tau3_sl (a copy of tau3 with a
+wider halo, see `age_semi_lagrangian_halo_width`); IceModel::step() updates
+the age often enough and determineTimeStep() limits the time step to ensure
+this (see ageSemiLagrangianMaxTimeStep()).
+Horizontal displacements which would still leave the halo are clipped (and
+reported).
+
+Trajectories which started above the ice surface or below the base during
+the time step carry the time since they crossed the surface (or the base):
+ice enters at these boundaries with zero age.
+
+Vertical displacements are not limited: each column is on one processor.
+Uses the storage grid.
+ */
+PetscErrorCode IceModel::ageStepSemiLagrangian() {
+  PetscErrorCode ierr;
+
+  const PetscReal dt_age = dt_Age;
+
+  IceModelVec3 *u3, *v3, *w3;
+  ierr = stress_balance->get_3d_velocity(u3, v3, w3); CHKERRQ(ierr);
+
+  // copy the age into tau3_sl and fill its (wide) halo
+  {
+    PetscScalar *column;
+    ierr = tau3.begin_access(); CHKERRQ(ierr);
+    ierr = tau3_sl.begin_access(); CHKERRQ(ierr);
+    for (PetscInt i=grid.xs; i<grid.xs+grid.xm; ++i) {
+      for (PetscInt j=grid.ys; j<grid.ys+grid.ym; ++j) {
+        ierr = tau3.getInternalColumn(i,j,&column); CHKERRQ(ierr);
+        ierr = tau3_sl.setInternalColumn(i,j,column); CHKERRQ(ierr);
+      }
+    }
+    ierr = tau3_sl.end_access(); CHKERRQ(ierr);
+    ierr = tau3.end_access(); CHKERRQ(ierr);
+
+    ierr = tau3_sl.beginGhostComm(); CHKERRQ(ierr);
+    ierr = tau3_sl.endGhostComm(); CHKERRQ(ierr);
+  }
+
+  // icy columns come first; age is zero in all the others
+  const vector<PISMColumnList::Column> &cols = columns->owned();
+  PISMColumnChunks chunks(config, columns->icy_count());
+
+  ierr = vH.begin_access(); CHKERRQ(ierr);
+  ierr = tau3_sl.begin_access(); CHKERRQ(ierr);
+  ierr = u3->begin_access(); CHKERRQ(ierr);
+  ierr = v3->begin_access(); CHKERRQ(ierr);
+  ierr = w3->begin_access(); CHKERRQ(ierr);
+  ierr = vWork3d.begin_access(); CHKERRQ(ierr);
+
+  // columns are processed in chunks, possibly by several threads at once;
+  // see PISMColumnChunks
+  vector<PetscErrorCode> errors(chunks.size(), 0);
+  vector<PetscInt> clipped(chunks.size(), 0);
+
+#if (PISM_USE_OPENMP==1)
+#pragma omp parallel for schedule(dynamic, 1) num_threads(chunks.threads())
+#endif
+  for (int c = 0; c < chunks.size(); ++c) {
+    errors[c] = ageSemiLagrangianColumns(chunks.begin(c), chunks.end(c), dt_age,
+                                         u3, v3, w3, clipped[c]);
+  }
+
+  PetscScalar my_clipped = 0.0, clipped_total;
+  for (int c = 0; c < chunks.size(); ++c) {
+    CHKERRQ(errors[c]);
+    my_clipped += clipped[c];
+  }
+
+  for (unsigned int n = columns->icy_count(); n < cols.size(); ++n) {
+    ierr = vWork3d.setColumn(cols[n].i, cols[n].j, 0.0); CHKERRQ(ierr);
+  }
+
+  ierr = vH.end_access(); CHKERRQ(ierr);
+  ierr = tau3_sl.end_access(); CHKERRQ(ierr);
+  ierr = u3->end_access(); CHKERRQ(ierr);
+  ierr = v3->end_access(); CHKERRQ(ierr);
+  ierr = w3->end_access(); CHKERRQ(ierr);
+  ierr = vWork3d.end_access(); CHKERRQ(ierr);
+
+  ierr = PISMGlobalSum(&my_clipped, &clipped_total, grid.com); CHKERRQ(ierr);
+  if (clipped_total > 0.0) {
+    ierr = verbPrintf(2, grid.com,
+                      "\n PISM WARNING: semi-Lagrangian age step of %.3f years: %d departure points"
+                      " clipped to the halo\n",
+                      dt_age / secpera, static_cast<int>(clipped_total)); CHKERRQ(ierr);
+  }
+
+  // age is zero above the level ks in every column, so levels up to
+  // max_ks() + 1 would do; send as many as ageStep() does, which covers
+  // them, so that both methods can re-use the same communication storage
+  const PetscInt levels = columns->max_ks() + 3;
+  ierr = tau3.beginGhostCommTransfer(vWork3d, levels); CHKERRQ(ierr);
+  ierr = tau3.endGhostCommTransfer(vWork3d, levels); CHKERRQ(ierr);
 
   return 0;
 }
 
+
+//! Update the age in owned columns `begin`, ..., `end - 1` using the
+//! semi-Lagrangian method.
+/*!
+Called by ageStepSemiLagrangian(), possibly by several threads at once
+(processing different columns). Fields used here have to be accessible (see
+begin_access()). Adds the number of clipped departure points to `clipped`.
+ */
+PetscErrorCode IceModel::ageSemiLagrangianColumns(unsigned int begin, unsigned int end,
+                                                  PetscReal dt_age,
+                                                  IceModelVec3 *u3, IceModelVec3 *v3, IceModelVec3 *w3,
+                                                  PetscInt &clipped) {
+  PetscErrorCode ierr;
+
+  const PetscInt Mz = grid.Mz;
+  const vector<double> &zlevels = grid.zlevels;
+  const PetscReal max_cells = tau3_sl.get_stencil_width() - 1;
+  const bool
+    x_periodic = (grid.periodicity & X_PERIODIC) != 0,
+    y_periodic = (grid.periodicity & Y_PERIODIC) != 0;
+
+  vector<PetscScalar> x(Mz); // new age in a column
+
+  const vector<PISMColumnList::Column> &cols = columns->owned();
+
+  for (unsigned int n = begin; n < end; ++n) {
+    const PetscInt i = cols[n].i, j = cols[n].j, ks = cols[n].ks;
+
+    if (ks == 0) { // if no ice, set the entire column to zero age
+      ierr = vWork3d.setColumn(i,j,0.0); CHKERRQ(ierr);
+      continue;
+    }
+
+    PetscScalar *u, *v, *w;
+    ierr = u3->getInternalColumn(i,j,&u); CHKERRQ(ierr);
+    ierr = v3->getInternalColumn(i,j,&v); CHKERRQ(ierr);
+    ierr = w3->getInternalColumn(i,j,&w); CHKERRQ(ierr);
+
+    const PetscScalar H = vH(i,j);
+
+    for (PetscInt k = 0; k <= ks; ++k) {
+      const PetscScalar z = zlevels[k], z_d = z - w[k] * dt_age;
+
+      if (z_d > H) {  // entered through the surface during this step
+        x[k] = dt_age * (H - z) / (z_d - z);
+      } else if (z_d < 0.0) { // entered through the base (freeze-on)
+        x[k] = dt_age * z / (z - z_d);
+      } else {
+        // horizontal displacement, in grid cells
+        PetscReal s_x = u[k] * dt_age / grid.dx,
+          s_y = v[k] * dt_age / grid.dy;
+        if (PetscAbs(s_x) > max_cells || PetscAbs(s_y) > max_cells) {
+          s_x = PetscMax(PetscMin(s_x, max_cells), -max_cells);
+          s_y = PetscMax(PetscMin(s_y, max_cells), -max_cells);
+          clipped++;
+        }
+
+        // departure point, in grid index coordinates
+        PetscReal x_d = i - s_x, y_d = j - s_y;
+        if (x_periodic == false)
+          x_d = PetscMax(PetscMin(x_d, grid.Mx - 1), 0);
+        if (y_periodic == false)
+          y_d = PetscMax(PetscMin(y_d, grid.My - 1), 0);
+
+        const PetscInt i0 = static_cast<PetscInt>(floor(x_d)),
+          j0 = static_cast<PetscInt>(floor(y_d));
+        const PetscReal f_x = x_d - i0, f_y = y_d - j0;
+        // avoid reading outside of the domain at its (non-periodic) edges
+        const PetscInt i1 = f_x > 0.0 ? i0 + 1 : i0,
+          j1 = f_y > 0.0 ? j0 + 1 : j0;
+
+        const PetscInt k0 = grid.level_below(z_d);
+        const PetscReal f_z = (z_d - zlevels[k0]) / (zlevels[k0 + 1] - zlevels[k0]);
+
+        PetscScalar *a00, *a10, *a01, *a11;
+        ierr = tau3_sl.getInternalColumn(i0, j0, &a00); CHKERRQ(ierr);
+        ierr = tau3_sl.getInternalColumn(i1, j0, &a10); CHKERRQ(ierr);
+        ierr = tau3_sl.getInternalColumn(i0, j1, &a01); CHKERRQ(ierr);
+        ierr = tau3_sl.getInternalColumn(i1, j1, &a11); CHKERRQ(ierr);
+
+        const PetscScalar
+          b00 = a00[k0] + f_z * (a00[k0 + 1] - a00[k0]),
+          b10 = a10[k0] + f_z * (a10[k0 + 1] - a10[k0]),
+          b01 = a01[k0] + f_z * (a01[k0 + 1] - a01[k0]),
+          b11 = a11[k0] + f_z * (a11[k0 + 1] - a11[k0]),
+          b0 = b00 + f_x * (b10 - b00),
+          b1 = b01 + f_x * (b11 - b01);
+
+        x[k] = b0 + f_y * (b1 - b0) + dt_age;
+      }
+
+      x[k] = PetscMax(x[k], 0.0);
+    }
+
+    // set age of ice above (and at) surface to zero years
+    for (PetscInt k = ks+1; k < Mz; k++) {
+      x[k] = 0.0;
+    }
+
+    ierr = vWork3d.setInternalColumn(i,j,&x[0]); CHKERRQ(ierr);
+  }
+
+  return 0;
+}
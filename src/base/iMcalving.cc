@@ -23,6 +23,7 @@
 #include "pism_signal.h"
 #include "Mask.hh"
 #include "PISMOcean.hh"
+#include "PISMGhostCommGroup.hh"
 
 
 //! \file iMcalving.cc Methods implementing PIK options -eigen_calving and -calving_at_thickness [\ref Winkelmannetal2011].
@@ -42,10 +43,11 @@ PetscErrorCode IceModel::eigenCalving() {
     discharge_flux = 0;
 
   // is ghost communication really needed here?
-  ierr = vH.beginGhostComm(); CHKERRQ(ierr);
-  ierr = vH.endGhostComm(); CHKERRQ(ierr);
-  ierr = vMask.beginGhostComm(); CHKERRQ(ierr);
-  ierr = vMask.endGhostComm(); CHKERRQ(ierr);
+  PISMGhostCommGroup ghosts(grid);
+  ierr = ghosts.add(vH); CHKERRQ(ierr);
+  ierr = ghosts.add(vMask); CHKERRQ(ierr);
+  ierr = ghosts.beginGhostComm(); CHKERRQ(ierr);
+  ierr = ghosts.endGhostComm(); CHKERRQ(ierr);
 
   double ocean_rho = config.get("sea_water_density");
   double ice_rho = config.get("ice_density");
@@ -77,13 +79,13 @@ PetscErrorCode IceModel::eigenCalving() {
 
   MaskQuery mask(vMask);
 
-  ierr = vH.begin_access(); CHKERRQ(ierr);
+  ierr = vH.begin_read_access(); CHKERRQ(ierr);
   ierr = vHnew.begin_access(); CHKERRQ(ierr);
-  ierr = vMask.begin_access(); CHKERRQ(ierr);
-  ierr = vbed.begin_access(); CHKERRQ(ierr);
+  ierr = vMask.begin_read_access(); CHKERRQ(ierr);
+  ierr = vbed.begin_read_access(); CHKERRQ(ierr);
   ierr = vHref.begin_access(); CHKERRQ(ierr);
-  ierr = vPrinStrain1.begin_access(); CHKERRQ(ierr);
-  ierr = vPrinStrain2.begin_access(); CHKERRQ(ierr);
+  ierr = vPrinStrain1.begin_read_access(); CHKERRQ(ierr);
+  ierr = vPrinStrain2.begin_read_access(); CHKERRQ(ierr);
   ierr = vDiffCalvRate.begin_access(); CHKERRQ(ierr);
   for (PetscInt i = grid.xs; i < grid.xs + grid.xm; ++i) {
     for (PetscInt j = grid.ys; j < grid.ys + grid.ym; ++j) {
@@ -266,9 +268,9 @@ PetscErrorCode IceModel::calvingAtThickness() {
     ierr = ocean->sea_level_elevation(sea_level); CHKERRQ(ierr);
   } else { SETERRQ(grid.com, 2, "PISM ERROR: ocean == NULL"); }
 
-  ierr = vH.begin_access(); CHKERRQ(ierr);
+  ierr = vH.begin_read_access(); CHKERRQ(ierr);
   ierr = vHnew.begin_access(); CHKERRQ(ierr);
-  ierr = vbed.begin_access(); CHKERRQ(ierr);
+  ierr = vbed.begin_read_access(); CHKERRQ(ierr);
   for (PetscInt i = grid.xs; i < grid.xs + grid.xm; ++i) {
     for (PetscInt j = grid.ys; j < grid.ys + grid.ym; ++j) {
       bool hereFloating = (vH(i, j) > 0.0 && (vbed(i, j) < (sea_level - ice_rho / ocean_rho * vH(i, j))));
@@ -306,10 +308,11 @@ PetscErrorCode IceModel::dt_from_eigenCalving() {
   ierr = verbPrintf(4, grid.com, "######### dt_from_eigenCalving() start \n");    CHKERRQ(ierr);
 
   // is ghost communication really needed here?
-  ierr = vH.beginGhostComm(); CHKERRQ(ierr);
-  ierr = vH.endGhostComm(); CHKERRQ(ierr);
-  ierr = vMask.beginGhostComm(); CHKERRQ(ierr);
-  ierr = vMask.endGhostComm(); CHKERRQ(ierr);
+  PISMGhostCommGroup ghosts(grid);
+  ierr = ghosts.add(vH); CHKERRQ(ierr);
+  ierr = ghosts.add(vMask); CHKERRQ(ierr);
+  ierr = ghosts.beginGhostComm(); CHKERRQ(ierr);
+  ierr = ghosts.endGhostComm(); CHKERRQ(ierr);
 
   double ocean_rho = config.get("sea_water_density");
   double ice_rho = config.get("ice_density");
@@ -339,11 +342,11 @@ PetscErrorCode IceModel::dt_from_eigenCalving() {
 
   MaskQuery mask(vMask);
 
-  ierr = vH.begin_access(); CHKERRQ(ierr);
-  ierr = vMask.begin_access(); CHKERRQ(ierr);
-  ierr = vbed.begin_access(); CHKERRQ(ierr);
-  ierr = vPrinStrain1.begin_access(); CHKERRQ(ierr);
-  ierr = vPrinStrain2.begin_access(); CHKERRQ(ierr);
+  ierr = vH.begin_read_access(); CHKERRQ(ierr);
+  ierr = vMask.begin_read_access(); CHKERRQ(ierr);
+  ierr = vbed.begin_read_access(); CHKERRQ(ierr);
+  ierr = vPrinStrain1.begin_read_access(); CHKERRQ(ierr);
+  ierr = vPrinStrain2.begin_read_access(); CHKERRQ(ierr);
 
   for (PetscInt i = grid.xs; i < grid.xs + grid.xm; ++i) {
     for (PetscInt j = grid.ys; j < grid.ys + grid.ym; ++j) {
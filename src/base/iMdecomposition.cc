@@ -0,0 +1,448 @@
+// Copyright (C) 2012 PISM Authors
+//
+// This file is part of PISM.
+//
+// PISM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 2 of the License, or (at your option) any later
+// version.
+//
+// PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License
+// along with PISM; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include <cmath>
+#include <petscdmda.h>
+
+#include "iceModel.hh"
+#include "IceGrid.hh"
+#include "Mask.hh"
+#include "PIO.hh"
+#include "LocalInterpCtx.hh"
+#include "PISMProf.hh"
+#include "pism_options.hh"
+#include "PISMStressBalance.hh"
+#include "PISMSurface.hh"
+#include "PISMOcean.hh"
+#include "PISMBedDef.hh"
+#include "bedrockThermalUnit.hh"
+#include "PISMTracerParticles.hh"
+#include "PISMYieldStress.hh"
+
+//! \file iMdecomposition.cc Methods of IceModel distributing the work among
+//! processors according to the ice extent.
+
+//! \brief Estimate the computational cost of map-plane columns using ice
+//! thickness (and bed elevation, if present) in `filename`.
+/*!
+ * Each processor reads a strip of columns with x-indices from `x_start` to
+ * `x_start + x_count - 1`; `cost[(i - x_start) * g.My + j]` is the cost of
+ * the column (i, j).
+ *
+ * Flotation is computed assuming zero sea level.
+ *
+ * Sets `success` to false if the file does not contain ice thickness or if its
+ * grid does not match `g`.
+ *
+ * See column_cost().
+ */
+PetscErrorCode IceModel::estimate_column_cost(IceGrid &g, string filename,
+                                              vector<double> &cost,
+                                              int &x_start, int &x_count,
+                                              bool &success) {
+  PetscErrorCode ierr;
+  PIO nc(g.com, g.rank, g.config.get_string("output_format"));
+  bool thk_exists, topg_exists, dummy;
+  string thk_name, topg_name;
+  unsigned int x_len = 0, y_len = 0;
+  grid_info gi;
+
+  success = false;
+
+  x_start = g.rank * (g.Mx / g.size) + PetscMin(g.rank, g.Mx % g.size);
+  x_count = g.Mx / g.size + ((g.Mx % g.size) > g.rank);
+
+  ierr = nc.open(filename, PISM_NOWRITE); CHKERRQ(ierr);
+
+  ierr = nc.inq_var("thk", "land_ice_thickness", thk_exists, thk_name, dummy); CHKERRQ(ierr);
+  ierr = nc.inq_var("topg", "bedrock_altitude", topg_exists, topg_name, dummy); CHKERRQ(ierr);
+
+  if (thk_exists) {
+    ierr = nc.inq_grid_info(thk_name, gi); CHKERRQ(ierr);
+    x_len = gi.x_len;
+    y_len = gi.y_len;
+  }
+
+  if (thk_exists == false || (int)x_len != g.Mx || (int)y_len != g.My) {
+    ierr = nc.close(); CHKERRQ(ierr);
+    return 0;
+  }
+
+  vector<double> thk(x_count * g.My, 0.0),
+    topg(x_count * g.My, 0.0);
+
+  ierr = read_2d_strip(nc, thk_name, x_start, x_count, g.My, thk); CHKERRQ(ierr);
+  if (topg_exists) {
+    ierr = read_2d_strip(nc, topg_name, x_start, x_count, g.My, topg); CHKERRQ(ierr);
+  }
+
+  ierr = nc.close(); CHKERRQ(ierr);
+
+  GeometryCalculator gc(0.0, config);
+
+  cost.resize(x_count * g.My);
+  for (int n = 0; n < x_count * g.My; ++n) {
+    double H = PetscMax(thk[n], 0.0);
+    cost[n] = column_cost(g, H, gc.mask(topg_exists ? topg[n] : 0.0, H));
+  }
+
+  success = true;
+
+  return 0;
+}
+
+//! \brief Estimated computational cost of a column with ice thickness `H`
+//! and mask value `mask`.
+/*!
+ * The cost is measured in "ice levels": an ice-free column costs
+ * `grid_column_cost_ice_free`, an icy column costs the number of vertical
+ * levels in the ice, multiplied by `grid_column_cost_floating_factor` if the
+ * ice is floating.
+ */
+double IceModel::column_cost(IceGrid &g, PetscReal H, int mask) {
+  Mask M;
+
+  if (M.ice_free(mask))
+    return config.get("grid_column_cost_ice_free");
+
+  double result = g.kBelowHeight(PetscMin(PetscMax(H, 0.0), g.Lz)) + 1;
+
+  if (M.floating_ice(mask))
+    result *= config.get("grid_column_cost_floating_factor");
+
+  return result;
+}
+
+//! \brief Read the last record of a 2D variable for x-indices from `x_start`
+//! to `x_start + x_count - 1` and all y-indices.
+/*!
+ * Stores data in the "[i][j]" order, i.e. the y-index changes fastest.
+ */
+PetscErrorCode IceModel::read_2d_strip(PIO &nc, string name, int x_start, int x_count,
+                                       int y_count, vector<double> &result) {
+  PetscErrorCode ierr;
+  vector<string> dims;
+  vector<unsigned int> start, count, imap;
+  unsigned int n_records;
+
+  ierr = nc.inq_nrecords(name, "", n_records); CHKERRQ(ierr);
+  ierr = nc.inq_vardims(name, dims); CHKERRQ(ierr);
+
+  for (unsigned int k = 0; k < dims.size(); ++k) {
+    AxisType dimtype;
+    ierr = nc.inq_dimtype(dims[k], dimtype); CHKERRQ(ierr);
+
+    switch (dimtype) {
+    case T_AXIS:
+      start.push_back(n_records > 0 ? n_records - 1 : 0);
+      count.push_back(1);
+      imap.push_back(x_count * y_count);
+      break;
+    case X_AXIS:
+      start.push_back(x_start);
+      count.push_back(x_count);
+      imap.push_back(y_count);
+      break;
+    case Y_AXIS:
+      start.push_back(0);
+      count.push_back(y_count);
+      imap.push_back(1);
+      break;
+    default:
+      SETERRQ1(grid.com, 1, "PISM ERROR: %s is not a 2D variable", name.c_str());
+    }
+  }
+
+  result.resize(x_count * y_count);
+  ierr = nc.get_varm_double(name, start, count, imap, &result[0]); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! \brief Compute ownership ranges balancing the estimated cost of columns,
+//! using the ice extent in `filename`.
+/*!
+ * Expects `g.Nx` and `g.Ny` to be set. Keeps the current (equal-area)
+ * ownership ranges if the cost could not be estimated.
+ *
+ * Reports the predicted load imbalance (the maximum subdomain cost divided by
+ * the mean) for both decompositions and saves the predicted cost of each
+ * processor's subdomain in the profiling report.
+ */
+PetscErrorCode IceModel::set_balanced_ownership_ranges(IceGrid &g, string filename) {
+  PetscErrorCode ierr;
+  vector<double> cost;
+  int x_start, x_count;
+  bool success;
+
+  ierr = estimate_column_cost(g, filename, cost, x_start, x_count, success); CHKERRQ(ierr);
+
+  if (success == false) {
+    ierr = verbPrintf(2, g.com,
+                      "PISM WARNING: can't estimate the cost of columns using '%s';\n"
+                      "              using the equal-area domain decomposition...\n",
+                      filename.c_str()); CHKERRQ(ierr);
+    return 0;
+  }
+
+  double equal_imbalance, balanced_imbalance, balanced_cost;
+
+  ierr = balance_ownership_ranges(g, cost, x_start, x_count, 0, g.My,
+                                  equal_imbalance, balanced_imbalance,
+                                  balanced_cost); CHKERRQ(ierr);
+
+  ierr = verbPrintf(2, g.com,
+                    "  Balancing the domain decomposition using the ice extent in '%s':\n"
+                    "    predicted load imbalance (max/mean): %.3f (equal-area: %.3f)\n",
+                    filename.c_str(), balanced_imbalance, equal_imbalance); CHKERRQ(ierr);
+
+  g.profiler->set_value("processor_predicted_cost",
+                           "estimated cost of computations in a processor's subdomain",
+                           "count", balanced_cost);
+  g.profiler->set_value("predicted_load_imbalance",
+                           "predicted load imbalance (maximum over mean subdomain cost)",
+                           "1", balanced_imbalance);
+
+  return 0;
+}
+
+//! \brief Replace ownership ranges of `g` by ones balancing the cost of
+//! columns.
+/*!
+ * `cost[(i - xs) * ym + (j - ys)]` is the cost of the column (i, j); each
+ * processor provides costs of columns in an `xm` by `ym` patch starting at
+ * (xs, ys). These patches have to cover the grid.
+ *
+ * Sets `old_imbalance` and `new_imbalance` to the load imbalance implied by
+ * the old and new ownership ranges and `new_cost` to the cost of this
+ * processor's subdomain in the new decomposition.
+ */
+PetscErrorCode IceModel::balance_ownership_ranges(IceGrid &g, const vector<double> &cost,
+                                                  int xs, int xm, int ys, int ym,
+                                                  double &old_imbalance, double &new_imbalance,
+                                                  double &new_cost) {
+  PetscErrorCode ierr;
+  double old_cost;
+
+  // Sums over rows and columns of the cost field:
+  vector<double> cost_x(g.Mx, 0.0), cost_y(g.My, 0.0);
+  for (int i = 0; i < xm; ++i) {
+    for (int j = 0; j < ym; ++j) {
+      cost_x[xs + i] += cost[i * ym + j];
+      cost_y[ys + j] += cost[i * ym + j];
+    }
+  }
+  ierr = MPI_Allreduce(MPI_IN_PLACE, &cost_x[0], g.Mx, MPI_DOUBLE, MPI_SUM, g.com); CHKERRQ(ierr);
+  ierr = MPI_Allreduce(MPI_IN_PLACE, &cost_y[0], g.My, MPI_DOUBLE, MPI_SUM, g.com); CHKERRQ(ierr);
+
+  ierr = subdomain_cost(g, cost, xs, xm, ys, ym,
+                        old_cost, old_imbalance); CHKERRQ(ierr);
+
+  g.compute_weighted_ownership_ranges(cost_x, cost_y);
+
+  ierr = subdomain_cost(g, cost, xs, xm, ys, ym,
+                        new_cost, new_imbalance); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! \brief Compute the cost of this processor's subdomain (`result`) and the
+//! load imbalance (`imbalance`) implied by the current ownership ranges.
+/*!
+ * See balance_ownership_ranges() for the meaning of `cost`, `xs`, `xm`, `ys`
+ * and `ym`.
+ */
+PetscErrorCode IceModel::subdomain_cost(IceGrid &g, const vector<double> &cost,
+                                        int xs, int xm, int ys, int ym,
+                                        double &result, double &imbalance) {
+  PetscErrorCode ierr;
+  vector<int> block_x(g.Mx), block_y(g.My);
+
+  for (int b = 0, i = 0; b < g.Nx; ++b)
+    for (int k = 0; k < g.procs_x[b]; ++k)
+      block_x[i++] = b;
+
+  for (int b = 0, j = 0; b < g.Ny; ++b)
+    for (int k = 0; k < g.procs_y[b]; ++k)
+      block_y[j++] = b;
+
+  vector<double> blocks(g.Nx * g.Ny, 0.0);
+  for (int i = 0; i < xm; ++i)
+    for (int j = 0; j < ym; ++j)
+      blocks[block_x[xs + i] * g.Ny + block_y[ys + j]] += cost[i * ym + j];
+
+  ierr = MPI_Allreduce(MPI_IN_PLACE, &blocks[0], g.Nx * g.Ny,
+                       MPI_DOUBLE, MPI_SUM, g.com); CHKERRQ(ierr);
+
+  double max_cost = 0.0, total_cost = 0.0;
+  for (unsigned int b = 0; b < blocks.size(); ++b) {
+    max_cost = PetscMax(max_cost, blocks[b]);
+    total_cost += blocks[b];
+  }
+
+  // ranks are ordered so that the y-index of a subdomain changes fastest (see
+  // IceGrid::createDA() and PISMProf::save_report())
+  result = blocks[g.rank];
+  imbalance = total_cost > 0.0 ? max_cost / (total_cost / blocks.size()) : 1.0;
+
+  return 0;
+}
+
+//! \brief Re-balance the domain decomposition if the estimated cost of
+//! computations became too unbalanced.
+/*!
+ * Every `grid_repartitioning_interval` time steps computes the load imbalance
+ * (maximum over mean) of the estimated cost of subdomains (see column_cost()
+ * and subdomain_cost()) using the current ice geometry. If it exceeds
+ * `grid_repartitioning_threshold`, computes ownership ranges balancing this
+ * cost and calls repartition() if these ranges are predicted to be better
+ * than the current ones.
+ *
+ * Measured wall-clock times are not used: the time spent in IceModel::step()
+ * includes the time spent waiting for other processors in collective
+ * operations, which evens out per-processor times and hides the imbalance.
+ */
+PetscErrorCode IceModel::check_load_balance() {
+  PetscErrorCode ierr;
+
+  if (config.get_flag("grid_dynamic_repartitioning") == false ||
+      config.get_flag("mesh_refinement") == true)
+    return 0;
+
+  steps_since_balance_check++;
+  if (steps_since_balance_check < config.get("grid_repartitioning_interval"))
+    return 0;
+
+  steps_since_balance_check = 0;
+
+  vector<double> cost(grid.xm * grid.ym);
+  ierr = vH.begin_read_access(); CHKERRQ(ierr);
+  ierr = vMask.begin_read_access(); CHKERRQ(ierr);
+  for (PetscInt i = grid.xs; i < grid.xs + grid.xm; ++i) {
+    for (PetscInt j = grid.ys; j < grid.ys + grid.ym; ++j) {
+      cost[(i - grid.xs) * grid.ym + (j - grid.ys)] = column_cost(grid, vH(i, j), vMask.as_int(i, j));
+    }
+  }
+  ierr = vMask.end_access(); CHKERRQ(ierr);
+  ierr = vH.end_access(); CHKERRQ(ierr);
+
+  double current_cost, current_imbalance;
+  ierr = subdomain_cost(grid, cost, grid.xs, grid.xm, grid.ys, grid.ym,
+                        current_cost, current_imbalance); CHKERRQ(ierr);
+
+  if (current_imbalance < config.get("grid_repartitioning_threshold"))
+    return 0;
+
+  vector<int> procs_x = grid.procs_x, procs_y = grid.procs_y;
+  double old_imbalance, new_imbalance, new_cost;
+
+  ierr = balance_ownership_ranges(grid, cost, grid.xs, grid.xm, grid.ys, grid.ym,
+                                  old_imbalance, new_imbalance, new_cost); CHKERRQ(ierr);
+
+  if (new_imbalance >= old_imbalance ||
+      (grid.procs_x == procs_x && grid.procs_y == procs_y)) {
+    // nothing to gain; restore ownership ranges
+    grid.procs_x = procs_x;
+    grid.procs_y = procs_y;
+    return 0;
+  }
+
+  ierr = verbPrintf(2, grid.com,
+                    "  Estimated load imbalance (max/mean): %.3f; re-balancing...\n"
+                    "    predicted load imbalance: %.3f\n",
+                    old_imbalance, new_imbalance); CHKERRQ(ierr);
+
+  ierr = repartition(); CHKERRQ(ierr);
+
+  grid.profiler->set_value("processor_predicted_cost",
+                           "estimated cost of computations in a processor's subdomain",
+                           "count", new_cost);
+
+  return 0;
+}
+
+//! \brief Move all the model state to the domain decomposition described by
+//! `grid.procs_x` and `grid.procs_y`.
+/*!
+ * Moves every IceModelVec (see IceGrid::redistribute()) and asks sub-models
+ * to re-create objects depending on the domain decomposition.
+ */
+PetscErrorCode IceModel::repartition() {
+  PetscErrorCode ierr;
+
+  ierr = grid.redistribute(); CHKERRQ(ierr);
+
+  if (stress_balance != NULL) {
+    ierr = stress_balance->redistribute(); CHKERRQ(ierr);
+  }
+
+  if (surface != NULL) {
+    ierr = surface->redistribute(); CHKERRQ(ierr);
+  }
+
+  if (ocean != NULL) {
+    ierr = ocean->redistribute(); CHKERRQ(ierr);
+  }
+
+  if (beddef != NULL) {
+    ierr = beddef->redistribute(); CHKERRQ(ierr);
+  }
+
+  if (btu != NULL) {
+    ierr = btu->redistribute(); CHKERRQ(ierr);
+  }
+
+  if (basal_yield_stress != NULL) {
+    ierr = basal_yield_stress->redistribute(); CHKERRQ(ierr);
+  }
+
+  if (tracers != NULL) {
+    ierr = tracers->redistribute(); CHKERRQ(ierr);
+  }
+
+  ierr = repartition_hook(); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! Allows derived classes to re-create their own objects depending on the domain decomposition.
+PetscErrorCode IceModel::repartition_hook() {
+  return 0;
+}
+
+//! \brief Report the measured load imbalance of time-stepping.
+/*!
+ * Uses per-processor times spent in IceModel::step(), so it includes the
+ * time spent waiting for other processors in collective operations.
+ */
+PetscErrorCode IceModel::report_load_imbalance() {
+  PetscErrorCode ierr;
+  double imbalance;
+
+  ierr = grid.profiler->get_imbalance(event_step, imbalance); CHKERRQ(ierr);
+
+  grid.profiler->set_value("measured_load_imbalance",
+                           "measured load imbalance (maximum over mean time spent time-stepping)",
+                           "1", imbalance);
+
+  ierr = verbPrintf(config.get_flag("grid_balanced_decomposition") ? 2 : 3, grid.com,
+                    "  measured load imbalance of time-stepping (max/mean): %.3f\n",
+                    imbalance); CHKERRQ(ierr);
+
+  return 0;
+}
@@ -22,6 +22,7 @@
 #include "PISMSurface.hh"
 #include "PISMOcean.hh"
 #include "enthalpyConverter.hh"
+#include "PISMColumnList.hh"
 #include <assert.h>
 
 //! \file iMenergy.cc Methods of IceModel which address conservation of energy.
@@ -40,6 +41,9 @@ do_cold_ice_methods == true, then energyStep() must also update this field
 
 Normally calls the method enthalpyAndDrainageStep().  Calls temperatureStep() if
 do_cold_ice_methods == true.
+
+If `age_with_enthalpy` is set (see IceModel::step()) enthalpyAndDrainageStep()
+updates the age, too, and this method communicates it (updating tau3).
  */
 PetscErrorCode IceModel::energyStep() {
   PetscErrorCode  ierr;
@@ -78,8 +82,19 @@ PetscErrorCode IceModel::energyStep() {
     ierr = enthalpyAndDrainageStep(&myVertSacrCount,&myLiquifiedVol,&myBulgeCount);
        CHKERRQ(ierr);
 
-    ierr = Enth3.beginGhostCommTransfer(vWork3d); CHKERRQ(ierr);
-    ierr = Enth3.endGhostCommTransfer(vWork3d); CHKERRQ(ierr);
+    // Enthalpy is constant above the level ks + 2 in every column (ks + 1
+    // may be affected by the interpolation from the fine grid), so ghost
+    // columns only need the bottom levels.
+    const PetscInt levels = columns->max_ks() + 3;
+    ierr = Enth3.beginGhostCommTransfer(vWork3d, levels); CHKERRQ(ierr);
+    ierr = Enth3.endGhostCommTransfer(vWork3d, levels); CHKERRQ(ierr);
+
+    if (age_with_enthalpy) {
+      // new age values are in vWork3d_age; the same applies to them (see
+      // IceModel::ageStep())
+      ierr = tau3.beginGhostCommTransfer(vWork3d_age, levels); CHKERRQ(ierr);
+      ierr = tau3.endGhostCommTransfer(vWork3d_age, levels); CHKERRQ(ierr);
+    }
 
     ierr = PISMGlobalSum(&myLiquifiedVol, &gLiquifiedVol, grid.com); CHKERRQ(ierr);
     if (gLiquifiedVol > 0.0) {
@@ -141,11 +156,11 @@ PetscErrorCode IceModel::get_bed_top_temp(IceModelVec2S &result) {
 
   MaskQuery mask(vMask);
 
-  ierr = vbed.begin_access(); CHKERRQ(ierr);
+  ierr = vbed.begin_read_access(); CHKERRQ(ierr);
   ierr = result.begin_access(); CHKERRQ(ierr);
-  ierr = vH.begin_access(); CHKERRQ(ierr);
-  ierr = vMask.begin_access(); CHKERRQ(ierr);
-  ierr = artm.begin_access(); CHKERRQ(ierr);
+  ierr = vH.begin_read_access(); CHKERRQ(ierr);
+  ierr = vMask.begin_read_access(); CHKERRQ(ierr);
+  ierr = artm.begin_read_access(); CHKERRQ(ierr);
   for (PetscInt   i = grid.xs; i < grid.xs+grid.xm; ++i) {
     for (PetscInt j = grid.ys; j < grid.ys+grid.ym; ++j) {
       if (mask.grounded(i,j)) {
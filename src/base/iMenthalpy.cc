@@ -19,6 +19,7 @@
 #include "iceModel.hh"
 #include "enthSystem.hh"
 #include "varenthSystem.hh"
+#include "ageSystem.hh"
 #include "DrainageCalculator.hh"
 #include "Mask.hh"
 #include "PISMStressBalance.hh"
@@ -27,6 +28,8 @@
 #include "bedrockThermalUnit.hh"
 #include "enthalpyConverter.hh"
 #include "pism_options.hh"
+#include "PISMColumnList.hh"
+#include "PISMColumnChunks.hh"
 
 //! \file iMenthalpy.cc Methods of IceModel which implement the enthalpy formulation of conservation of energy.
 
@@ -52,17 +55,17 @@ PetscErrorCode IceModel::compute_enthalpy_cold(IceModelVec3 &temperature, IceMod
   ierr = vH.begin_access(); CHKERRQ(ierr);
 
   PetscScalar *Tij, *Enthij; // columns of these values
+  PetscScalar *p = new PetscScalar[grid.Mz]; // pressure in a column
   for (PetscInt i=grid.xs; i<grid.xs+grid.xm; ++i) {
     for (PetscInt j=grid.ys; j<grid.ys+grid.ym; ++j) {
       ierr = temperature.getInternalColumn(i,j,&Tij); CHKERRQ(ierr);
       ierr = result.getInternalColumn(i,j,&Enthij); CHKERRQ(ierr);
-      for (PetscInt k=0; k<grid.Mz; ++k) {
-        const PetscScalar depth = vH(i,j) - grid.zlevels[k]; // FIXME issue #15
-        ierr = EC->getEnthPermissive(Tij[k],0.0,EC->getPressureFromDepth(depth),
-                                    Enthij[k]); CHKERRQ(ierr);
-      }
+      // FIXME issue #15
+      EC->getPressureFromDepth_column(grid.Mz, vH(i,j), &grid.zlevels[0], p);
+      ierr = EC->getEnthPermissive_column(grid.Mz, Tij, NULL, p, Enthij); CHKERRQ(ierr);
     }
   }
+  delete [] p;
 
   ierr = result.end_access(); CHKERRQ(ierr);
   ierr = temperature.end_access(); CHKERRQ(ierr);
@@ -89,18 +92,18 @@ PetscErrorCode IceModel::compute_enthalpy(IceModelVec3 &temperature,
   ierr = vH.begin_access(); CHKERRQ(ierr);
 
   PetscScalar *Tij, *Liqfracij, *Enthij; // columns of these values
+  PetscScalar *p = new PetscScalar[grid.Mz]; // pressure in a column
   for (PetscInt i=grid.xs; i<grid.xs+grid.xm; ++i) {
     for (PetscInt j=grid.ys; j<grid.ys+grid.ym; ++j) {
       ierr = temperature.getInternalColumn(i,j,&Tij); CHKERRQ(ierr);
       ierr = liquid_water_fraction.getInternalColumn(i,j,&Liqfracij); CHKERRQ(ierr);
       ierr = result.getInternalColumn(i,j,&Enthij); CHKERRQ(ierr);
-      for (PetscInt k=0; k<grid.Mz; ++k) {
-        const PetscScalar depth = vH(i,j) - grid.zlevels[k]; // FIXME issue #15
-        ierr = EC->getEnthPermissive(Tij[k],Liqfracij[k],
-                      EC->getPressureFromDepth(depth), Enthij[k]); CHKERRQ(ierr);
-      }
+      // FIXME issue #15
+      EC->getPressureFromDepth_column(grid.Mz, vH(i,j), &grid.zlevels[0], p);
+      ierr = EC->getEnthPermissive_column(grid.Mz, Tij, Liqfracij, p, Enthij); CHKERRQ(ierr);
     }
   }
+  delete [] p;
 
   ierr = result.end_access(); CHKERRQ(ierr);
   ierr = temperature.end_access(); CHKERRQ(ierr);
@@ -130,17 +133,17 @@ PetscErrorCode IceModel::compute_liquid_water_fraction(IceModelVec3 &enthalpy,
   ierr = result.begin_access(); CHKERRQ(ierr);
   ierr = enthalpy.begin_access(); CHKERRQ(ierr);
   ierr = vH.begin_access(); CHKERRQ(ierr);
+  PetscScalar *p = new PetscScalar[grid.Mz]; // pressure in a column
   for (PetscInt i=grid.xs; i<grid.xs+grid.xm; ++i) {
     for (PetscInt j=grid.ys; j<grid.ys+grid.ym; ++j) {
       ierr = result.getInternalColumn(i,j,&omegaij); CHKERRQ(ierr);
       ierr = enthalpy.getInternalColumn(i,j,&Enthij); CHKERRQ(ierr);
-      for (PetscInt k=0; k<grid.Mz; ++k) {
-        const PetscScalar depth = vH(i,j) - grid.zlevels[k]; // FIXME issue #15
-        ierr = EC->getWaterFraction(Enthij[k],EC->getPressureFromDepth(depth),
-                                   omegaij[k]); CHKERRQ(ierr);
-      }
+      // FIXME issue #15
+      EC->getPressureFromDepth_column(grid.Mz, vH(i,j), &grid.zlevels[0], p);
+      ierr = EC->getWaterFraction_column(grid.Mz, Enthij, p, omegaij); CHKERRQ(ierr);
     }
   }
+  delete [] p;
   ierr = enthalpy.end_access(); CHKERRQ(ierr);
   ierr = result.end_access(); CHKERRQ(ierr);
   ierr = vH.end_access(); CHKERRQ(ierr);
@@ -166,16 +169,17 @@ PetscErrorCode IceModel::setCTSFromEnthalpy(IceModelVec3 &useForCTS) {
   ierr = useForCTS.begin_access(); CHKERRQ(ierr);
   ierr = Enth3.begin_access(); CHKERRQ(ierr);
   ierr = vH.begin_access(); CHKERRQ(ierr);
+  PetscScalar *p = new PetscScalar[grid.Mz]; // pressure in a column
   for (PetscInt i=grid.xs; i<grid.xs+grid.xm; ++i) {
     for (PetscInt j=grid.ys; j<grid.ys+grid.ym; ++j) {
       ierr = useForCTS.getInternalColumn(i,j,&CTSij); CHKERRQ(ierr);
       ierr = Enth3.getInternalColumn(i,j,&Enthij); CHKERRQ(ierr);
-      for (PetscInt k=0; k<grid.Mz; ++k) {
-        const PetscScalar depth = vH(i,j) - grid.zlevels[k]; // FIXME issue #15
-        CTSij[k] = EC->getCTS(Enthij[k], EC->getPressureFromDepth(depth));
-      }
+      // FIXME issue #15
+      EC->getPressureFromDepth_column(grid.Mz, vH(i,j), &grid.zlevels[0], p);
+      EC->getCTS_column(grid.Mz, Enthij, p, CTSij);
     }
   }
+  delete [] p;
   ierr = Enth3.end_access(); CHKERRQ(ierr);
   ierr = useForCTS.end_access(); CHKERRQ(ierr);
   ierr = vH.end_access(); CHKERRQ(ierr);
@@ -186,19 +190,19 @@ PetscErrorCode IceModel::setCTSFromEnthalpy(IceModelVec3 &useForCTS) {
 //! Compute the CTS value of enthalpy in an ice column.
 /*!
 Return argument Enth_s[Mz] has the enthalpy value for the pressure-melting 
-temperature at the corresponding z level.
+temperature at the corresponding z level of `vgrid`.
  */
-PetscErrorCode IceModel::getEnthalpyCTSColumn(PetscScalar p_air,
+PetscErrorCode IceModel::getEnthalpyCTSColumn(const columnSystemGrid &vgrid,
+                                              PetscScalar p_air,
 					      PetscScalar thk,
 					      PetscInt ks,
 					      PetscScalar **Enth_s) {
 
-  for (PetscInt k = 0; k <= ks; k++) {
-    const PetscScalar p = EC->getPressureFromDepth(thk - grid.zlevels_fine[k]); // FIXME issue #15
-    (*Enth_s)[k] = EC->getEnthalpyCTS(p);
-  }
+  // store pressure in Enth_s, then replace it with the CTS enthalpy
+  EC->getPressureFromDepth_column(ks + 1, thk, &vgrid.levels()[0], *Enth_s); // FIXME issue #15
+  EC->getEnthalpyCTS_column(ks + 1, *Enth_s, *Enth_s);
   const PetscScalar Es_air = EC->getEnthalpyCTS(p_air);
-  for (PetscInt k = ks+1; k < grid.Mz_fine; k++) {
+  for (PetscInt k = ks+1; k < vgrid.Mz(); k++) {
     (*Enth_s)[k] = Es_air;
   }
   return 0;
@@ -209,7 +213,8 @@ PetscErrorCode IceModel::getEnthalpyCTSColumn(PetscScalar p_air,
 /*!
 See page \ref bombproofenth.
  */
-PetscErrorCode IceModel::getlambdaColumn(PetscInt ks,
+PetscErrorCode IceModel::getlambdaColumn(const columnSystemGrid &vgrid,
+                                         PetscInt ks,
 					 PetscScalar ice_rho_c,
                                          PetscScalar ice_k,
 					 const PetscScalar *Enth,
@@ -223,7 +228,7 @@ PetscErrorCode IceModel::getlambdaColumn(PetscInt ks,
       *lambda = 0.0;
     } else {
       const PetscScalar 
-          denom = (PetscAbs(w[k]) + 0.000001/secpera) * ice_rho_c * grid.dz_fine;
+          denom = (PetscAbs(w[k]) + 0.000001/secpera) * ice_rho_c * vgrid.dz_layer[k];
       *lambda = PetscMin(*lambda, 2.0 * ice_k / denom);
     }
   }
@@ -239,7 +244,20 @@ AschwandenBuelerKhroulevBlatter].
 This method updates IceModelVec3 vWork3d = vEnthnew, IceModelVec2S vbmr, and 
 IceModelVec2S vbwat.  No communication of ghosts is done for any of these fields.
 
-We use an instance of enthSystemCtx.
+Columns are processed by enthalpyAndDrainageColumns(), in chunks which may
+be handled by several threads (see PISMColumnChunks). It uses an instance of
+enthSystemCtx to set up systems one column at a time and solves them in
+batches of columns (see columnSystemBatch). Updating enthalpy, the basal
+melt rate and the amount of basal water (drainage, etc) is done once the
+batch containing a column is solved. Only icy columns are split into
+chunks; ice-free columns need no column systems and are handled separately,
+in one pass.
+
+If `age_with_enthalpy` is set (see IceModel::step()) the age is updated in the
+same pass, using the velocity columns read for the enthalpy system and an
+instance of ageSystemCtx; new age values go in vWork3d_age. This reads each
+column of the 3D velocity once instead of twice. The age system is the one
+used by ageStep(), so results are the same.
 
 Regarding drainage, see [\ref AschwandenBuelerKhroulevBlatter] and references therein.
  */
@@ -255,54 +273,77 @@ PetscErrorCode IceModel::enthalpyAndDrainageStep(
 
   const PetscReal dt_secs = dt_TempAge;
 
-  // get fine grid levels in ice
-  PetscInt    fMz = grid.Mz_fine;  
-  PetscScalar fdz = grid.dz_fine;
-  vector<double> &fzlev = grid.zlevels_fine;
+  // vertical grid in ice used by column systems
+  columnSystemGrid vgrid(grid, config.get_flag("grid_storage_column_systems"));
+
+  // parameters, fields and options used in each column; see
+  // enthalpyAndDrainageColumns()
+  EnergyStepData data;
+  data.vgrid = &vgrid;
 
   // essentially physical constants
-  const PetscScalar
-    p_air     = config.get("surface_pressure"),          // Pa
-    ice_rho   = config.get("ice_density"),               // kg m-3
-    L         = config.get("water_latent_heat_fusion");  // J kg-1
+  data.p_air   = config.get("surface_pressure");          // Pa
+  data.ice_rho = config.get("ice_density");               // kg m-3
+  data.L       = config.get("water_latent_heat_fusion");  // J kg-1
 
   // constants used in controlling numerical scheme
-  const PetscScalar
-    default_ice_k = config.get("ice_thermal_conductivity"),   // used in setting lambda
-    default_ice_c = config.get("ice_specific_heat_capacity"), // used in setting lambda
-    bulgeEnthMax  = config.get("enthalpy_cold_bulge_max");    // J kg-1
+  data.ice_k        = config.get("ice_thermal_conductivity");   // used in setting lambda
+  data.ice_c        = config.get("ice_specific_heat_capacity"); // used in setting lambda
+  data.bulgeEnthMax = config.get("enthalpy_cold_bulge_max");    // J kg-1
 
   // constants used in hydrology model
-  const PetscScalar
-    bwat_decay_rate = config.get("bwat_decay_rate"),   // m s-1
-    bwat_max        = config.get("bwat_max");          // m
+  data.bwat_decay_rate = config.get("bwat_decay_rate");   // m s-1
+  data.bwat_max        = config.get("bwat_max");          // m
 
   DrainageCalculator dc(config);
-  
-  IceModelVec2S *Rb;
-  IceModelVec3 *u3, *v3, *w3, *Sigma3;
-  ierr = stress_balance->get_basal_frictional_heating(Rb); CHKERRQ(ierr);
-  ierr = stress_balance->get_3d_velocity(u3, v3, w3); CHKERRQ(ierr);
-  ierr = stress_balance->get_volumetric_strain_heating(Sigma3); CHKERRQ(ierr); 
+  data.dc = &dc;
 
-  PetscScalar *Enthnew;
-  Enthnew = new PetscScalar[fMz];  // new enthalpy in column
+  ierr = stress_balance->get_basal_frictional_heating(data.Rb); CHKERRQ(ierr);
+  ierr = stress_balance->get_3d_velocity(data.u3, data.v3, data.w3); CHKERRQ(ierr);
+  ierr = stress_balance->get_volumetric_strain_heating(data.Sigma3); CHKERRQ(ierr); 
 
-  enthSystemCtx *esys;
-  if (config.get_flag("use_temperature_dependent_thermal_conductivity") ||
-      config.get_flag("use_linear_in_temperature_heat_capacity")) {
-    esys  = new varenthSystemCtx(config, Enth3, fMz, "varenth", EC);
-  } else {
-    esys  = new enthSystemCtx(config, Enth3, fMz, "enth");
+  ierr = PISMOptionsIsSet("-view_sys", data.viewOneColumn); CHKERRQ(ierr);
+
+  // icy columns come first; see PISMColumnList
+  const vector<PISMColumnList::Column> &cols = columns->owned();
+  PISMColumnChunks chunks(config, columns->icy_count());
+
+  vector<PetscScalar> liquified(cols.size(), 0.0);
+  data.liquified = cols.empty() ? NULL : &liquified[0];
+
+  // each thread uses its own system
+  vector<enthSystemCtx*> esys(chunks.threads());
+  for (int t = 0; t < chunks.threads(); ++t) {
+    if (config.get_flag("use_temperature_dependent_thermal_conductivity") ||
+        config.get_flag("use_linear_in_temperature_heat_capacity")) {
+      esys[t] = new varenthSystemCtx(config, Enth3, vgrid, "varenth", EC);
+    } else {
+      esys[t] = new enthSystemCtx(config, Enth3, vgrid, "enth");
+    }
+    ierr = esys[t]->initAllColumns(grid.dx, grid.dy, dt_secs); CHKERRQ(ierr);
   }
-  ierr = esys->initAllColumns(grid.dx, grid.dy, dt_secs, fdz); CHKERRQ(ierr);
 
-  bool viewOneColumn;
-  ierr = PISMOptionsIsSet("-view_sys", viewOneColumn); CHKERRQ(ierr);
+  // if the age is updated in the same pass, each thread uses its own age
+  // system, sharing velocity columns with the enthalpy system
+  vector<ageSystemCtx*> asys(chunks.threads(), (ageSystemCtx*)NULL);
+  if (age_with_enthalpy) {
+    for (int t = 0; t < chunks.threads(); ++t) {
+      asys[t] = new ageSystemCtx(vgrid.Mz(), "age");
+      asys[t]->dx    = grid.dx;
+      asys[t]->dy    = grid.dy;
+      asys[t]->dtAge = dt_secs;
+      asys[t]->vgrid = &vgrid;
+      asys[t]->u     = esys[t]->u;
+      asys[t]->v     = esys[t]->v;
+      asys[t]->w     = esys[t]->w;
+      asys[t]->tau3  = &tau3;
+      ierr = asys[t]->initAllColumns(); CHKERRQ(ierr);
+    }
+  }
 
   if (getVerbosityLevel() >= 4) {  // view: all column-independent constants correct?
     ierr = EC->viewConstants(NULL); CHKERRQ(ierr);
-    ierr = esys->viewConstants(NULL, false); CHKERRQ(ierr);
+    ierr = esys[0]->viewConstants(NULL, false); CHKERRQ(ierr);
   }
 
   // now get map-plane coupler fields: Dirichlet upper surface boundary and
@@ -341,30 +382,157 @@ PetscErrorCode IceModel::enthalpyAndDrainageStep(
   ierr = vH.begin_access(); CHKERRQ(ierr);
   ierr = vbwat.begin_access(); CHKERRQ(ierr);
   ierr = vbmr.begin_access(); CHKERRQ(ierr);
-  ierr = Rb->begin_access(); CHKERRQ(ierr);
+  ierr = data.Rb->begin_access(); CHKERRQ(ierr);
   ierr = G0.begin_access(); CHKERRQ(ierr);
   ierr = vMask.begin_access(); CHKERRQ(ierr);
 
   // these are accessed a column at a time
-  ierr = u3->begin_access(); CHKERRQ(ierr);
-  ierr = v3->begin_access(); CHKERRQ(ierr);
-  ierr = w3->begin_access(); CHKERRQ(ierr);
-  ierr = Sigma3->begin_access(); CHKERRQ(ierr);
+  ierr = data.u3->begin_access(); CHKERRQ(ierr);
+  ierr = data.v3->begin_access(); CHKERRQ(ierr);
+  ierr = data.w3->begin_access(); CHKERRQ(ierr);
+  ierr = data.Sigma3->begin_access(); CHKERRQ(ierr);
   ierr = Enth3.begin_access(); CHKERRQ(ierr);
   ierr = vWork3d.begin_access(); CHKERRQ(ierr);
+  if (age_with_enthalpy) {
+    ierr = tau3.begin_access(); CHKERRQ(ierr);
+    ierr = vWork3d_age.begin_access(); CHKERRQ(ierr);
+  }
+
+  data.G0 = &G0;
+
+  // columns are processed in chunks, possibly by several threads at once;
+  // see PISMColumnChunks
+  vector<PetscErrorCode> errors(chunks.size(), 0);
+  vector<EnergyStepCounts> counts(chunks.size());
+
+#if (PISM_USE_OPENMP==1)
+#pragma omp parallel for schedule(dynamic, 1) num_threads(chunks.threads())
+#endif
+  for (int c = 0; c < chunks.size(); ++c) {
+    const int t = PISMColumnChunks::thread();
+    errors[c] = enthalpyAndDrainageColumns(chunks.begin(c), chunks.end(c), data,
+                                           *esys[t], asys[t], counts[c]);
+  }
+
+  // ice-free columns: these only get the surface enthalpy (and zero age), so
+  // there is no point in spreading them over threads
+  EnergyStepCounts ice_free_counts;
+  ierr = enthalpyAndDrainageColumns(columns->icy_count(), cols.size(), data,
+                                    *esys[0], asys[0], ice_free_counts); CHKERRQ(ierr);
+
+  for (int c = 0; c < chunks.size(); ++c) {
+    CHKERRQ(errors[c]);
+
+    *vertSacrCount += counts[c].vertSacrCount;
+    *bulgeCount    += counts[c].bulgeCount;
+  }
+
+  // summed in the same order regardless of the number of threads
+  PetscScalar liquifiedCount = 0.0;
+  for (unsigned int n = 0; n < liquified.size(); ++n) {
+    liquifiedCount += liquified[n];
+  }
+
+  ierr = artm.end_access(); CHKERRQ(ierr);
+  ierr = shelfbmassflux.end_access(); CHKERRQ(ierr);
+  ierr = shelfbtemp.end_access(); CHKERRQ(ierr);
+
+  ierr = vH.end_access(); CHKERRQ(ierr);
+  ierr = vMask.end_access(); CHKERRQ(ierr);
+  ierr = vbwat.end_access(); CHKERRQ(ierr);
+  ierr = data.Rb->end_access(); CHKERRQ(ierr);
+  ierr = G0.end_access(); CHKERRQ(ierr);
+  ierr = vbmr.end_access(); CHKERRQ(ierr);
+  ierr = liqfrac_surface.end_access(); CHKERRQ(ierr);
+
+  ierr = data.u3->end_access(); CHKERRQ(ierr);
+  ierr = data.v3->end_access(); CHKERRQ(ierr);
+  ierr = data.w3->end_access(); CHKERRQ(ierr);
+  ierr = data.Sigma3->end_access(); CHKERRQ(ierr);
+  ierr = Enth3.end_access(); CHKERRQ(ierr);
+  ierr = vWork3d.end_access(); CHKERRQ(ierr);
+  if (age_with_enthalpy) {
+    ierr = tau3.end_access(); CHKERRQ(ierr);
+    ierr = vWork3d_age.end_access(); CHKERRQ(ierr);
+  }
+
+  for (int t = 0; t < chunks.threads(); ++t) {
+    delete esys[t];
+    delete asys[t];
+  }
+
+  *liquifiedVol = liquifiedCount * vgrid.dz() * grid.dx * grid.dy;
+  return 0;
+}
+
+
+//! Update enthalpy, the basal melt rate and the amount of basal water in
+//! owned columns `begin`, ..., `end - 1`.
+/*!
+Called by enthalpyAndDrainageStep(), possibly by several threads at once
+(processing different columns); `system` has to be private to the calling
+thread. Fields used here have to be accessible (see begin_access()).
 
-  PetscInt liquifiedCount = 0;
+If `age_system` is not NULL (it has to be private to the calling thread, too)
+this updates the age as well, putting new values in vWork3d_age.
+ */
+PetscErrorCode IceModel::enthalpyAndDrainageColumns(unsigned int begin, unsigned int end,
+                                                    const EnergyStepData &data,
+                                                    enthSystemCtx &system,
+                                                    ageSystemCtx *age_system,
+                                                    EnergyStepCounts &counts) {
+  PetscErrorCode  ierr;
+
+  const PetscReal dt_secs = dt_TempAge;
+
+  // vertical grid in ice used by column systems
+  const columnSystemGrid &vgrid = *data.vgrid;
+  const PetscInt Mz = vgrid.Mz();
+
+  const PetscScalar
+    p_air           = data.p_air,
+    ice_rho         = data.ice_rho,
+    L               = data.L,
+    default_ice_k   = data.ice_k,
+    default_ice_c   = data.ice_c,
+    bulgeEnthMax    = data.bulgeEnthMax,
+    bwat_decay_rate = data.bwat_decay_rate,
+    bwat_max        = data.bwat_max;
+
+  DrainageCalculator &dc = *data.dc;
+  IceModelVec2S *Rb = data.Rb, &G0 = *data.G0;
+  IceModelVec3 *u3 = data.u3, *v3 = data.v3, *w3 = data.w3, *Sigma3 = data.Sigma3;
+  const bool viewOneColumn = data.viewOneColumn;
+
+  enthSystemCtx *esys = &system;
+
+  PetscScalar *Enthnew;
+  Enthnew = new PetscScalar[Mz];  // new enthalpy in column
+
+  // systems are solved in batches; when viewing a column each batch contains
+  // one system so that everything viewed corresponds to the same column
+  columnSystemBatch batch(Mz, viewOneColumn ? 1 : columnSystemBatch::default_width);
+  const int W = batch.width();
+  vector<unsigned int> lane_column(W); // column index in each lane
+  vector<PetscScalar> lane_Enth_ks(W), // surface enthalpy in each lane
+    lane_Enth_s(W * Mz);               // CTS enthalpy in each lane
+
+  // age systems (if any) occupy the same lanes of their own batch
+  columnSystemBatch age_batch(age_system != NULL ? Mz : 1, W);
+  vector<PetscScalar> agenew(Mz);
 
   MaskQuery mask(vMask);
 
-  for (PetscInt i=grid.xs; i<grid.xs+grid.xm; ++i) {
-    for (PetscInt j=grid.ys; j<grid.ys+grid.ym; ++j) {
+  const vector<PISMColumnList::Column> &cols = columns->owned();
 
-      // for fine grid; this should *not* be replaced by call to grid.kBelowHeight()
-      const PetscInt ks = static_cast<PetscInt>(floor(vH(i,j)/fdz));
+  for (unsigned int n = begin; n < end; ++n) {
+    { // set up the system in column n (ice-free columns are finished here)
+      const PetscInt i = cols[n].i, j = cols[n].j;
+      // index of the level just below the ice surface
+      const PetscInt ks = vgrid.ks(cols[n]);
 #if (PISM_DEBUG==1)
       // check if ks is valid
-      if ((ks < 0) || (ks >= grid.Mz_fine)) {
+      if ((ks < 0) || (ks >= Mz)) {
         PetscPrintf(grid.com,
                     "ERROR: ks = %d computed at i = %d, j = %d is invalid,"
                     " possibly because of invalid ice thickness.\n",
@@ -377,13 +545,16 @@ PetscErrorCode IceModel::enthalpyAndDrainageStep(
                  is_floating     = mask.ocean(i,j);
 
       // enthalpy and pressures at top of ice
-      const PetscScalar p_ks = EC->getPressureFromDepth(vH(i,j) - fzlev[ks]); // FIXME issue #15
+      const PetscScalar p_ks = EC->getPressureFromDepth(vH(i,j) - vgrid.z(ks)); // FIXME issue #15
       PetscScalar Enth_ks;
       ierr = EC->getEnthPermissive(artm(i,j), liqfrac_surface(i,j), p_ks, Enth_ks); CHKERRQ(ierr);
 
       // deal completely with columns with no ice; enthalpy, vbwat, vbmr all need setting
       if (ice_free_column) {
         ierr = vWork3d.setColumn(i,j,Enth_ks); CHKERRQ(ierr);
+        if (age_system != NULL) {
+          ierr = vWork3d_age.setColumn(i,j,0.0); CHKERRQ(ierr);
+        }
         if (mask.floating_ice(i,j)) {
           // if floating then assume-maximally saturated till to avoid "shock"
           //   when grounding line advances
@@ -406,16 +577,16 @@ PetscErrorCode IceModel::enthalpyAndDrainageStep(
                                  vH(i+1,j),vH(i+1,j+1),vH(i,j+1),vH(i-1,j+1),
                                  vH(i-1,j),vH(i-1,j-1),vH(i,j-1),vH(i+1,j-1)  );
 
-        ierr = Enth3.getValColumn(i,j,ks,esys->Enth); CHKERRQ(ierr);
-        ierr = w3->getValColumn(i,j,ks,esys->w); CHKERRQ(ierr);
+        ierr = vgrid.get_column(Enth3, i, j, ks, esys->Enth); CHKERRQ(ierr);
+        ierr = vgrid.get_column(*w3, i, j, ks, esys->w); CHKERRQ(ierr);
 
-        ierr = getEnthalpyCTSColumn(p_air, vH(i,j), ks, &esys->Enth_s); CHKERRQ(ierr);
+        ierr = getEnthalpyCTSColumn(vgrid, p_air, vH(i,j), ks, &esys->Enth_s); CHKERRQ(ierr);
 
         PetscScalar lambda;
-        ierr = getlambdaColumn(ks, ice_rho * default_ice_c, default_ice_k,
+        ierr = getlambdaColumn(vgrid, ks, ice_rho * default_ice_c, default_ice_k,
                                esys->Enth, esys->Enth_s, esys->w,
                                &lambda); CHKERRQ(ierr);
-        if (lambda < 1.0)  *vertSacrCount += 1; // count columns with lambda < 1
+        if (lambda < 1.0)  counts.vertSacrCount += 1; // count columns with lambda < 1
 
         // if there is subglacial water, don't allow ice base enthalpy to be below
         // pressure-melting; that is, assume subglacial water is at the pressure-
@@ -425,7 +596,7 @@ PetscErrorCode IceModel::enthalpyAndDrainageStep(
         }
 
         const bool base_is_cold = (esys->Enth[0] < esys->Enth_s[0]);
-        const PetscScalar p1 = EC->getPressureFromDepth(vH(i,j) - fdz); // FIXME issue #15
+        const PetscScalar p1 = EC->getPressureFromDepth(vH(i,j) - vgrid.z(1)); // FIXME issue #15
         const bool k1_istemperate = EC->isTemperate(esys->Enth[1], p1); // level  z = + \Delta z
 
         // can now determine melt, but only preliminarily because of drainage,
@@ -440,12 +611,12 @@ PetscErrorCode IceModel::enthalpyAndDrainageStep(
             PetscScalar hf_up;
             if (k1_istemperate) {
               const PetscScalar Tpmpbasal = EC->getMeltingTemp(pbasal);
-              hf_up = - esys->k_from_T(Tpmpbasal) * (EC->getMeltingTemp(p1) - Tpmpbasal) / fdz;
+              hf_up = - esys->k_from_T(Tpmpbasal) * (EC->getMeltingTemp(p1) - Tpmpbasal) / vgrid.dz_plus[0];
             } else {
               PetscScalar Tbasal;
               ierr = EC->getAbsTemp(esys->Enth[0], pbasal, Tbasal); CHKERRQ(ierr);
               const PetscScalar Kbasal = esys->k_from_T(Tbasal) / EC->c_from_T(Tbasal);
-              hf_up = - Kbasal * (esys->Enth[1] - esys->Enth[0]) / fdz;
+              hf_up = - Kbasal * (esys->Enth[1] - esys->Enth[0]) / vgrid.dz_plus[0];
             }
 
             // compute basal melt rate from flux balance; vbmr = - Mb / rho in
@@ -462,9 +633,9 @@ PetscErrorCode IceModel::enthalpyAndDrainageStep(
         //   esys->Enth_s[] are already filled
         ierr = esys->setIndicesAndClearThisColumn(i,j,ks); CHKERRQ(ierr);
 
-        ierr = u3->getValColumn(i,j,ks,esys->u); CHKERRQ(ierr);
-        ierr = v3->getValColumn(i,j,ks,esys->v); CHKERRQ(ierr);
-        ierr = Sigma3->getValColumn(i,j,ks,esys->Sigma); CHKERRQ(ierr);
+        ierr = vgrid.get_column(*u3, i, j, ks, esys->u); CHKERRQ(ierr);
+        ierr = vgrid.get_column(*v3, i, j, ks, esys->v); CHKERRQ(ierr);
+        ierr = vgrid.get_column(*Sigma3, i, j, ks, esys->Sigma); CHKERRQ(ierr);
 
         ierr = esys->initThisColumn(isMarginal, lambda, vH(i, j)); CHKERRQ(ierr);
         ierr = esys->setBoundaryValuesThisColumn(Enth_ks); CHKERRQ(ierr);
@@ -492,22 +663,93 @@ PetscErrorCode IceModel::enthalpyAndDrainageStep(
           }
         }
 
-        // solve the system
-        PetscErrorCode pivoterr;
-        ierr = esys->solveThisColumn(&Enthnew,pivoterr); CHKERRQ(ierr);
+        // set up the system; it is solved below, together with systems from
+        // other columns
+        ierr = esys->assembleThisColumn(); CHKERRQ(ierr);
+
+        const int lane = batch.size();
+        lane_column[lane]  = n;
+        lane_Enth_ks[lane] = Enth_ks;
+        for (PetscInt k = 0; k <= ks; ++k)
+          lane_Enth_s[lane * Mz + k] = esys->Enth_s[k];
+
+        ierr = batch.add(*esys, ks + 1); CHKERRQ(ierr);
+
+        if (age_system != NULL) {
+          // uses velocity columns in esys->u, esys->v, esys->w
+          ierr = age_system->setIndicesAndClearThisColumn(i,j,ks); CHKERRQ(ierr);
+          ierr = age_system->assembleThisColumn(); CHKERRQ(ierr);
+          ierr = age_batch.add(*age_system, ks + 1); CHKERRQ(ierr);
+        }
+      } // end explicit scoping
+
+      donewithcolumn:
+      { }  // odd thing: something needs to follow goto target to get compilation
+    }
+
+    if (batch.full() || n + 1 == end) {
+      ierr = batch.solve(); CHKERRQ(ierr);
+      if (age_system != NULL) {
+        ierr = age_batch.solve(); CHKERRQ(ierr);
+      }
+
+      for (int l = 0; l < batch.size(); ++l) {
+        const PetscInt i = cols[lane_column[l]].i, j = cols[lane_column[l]].j,
+          ks = vgrid.ks(cols[lane_column[l]]);
+        const bool is_floating = mask.ocean(i,j);
+        const PetscScalar Enth_ks = lane_Enth_ks[l],
+          *Enth_s = &lane_Enth_s[l * Mz];
+
+        if (age_system != NULL) { // same as in IceModel::ageColumns()
+          PetscErrorCode agepivoterr = age_batch.pivot_error(l);
+          if (agepivoterr != 0) {
+            ierr = PetscPrintf(PETSC_COMM_SELF,
+              "\n\ntridiagonal solve of ageSystemCtx in enthalpyAndDrainageStep() FAILED at (%d,%d)\n"
+                  " with zero pivot position %d; viewing system to m-file ... \n",
+              i, j, agepivoterr); CHKERRQ(ierr);
+            ierr = age_batch.get_system(l, *age_system); CHKERRQ(ierr);
+            ierr = age_system->reportColumnZeroPivotErrorMFile(agepivoterr); CHKERRQ(ierr);
+            SETERRQ(grid.com, 1,"PISM ERROR in enthalpyDrainageStep()\n");
+          }
+
+          ierr = age_batch.get_solution(l, &agenew[0]); CHKERRQ(ierr);
+
+          if (viewOneColumn && issounding(i,j)) {
+            ierr = age_batch.get_system(l, *age_system); CHKERRQ(ierr);
+            ierr = age_system->viewColumnInfoMFile(&agenew[0], Mz); CHKERRQ(ierr);
+          }
+
+          // age of ice above (and at) surface is zero
+          for (PetscInt k = ks+1; k < Mz; k++) {
+            agenew[k] = 0.0;
+          }
+
+          ierr = vgrid.set_column(vWork3d_age, i, j, &agenew[0]); CHKERRQ(ierr);
+        }
+
+        PetscErrorCode pivoterr = batch.pivot_error(l);
         if (pivoterr != 0) {
           ierr = PetscPrintf(PETSC_COMM_SELF,
             "\n\ntridiagonal solve of enthSystemCtx in enthalpyAndDrainageStep() FAILED at (%d,%d)\n"
                 " with zero pivot position %d; viewing system to m-file ... \n",
             i, j, pivoterr); CHKERRQ(ierr);
+          ierr = batch.get_system(l, *esys); CHKERRQ(ierr);
           ierr = esys->reportColumnZeroPivotErrorMFile(pivoterr); CHKERRQ(ierr);
           SETERRQ(grid.com, 1,"PISM ERROR in enthalpyDrainageStep()\n");
         }
+
+        ierr = batch.get_solution(l, Enthnew); CHKERRQ(ierr);
+        // air above
+        for (PetscInt k = ks+1; k < Mz; k++) {
+          Enthnew[k] = Enth_ks;
+        }
+
         if (viewOneColumn && issounding(i,j)) {
           ierr = PetscPrintf(PETSC_COMM_SELF,
             "\n\nin enthalpyAndDrainageStep(): viewing enthSystemCtx at (i,j)=(%d,%d) to m-file ... \n\n",
             i, j); CHKERRQ(ierr);
-          ierr = esys->viewColumnInfoMFile(Enthnew, fMz); CHKERRQ(ierr);
+          ierr = batch.get_system(l, *esys); CHKERRQ(ierr);
+          ierr = esys->viewColumnInfoMFile(Enthnew, Mz); CHKERRQ(ierr);
         }
 
         // thermodynamic basal melt rate causes water to be added to layer
@@ -520,18 +762,18 @@ PetscErrorCode IceModel::enthalpyAndDrainageStep(
         //   using DrainageCalculator dc
         PetscScalar Hdrainedtotal = 0.0;
         for (PetscInt k=0; k < ks; k++) {
-          if (Enthnew[k] > esys->Enth_s[k]) { // avoid doing any more work if cold
-            if (Enthnew[k] >= esys->Enth_s[k] + 0.5 * L) {
-              liquifiedCount++; // count these rare events ...
-              Enthnew[k] = esys->Enth_s[k] + 0.5 * L; //  but lose the energy
+          if (Enthnew[k] > Enth_s[k]) { // avoid doing any more work if cold
+            if (Enthnew[k] >= Enth_s[k] + 0.5 * L) {
+              data.liquified[lane_column[l]] += vgrid.dz_layer[k] / vgrid.dz(); // count these rare events ...
+              Enthnew[k] = Enth_s[k] + 0.5 * L; //  but lose the energy
             }
-            const PetscReal p = EC->getPressureFromDepth(vH(i,j) - fzlev[k]); // FIXME issue #15
+            const PetscReal p = EC->getPressureFromDepth(vH(i,j) - vgrid.z(k)); // FIXME issue #15
             PetscReal omega;
             EC->getWaterFraction(Enthnew[k], p, omega);  // return code not checked
             if (omega > 0.01) {
               PetscReal fractiondrained = dc.get_drainage_rate(omega) * dt_secs; // pure number
               fractiondrained = PetscMin(fractiondrained, omega - 0.01); // only drain down to 0.01
-              Hdrainedtotal += fractiondrained * fdz;  // always a positive contribution
+              Hdrainedtotal += fractiondrained * vgrid.dz_layer[k];  // always a positive contribution
               Enthnew[k] -= fractiondrained * L;
             }
           }
@@ -549,11 +791,11 @@ PetscErrorCode IceModel::enthalpyAndDrainageStep(
         const PetscReal lowerEnthLimit = Enth_ks - bulgeEnthMax;
         for (PetscInt k=0; k < ks; k++) {
           if (Enthnew[k] < lowerEnthLimit) {
-            *bulgeCount += 1;      // count the columns which have very large cold 
+            counts.bulgeCount += 1;      // count the columns which have very large cold 
             Enthnew[k] = lowerEnthLimit;  // limit advection bulge ... enthalpy not too low
           }
         }
-        ierr = vWork3d.setValColumnPL(i,j,Enthnew); CHKERRQ(ierr);
+        ierr = vgrid.set_column(vWork3d, i, j, Enthnew); CHKERRQ(ierr);
 
         // finalize bwat value
         bwatnew -= bwat_decay_rate * dt_secs;
@@ -566,38 +808,15 @@ PetscErrorCode IceModel::enthalpyAndDrainageStep(
           // UNACCOUNTED MASS & ENERGY (LATENT) LOSS (TO INFINITY AND BEYOND)!!
           vbwat(i,j) = PetscMax(0.0, PetscMin(bwat_max, bwatnew) );
         }
+      }
 
-      } // end explicit scoping
-      
-      donewithcolumn: 
-      { }  // odd thing: something needs to follow goto target to get compilation
-
+      batch.clear();
+      age_batch.clear();
     }
   }
 
-  ierr = artm.end_access(); CHKERRQ(ierr);
-  ierr = shelfbmassflux.end_access(); CHKERRQ(ierr);
-  ierr = shelfbtemp.end_access(); CHKERRQ(ierr);
-
-  ierr = vH.end_access(); CHKERRQ(ierr);
-  ierr = vMask.end_access(); CHKERRQ(ierr);
-  ierr = vbwat.end_access(); CHKERRQ(ierr);
-  ierr = Rb->end_access(); CHKERRQ(ierr);
-  ierr = G0.end_access(); CHKERRQ(ierr);
-  ierr = vbmr.end_access(); CHKERRQ(ierr);
-  ierr = liqfrac_surface.end_access(); CHKERRQ(ierr);
-
-  ierr = u3->end_access(); CHKERRQ(ierr);
-  ierr = v3->end_access(); CHKERRQ(ierr);
-  ierr = w3->end_access(); CHKERRQ(ierr);
-  ierr = Sigma3->end_access(); CHKERRQ(ierr);
-  ierr = Enth3.end_access(); CHKERRQ(ierr);
-  ierr = vWork3d.end_access(); CHKERRQ(ierr);
-
   delete [] Enthnew;
-  delete esys;
 
-  *liquifiedVol = ((double) liquifiedCount) * fdz * grid.dx * grid.dy;
   return 0;
 }
 
@@ -25,6 +25,7 @@
 #include "PISMOcean.hh"
 #include "PISMSurface.hh"
 #include "PISMStressBalance.hh"
+#include "PISMRefinedPatches.hh"
 
 //! \file iMgeometry.cc Methods of IceModel which update and maintain consistency of ice sheet geometry.
 
@@ -220,6 +221,45 @@ ierr =  var_ref->end_access(); CHKERRQ(ierr);
 return 0;
 }
 
+//! \brief Follow the grounding line with refined tiles and initialize newly
+//! refined cells.
+/*!
+ * Used instead of update_refined_variable() if refined fields are stored in
+ * tiles (see PISMRefinedPatches). Only the ice thickness is refined; other
+ * inputs of the mass continuity step are read from the coarse grid, as in the
+ * whole-domain version.
+ */
+PetscErrorCode IceModel::update_refined_patches() {
+  PetscErrorCode ierr;
+  int allocated, freed;
+
+  ierr = refined_patches->update(*vGLMask[0], allocated, freed); CHKERRQ(ierr);
+
+  // counts are per processor: reduce them on all processors (the verbosity
+  // level is the same everywhere), then decide whether to report
+  if (getVerbosityLevel() >= 3) {
+    PetscScalar local[4] = {static_cast<PetscScalar>(allocated),
+                            static_cast<PetscScalar>(freed),
+                            static_cast<PetscScalar>(refined_patches->tile_count()),
+                            refined_patches->memory_bytes() / 1048576.0},
+      global[4];
+    for (int n = 0; n < 4; ++n) {
+      ierr = PISMGlobalSum(&local[n], &global[n], grid.com); CHKERRQ(ierr);
+    }
+
+    if (global[0] > 0 || global[1] > 0) {
+      ierr = verbPrintf(3, grid.com,
+                        "  refined patches: %d allocated, %d freed, %d active (%.2f Mb)\n",
+                        (int)global[0], (int)global[1], (int)global[2], global[3]); CHKERRQ(ierr);
+    }
+  }
+
+  ierr = refined_patches->refine(patch_thk, vH, *vGLMask[0], *vGLMask[1]); CHKERRQ(ierr);
+  ierr = refined_patches->fill_halo(patch_thk, vH, *vGLMask[0]); CHKERRQ(ierr);
+
+  return 0;
+}
+
 //! \brief Adjust ice flow through interfaces of the cell i,j.
 /*!
  *
@@ -613,13 +653,17 @@ PetscErrorCode IceModel::massContExplicitStep() {
     include_bmr_in_continuity = config.get_flag("include_bmr_in_continuity"),
     compute_cumulative_climatic_mass_balance = config.get_flag("compute_cumulative_climatic_mass_balance"),
 	do_part_grid = config.get_flag("part_grid"),
-    do_redist = config.get_flag("part_redist");
+    do_redist = config.get_flag("part_redist"),
+    use_patches = do_mesh_refinement && refined_patches != NULL;
 
 	  if(config.get_flag("mesh_refinement")||config.get_flag("do_glmask")){
    ierr=update_glmask(); CHKERRQ(ierr);
 	 }
 	//update refined mesh
 	 if(config.get_flag("mesh_refinement")){
+    if (use_patches) {
+      ierr = update_refined_patches(); CHKERRQ(ierr);
+    } else {
 	update_refined_variable(vH,vH_ref);
     update_refined_variable (acab,acab_ref);
     update_refined_variable (vbmr,vbmr_ref);
@@ -628,6 +672,7 @@ PetscErrorCode IceModel::massContExplicitStep() {
 	if(do_part_grid){
 	update_refined_variable(vHref,vHref_ref);
 	}	
+    }
 	 }
 
   // FIXME: use corrected cell areas (when available)
@@ -648,7 +693,9 @@ PetscErrorCode IceModel::massContExplicitStep() {
 	IceModelVec2S  *vHnew_ref,
 							*vHnew_ptr;
  PetscScalar *dx_ref,*dy_ref ;
- if(config.get_flag("mesh_refinement")){
+ if (use_patches) {
+   ierr = refined_patches->copy(patch_thk, patch_thk_new); CHKERRQ(ierr);
+ } else if(config.get_flag("mesh_refinement")){
 		dx_ref=&grid_refined->dx;
 		dy_ref=&grid_refined->dy;
 	 
@@ -675,7 +722,7 @@ IceModelVec2V *vel_advective_ref;
  if(config.get_flag("mesh_refinement")||config.get_flag("do_glmask")){ 
 ierr = vGLMask[0]->begin_access();  CHKERRQ(ierr);
  }
- if(config.get_flag("mesh_refinement")){ 
+ if(config.get_flag("mesh_refinement") && !use_patches){ 
 /*	 
   ierr = stress_balance_ref->get_diffusive_flux(Qdiff_ref); CHKERRQ(ierr); //TODO maybe later
   ierr = stress_balance_ref->get_advective_2d_velocity(vel_advective_ref); CHKERRQ(ierr);
@@ -736,10 +783,21 @@ mcs.compute_cumulative_climatic_mass_balance=compute_cumulative_climatic_mass_ba
 PetscScalar *dx_ptr,
 				  *dy_ptr;
 PetscInt weighting;
-PetscPrintf(grid.com,"DURCHLAUF ");
-PetscPrintf(grid.com,"Hoehe: %f  GL:%f \n",vH(200,3),(*vGLMask[0])(200,3));
-  for (PetscInt i = grid.xs; i < grid.xs + grid.xm; ++i) {
-    for (PetscInt j = grid.ys; j < grid.ys + grid.ym; ++j) {
+  // The ghost update of vHnew can start as soon as the strip along sub-domain
+  // edges is done and proceed while the interior is computed. This is not done
+  // with mesh refinement because vHnew is modified after this loop then.
+  const bool overlap = config.get_flag("grid_overlap_communication") && !do_mesh_refinement;
+  bool ghost_comm_started = false;
+  for (PISMSplitLoop p(grid, vHnew.get_stencil_width()); !p.done(); p.next()) {
+      PetscInt i = p.i(), j = p.j();
+      if (overlap && p.interior_starts()) {
+        // the array has to be restored before the communication starts; the
+        // interior computed next does not overlap the values being sent
+        ierr = vHnew.end_access(); CHKERRQ(ierr);
+        ierr = vHnew.beginGhostComm(); CHKERRQ(ierr);
+        ierr = vHnew.begin_access(); CHKERRQ(ierr);
+        ghost_comm_started = true;
+      }
 	
 		PetscInt i_ref = refinement*i,
 					j_ref = refinement*j;
@@ -748,13 +806,22 @@ PetscPrintf(grid.com,"Hoehe: %f  GL:%f \n",vH(200,3),(*vGLMask[0])(200,3));
 			if((*vGLMask[0])(i,j)==1){
 			//PetscPrintf(grid.com,"GLPos:%d %d\n",i,j);
 			no_refinement_iteration=false;
-			i_ptr=   &i_ref;		j_ptr=	&j_ref;
 			dx_ptr=&dx;
 			dy_ptr=&dy;
+			weighting=refinement*refinement;
+			if (use_patches) {
+			  // thickness is read from and written to tiles below; Href is
+			  // not refined
+			  i_ptr = &i;		j_ptr = &j;
+			  vH_ptr = &vH;
+			  vHnew_ptr = &vHnew;
+			  vHref_ptr = &vHref;
+			} else {
+			i_ptr=   &i_ref;		j_ptr=	&j_ref;
 			vH_ptr=vH_ref;
 			vHnew_ptr=vHnew_ref;
 			vHref_ptr=vHref_ref;
-			weighting=refinement*refinement;
+			}
 			}
 			else{ 
 			no_refinement_iteration=true;
@@ -794,6 +861,18 @@ PetscPrintf(grid.com,"Hoehe: %f  GL:%f \n",vH(200,3),(*vGLMask[0])(200,3));
 	
 double divQ_SIA = 0.0, divQ_SSA = 0.0;
 
+      // ice thickness at the current (possibly refined) cell and its
+      // neighbors, and the location of the new thickness
+      planeStar<PetscScalar> H;
+      PetscScalar *H_new;
+      if (use_patches && !no_refinement_iteration) {
+        H     = refined_patches->star(patch_thk, i_ref, j_ref);
+        H_new = &(*refined_patches)(patch_thk_new, i_ref, j_ref);
+      } else {
+        H     = vH_ptr->star(*i_ptr, *j_ptr);
+        H_new = &(*vHnew_ptr)(*i_ptr, *j_ptr);
+      }
+
       // Source terms:
       double
         surface_mass_balance = acab(i, j),
@@ -823,11 +902,11 @@ double divQ_SIA = 0.0, divQ_SSA = 0.0;
 		//if (no_refinement_iteration){PetscPrintf(grid.com,"divQ B %f\n ",divQ_SIA);} //TODO test 
         // Plug flow part (i.e. basal sliding; from SSA): upwind by staggered grid
         // PIK method;  this is   \nabla \cdot [(u, v) H]
-        divQ_SSA += ( v.e * (v.e > 0 ? (*vH_ptr)(*i_ptr, *j_ptr) : (*vH_ptr)(*i_ptr+1, *j_ptr))
-                      - v.w * (v.w > 0 ? (*vH_ptr)(*i_ptr-1, *j_ptr) : (*vH_ptr)(*i_ptr, *j_ptr)) ) / (*dx_ptr); 
+        divQ_SSA += ( v.e * (v.e > 0 ? H.ij : H.e)
+                      - v.w * (v.w > 0 ? H.w : H.ij) ) / (*dx_ptr); 
 		 
-        divQ_SSA += ( v.n * (v.n > 0 ? (*vH_ptr)(*i_ptr, *j_ptr) : (*vH_ptr)(*i_ptr, *j_ptr+1))
-                      - v.s * (v.s > 0 ? (*vH_ptr)(*i_ptr, *j_ptr-1) : (*vH_ptr)(*i_ptr, *j_ptr)) ) / (*dy_ptr);
+        divQ_SSA += ( v.n * (v.n > 0 ? H.ij : H.n)
+                      - v.s * (v.s > 0 ? H.s : H.ij) ) / (*dy_ptr);
 		
       }
 
@@ -862,8 +941,8 @@ double divQ_SIA = 0.0, divQ_SSA = 0.0;
 
           PetscReal H_average = get_average_thickness(do_redist,
                                                       vMask.int_star(i, j),
-                                                      vH_ptr->star(*i_ptr, *j_ptr)),
-            coverage_ratio = (*vH_ptr)(*i_ptr, *j_ptr) / H_average;
+                                                      H),
+            coverage_ratio = H.ij / H_average;
 
           if (coverage_ratio >= 1.0) {
             // A partially filled grid cell is now considered to be full.
@@ -907,17 +986,17 @@ double divQ_SIA = 0.0, divQ_SSA = 0.0;
 			
  //if ((*vGLMask[0])(i,j)==1){PetscPrintf(grid.com,"Werte:: %f, %f, %f,H: %f \n ",1000*surface_mass_balance,
    //                                       1000*divQ_SIA, 1000*divQ_SSA,(*vHnew_ptr)(*i_ptr, *j_ptr));}
-      (*vHnew_ptr)(*i_ptr, *j_ptr) += (dt * (surface_mass_balance // accumulation/ablation
+      *H_new += (dt * (surface_mass_balance // accumulation/ablation
                             - meltrate_grounded // basal melt rate (grounded)
                             - meltrate_floating // sub-shelf melt rate
                             - (divQ_SIA + divQ_SSA)) // flux divergence
                       + Href_to_H_flux); // corresponds to a cell becoming "full"
 
-      if ((*vHnew_ptr)(*i_ptr, *j_ptr) < 0.0) {
-        nonneg_rule_flux += -(*vHnew_ptr)(*i_ptr, *j_ptr); //TODO flux?
+      if (*H_new < 0.0) {
+        nonneg_rule_flux += -*H_new; //TODO flux?
 
         // this has to go *after* accounting above!
-        (*vHnew_ptr)(*i_ptr, *j_ptr) = 0.0;
+        *H_new = 0.0;
       }
 
       // "Calving" mechanisms
@@ -931,19 +1010,19 @@ double divQ_SIA = 0.0, divQ_SSA = 0.0;
         // force zero thickness at points which were originally ocean (if "-ocean_kill");
         //   this is calving at original calving front location
         if ( do_ocean_kill && ocean_kill_mask.as_int(i, j) == 1) {
-          ocean_kill_flux = -(*vHnew_ptr)(*i_ptr, *j_ptr);
+          ocean_kill_flux = -*H_new;
 
           // this has to go *after* accounting above!
-          (*vHnew_ptr)(*i_ptr, *j_ptr) = 0.0;
+          *H_new = 0.0;
         }
 
         // force zero thickness at points which are floating (if "-float_kill");
         //   this is calving at grounding line
         if ( floating_ice_killed && mask.ocean(i, j) ) { // FIXME: *was* ocean???
-          float_kill_flux = -(*vHnew_ptr)(*i_ptr, *j_ptr);
+          float_kill_flux = -*H_new;
 
           // this has to go *after* accounting above!
-          (*vHnew_ptr)(*i_ptr, *j_ptr) = 0.0;
+          *H_new = 0.0;
         }
       }
 
@@ -972,8 +1051,7 @@ double divQ_SIA = 0.0, divQ_SSA = 0.0;
 		if (no_refinement_iteration) break;
 		j_ref = refinement*j;
 		} //end of i_ref loop	
-    } // end of the inner (j) for loop
-  } // end of the outer (i) for loop
+  } // end of the loop over owned points
 
   ierr = vbmr.end_access(); CHKERRQ(ierr);
   ierr = vMask.end_access(); CHKERRQ(ierr);
@@ -987,7 +1065,10 @@ double divQ_SIA = 0.0, divQ_SSA = 0.0;
  if(config.get_flag("mesh_refinement")||config.get_flag("do_glmask")){ 
 ierr = vGLMask[0]->end_access();  CHKERRQ(ierr);
  }    
-if(config.get_flag("mesh_refinement")){
+if (use_patches) {
+  ierr = refined_patches->coarsen(patch_thk, vH, *vGLMask[0]); CHKERRQ(ierr);
+  ierr = refined_patches->coarsen(patch_thk_new, vHnew, *vGLMask[0]); CHKERRQ(ierr);
+} else if(config.get_flag("mesh_refinement")){
 ierr = vbmr_ref->end_access(); CHKERRQ(ierr);
   ierr = vMask_ref->end_access(); CHKERRQ(ierr);
 	/*
@@ -1056,9 +1137,20 @@ update_unrefined_variable(vHnew,vHnew_ref);
   }
 
   // finally copy vHnew into vH and communicate ghosted values
-  ierr = vHnew.beginGhostComm(vH); CHKERRQ(ierr);
-  ierr = vHnew.endGhostComm(vH); CHKERRQ(ierr);
-  if(do_mesh_refinement){
+  if (overlap) {
+    if (!ghost_comm_started) {
+      // the sub-domain has no interior
+      ierr = vHnew.beginGhostComm(); CHKERRQ(ierr);
+    }
+    ierr = vHnew.endGhostComm(); CHKERRQ(ierr);
+    ierr = vHnew.copy_to(vH); CHKERRQ(ierr);
+  } else {
+    ierr = vHnew.beginGhostComm(vH); CHKERRQ(ierr);
+    ierr = vHnew.endGhostComm(vH); CHKERRQ(ierr);
+  }
+  if (use_patches) {
+    ierr = refined_patches->copy(patch_thk_new, patch_thk); CHKERRQ(ierr);
+  } else if(do_mesh_refinement){
   ierr = vHnew_ref->beginGhostComm(*vH_ref); CHKERRQ(ierr);
   ierr = vHnew_ref->endGhostComm(*vH_ref); CHKERRQ(ierr);
   }
@@ -22,6 +22,7 @@
 #include "iceModel.hh"
 #include "Mask.hh"
 #include "PISMOcean.hh"
+#include "PISMGhostCommGroup.hh"
 
 //! \file iMicebergs.cc Methods implementing PIK option -kill_icebergs [\ref Winkelmannetal2011].
 
@@ -105,11 +106,11 @@ PetscErrorCode IceModel::findIceBergCandidates() {
   ierr = vIcebergMask.end_access(); CHKERRQ(ierr);
   ierr = vbed.end_access(); CHKERRQ(ierr);
 
-  ierr = vMask.beginGhostComm(); CHKERRQ(ierr);
-  ierr = vMask.endGhostComm(); CHKERRQ(ierr);
-
-  ierr = vIcebergMask.beginGhostComm(); CHKERRQ(ierr);
-  ierr = vIcebergMask.endGhostComm(); CHKERRQ(ierr);
+  PISMGhostCommGroup ghosts(grid);
+  ierr = ghosts.add(vMask); CHKERRQ(ierr);
+  ierr = ghosts.add(vIcebergMask); CHKERRQ(ierr);
+  ierr = ghosts.beginGhostComm(); CHKERRQ(ierr);
+  ierr = ghosts.endGhostComm(); CHKERRQ(ierr);
 
   // set all floating points to ICEBERGMASK_ICEBERG_CAND
   MaskQuery M(vMask);
@@ -278,14 +279,12 @@ PetscErrorCode IceModel::killIdentifiedIceBergs() {
   PetscScalar factor = config.get("ice_density") * (dx * dy);
   cumulative_discharge_flux     += discharge_flux     * factor;
 
-  ierr = vMask.beginGhostComm(); CHKERRQ(ierr);
-  ierr = vMask.endGhostComm(); CHKERRQ(ierr);
-
-  ierr = vH.beginGhostComm(); CHKERRQ(ierr);
-  ierr = vH.endGhostComm(); CHKERRQ(ierr);
-
-  ierr = vh.beginGhostComm(); CHKERRQ(ierr);
-  ierr = vh.endGhostComm(); CHKERRQ(ierr);
+  PISMGhostCommGroup ghosts(grid);
+  ierr = ghosts.add(vMask); CHKERRQ(ierr);
+  ierr = ghosts.add(vH); CHKERRQ(ierr);
+  ierr = ghosts.add(vh); CHKERRQ(ierr);
+  ierr = ghosts.beginGhostComm(); CHKERRQ(ierr);
+  ierr = ghosts.endGhostComm(); CHKERRQ(ierr);
 
   return 0;
 }
@@ -464,17 +463,13 @@ PetscErrorCode IceModel::killEasyIceBergs() {
   if (vpik)  // actually get output from PetscSynchronizedPrintf()
     PetscSynchronizedFlush(grid.com);
 
-  ierr = vHnew.beginGhostComm(vH); CHKERRQ(ierr);
-  ierr = vHnew.endGhostComm(vH); CHKERRQ(ierr);
-
-  ierr = vMask.beginGhostComm(); CHKERRQ(ierr);
-  ierr = vMask.endGhostComm(); CHKERRQ(ierr);
-
-  ierr = vh.beginGhostComm(); CHKERRQ(ierr);
-  ierr = vh.endGhostComm(); CHKERRQ(ierr);
-
-  ierr = vHref.beginGhostComm(); CHKERRQ(ierr);
-  ierr = vHref.endGhostComm(); CHKERRQ(ierr);
+  PISMGhostCommGroup ghosts(grid);
+  ierr = ghosts.add(vHnew, vH); CHKERRQ(ierr);
+  ierr = ghosts.add(vMask); CHKERRQ(ierr);
+  ierr = ghosts.add(vh); CHKERRQ(ierr);
+  ierr = ghosts.add(vHref); CHKERRQ(ierr);
+  ierr = ghosts.beginGhostComm(); CHKERRQ(ierr);
+  ierr = ghosts.endGhostComm(); CHKERRQ(ierr);
 
   return 0;
 }
@@ -39,6 +39,7 @@
 #include "PISMMohrCoulombYieldStress.hh"
 #include "PISMConstantYieldStress.hh"
 #include "bedrockThermalUnit.hh"
+#include "PISMTracerParticles.hh"
 #include "flowlaw_factory.hh"
 #include "basal_resistance.hh"
 #include "PISMProf.hh"
@@ -390,6 +391,7 @@ grid_setup(IceGrid& grid ,PetscInt refinement) {
     PISMEnd();
   }
 
+  bool ranges_set = false;
   if ((!Nx_set) && (!Ny_set)) {
     grid.compute_nprocs();
     grid.compute_ownership_ranges();
@@ -456,11 +458,37 @@ grid_setup(IceGrid& grid ,PetscInt refinement) {
 
       for (PetscInt j=0; j < grid.Ny; j++)
 	grid.procs_y[j] = tmp_y[j];
+
+      ranges_set = true;
     } else {
       grid.compute_ownership_ranges();
     }
   } // -Nx and -Ny set
 
+  // Replace equal-area ownership ranges by ones balancing the estimated cost
+  // of columns. Transfers between the refined and the coarse grid assume that
+  // both use the same (equal-area) decomposition, so this is disabled if
+  // mesh refinement is used (as in repartition()).
+  if (config.get_flag("grid_balanced_decomposition") && refinement == 1 &&
+      ranges_set == false && config.get_flag("mesh_refinement")) {
+    ierr = verbPrintf(2, grid.com,
+                      "PISM WARNING: balanced domain decomposition is not supported with mesh refinement.\n"
+                      "  Using equal-area ownership ranges...\n"); CHKERRQ(ierr);
+  } else if (config.get_flag("grid_balanced_decomposition") && refinement == 1 &&
+             ranges_set == false) {
+    string input_file = filename;
+    bool input_file_set = i_set;
+
+    if (i_set == false) {
+      ierr = PISMOptionsString("-boot_file", "Specifies the file to bootstrap from",
+                               input_file, input_file_set); CHKERRQ(ierr);
+    }
+
+    if (input_file_set) {
+      ierr = set_balanced_ownership_ranges(grid, input_file); CHKERRQ(ierr);
+    }
+  }
+
   grid.check_parameters();
 
   ierr = grid.createDA(); CHKERRQ(ierr);
@@ -753,6 +781,17 @@ PetscErrorCode IceModel::allocate_bedrock_thermal_unit() {
   return 0;
 }
 
+//! \brief Allocate Lagrangian tracer particles (if requested).
+PetscErrorCode IceModel::allocate_tracers() {
+
+  if (tracers != NULL || config.get_flag("do_tracers") == false)
+    return 0;
+
+  tracers = new PISMTracerParticles(grid, config, *EC, stress_balance);
+
+  return 0;
+}
+
 //! \brief Decide which basal yield stress model to use.
 PetscErrorCode IceModel::allocate_basal_yield_stress() {
   PetscErrorCode ierr;
@@ -811,6 +850,8 @@ PetscErrorCode IceModel::allocate_submodels() {
 
   ierr = allocate_bedrock_thermal_unit(); CHKERRQ(ierr);
 
+  ierr = allocate_tracers(); CHKERRQ(ierr);
+
   ierr = allocate_bed_deformation(); CHKERRQ(ierr);
 
   ierr = allocate_couplers(); CHKERRQ(ierr);
@@ -877,16 +918,35 @@ PetscErrorCode IceModel::allocate_internal_objects() {
            "e.g. new values of temperature or age or enthalpy during time step",
            "", ""); CHKERRQ(ierr);
 
+  if (config.get_flag("do_age") && config.get_flag("age_semi_lagrangian")) {
+    const PetscInt halo_width =
+      PetscMax(static_cast<PetscInt>(config.get("age_semi_lagrangian_halo_width")), 2);
+    ierr = tau3_sl.create(grid, "age_semi_lagrangian", true, halo_width); CHKERRQ(ierr);
+    ierr = tau3_sl.set_attrs("internal",
+                             "age of ice (with a wide halo, used by the semi-Lagrangian method)",
+                             "s", ""); CHKERRQ(ierr);
+  }
+
+  if (config.get_flag("do_age") && config.get_flag("do_age_with_enthalpy")) {
+    ierr = vWork3d_age.create(grid,"work_vector_3d_age",false); CHKERRQ(ierr);
+    ierr = vWork3d_age.set_attrs(
+             "internal",
+             "new values of age computed together with enthalpy during time step",
+             "", ""); CHKERRQ(ierr);
+  }
+
 
 if(config.get_flag("mesh_refinement")){
   // various internal quantities
-  // 2d  refined work vectors
+  // 2d  refined work vectors (not needed if refined fields are stored in tiles)
+  if (config.get_flag("mesh_refinement_patches") == false) {
 	for (int j = 0; j < nWork2d; j++) {
 	vWork2d_ref[j]=new IceModelVec2S;
     char namestr[30];
     snprintf(namestr, sizeof(namestr), "work_vector_refined_%d", j);
     ierr = vWork2d_ref[j]->create(*grid_refined, namestr, true, WIDE_STENCIL); CHKERRQ(ierr);
 	}
+  }
 		
   vWork2dV_ref=new  IceModelVec2V;
   ierr = vWork2dV_ref->create(grid, "vWork2dV", true); CHKERRQ(ierr);
@@ -923,6 +983,13 @@ PetscErrorCode IceModel::misc_setup() {
   ierr = init_extras(); CHKERRQ(ierr);
   ierr = init_viewers(); CHKERRQ(ierr);
 
+  // Tracer particles are seeded using the ice geometry (which can come from
+  // regridding) and are not a part of the model state, so they are not
+  // re-initialized after the preliminary step (see IceModel::run()).
+  if (tracers) {
+    ierr = tracers->init(variables); CHKERRQ(ierr);
+  }
+
   // Make sure that we use the output_variable_order that works with NetCDF-4
   // parallel I/O. (For two reasons: it is faster and it will probably hang if
   // it is not "xyz".)
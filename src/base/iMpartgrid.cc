@@ -24,6 +24,7 @@
 #include "Mask.hh"
 #include "PISMStressBalance.hh"
 #include "PISMOcean.hh"
+#include "PISMGhostCommGroup.hh"
 
 
 //! \file iMpartgrid.cc Methods implementing PIK option -part_grid [\ref Albrechtetal2011].
@@ -220,11 +221,11 @@ PetscErrorCode IceModel::calculateRedistResiduals() {
   }
 
   // finally copy vHnew into vH and communicate ghosted values
-  ierr = vHnew.beginGhostComm(vH); CHKERRQ(ierr);
-  ierr = vHnew.endGhostComm(vH); CHKERRQ(ierr);
-
-  ierr = vHresidualnew.beginGhostComm(vHresidual); CHKERRQ(ierr);
-  ierr = vHresidualnew.endGhostComm(vHresidual); CHKERRQ(ierr);
+  PISMGhostCommGroup ghosts(grid);
+  ierr = ghosts.add(vHnew, vH); CHKERRQ(ierr);
+  ierr = ghosts.add(vHresidualnew, vHresidual); CHKERRQ(ierr);
+  ierr = ghosts.beginGhostComm(); CHKERRQ(ierr);
+  ierr = ghosts.endGhostComm(); CHKERRQ(ierr);
 
   return 0;
 }
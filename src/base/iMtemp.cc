@@ -24,6 +24,8 @@
 #include "PISMStressBalance.hh"
 #include "bedrockThermalUnit.hh"
 #include "pism_options.hh"
+#include "PISMColumnList.hh"
+#include "PISMColumnChunks.hh"
 
 
 //! \file iMtemp.cc Methods of IceModel which implement the cold-ice, temperature-based formulation of conservation of energy.
@@ -107,7 +109,9 @@ This method should be kept because it is worth having alternative physics, and
 
     The method uses equally-spaced calculation but the methods getValColumn(),
     setValColumn() interpolate back-and-forth from this equally-spaced calculational
-    grid to the (usually) non-equally spaced storage grid.
+    grid to the (usually) non-equally spaced storage grid.  If
+    `grid_storage_column_systems` is set, the storage grid is used directly
+    instead (see columnSystemGrid).
 
     An instance of tempSystemCtx is used to solve the tridiagonal system set-up here.
 
@@ -129,62 +133,64 @@ This method should be kept because it is worth having alternative physics, and
 PetscErrorCode IceModel::temperatureStep(PetscScalar* vertSacrCount, PetscScalar* bulgeCount) {
     PetscErrorCode  ierr;
 
-    // set up fine grid in ice
-    PetscInt    fMz    = grid.Mz_fine;
-    PetscScalar fdz    = grid.dz_fine;
-    vector<double> &fzlev = grid.zlevels_fine;
+    // vertical grid in ice used by column systems
+    columnSystemGrid vgrid(grid, config.get_flag("grid_storage_column_systems"));
+    const PetscInt Mz = vgrid.Mz();
 
     ierr = verbPrintf(5,grid.com,
-                      "\n  [entering temperatureStep(); fMz = %d, fdz = %5.3f]",
-                      fMz, fdz); CHKERRQ(ierr);
-
-    bool viewOneColumn;
-    ierr = PISMOptionsIsSet("-view_sys", viewOneColumn); CHKERRQ(ierr);
-
-    const PetscScalar
-      ice_rho   = config.get("ice_density"),
-      ice_k     = config.get("ice_thermal_conductivity"),
-      ice_c     = config.get("ice_specific_heat_capacity"),
-      L         = config.get("water_latent_heat_fusion"),
-      melting_point_temp = config.get("water_melting_point_temperature"),
-      beta_CC_grad = config.get("beta_CC") * ice_rho * config.get("standard_gravity");
-
-    tempSystemCtx system(fMz, "temperature");
-    system.dx              = grid.dx;
-    system.dy              = grid.dy;
-    system.dtTemp          = dt_TempAge; // same time step for temp and age, currently
-    system.dzEQ            = fdz;
-    system.ice_rho         = ice_rho;
-    system.ice_k           = ice_k;
-    system.ice_c_p         = ice_c;
-
-    PetscScalar *x;
-    x = new PetscScalar[fMz]; // space for solution of system
-
-    // this is bulge limit constant in K; is max amount by which ice
-    //   or bedrock can be lower than surface temperature
-    const PetscScalar bulgeMax  = config.get("enthalpy_cold_bulge_max") / ice_c;
-
-    const PetscReal bwat_decay_rate = config.get("bwat_decay_rate");  // m s-1
-
-    PetscScalar *Tnew;
-    // pointers to values in current column
-    system.u     = new PetscScalar[fMz];
-    system.v     = new PetscScalar[fMz];
-    system.w     = new PetscScalar[fMz];
-    system.Sigma = new PetscScalar[fMz];
-    system.T     = new PetscScalar[fMz];
-    Tnew         = new PetscScalar[fMz];
-
-    // system needs access to T3 for T3.getPlaneStar_fine()
-    system.T3 = &T3;
-
-    // checks that all needed constants and pointers got set:
-    ierr = system.initAllColumns(); CHKERRQ(ierr);
+                      "\n  [entering temperatureStep(); Mz = %d, dz = %5.3f]",
+                      Mz, vgrid.dz()); CHKERRQ(ierr);
+
+    // parameters, fields and options used in each column; see
+    // temperatureColumns()
+    EnergyStepData data;
+    data.vgrid = &vgrid;
+
+    ierr = PISMOptionsIsSet("-view_sys", data.viewOneColumn); CHKERRQ(ierr);
+
+    data.ice_rho            = config.get("ice_density");
+    data.ice_k              = config.get("ice_thermal_conductivity");
+    data.ice_c              = config.get("ice_specific_heat_capacity");
+    data.L                  = config.get("water_latent_heat_fusion");
+    data.melting_point_temp = config.get("water_melting_point_temperature");
+    data.beta_CC_grad       = config.get("beta_CC") * data.ice_rho * config.get("standard_gravity");
+    data.bulgeEnthMax       = config.get("enthalpy_cold_bulge_max");
+    data.bwat_decay_rate    = config.get("bwat_decay_rate");  // m s-1
+    data.bwat_max           = config.get("bwat_max");
+    data.global_min_allowed_temp = config.get("global_min_allowed_temp");
+
+    const vector<PISMColumnList::Column> &cols = columns->owned();
+    PISMColumnChunks chunks(config, cols.size());
+
+    // each thread uses its own system
+    vector<tempSystemCtx*> systems(chunks.threads());
+    for (int t = 0; t < chunks.threads(); ++t) {
+      tempSystemCtx *system = new tempSystemCtx(Mz, "temperature");
+      system->dx              = grid.dx;
+      system->dy              = grid.dy;
+      system->dtTemp          = dt_TempAge; // same time step for temp and age, currently
+      system->vgrid           = &vgrid;
+      system->ice_rho         = data.ice_rho;
+      system->ice_k           = data.ice_k;
+      system->ice_c_p         = data.ice_c;
+
+      // pointers to values in current column
+      system->u     = new PetscScalar[Mz];
+      system->v     = new PetscScalar[Mz];
+      system->w     = new PetscScalar[Mz];
+      system->Sigma = new PetscScalar[Mz];
+      system->T     = new PetscScalar[Mz];
+
+      // system needs access to T3 for planeStar values
+      system->T3 = &T3;
+
+      // checks that all needed constants and pointers got set:
+      ierr = system->initAllColumns(); CHKERRQ(ierr);
+
+      systems[t] = system;
+    }
 
     // now get map-plane fields, starting with coupler fields
-    PetscScalar  **bwat, **basalMeltRate;
-
     if (surface != PETSC_NULL) {
       ierr = surface->ice_surface_temperature(artm); CHKERRQ(ierr);
     } else {
@@ -211,94 +217,226 @@ PetscErrorCode IceModel::temperatureStep(PetscScalar* vertSacrCount, PetscScalar
     ierr = shelfbtemp.begin_access(); CHKERRQ(ierr);
 
     ierr = vH.begin_access(); CHKERRQ(ierr);
-    ierr = vbwat.get_array(bwat); CHKERRQ(ierr);
-    ierr = vbmr.get_array(basalMeltRate); CHKERRQ(ierr);
+    ierr = vbwat.begin_access(); CHKERRQ(ierr);
+    ierr = vbmr.begin_access(); CHKERRQ(ierr);
     ierr = vMask.begin_access(); CHKERRQ(ierr);
     ierr = G0.begin_access(); CHKERRQ(ierr);
 
-    IceModelVec2S *Rb;            // basal frictional heating
-    ierr = stress_balance->get_basal_frictional_heating(Rb); CHKERRQ(ierr);
+    // basal frictional heating
+    ierr = stress_balance->get_basal_frictional_heating(data.Rb); CHKERRQ(ierr);
 
-    IceModelVec3 *u3, *v3, *w3, *Sigma3;
-    ierr = stress_balance->get_3d_velocity(u3, v3, w3); CHKERRQ(ierr);
-    ierr = stress_balance->get_volumetric_strain_heating(Sigma3); CHKERRQ(ierr);
+    ierr = stress_balance->get_3d_velocity(data.u3, data.v3, data.w3); CHKERRQ(ierr);
+    ierr = stress_balance->get_volumetric_strain_heating(data.Sigma3); CHKERRQ(ierr);
 
-    ierr = Rb->begin_access(); CHKERRQ(ierr);
+    ierr = data.Rb->begin_access(); CHKERRQ(ierr);
 
-    ierr = u3->begin_access(); CHKERRQ(ierr);
-    ierr = v3->begin_access(); CHKERRQ(ierr);
-    ierr = w3->begin_access(); CHKERRQ(ierr);
-    ierr = Sigma3->begin_access(); CHKERRQ(ierr);
+    ierr = data.u3->begin_access(); CHKERRQ(ierr);
+    ierr = data.v3->begin_access(); CHKERRQ(ierr);
+    ierr = data.w3->begin_access(); CHKERRQ(ierr);
+    ierr = data.Sigma3->begin_access(); CHKERRQ(ierr);
     ierr = T3.begin_access(); CHKERRQ(ierr);
     ierr = vWork3d.begin_access(); CHKERRQ(ierr);
 
+    data.G0 = &G0;
+
+    // columns are processed in chunks, possibly by several threads at once;
+    // see PISMColumnChunks
+    vector<PetscErrorCode> errors(chunks.size(), 0);
+    vector<EnergyStepCounts> counts(chunks.size());
+
+#if (PISM_USE_OPENMP==1)
+#pragma omp parallel for schedule(dynamic, 1) num_threads(chunks.threads())
+#endif
+    for (int c = 0; c < chunks.size(); ++c) {
+      errors[c] = temperatureColumns(chunks.begin(c), chunks.end(c), data,
+                                     *systems[PISMColumnChunks::thread()], counts[c]);
+    }
+
     // counts unreasonably low temperature values; deprecated?
     PetscInt myLowTempCount = 0;
     PetscInt maxLowTempCount = static_cast<PetscInt>(config.get("max_low_temp_count"));
-    PetscReal globalMinAllowedTemp = config.get("global_min_allowed_temp");
 
-    PetscReal bwat_max = config.get("bwat_max");
+    for (int c = 0; c < chunks.size(); ++c) {
+      CHKERRQ(errors[c]);
 
-    MaskQuery mask(vMask);
+      *vertSacrCount += counts[c].vertSacrCount;
+      *bulgeCount    += counts[c].bulgeCount;
+      myLowTempCount += counts[c].lowTempCount;
+    }
 
-    for (PetscInt i=grid.xs; i<grid.xs+grid.xm; ++i) {
-      for (PetscInt j=grid.ys; j<grid.ys+grid.ym; ++j) {
+  if (myLowTempCount > maxLowTempCount) { SETERRQ(grid.com, 1,"too many low temps"); }
 
-        // this should *not* be replaced by call to grid.kBelowHeight():
-        const PetscInt  ks = static_cast<PetscInt>(floor(vH(i,j)/fdz));
+  ierr = vH.end_access(); CHKERRQ(ierr);
+  ierr = vMask.end_access(); CHKERRQ(ierr);
+  ierr = vbwat.end_access(); CHKERRQ(ierr);
+  ierr = data.Rb->end_access(); CHKERRQ(ierr);
+  ierr = G0.end_access(); CHKERRQ(ierr);
+  ierr = vbmr.end_access(); CHKERRQ(ierr);
 
-        if (ks>0) { // if there are enough points in ice to bother ...
-          ierr = system.setIndicesAndClearThisColumn(i,j,ks); CHKERRQ(ierr);
+  ierr = artm.end_access(); CHKERRQ(ierr);
 
-          ierr = u3->getValColumn(i,j,ks,system.u); CHKERRQ(ierr);
-          ierr = v3->getValColumn(i,j,ks,system.v); CHKERRQ(ierr);
-          ierr = w3->getValColumn(i,j,ks,system.w); CHKERRQ(ierr);
-          ierr = Sigma3->getValColumn(i,j,ks,system.Sigma); CHKERRQ(ierr);
-          ierr = T3.getValColumn(i,j,ks,system.T); CHKERRQ(ierr);
+  ierr = shelfbmassflux.end_access(); CHKERRQ(ierr);
+  ierr = shelfbtemp.end_access(); CHKERRQ(ierr);
 
-          // go through column and find appropriate lambda for BOMBPROOF
-          PetscScalar lambda = 1.0;  // start with centered implicit for more accuracy
-          for (PetscInt k = 1; k < ks; k++) {
-            const PetscScalar denom = (PetscAbs(system.w[k]) + 0.000001/secpera)
-              * ice_rho * ice_c * fdz;
-            lambda = PetscMin(lambda, 2.0 * ice_k / denom);
-          }
-          if (lambda < 1.0)  *vertSacrCount += 1; // count columns with lambda < 1
-          // if isMarginal then only do vertical conduction for ice; ignore advection
-          //   and strain heating if isMarginal
-          const bool isMarginal = checkThinNeigh(vH(i+1,j),vH(i+1,j+1),vH(i,j+1),vH(i-1,j+1),
-                                                 vH(i-1,j),vH(i-1,j-1),vH(i,j-1),vH(i+1,j-1));
-          PismMask mask_value = static_cast<PismMask>(vMask.as_int(i,j));
-          ierr = system.setSchemeParamsThisColumn(mask_value, isMarginal, lambda);
-          CHKERRQ(ierr);
-
-          // set boundary values for tridiagonal system
-          ierr = system.setSurfaceBoundaryValuesThisColumn(artm(i,j)); CHKERRQ(ierr);
-          ierr = system.setBasalBoundaryValuesThisColumn(G0(i,j),shelfbtemp(i,j),(*Rb)(i,j)); CHKERRQ(ierr);
-
-          // solve the system for this column; melting not addressed yet
-          PetscErrorCode pivoterr;
-          ierr = system.solveThisColumn(&x, pivoterr); CHKERRQ(ierr);
+  ierr = data.u3->end_access(); CHKERRQ(ierr);
+  ierr = data.v3->end_access(); CHKERRQ(ierr);
+  ierr = data.w3->end_access(); CHKERRQ(ierr);
+  ierr = data.Sigma3->end_access(); CHKERRQ(ierr);
+  ierr = T3.end_access(); CHKERRQ(ierr);
+  ierr = vWork3d.end_access(); CHKERRQ(ierr);
+
+  for (int t = 0; t < chunks.threads(); ++t) {
+    tempSystemCtx *system = systems[t];
+    delete [] system->T;  delete [] system->Sigma;
+    delete [] system->u;  delete [] system->v;  delete [] system->w;
+    delete system;
+  }
+  return 0;
+}
+
+
+//! Update ice temperature, the basal melt rate and the amount of basal water
+//! in owned columns `begin`, ..., `end - 1`.
+/*!
+Called by temperatureStep(), possibly by several threads at once (processing
+different columns); `system` has to be private to the calling thread. Fields
+used here have to be accessible (see begin_access()).
+ */
+PetscErrorCode IceModel::temperatureColumns(unsigned int begin, unsigned int end,
+                                            const EnergyStepData &data,
+                                            tempSystemCtx &system,
+                                            EnergyStepCounts &counts) {
+  PetscErrorCode  ierr;
+
+  // vertical grid in ice used by column systems
+  const columnSystemGrid &vgrid = *data.vgrid;
+  const PetscInt Mz = vgrid.Mz();
+
+  const PetscScalar
+    ice_rho   = data.ice_rho,
+    ice_k     = data.ice_k,
+    ice_c     = data.ice_c,
+    L         = data.L,
+    melting_point_temp = data.melting_point_temp,
+    beta_CC_grad = data.beta_CC_grad;
+
+  // this is bulge limit constant in K; is max amount by which ice
+  //   or bedrock can be lower than surface temperature
+  const PetscScalar bulgeMax  = data.bulgeEnthMax / ice_c;
+
+  const PetscReal bwat_decay_rate = data.bwat_decay_rate,  // m s-1
+    globalMinAllowedTemp = data.global_min_allowed_temp,
+    bwat_max = data.bwat_max;
+
+  IceModelVec2S *Rb = data.Rb, &G0 = *data.G0;
+  IceModelVec3 *u3 = data.u3, *v3 = data.v3, *w3 = data.w3, *Sigma3 = data.Sigma3;
+  const bool viewOneColumn = data.viewOneColumn;
+
+  PetscScalar *x;
+  x = new PetscScalar[Mz]; // space for solution of system
+
+  PetscScalar *Tnew;
+  Tnew = new PetscScalar[Mz];
+
+  MaskQuery mask(vMask);
+
+  // systems are solved in batches; when viewing a column each batch contains
+  // one system so that everything viewed corresponds to the same column
+  columnSystemBatch batch(Mz, viewOneColumn ? 1 : columnSystemBatch::default_width);
+  // columns waiting for the batch to be solved (in order), the lane
+  // containing the system of each column (-1 if ice-free) and vertical
+  // velocities in each lane (used in error messages)
+  vector<unsigned int> pending_column;
+  vector<int> pending_lane;
+  vector<PetscScalar> lane_w(batch.width() * Mz);
+
+  const vector<PISMColumnList::Column> &cols = columns->owned();
+
+  for (unsigned int n = begin; n < end; ++n) {
+    { // set up the system in column n
+      const PetscInt i = cols[n].i, j = cols[n].j;
+
+      // index of the level just below the ice surface
+      const PetscInt ks = vgrid.ks(cols[n]);
+
+      pending_column.push_back(n);
+      pending_lane.push_back(ks > 0 ? batch.size() : -1);
+
+      if (ks>0) { // if there are enough points in ice to bother ...
+        ierr = system.setIndicesAndClearThisColumn(i,j,ks); CHKERRQ(ierr);
+
+        ierr = vgrid.get_column(*u3, i, j, ks, system.u); CHKERRQ(ierr);
+        ierr = vgrid.get_column(*v3, i, j, ks, system.v); CHKERRQ(ierr);
+        ierr = vgrid.get_column(*w3, i, j, ks, system.w); CHKERRQ(ierr);
+        ierr = vgrid.get_column(*Sigma3, i, j, ks, system.Sigma); CHKERRQ(ierr);
+        ierr = vgrid.get_column(T3, i, j, ks, system.T); CHKERRQ(ierr);
+
+        // go through column and find appropriate lambda for BOMBPROOF
+        PetscScalar lambda = 1.0;  // start with centered implicit for more accuracy
+        for (PetscInt k = 1; k < ks; k++) {
+          const PetscScalar denom = (PetscAbs(system.w[k]) + 0.000001/secpera)
+            * ice_rho * ice_c * vgrid.dz_layer[k];
+          lambda = PetscMin(lambda, 2.0 * ice_k / denom);
+        }
+        if (lambda < 1.0)  counts.vertSacrCount += 1; // count columns with lambda < 1
+        // if isMarginal then only do vertical conduction for ice; ignore advection
+        //   and strain heating if isMarginal
+        const bool isMarginal = checkThinNeigh(vH(i+1,j),vH(i+1,j+1),vH(i,j+1),vH(i-1,j+1),
+                                               vH(i-1,j),vH(i-1,j-1),vH(i,j-1),vH(i+1,j-1));
+        PismMask mask_value = static_cast<PismMask>(vMask.as_int(i,j));
+        ierr = system.setSchemeParamsThisColumn(mask_value, isMarginal, lambda);
+        CHKERRQ(ierr);
+
+        // set boundary values for tridiagonal system
+        ierr = system.setSurfaceBoundaryValuesThisColumn(artm(i,j)); CHKERRQ(ierr);
+        ierr = system.setBasalBoundaryValuesThisColumn(G0(i,j),shelfbtemp(i,j),(*Rb)(i,j)); CHKERRQ(ierr);
+
+        // set up the system; it is solved below, together with systems from
+        // other columns; melting not addressed yet
+        ierr = system.assembleThisColumn(); CHKERRQ(ierr);
+
+        for (PetscInt k = 0; k <= ks; ++k)
+          lane_w[batch.size() * Mz + k] = system.w[k];
+
+        ierr = batch.add(system, ks + 1); CHKERRQ(ierr);
+      }
+    }
+
+    if (batch.full() || n + 1 == end) {
+      ierr = batch.solve(); CHKERRQ(ierr);
+
+      for (unsigned int m = 0; m < pending_column.size(); ++m) {
+        const PetscInt i = cols[pending_column[m]].i, j = cols[pending_column[m]].j,
+          ks = vgrid.ks(cols[pending_column[m]]);
+        const int lane = pending_lane[m];
+        const PetscScalar *w = lane >= 0 ? &lane_w[lane * Mz] : PETSC_NULL;
+
+        if (lane >= 0) {
+          PetscErrorCode pivoterr = batch.pivot_error(lane);
 
           if (pivoterr != 0) {
             ierr = PetscPrintf(PETSC_COMM_SELF,
               "\n\ntridiagonal solve of tempSystemCtx in temperatureStep() FAILED at (%d,%d)\n"
                   " with zero pivot position %d; viewing system to m-file ... \n",
               i, j, pivoterr); CHKERRQ(ierr);
+            ierr = batch.get_system(lane, system); CHKERRQ(ierr);
             ierr = system.reportColumnZeroPivotErrorMFile(pivoterr); CHKERRQ(ierr);
             SETERRQ(grid.com, 1,"PISM ERROR in temperatureStep()\n");
           }
+
+          ierr = batch.get_solution(lane, x); CHKERRQ(ierr);
+
           if (viewOneColumn && issounding(i,j)) {
             ierr = PetscPrintf(grid.com,
               "\n\nin temperatureStep(): viewing tempSystemCtx at (i,j)=(%d,%d) to m-file ... \n\n",
               i, j); CHKERRQ(ierr);
-            ierr = system.viewColumnInfoMFile(x, fMz); CHKERRQ(ierr);
+            ierr = batch.get_system(lane, system); CHKERRQ(ierr);
+            ierr = system.viewColumnInfoMFile(x, Mz); CHKERRQ(ierr);
           }
-
-        }	// end of "if there are enough points in ice to bother ..."
+        }
 
         // prepare for melting/refreezing
-        PetscScalar bwatnew = bwat[i][j];
+        PetscScalar bwatnew = vbwat(i,j);
 
         // insert solution for generic ice segments
         for (PetscInt k=1; k <= ks; k++) {
@@ -306,11 +444,12 @@ PetscErrorCode IceModel::temperatureStep(PetscScalar* vertSacrCount, PetscScalar
             Tnew[k] = x[k];
           } else {
             const PetscScalar
-              Tpmp = melting_point_temp - beta_CC_grad * (vH(i,j) - fzlev[k]); // FIXME issue #15
+              Tpmp = melting_point_temp - beta_CC_grad * (vH(i,j) - vgrid.z(k)); // FIXME issue #15
             if (x[k] > Tpmp) {
               Tnew[k] = Tpmp;
               PetscScalar Texcess = x[k] - Tpmp; // always positive
-              excessToFromBasalMeltLayer(ice_rho, ice_c, L, fzlev[k], fdz, &Texcess, &bwatnew);
+              excessToFromBasalMeltLayer(ice_rho, ice_c, L, vgrid.z(k), vgrid.dz_layer[k],
+                                         &Texcess, &bwatnew);
               // Texcess  will always come back zero here; ignore it
             } else {
               Tnew[k] = x[k];
@@ -321,11 +460,11 @@ PetscErrorCode IceModel::temperatureStep(PetscScalar* vertSacrCount, PetscScalar
                                "  [[too low (<200) ice segment temp T = %f at %d,%d,%d;"
                                " proc %d; mask=%d; w=%f m/a]]\n",
                                Tnew[k],i,j,k,grid.rank,vMask.as_int(i,j),
-                               convert(system.w[k], "m/s", "m/year")); CHKERRQ(ierr);
-            myLowTempCount++;
+                               convert(w[k], "m/s", "m/year")); CHKERRQ(ierr);
+            counts.lowTempCount++;
           }
           if (Tnew[k] < artm(i,j) - bulgeMax) {
-            Tnew[k] = artm(i,j) - bulgeMax;  bulgeCount++;   }
+            Tnew[k] = artm(i,j) - bulgeMax;  counts.bulgeCount += 1;   }
         }
 
         // insert solution for ice base segment
@@ -338,9 +477,9 @@ PetscErrorCode IceModel::temperatureStep(PetscScalar* vertSacrCount, PetscScalar
             if (mask.ocean(i,j)) {
               // when floating, only half a segment has had its temperature raised
               // above Tpmp
-              excessToFromBasalMeltLayer(ice_rho, ice_c, L, 0.0, fdz/2.0, &Texcess, &bwatnew);
+              excessToFromBasalMeltLayer(ice_rho, ice_c, L, 0.0, vgrid.dz_layer[0]/2.0, &Texcess, &bwatnew);
             } else {
-              excessToFromBasalMeltLayer(ice_rho, ice_c, L, 0.0, fdz, &Texcess, &bwatnew);
+              excessToFromBasalMeltLayer(ice_rho, ice_c, L, 0.0, vgrid.dz_layer[0], &Texcess, &bwatnew);
             }
             Tnew[0] = Tpmp + Texcess;
             if (Tnew[0] > (Tpmp + 0.00001)) {
@@ -352,22 +491,22 @@ PetscErrorCode IceModel::temperatureStep(PetscScalar* vertSacrCount, PetscScalar
                                "  [[too low (<200) ice/bedrock segment temp T = %f at %d,%d;"
                                " proc %d; mask=%d; w=%f]]\n",
                                Tnew[0],i,j,grid.rank,vMask.as_int(i,j),
-                               convert(system.w[0], "m/s", "m/year")); CHKERRQ(ierr);
-            myLowTempCount++;
+                               convert(w[0], "m/s", "m/year")); CHKERRQ(ierr);
+            counts.lowTempCount++;
           }
           if (Tnew[0] < artm(i,j) - bulgeMax) {
-            Tnew[0] = artm(i,j) - bulgeMax;   bulgeCount++;   }
+            Tnew[0] = artm(i,j) - bulgeMax;   counts.bulgeCount += 1;   }
         } else {
           bwatnew = 0.0;
         }
 
         // set to air temp above ice
-        for (PetscInt k=ks; k<fMz; k++) {
+        for (PetscInt k=ks; k<Mz; k++) {
           Tnew[k] = artm(i,j);
         }
 
         // transfer column into vWork3d; communication later
-        ierr = vWork3d.setValColumnPL(i,j,Tnew); CHKERRQ(ierr);
+        ierr = vgrid.set_column(vWork3d, i, j, Tnew); CHKERRQ(ierr);
 
         // basalMeltRate[][] is rate of mass loss at bottom of ice; finalize it and bwat
         //   note massContExplicitStep() calls PISMOceanCoupler; FIXME: does there
@@ -375,52 +514,34 @@ PetscErrorCode IceModel::temperatureStep(PetscScalar* vertSacrCount, PetscScalar
         if (mask.ocean(i,j)) {
           if (mask.icy(i,j)) {
             // rate of mass loss at bottom of ice shelf;  can be negative (marine freeze-on)
-            basalMeltRate[i][j] = shelfbmassflux(i,j); // set by PISMOceanCoupler
+            vbmr(i,j) = shelfbmassflux(i,j); // set by PISMOceanCoupler
             // if floating ice is present assume maximally saturated till to avoid "shock" if
             //   grounding line advances
-            bwat[i][j] = bwat_max;
+            vbwat(i,j) = bwat_max;
           } else {
-            basalMeltRate[i][j] = 0.0;
-            bwat[i][j] = 0.0;
+            vbmr(i,j) = 0.0;
+            vbwat(i,j) = 0.0;
           }
         } else {
           // basalMeltRate is rate of change of bwat[][];  can be negative
           //   (subglacial water freezes-on); note this rate is calculated
           //   *before* limiting bwat.
-          basalMeltRate[i][j] = (bwatnew - bwat[i][j]) / dt_TempAge;
+          vbmr(i,j) = (bwatnew - vbwat(i,j)) / dt_TempAge;
           // model loss to undetermined exterior:
           bwatnew -= bwat_decay_rate * dt_TempAge;
-          bwat[i][j] = PetscMin(bwat_max, PetscMax(bwatnew, 0.0));
+          vbwat(i,j) = PetscMin(bwat_max, PetscMax(bwatnew, 0.0));
         }
+      }
 
+      batch.clear();
+      pending_column.clear();
+      pending_lane.clear();
     }
   }
 
-  if (myLowTempCount > maxLowTempCount) { SETERRQ(grid.com, 1,"too many low temps"); }
-
-  ierr = vH.end_access(); CHKERRQ(ierr);
-  ierr = vMask.end_access(); CHKERRQ(ierr);
-  ierr = vbwat.end_access(); CHKERRQ(ierr);
-  ierr = Rb->end_access(); CHKERRQ(ierr);
-  ierr = G0.end_access(); CHKERRQ(ierr);
-  ierr = vbmr.end_access(); CHKERRQ(ierr);
-
-  ierr = artm.end_access(); CHKERRQ(ierr);
-
-  ierr = shelfbmassflux.end_access(); CHKERRQ(ierr);
-  ierr = shelfbtemp.end_access(); CHKERRQ(ierr);
-
-  ierr = u3->end_access(); CHKERRQ(ierr);
-  ierr = v3->end_access(); CHKERRQ(ierr);
-  ierr = w3->end_access(); CHKERRQ(ierr);
-  ierr = Sigma3->end_access(); CHKERRQ(ierr);
-  ierr = T3.end_access(); CHKERRQ(ierr);
-  ierr = vWork3d.end_access(); CHKERRQ(ierr);
-
   delete [] x;
-  delete [] system.T;  delete [] system.Sigma;
-  delete [] system.u;  delete [] system.v;  delete [] system.w;
   delete [] Tnew;
+
   return 0;
 }
 
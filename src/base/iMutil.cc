@@ -163,6 +163,9 @@ PetscErrorCode  IceModel::stampHistory(string str) {
 //! Check if the thickness of the ice is too large and extend the grid if necessary.
 /*!
   Extends the grid such that the new one has 2 (two) levels above the ice.
+
+  3D fields allocated with room for more levels (see the configuration
+  parameter `grid_Mz_capacity`) are extended in place.
  */
 PetscErrorCode IceModel::check_maximum_thickness() {
   PetscErrorCode  ierr;
@@ -264,6 +267,14 @@ PetscErrorCode IceModel::check_maximum_thickness() {
   // deal with 3D age conditionally
   if (config.get_flag("do_age")) {
     ierr = tau3.extend_vertically(old_Mz, 0); CHKERRQ(ierr);
+
+    if (vWork3d_age.was_created()) {
+      ierr = vWork3d_age.extend_vertically(old_Mz, 0); CHKERRQ(ierr);
+    }
+
+    if (tau3_sl.was_created()) {
+      ierr = tau3_sl.extend_vertically(old_Mz, 0); CHKERRQ(ierr);
+    }
   }
 
   // Ask the stress balance module to extend its 3D fields:
@@ -27,6 +27,7 @@
 #include "PISMOcean.hh"
 #include "PISMBedDef.hh"
 #include "bedrockThermalUnit.hh"
+#include "PISMTracerParticles.hh"
 #include "PISMYieldStress.hh"
 #include "basal_resistance.hh"
 #include "enthalpyConverter.hh"
@@ -34,6 +35,8 @@
 #include "pism_options.hh"
 #include "IceGrid.hh"
 #include "PISMDiagnostic.hh"
+#include "PISMRefinedPatches.hh"
+#include "PISMColumnList.hh"
 
 
 
@@ -65,6 +68,11 @@ if(config.get_flag("mesh_refinement")){
   basal = NULL;
 
   stress_balance = NULL;
+  refined_patches = NULL;
+  columns = NULL;
+  age_with_enthalpy = false;
+
+  steps_since_balance_check = 0;
 
   surface = NULL;
   ocean   = NULL;
@@ -72,6 +80,7 @@ if(config.get_flag("mesh_refinement")){
 
   EC = NULL;
   btu = NULL;
+  tracers = NULL;
 
   executable_short_name = "pism"; // drivers typically override this
 
@@ -107,6 +116,7 @@ void IceModel::reset_counters() {
   CFLmaxdt = CFLmaxdt2D = 0.0;
   CFLviolcount = 0;
   dt_TempAge = 0.0;
+  dt_Age = 0.0;
   dt_from_diffus = dt_from_cfl = 0.0;
 
   // Do not reset the following: they are always re-computed before use (i.e.
@@ -155,6 +165,8 @@ IceModel::~IceModel() {
   }
 
   delete stress_balance;
+  delete refined_patches;
+  delete columns;
 
   delete ocean;
   delete surface;
@@ -163,6 +175,7 @@ IceModel::~IceModel() {
   delete basal;
   delete EC;
   delete btu;
+  delete tracers;
 
   utTerm(); // Clean up after UDUNITS
 }
@@ -180,6 +193,10 @@ IceModel::~IceModel() {
 PetscErrorCode IceModel::createVecs() {
   PetscErrorCode ierr;
   PetscInt WIDE_STENCIL = grid.max_stencil_width;
+  // refined fields cover the whole refined grid unless they are stored in
+  // tiles around the grounding line
+  bool refine_dense = config.get_flag("mesh_refinement") &&
+    (config.get_flag("mesh_refinement_patches") == false);
   
   ierr = verbPrintf(3, grid.com,
 		    "Allocating memory...\n"); CHKERRQ(ierr);
@@ -204,7 +221,7 @@ if(config.get_flag("mesh_refinement")){
                          "J kg-1", ""); CHKERRQ(ierr);
   ierr = variables.add(Enth3); CHKERRQ(ierr);
 
- if(config.get_flag("mesh_refinement")){
+ if(refine_dense){
 	 ierr = Enth3_ref.create((*grid_refined), "enthalpy_refined", true, WIDE_STENCIL); CHKERRQ(ierr);
      ierr = Enth3_ref.set_attrs(
                          "model_state",
@@ -221,7 +238,7 @@ if(config.get_flag("mesh_refinement")){
     ierr = T3.set_attr("valid_min", 0.0); CHKERRQ(ierr);
     ierr = variables.add(T3); CHKERRQ(ierr);
     ierr = Enth3.set_attr("pism_intent", "diagnostic"); CHKERRQ(ierr); 
-	 if(config.get_flag("mesh_refinement")){
+	 if(refine_dense){
         ierr = T3_ref.create(*grid_refined, "temp_refined", true); CHKERRQ(ierr);
     ierr = T3_ref.set_attrs("diagnostic", "ice temperature", "K", "land_ice_temperature_refined"); CHKERRQ(ierr);
     ierr = T3_ref.set_attr("valid_min", 0.0); CHKERRQ(ierr);
@@ -256,7 +273,7 @@ if(config.get_flag("mesh_refinement")){
   ierr = variables.add(vH); CHKERRQ(ierr);
 
 	//refined land ice thickness
-   if(config.get_flag("mesh_refinement")){
+   if(refine_dense){
    vH_ref = new IceModelVec2S;
    ierr = vH_ref->create(*grid_refined, "thk_refined", true, WIDE_STENCIL); CHKERRQ(ierr);
   ierr = vH_ref->set_attrs("diagnostic", "land ice thickness",
@@ -302,7 +319,7 @@ if(config.get_flag("mesh_refinement")){
   ierr = variables.add(vMask); CHKERRQ(ierr);
 
 
-if(config.get_flag("mesh_refinement")){
+if(refine_dense){
 if(config.get_flag("do_eigen_calving")) {
 	vMask_ref = new IceModelVec2Int;
     ierr = vMask_ref->create(*grid_refined, "mask_refined", true, 3); CHKERRQ(ierr); 
@@ -344,6 +361,15 @@ for(int i=0;i<2;i++){
  }  //end i loop
  }  //end mesh refinement
 
+  if (config.get_flag("mesh_refinement") && config.get_flag("mesh_refinement_patches")) {
+    int patch_size = static_cast<int>(config.get("refinement_patch_size"));
+    refined_patches = new PISMRefinedPatches(grid, refinement, patch_size);
+    patch_thk     = refined_patches->add_field("thk_refined");
+    patch_thk_new = refined_patches->add_field("thk_new_refined");
+  }
+
+  columns = new PISMColumnList(grid, static_cast<int>(config.get("grid_column_tile_size")));
+
   // iceberg identifying integer mask
   if (config.get_flag("kill_icebergs")) {
     ierr = vIcebergMask.create(grid, "IcebergMask", true, WIDE_STENCIL); CHKERRQ(ierr);
@@ -420,7 +446,7 @@ for(int i=0;i<2;i++){
   vbmr.set_attr("comment", "positive basal melt rate corresponds to ice loss");
   ierr = variables.add(vbmr); CHKERRQ(ierr);
  //refined basal melt rate
-  if(config.get_flag("mesh_refinement")){
+  if(refine_dense){
   vbmr_ref= new  IceModelVec2S; 
  ierr = vbmr_ref->create(*grid_refined, "bmelt_refined", true, WIDE_STENCIL); CHKERRQ(ierr);
   // ghosted to allow the "redundant" computation of tauc
@@ -460,7 +486,7 @@ for(int i=0;i<2;i++){
                            "m", ""); CHKERRQ(ierr);
     ierr = variables.add(vHref); CHKERRQ(ierr);
 	  
-	if(config.get_flag("mesh_refinement")){
+	if(refine_dense){
 	vHref_ref= new IceModelVec2S;
 	ierr = vHref_ref->create(*grid_refined, "vHref_ref", true); CHKERRQ(ierr);
     ierr = vHref_ref->set_attrs("diagnostic", "refined temporary ice thickness at calving front boundary",
@@ -550,7 +576,7 @@ for(int i=0;i<2;i++){
   acab.write_in_glaciological_units = true;
   acab.set_attr("comment", "positive values correspond to ice gain");
 
-if(config.get_flag("mesh_refinement")){
+if(refine_dense){
 acab_ref= new  IceModelVec2S;
  ierr = acab_ref->create(*grid_refined, "climatic_mass_balance_refined", false); CHKERRQ(ierr);
   ierr = acab_ref->set_attrs(
@@ -603,7 +629,7 @@ acab_ref= new  IceModelVec2S;
   ierr = shelfbmassflux.set_glaciological_units("m year-1"); CHKERRQ(ierr);
   // do not add; boundary models are in charge here
   //ierr = variables.add(shelfbmassflux); CHKERRQ(ierr);
-  if(config.get_flag("mesh_refinement")){
+  if(refine_dense){
   shelfbmassflux_ref= new  IceModelVec2S;
   ierr = shelfbmassflux_ref->create(*grid_refined, "shelfbmassflux_refined", false); CHKERRQ(ierr); // no ghosts; NO HOR. DIFF.!
   ierr = shelfbmassflux_ref->set_attrs(
@@ -745,16 +771,54 @@ PetscErrorCode IceModel::step(bool do_mass_continuity,
   ierr = ocean->update(grid.time->current(),   dt); CHKERRQ(ierr);
 
   dt_TempAge += dt;
+  dt_Age += dt;
   // IceModel::dt,dtTempAge are now set correctly according to
   // mass-continuity-eqn-diffusivity criteria, horizontal CFL criteria, and
   // other criteria from derived class additionalAtStartTimestep(), and from
   // "-skip" mechanism
 
+  //! \li the semi-Lagrangian age method uses its own time step (dt_Age),
+  //!  independent of the -skip mechanism and using the latest 3D velocity;
+  //!  the age is updated if the update is due, if waiting for as long again
+  //!  could move departure points out of the halo, or at the end of the run
+  const bool age_semi_lagrangian = config.get_flag("age_semi_lagrangian");
+  bool age_sl_step = false;
+  if (do_age && age_semi_lagrangian) {
+    const bool last_step = grid.time->current() + dt >= grid.time->end();
+    age_sl_step = (last_step ||
+                   dt_Age >= config.get("age_semi_lagrangian_interval", "years", "seconds") ||
+                   2.0 * dt_Age >= ageSemiLagrangianMaxTimeStep());
+  }
+
+  //! \li classify columns for the age and energy steps (ice thickness does
+  //!  not change until the mass continuity step)
+  if ((do_age && updateAtDepth) || age_sl_step || do_energy_step) {
+    ierr = columns->update(vH); CHKERRQ(ierr);
+  }
+
+  //! \li if requested, update the age in the same pass over columns as the
+  //!  enthalpy (velocity columns are then read once); see
+  //!  enthalpyAndDrainageStep()
+  age_with_enthalpy = do_age && do_energy_step &&
+    config.get_flag("do_age_with_enthalpy") &&
+    config.get_flag("do_cold_ice_methods") == false &&
+    age_semi_lagrangian == false;
+
   grid.profiler->begin(event_age);
 
   //! \li update the age of the ice (if appropriate)
-  if (do_age && updateAtDepth) {
-    ierr = ageStep(); CHKERRQ(ierr);
+  if (do_age && age_semi_lagrangian) {
+    if (age_sl_step) {
+      ierr = ageStepSemiLagrangian(); CHKERRQ(ierr);
+      dt_Age = 0.0;
+      stdout_flags += "a";
+    } else {
+      stdout_flags += "$";
+    }
+  } else if (do_age && updateAtDepth) {
+    if (age_with_enthalpy == false) {
+      ierr = ageStep(); CHKERRQ(ierr);
+    }
     stdout_flags += "a";
   } else {
     stdout_flags += "$";
@@ -810,6 +874,11 @@ PetscErrorCode IceModel::step(bool do_mass_continuity,
 
   grid.profiler->end(event_mass);
 
+  //! \li advect tracer particles (if any) using the new 3D velocity
+  if (tracers != NULL && updateAtDepth) {
+    ierr = tracers->update(grid.time->current(), dt); CHKERRQ(ierr);
+  }
+
   //! \li compute the bed deformation, which only depends on current thickness
   //! and bed elevation
   if (beddef) {
@@ -880,6 +949,7 @@ PetscErrorCode IceModel::run() {
   skipCountDown = 0;
   t_TempAge = grid.time->start();
   dt_TempAge = 1.0;             // one second (for the preliminary step)
+  dt_Age = 1.0;
   dt = 0.0;
   PetscReal run_end = grid.time->end();
 
@@ -905,6 +975,7 @@ PetscErrorCode IceModel::run() {
   grid.time->set(grid.time->start());
   t_TempAge = grid.time->start();
   dt_TempAge = 0.0;
+  dt_Age = 0.0;
   grid.time->set_end(run_end);
   ierr = model_state_setup(); CHKERRQ(ierr);
 
@@ -950,10 +1021,14 @@ PetscErrorCode IceModel::run() {
 
     ierr = update_viewers(); CHKERRQ(ierr);
 
+    ierr = check_load_balance(); CHKERRQ(ierr);
+
     if (stepcount >= 0) stepcount++;
     if (endOfTimeStepHook() != 0) break;
   } // end of the time-stepping loop
 
+  ierr = report_load_imbalance(); CHKERRQ(ierr);
+
   bool flag;
   PetscInt pause_time = 0;
   ierr = PISMOptionsInt("-pause", "Pause after the run, seconds",
@@ -56,8 +56,17 @@ class PISMSurfaceModel;
 class PISMOceanModel;
 class PISMBedDef;
 class PISMBedThermalUnit;
+class PISMTracerParticles;
 class PISMDiagnostic;
 class PISMTSDiagnostic;
+class PISMRefinedPatches;
+class PISMColumnList;
+class DrainageCalculator;
+class enthSystemCtx;
+class tempSystemCtx;
+class ageSystemCtx;
+class columnSystemGrid;
+class PIO;
 
 // use namespace std BUT remove trivial namespace browser from doxygen-erated HTML source browser
 /// @cond NAMESPACE_BROWSER
@@ -142,6 +151,7 @@ public:
   virtual PetscErrorCode allocate_bed_deformation();
   virtual PetscErrorCode allocate_bedrock_thermal_unit();
   virtual PetscErrorCode allocate_basal_yield_stress();
+  virtual PetscErrorCode allocate_tracers();
   virtual PetscErrorCode allocate_couplers();
 
   virtual PetscErrorCode init_couplers();
@@ -156,6 +166,15 @@ public:
 
   virtual PetscErrorCode list_diagnostics();
 
+  // see iMdecomposition.cc
+  virtual PetscErrorCode set_balanced_ownership_ranges(IceGrid &g, string filename);
+  virtual PetscErrorCode estimate_column_cost(IceGrid &g, string filename,
+                                              vector<double> &cost,
+                                              int &x_start, int &x_count,
+                                              bool &success);
+  virtual PetscErrorCode report_load_imbalance();
+  virtual PetscErrorCode repartition();
+
   // see iceModel.cc
   PetscErrorCode init();
   virtual PetscErrorCode run();
@@ -204,6 +223,7 @@ protected:
 
   EnthalpyConverter *EC;
   PISMBedThermalUnit *btu;
+  PISMTracerParticles *tracers;
 
   PISMSurfaceModel *surface;
   PISMOceanModel   *ocean;
@@ -268,6 +288,7 @@ protected:
   PetscReal   dt,     //!< mass continuity time step, s
               t_TempAge,  //!< time of last update for enthalpy/temperature
               dt_TempAge,  //!< enthalpy/temperature and age time-steps
+              dt_Age,      //!< time since the last semi-Lagrangian age update
               maxdt_temporary, dt_force,
               CFLviolcount,    //!< really is just a count, but PISMGlobalSum requires this type
               dt_from_diffus, dt_from_cfl, CFLmaxdt, CFLmaxdt2D, dt_from_eigencalving,
@@ -295,6 +316,7 @@ protected:
   // flags
   PetscBool  shelvesDragToo, allowAboveMelting;
   PetscBool  repeatRedist, putOnTop;
+  bool        age_with_enthalpy; //!< true if enthalpyAndDrainageStep() updates the age, too
   char        adaptReasonFlag;
 
   string      stdout_flags, stdout_ssa;
@@ -316,12 +338,64 @@ protected:
 
   // see iMage.cc
   virtual PetscErrorCode ageStep();
+  virtual PetscErrorCode ageColumns(unsigned int begin, unsigned int end,
+                                    const columnSystemGrid &vgrid,
+                                    IceModelVec3 *u3, IceModelVec3 *v3, IceModelVec3 *w3,
+                                    bool viewOneColumn, ageSystemCtx &system);
+  virtual PetscErrorCode ageStepSemiLagrangian();
+  virtual PetscErrorCode ageSemiLagrangianColumns(unsigned int begin, unsigned int end,
+                                                  PetscReal dt_age,
+                                                  IceModelVec3 *u3, IceModelVec3 *v3, IceModelVec3 *w3,
+                                                  PetscInt &clipped);
+  virtual PetscReal ageSemiLagrangianMaxTimeStep();
 
   // see iMcalving.cc
   virtual PetscErrorCode eigenCalving();
   virtual PetscErrorCode calvingAtThickness();
   virtual PetscErrorCode dt_from_eigenCalving();
 
+  // see iMdecomposition.cc
+  virtual PetscErrorCode read_2d_strip(PIO &nc, string name, int x_start, int x_count,
+                                       int y_count, vector<double> &result);
+  virtual double column_cost(IceGrid &g, PetscReal H, int mask);
+  virtual PetscErrorCode balance_ownership_ranges(IceGrid &g, const vector<double> &cost,
+                                                  int xs, int xm, int ys, int ym,
+                                                  double &old_imbalance, double &new_imbalance,
+                                                  double &new_cost);
+  virtual PetscErrorCode subdomain_cost(IceGrid &g, const vector<double> &cost,
+                                        int xs, int xm, int ys, int ym,
+                                        double &result, double &imbalance);
+  virtual PetscErrorCode check_load_balance();
+  virtual PetscErrorCode repartition_hook();
+
+  //! Fields, parameters and options used in every column by
+  //! enthalpyAndDrainageStep() and temperatureStep(), which may process
+  //! columns using several threads.
+  struct EnergyStepData {
+    IceModelVec2S *Rb, *G0;
+    IceModelVec3 *u3, *v3, *w3, *Sigma3;
+    const columnSystemGrid *vgrid;
+    DrainageCalculator *dc;
+    bool viewOneColumn;
+    //! liquified thickness in each column of IceModel::columns->owned(), in
+    //! units of the reference spacing columnSystemGrid::dz() (on the fine
+    //! grid: a count of levels); kept per column so that the total does not
+    //! depend on the way columns are split into chunks
+    PetscScalar *liquified;
+    PetscScalar p_air, ice_rho, ice_c, ice_k, L, bulgeEnthMax,
+      bwat_decay_rate, bwat_max,
+      melting_point_temp, beta_CC_grad, global_min_allowed_temp;
+  };
+
+  //! Statistics collected by enthalpyAndDrainageStep() and temperatureStep()
+  //! in a chunk of columns.
+  struct EnergyStepCounts {
+    EnergyStepCounts()
+      : vertSacrCount(0.0), bulgeCount(0.0), lowTempCount(0) {}
+    PetscScalar vertSacrCount, bulgeCount;
+    PetscInt lowTempCount;
+  };
+
   // see iMenergy.cc
   virtual PetscErrorCode energyStep();
   virtual PetscErrorCode get_bed_top_temp(IceModelVec2S &result);
@@ -337,13 +411,15 @@ protected:
 
   virtual PetscErrorCode setCTSFromEnthalpy(IceModelVec3 &useForCTS);
 
-  virtual PetscErrorCode getEnthalpyCTSColumn(PetscScalar p_air, //!< atmospheric pressure
+  virtual PetscErrorCode getEnthalpyCTSColumn(const columnSystemGrid &vgrid, //!< vertical grid
+                                              PetscScalar p_air, //!< atmospheric pressure
 					      PetscScalar thk,	 //!< ice thickness
 					      PetscInt ks,	 //!< index of the level just below the surface
 					      PetscScalar **Enth_s //!< enthalpy of pressure-melting temperature cold ice
 					      );
 
-  virtual PetscErrorCode getlambdaColumn(PetscInt ks,	       //!< index of the level just below the surface
+  virtual PetscErrorCode getlambdaColumn(const columnSystemGrid &vgrid, //!< vertical grid
+                                         PetscInt ks,	       //!< index of the level just below the surface
 					 PetscScalar ice_rho_c,//!< default value only
                                          PetscScalar ice_k,    //!< default value only
 					 const PetscScalar *Enth,   //!< enthalpy in the column
@@ -355,6 +431,11 @@ protected:
   virtual PetscErrorCode enthalpyAndDrainageStep(
                 PetscScalar* vertSacrCount, PetscScalar* liquifiedVol,
                 PetscScalar* bulgeCount);
+  virtual PetscErrorCode enthalpyAndDrainageColumns(unsigned int begin, unsigned int end,
+                                                    const EnergyStepData &data,
+                                                    enthSystemCtx &system,
+                                                    ageSystemCtx *age_system,
+                                                    EnergyStepCounts &counts);
 
   // see iMgeometry.cc
   virtual PetscErrorCode updateSurfaceElevationAndMask();
@@ -363,6 +444,7 @@ protected:
   virtual PetscErrorCode update_surface_elevation();
   virtual PetscErrorCode update_refined_variable(IceModelVec2S &var, IceModelVec2S *var_ref);
   virtual PetscErrorCode update_unrefined_variable(IceModelVec2S &var, IceModelVec2S *var_ref);
+  virtual PetscErrorCode update_refined_patches();
   virtual void cell_interface_fluxes(bool dirichlet_bc,
                                      int i, int j,
                                      planeStar<PISMVector2> input_velocity,
@@ -430,6 +512,10 @@ protected:
                       const PetscScalar z, const PetscScalar dz,
                       PetscScalar *Texcess, PetscScalar *bwat);
   virtual PetscErrorCode temperatureStep(PetscScalar* vertSacrCount, PetscScalar* bulgeCount);
+  virtual PetscErrorCode temperatureColumns(unsigned int begin, unsigned int end,
+                                            const EnergyStepData &data,
+                                            tempSystemCtx &system,
+                                            EnergyStepCounts &counts);
 
   // see iMutil.cc
   virtual int            endOfTimeStepHook();
@@ -450,11 +536,22 @@ protected:
 
   // 3D working space
   IceModelVec3 vWork3d;
+  IceModelVec3 vWork3d_age;     //!< new age values; allocated if do_age_with_enthalpy is set
+  IceModelVec3 tau3_sl;         //!< age with a wide halo; allocated if age_semi_lagrangian is set
   IceModelVec3 *vWork3d_ref;
 
   PISMStressBalance *stress_balance;
   PISMStressBalance *stress_balance_ref;
 
+  // refined fields stored in tiles around the grounding line (used instead of
+  // the *_ref fields if "mesh_refinement_patches" is set)
+  PISMRefinedPatches *refined_patches;
+  int patch_thk, patch_thk_new;
+
+  // icy and ice-free columns; updated once per time step before the age and
+  // energy steps
+  PISMColumnList *columns;
+
   map<string,PISMDiagnostic*> diagnostics;
   map<string,PISMTSDiagnostic*> ts_diagnostics;
 
@@ -502,6 +599,9 @@ protected:
   PetscErrorCode init_backups();
   PetscErrorCode write_backup();
 
+  // dynamic repartitioning; see iMdecomposition.cc
+  int steps_since_balance_check;
+
   // diagnostic viewers; see iMviewers.cc
   virtual PetscErrorCode init_viewers();
   virtual PetscErrorCode update_viewers();
@@ -97,6 +97,7 @@ PetscErrorCode IceModel::init_diagnostics() {
 
   // Get diagnostics supported by the stress balance object:
   stress_balance->get_diagnostics(diagnostics);
+  stress_balance->get_ts_diagnostics(ts_diagnostics);
 
   // Get diagnostics supported by the surface model:
   surface->get_diagnostics(diagnostics);
@@ -577,8 +578,8 @@ PetscErrorCode IceModel_temppabase::compute(IceModelVec* &output) {
 
   PetscScalar *Enthij; // columns of these values
   ierr = result->begin_access(); CHKERRQ(ierr);
-  ierr = enthalpy->begin_access(); CHKERRQ(ierr);
-  ierr = thickness->begin_access(); CHKERRQ(ierr);
+  ierr = enthalpy->begin_read_access(); CHKERRQ(ierr);
+  ierr = thickness->begin_read_access(); CHKERRQ(ierr);
   for (PetscInt i=grid.xs; i<grid.xs+grid.xm; ++i) {
     for (PetscInt j=grid.ys; j<grid.ys+grid.ym; ++j) {
       ierr = enthalpy->getInternalColumn(i,j,&Enthij); CHKERRQ(ierr);
@@ -634,7 +635,7 @@ PetscErrorCode IceModel_enthalpysurf::compute(IceModelVec* &output) {
 
   // compute levels corresponding to 1 m below the ice surface:
 
-  ierr = model->vH.begin_access(); CHKERRQ(ierr);
+  ierr = model->vH.begin_read_access(); CHKERRQ(ierr);
   ierr = result->begin_access(); CHKERRQ(ierr);
   for (PetscInt i=grid.xs; i<grid.xs+grid.xm; ++i) {
     for (PetscInt j=grid.ys; j<grid.ys+grid.ym; ++j) {
@@ -716,7 +717,7 @@ PetscErrorCode IceModel_tempbase::compute(IceModelVec* &output) {
   if (thickness == NULL) SETERRQ(grid.com, 1, "land_ice_thickness is not available");
 
   ierr = result->begin_access(); CHKERRQ(ierr);
-  ierr = thickness->begin_access(); CHKERRQ(ierr);
+  ierr = thickness->begin_read_access(); CHKERRQ(ierr);
 
   for (PetscInt   i = grid.xs; i < grid.xs+grid.xm; ++i) {
     for (PetscInt j = grid.ys; j < grid.ys+grid.ym; ++j) {
@@ -770,7 +771,7 @@ PetscErrorCode IceModel_tempsurf::compute(IceModelVec* &output) {
   // enth.compute().
 
   ierr = result->begin_access(); CHKERRQ(ierr);
-  ierr = thickness->begin_access(); CHKERRQ(ierr);
+  ierr = thickness->begin_read_access(); CHKERRQ(ierr);
 
   PetscReal depth = 1.0,
     pressure = model->EC->getPressureFromDepth(depth);
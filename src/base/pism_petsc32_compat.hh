@@ -40,6 +40,7 @@
 # define PISM_PETSC32_COMPAT 1
 # define PetscObjectTypeCompare(obj,type,flag) PetscTypeCompare(obj,type,flag)
 # define DMCreateMatrix(a,b,c) DMGetMatrix(a,b,c)
+# define PCMGSetGalerkin(pc,flag) PCMGSetGalerkin(pc)
 #else
 # define PISM_PETSC32_COMPAT 0
 #endif
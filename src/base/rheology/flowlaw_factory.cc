@@ -174,6 +174,9 @@ PetscErrorCode IceFlowLawFactory::create(IceFlowLaw **inice)
 
   // create an IceFlowLaw instance:
   ierr = (*r)(com, prefix, config, EC, &ice);CHKERRQ(ierr);
+
+  // process flow law options and build the softness table (if requested):
+  ierr = ice->setFromOptions(); CHKERRQ(ierr);
   *inice = ice;
 
   PetscFunctionReturn(0);
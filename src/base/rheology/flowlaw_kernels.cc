@@ -0,0 +1,149 @@
+// Copyright (C) 2012 Constantine Khroulev
+//
+// This file is part of PISM.
+//
+// PISM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 2 of the License, or (at your option) any later
+// version.
+//
+// PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License
+// along with PISM; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include <typeinfo>
+#include "flowlaw_kernels.hh"
+
+//! Copies parameters of `flow_law` into the kernel matching its class.
+/*!
+  Note that the class of `flow_law` is compared using `typeid`: a class
+  derived from, say, ThermoGlenIce may override any of its methods, so it
+  gets the virtual kernel.
+ */
+IceFlowLawKernels::IceFlowLawKernels(const IceFlowLaw &flow_law) {
+  const std::type_info &t = typeid(flow_law);
+  const bool plain_EC = (flow_law.EC != NULL &&
+                         typeid(*flow_law.EC) == typeid(EnthalpyConverter));
+
+  m_type = VIRTUAL;
+
+  m_virtual.law = &flow_law;
+  m_virtual.EC  = flow_law.EC;
+
+  const double
+    n_minus_one         = flow_law.n - 1,
+    minus_one_over_n    = -1.0 / flow_law.n,
+    R                   = flow_law.ideal_gas_constant,
+    pressure_adjustment = flow_law.beta_CC_grad / (flow_law.rho * flow_law.standard_gravity);
+
+  // Paterson-Budd softness is used by GPBLDIce and ThermoGlenIce:
+  PatersonBuddSoftness pb;
+  pb.A_cold    = flow_law.A_cold;
+  pb.A_warm    = flow_law.A_warm;
+  pb.Q_cold    = flow_law.Q_cold;
+  pb.Q_warm    = flow_law.Q_warm;
+  pb.crit_temp = flow_law.crit_temp;
+  pb.R         = R;
+
+  if (t == typeid(IsothermalGlenIce)) {
+    // does not use the EnthalpyConverter (except for the pressure)
+    const IsothermalGlenIce &law = static_cast<const IsothermalGlenIce&>(flow_law);
+
+    m_isothermal_glen.n_minus_one = n_minus_one;
+    m_isothermal_glen.softness_A  = law.softness_A;
+    m_isothermal_glen.hardness_B  = law.hardness_B;
+    m_isothermal_glen.EC          = flow_law.EC;
+
+    m_type = ISOTHERMAL_GLEN;
+    return;
+  }
+
+  // Kernels use exact formulas, so a flow law using tabulated softness has to
+  // use virtual methods.
+  if (plain_EC == false || flow_law.table.empty() == false)
+    return;
+
+  if (t == typeid(GPBLDIce)) {
+    const GPBLDIce &law = static_cast<const GPBLDIce&>(flow_law);
+
+    init_EC(*flow_law.EC, m_gpbld.EC);
+    m_gpbld.softness_paterson_budd    = pb;
+    m_gpbld.n_minus_one               = n_minus_one;
+    m_gpbld.minus_one_over_n          = minus_one_over_n;
+    m_gpbld.T_0                       = law.T_0;
+    m_gpbld.water_frac_coeff          = law.water_frac_coeff;
+    m_gpbld.water_frac_observed_limit = law.water_frac_observed_limit;
+
+    m_type = GPBLD;
+  } else if (t == typeid(ThermoGlenIce)) {
+    init_EC(*flow_law.EC, m_pb.EC);
+    m_pb.softness_from_temp  = pb;
+    m_pb.n_minus_one         = n_minus_one;
+    m_pb.minus_one_over_n    = minus_one_over_n;
+    m_pb.pressure_adjustment = pressure_adjustment;
+
+    m_type = PATERSON_BUDD;
+  } else if (t == typeid(ThermoGlenArrIce) || t == typeid(ThermoGlenArrIceWarm)) {
+    const bool warm = (t == typeid(ThermoGlenArrIceWarm));
+
+    init_EC(*flow_law.EC, m_arr.EC);
+    m_arr.softness_from_temp.A = warm ? flow_law.A_warm : flow_law.A_cold;
+    m_arr.softness_from_temp.Q = warm ? flow_law.Q_warm : flow_law.Q_cold;
+    m_arr.softness_from_temp.R = R;
+    m_arr.n_minus_one          = n_minus_one;
+    m_arr.minus_one_over_n     = minus_one_over_n;
+    m_arr.pressure_adjustment  = pressure_adjustment;
+
+    m_type = ARRHENIUS;
+  } else if (t == typeid(HookeIce)) {
+    const HookeIce &law = static_cast<const HookeIce&>(flow_law);
+
+    init_EC(*flow_law.EC, m_hooke.EC);
+    m_hooke.softness_from_temp.A  = law.A_Hooke;
+    m_hooke.softness_from_temp.Q  = law.Q_Hooke;
+    m_hooke.softness_from_temp.C  = law.C_Hooke;
+    m_hooke.softness_from_temp.K  = law.K_Hooke;
+    m_hooke.softness_from_temp.Tr = law.Tr_Hooke;
+    m_hooke.softness_from_temp.R  = R;
+    m_hooke.n_minus_one           = n_minus_one;
+    m_hooke.minus_one_over_n      = minus_one_over_n;
+    m_hooke.pressure_adjustment   = pressure_adjustment;
+
+    m_type = HOOKE;
+  }
+}
+
+//! Returns the name of the kernel in use (for reporting).
+const char* IceFlowLawKernels::name() const {
+  switch (m_type) {
+  case GPBLD:
+    return "gpbld";
+  case PATERSON_BUDD:
+    return "pb";
+  case ISOTHERMAL_GLEN:
+    return "isothermal_glen";
+  case ARRHENIUS:
+    return "arr";
+  case HOOKE:
+    return "hooke";
+  default:
+    return "virtual";
+  }
+}
+
+void IceFlowLawKernels::init_EC(const EnthalpyConverter &EC,
+                                EnthalpyConverterKernel &result) const {
+  result.T_melting = EC.T_melting;
+  result.L         = EC.L;
+  result.c_i       = EC.c_i;
+  result.rho_i     = EC.rho_i;
+  result.g         = EC.g;
+  result.p_air     = EC.p_air;
+  result.beta      = EC.beta;
+  result.T_0       = EC.T_0;
+}
@@ -0,0 +1,340 @@
+// Copyright (C) 2012 Constantine Khroulev
+//
+// This file is part of PISM.
+//
+// PISM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 2 of the License, or (at your option) any later
+// version.
+//
+// PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License
+// along with PISM; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef __flowlaw_kernels_hh
+#define __flowlaw_kernels_hh
+
+#include <cmath>
+#include "flowlaws.hh"
+#include "enthalpyConverter.hh"
+
+//! \file flowlaw_kernels.hh Non-virtual, inlinable copies of the flow laws
+//! created by IceFlowLawFactory.
+/*!
+  The stress balance code evaluates IceFlowLaw::flow() and
+  IceFlowLaw::hardness_parameter() once per level in every column. These are
+  virtual and call virtual EnthalpyConverter methods, so none of this can be
+  inlined.
+
+  Each "kernel" below re-implements flow(), hardness_parameter() and
+  EnthalpyConverter::getPressureFromDepth() for \e one concrete flow law
+  class, using the same formulas (evaluated in the same order) and parameters
+  copied from an IceFlowLaw instance. Results are identical to the ones
+  computed by the virtual methods.
+
+  Loops over levels should be written as templates taking the kernel type as
+  a parameter; use IceFlowLawKernels::apply() to call such a template with the
+  kernel matching a given flow law. Such templates can also use the column
+  functions flow_column(), hardness_parameter_column() and
+  getPressureFromDepth_column() defined below; with IceFlowLawVirtualKernel
+  these call the "_column" methods of IceFlowLaw and EnthalpyConverter.
+ */
+
+//! Inlined copy of the EnthalpyConverter methods used by flow laws.
+class EnthalpyConverterKernel {
+public:
+  EnthalpyConverterKernel()
+    : T_melting(0), L(0), c_i(0), rho_i(0), g(0), p_air(0), beta(0), T_0(0) {}
+
+  inline double getPressureFromDepth(double depth) const {
+    if (depth <= 0.0)
+      return p_air;
+    return p_air + rho_i * g * depth;
+  }
+
+  inline double getMeltingTemp(double p) const {
+    return T_melting - beta * p;
+  }
+
+  inline double getEnthalpyCTS(double p) const {
+    return c_i * (getMeltingTemp(p) - T_0);
+  }
+
+  inline double getAbsTemp(double E, double p) const {
+    if (E < getEnthalpyCTS(p))
+      return (E / c_i) + T_0;
+    return getMeltingTemp(p);
+  }
+
+  inline double getPATemp(double E, double p) const {
+    return getAbsTemp(E, p) - getMeltingTemp(p) + T_melting;
+  }
+
+  inline double getWaterFraction(double E, double p) const {
+    const double E_s = getEnthalpyCTS(p), E_l = E_s + L;
+    if (E >= E_l)
+      return 1.0;
+    if (E <= E_s)
+      return 0.0;
+    return (E - E_s) / L;
+  }
+
+  double T_melting, L, c_i, rho_i, g, p_air, beta, T_0;
+};
+
+//! Paterson-Budd softness (IceFlowLaw::softness_parameter_paterson_budd()).
+class PatersonBuddSoftness {
+public:
+  PatersonBuddSoftness()
+    : A_cold(0), A_warm(0), Q_cold(0), Q_warm(0), crit_temp(0), R(1) {}
+
+  inline double operator()(double T_pa) const {
+    if (T_pa < crit_temp)
+      return A_cold * exp(-Q_cold/(R * T_pa));
+    return A_warm * exp(-Q_warm/(R * T_pa));
+  }
+
+  double A_cold, A_warm, Q_cold, Q_warm, crit_temp, R;
+};
+
+//! Arrhenius softness (ThermoGlenArrIce and ThermoGlenArrIceWarm).
+class ArrheniusSoftness {
+public:
+  ArrheniusSoftness() : A(0), Q(0), R(1) {}
+
+  inline double operator()(double T_pa) const {
+    return A * exp(-Q/(R * T_pa));
+  }
+
+  double A, Q, R;
+};
+
+//! Hooke (1981) softness (HookeIce).
+class HookeSoftness {
+public:
+  HookeSoftness() : A(0), Q(0), C(0), K(0), Tr(0), R(1) {}
+
+  inline double operator()(double T_pa) const {
+    return A * exp( -Q/(R * T_pa) + 3.0 * C * pow(Tr - T_pa, -K));
+  }
+
+  double A, Q, C, K, Tr, R;
+};
+
+//! Kernel calling virtual methods; used with flow laws that have no kernel.
+class IceFlowLawVirtualKernel {
+public:
+  IceFlowLawVirtualKernel() : law(NULL), EC(NULL) {}
+
+  inline double flow(double stress, double E, double p, double gs) const
+  { return law->flow(stress, E, p, gs); }
+
+  inline double hardness_parameter(double E, double p) const
+  { return law->hardness_parameter(E, p); }
+
+  inline double getPressureFromDepth(double depth) const
+  { return EC->getPressureFromDepth(depth); }
+
+  const IceFlowLaw *law;
+  const EnthalpyConverter *EC;
+};
+
+//! Kernel for GPBLDIce.
+class GPBLDIceKernel {
+public:
+  GPBLDIceKernel()
+    : n_minus_one(0), minus_one_over_n(0), T_0(0),
+      water_frac_coeff(0), water_frac_observed_limit(0) {}
+
+  inline double softness_parameter(double E, double p) const {
+    if (E < EC.getEnthalpyCTS(p)) {       // cold ice
+      return softness_paterson_budd(EC.getPATemp(E, p));
+    }
+    // temperate ice
+    const double omega = PetscMin(EC.getWaterFraction(E, p), water_frac_observed_limit);
+    return softness_paterson_budd(T_0) * (1.0 + water_frac_coeff * omega);
+  }
+
+  inline double flow(double stress, double E, double p, double) const
+  { return softness_parameter(E, p) * pow(stress, n_minus_one); }
+
+  inline double hardness_parameter(double E, double p) const
+  { return pow(softness_parameter(E, p), minus_one_over_n); }
+
+  inline double getPressureFromDepth(double depth) const
+  { return EC.getPressureFromDepth(depth); }
+
+  EnthalpyConverterKernel EC;
+  PatersonBuddSoftness softness_paterson_budd;
+  double n_minus_one, minus_one_over_n, T_0,
+    water_frac_coeff, water_frac_observed_limit;
+};
+
+//! Kernel for ThermoGlenIce and classes differing from it in the
+//! temperature dependence of the softness only.
+/*!
+  Set `pressure_adjusted_flow` to false for flow laws using the
+  non-pressure-adjusted temperature in flow_from_temp() (ThermoGlenArrIce).
+ */
+template <class Softness, bool pressure_adjusted_flow>
+class ThermoGlenIceKernelT {
+public:
+  ThermoGlenIceKernelT()
+    : n_minus_one(0), minus_one_over_n(0), pressure_adjustment(0) {}
+
+  inline double flow(double stress, double E, double p, double) const {
+    const double T = EC.getAbsTemp(E, p),
+      T_pa = pressure_adjusted_flow ? T + pressure_adjustment * p : T;
+    return softness_from_temp(T_pa) * pow(stress, n_minus_one);
+  }
+
+  inline double hardness_parameter(double E, double p) const
+  { return pow(softness_from_temp(EC.getPATemp(E, p)), minus_one_over_n); }
+
+  inline double getPressureFromDepth(double depth) const
+  { return EC.getPressureFromDepth(depth); }
+
+  EnthalpyConverterKernel EC;
+  Softness softness_from_temp;
+  //! beta_CC_grad / (rho * standard_gravity)
+  double n_minus_one, minus_one_over_n, pressure_adjustment;
+};
+
+typedef ThermoGlenIceKernelT<PatersonBuddSoftness, true> ThermoGlenIceKernel;
+typedef ThermoGlenIceKernelT<ArrheniusSoftness, false>   ThermoGlenArrIceKernel;
+typedef ThermoGlenIceKernelT<HookeSoftness, true>        HookeIceKernel;
+
+//! Kernel for IsothermalGlenIce.
+class IsothermalGlenIceKernel {
+public:
+  IsothermalGlenIceKernel() : n_minus_one(0), softness_A(0), hardness_B(0), EC(NULL) {}
+
+  inline double flow(double stress, double, double, double) const
+  { return softness_A * pow(stress, n_minus_one); }
+
+  inline double hardness_parameter(double, double) const
+  { return hardness_B; }
+
+  inline double getPressureFromDepth(double depth) const
+  { return EC->getPressureFromDepth(depth); }
+
+  double n_minus_one, softness_A, hardness_B;
+  const EnthalpyConverter *EC;
+};
+
+//! Computes flow() at \c n levels.
+template <class K>
+inline void flow_column(const K &kernel, int n, const double *stress, const double *E,
+                        const double *p, const double *gs, double *result) {
+  for (int k = 0; k < n; ++k)
+    result[k] = kernel.flow(stress[k], E[k], p[k], gs[k]);
+}
+
+inline void flow_column(const IceFlowLawVirtualKernel &kernel, int n, const double *stress,
+                        const double *E, const double *p, const double *gs, double *result) {
+  kernel.law->flow_column(n, stress, E, p, gs, result);
+}
+
+//! Computes hardness_parameter() at \c n levels.
+template <class K>
+inline void hardness_parameter_column(const K &kernel, int n, const double *E, const double *p,
+                                      double *result) {
+  for (int k = 0; k < n; ++k)
+    result[k] = kernel.hardness_parameter(E[k], p[k]);
+}
+
+inline void hardness_parameter_column(const IceFlowLawVirtualKernel &kernel, int n,
+                                      const double *E, const double *p, double *result) {
+  kernel.law->hardness_parameter_column(n, E, p, result);
+}
+
+//! Computes pressure at levels `z[0], ..., z[n-1]` in ice of thickness `thickness`.
+template <class K>
+inline void getPressureFromDepth_column(const K &kernel, int n, double thickness,
+                                        const double *z, double *p) {
+  for (int k = 0; k < n; ++k)
+    p[k] = kernel.getPressureFromDepth(thickness - z[k]);
+}
+
+inline void getPressureFromDepth_column(const IceFlowLawVirtualKernel &kernel, int n,
+                                        double thickness, const double *z, double *p) {
+  kernel.EC->getPressureFromDepth_column(n, thickness, z, p);
+}
+
+//! \brief Selects (once) the kernel matching a flow law and calls templates
+//! with it.
+/*!
+  A specialized kernel is used only if the flow law is an instance of one of
+  the classes listed in IceFlowLawKernels::Type (and not of a class derived
+  from it) and its EnthalpyConverter is the base class EnthalpyConverter
+  (i.e. not the one used in verification tests), and if the flow law does not
+  use tabulated softness (see \ref flow_law_table). Otherwise apply() falls
+  back to IceFlowLawVirtualKernel.
+
+  Use this way:
+  \code
+  struct MyColumnOp {
+    // ... inputs ...
+    template <class F>
+    double operator()(const F &flow_law) const {
+      // loop over levels calling flow_law.flow(...)
+    }
+  };
+
+  IceFlowLawKernels kernels(*flow_law);
+  MyColumnOp op;
+  double result = kernels.apply(op);
+  \endcode
+ */
+class IceFlowLawKernels {
+public:
+  enum Type {VIRTUAL = 0, GPBLD, PATERSON_BUDD, ISOTHERMAL_GLEN, ARRHENIUS, HOOKE};
+
+  IceFlowLawKernels(const IceFlowLaw &flow_law);
+
+  Type type() const
+  { return m_type; }
+
+  const char* name() const;
+
+  template <class Op>
+  inline double apply(const Op &op) const {
+    switch (m_type) {
+    case GPBLD:
+      return op(m_gpbld);
+    case PATERSON_BUDD:
+      return op(m_pb);
+    case ISOTHERMAL_GLEN:
+      return op(m_isothermal_glen);
+    case ARRHENIUS:
+      return op(m_arr);
+    case HOOKE:
+      return op(m_hooke);
+    default:
+      return op(m_virtual);
+    }
+  }
+
+  //! Always calls `op` with the kernel calling virtual methods.
+  template <class Op>
+  inline double apply_virtual(const Op &op) const
+  { return op(m_virtual); }
+
+protected:
+  void init_EC(const EnthalpyConverter &EC, EnthalpyConverterKernel &result) const;
+
+  Type m_type;
+  IceFlowLawVirtualKernel m_virtual;
+  GPBLDIceKernel m_gpbld;
+  ThermoGlenIceKernel m_pb;
+  IsothermalGlenIceKernel m_isothermal_glen;
+  ThermoGlenArrIceKernel m_arr;
+  HookeIceKernel m_hooke;
+};
+
+#endif /* __flowlaw_kernels_hh */
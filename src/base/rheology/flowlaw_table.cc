@@ -0,0 +1,58 @@
+// Copyright (C) 2012 Constantine Khroulev
+//
+// This file is part of PISM.
+//
+// PISM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 2 of the License, or (at your option) any later
+// version.
+//
+// PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License
+// along with PISM; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "flowlaw_table.hh"
+
+IceFlowLawTable::IceFlowLawTable() {
+  clear();
+}
+
+//! Removes all segments. (An empty table covers no values of `x`.)
+void IceFlowLawTable::clear() {
+  m_breakpoints.clear();
+  m_inverse_spacing.clear();
+  m_intervals.clear();
+  m_offset.clear();
+  m_softness.clear();
+  m_hardness.clear();
+  m_x_min = 1.0;
+  m_x_max = -1.0;
+}
+
+//! Appends the segment \f$[a, b]\f$ with values at `softness.size()` equally-spaced nodes.
+/*!
+  Segments have to be added left to right: `a` has to be equal to the right
+  end point of the previous segment.
+ */
+void IceFlowLawTable::add_segment(double a, double b,
+                                  const std::vector<double> &softness,
+                                  const std::vector<double> &hardness) {
+  const int N = static_cast<int>(softness.size()) - 1;
+
+  if (empty())
+    m_x_min = a;
+  m_x_max = b;
+
+  m_breakpoints.push_back(a);
+  m_inverse_spacing.push_back(N / (b - a));
+  m_intervals.push_back(N);
+  m_offset.push_back(size());
+
+  m_softness.insert(m_softness.end(), softness.begin(), softness.end());
+  m_hardness.insert(m_hardness.end(), hardness.begin(), hardness.end());
+}
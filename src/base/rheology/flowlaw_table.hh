@@ -0,0 +1,90 @@
+// Copyright (C) 2012 Constantine Khroulev
+//
+// This file is part of PISM.
+//
+// PISM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 2 of the License, or (at your option) any later
+// version.
+//
+// PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License
+// along with PISM; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef __flowlaw_table_hh
+#define __flowlaw_table_hh
+
+#include <vector>
+
+//! \brief Piecewise-linear table of ice softness and hardness as functions
+//! of the enthalpy relative to the cold-temperate transition surface,
+//! \f$x = E - E_{\text{cts}}(p)\f$.
+/*!
+  The table consists of segments \f$[x_0, x_1], [x_1, x_2], \dots\f$, each
+  using its own uniform spacing. Segment end points are placed at points
+  where the tabulated functions are not smooth (the Paterson-Budd critical
+  temperature, the CTS, etc), so that the linear interpolation does not
+  smear discontinuities. Values at segment end points are one-sided limits,
+  which is why each segment stores its own end points.
+
+  See IceFlowLaw::build_table().
+ */
+class IceFlowLawTable {
+public:
+  IceFlowLawTable();
+
+  void clear();
+
+  bool empty() const
+  { return m_breakpoints.empty(); }
+
+  //! Number of nodes in the table.
+  int size() const
+  { return static_cast<int>(m_softness.size()); }
+
+  void add_segment(double a, double b,
+                   const std::vector<double> &softness,
+                   const std::vector<double> &hardness);
+
+  //! Returns true if `x` is in the range covered by the table.
+  inline bool covers(double x) const
+  { return x >= m_x_min && x <= m_x_max; }
+
+  //! Interpolated softness at `x`; `x` has to be in the range covered by the table.
+  inline double softness(double x) const
+  { return interpolate(x, m_softness); }
+
+  //! Interpolated hardness at `x`; `x` has to be in the range covered by the table.
+  inline double hardness(double x) const
+  { return interpolate(x, m_hardness); }
+
+protected:
+  inline double interpolate(double x, const std::vector<double> &f) const {
+    const int last = static_cast<int>(m_breakpoints.size()) - 1;
+    int s = 0;
+    while (s < last && x >= m_breakpoints[s + 1])
+      ++s;
+
+    const double t = (x - m_breakpoints[s]) * m_inverse_spacing[s];
+    int j = static_cast<int>(t);
+    if (j >= m_intervals[s])
+      j = m_intervals[s] - 1;
+
+    const int i = m_offset[s] + j;
+    return f[i] + (t - j) * (f[i + 1] - f[i]);
+  }
+
+  // left end points, spacing, number of intervals and the index of the first
+  // node of each segment
+  std::vector<double> m_breakpoints, m_inverse_spacing;
+  std::vector<int> m_intervals, m_offset;
+  std::vector<double> m_softness, m_hardness;
+  double m_x_min, m_x_max;
+};
+
+#endif /* __flowlaw_table_hh */
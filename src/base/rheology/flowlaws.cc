@@ -23,6 +23,9 @@
 
 #include "NCVariable.hh"
 
+//! Size of blocks of levels processed by column methods that need temporary storage.
+static const int column_block_size = 64;
+
 PetscBool IceFlowLawUsesGrainSize(IceFlowLaw *flow_law) {
   static const PetscReal gs[] = {1e-4, 1e-3, 1e-2, 1}, s=1e4, E=500000, p=1e6;
   PetscReal ref = flow_law->flow(s, E, p, gs[0]);
@@ -71,12 +74,200 @@ IceFlowLaw::IceFlowLaw(MPI_Comm c, const char pre[], const NCConfigVariable &con
   schoofLen = config.get("Schoof_regularizing_length", "km", "m"); // convert to meters
   schoofVel = config.get("Schoof_regularizing_velocity", "m/year", "m/s"); // convert to m/s
   schoofReg = PetscSqr(schoofVel/schoofLen);
+
+  use_table             = config.get_flag("flow_law_use_table");
+  table_tolerance       = config.get("flow_law_table_tolerance");
+  table_min_temperature = config.get("flow_law_table_min_temperature");
 }
 
+//! Builds the softness and hardness table, if requested.
+/*! Derived classes re-implementing this should call it \e after setting
+  their parameters so that the table uses them.
+ */
 PetscErrorCode IceFlowLaw::setFromOptions() {
+  PetscErrorCode ierr;
+
+  if (use_table) {
+    ierr = build_table(); CHKERRQ(ierr);
+  }
+
+  return 0;
+}
+
+//! \brief Sets `result` to the end points of segments of the softness table
+//! (values of \f$E - E_{\text{cts}}(p)\f$, in increasing order).
+/*!
+  Classes supporting tabulated softness and hardness implement this; an empty
+  list (the default) means "not supported". End points should include all the
+  points at which the softness is not smooth.
+ */
+PetscErrorCode IceFlowLaw::table_breakpoints(std::vector<PetscReal> &result) const {
+  result.clear();
+  return 0;
+}
+
+//! Computes \f$E - E_{\text{cts}}(p)\f$ corresponding to the temperature `T` and
+//! the liquid water fraction `omega` at zero pressure.
+PetscErrorCode IceFlowLaw::table_coordinate(PetscReal T, PetscReal omega,
+                                            PetscReal &result) const {
+  PetscErrorCode ierr;
+  PetscReal E;
+
+  ierr = EC->getEnthPermissive(T, omega, 0.0, E); CHKERRQ(ierr);
+  result = E - EC->getEnthalpyCTS(0.0);
+
   return 0;
 }
 
+//! Computes softness and hardness at `N` + 1 equally-spaced points in \f$[a, b]\f$.
+/*!
+  End points are moved inside the interval a little so that values there are
+  one-sided limits. Must be called while the table is empty (so that exact
+  formulas are used).
+ */
+void IceFlowLaw::table_nodes(PetscReal a, PetscReal b, int N, PetscReal p,
+                             std::vector<PetscReal> &softness,
+                             std::vector<PetscReal> &hardness) const {
+  const PetscReal h = (b - a) / N, eps = 1e-6 * h,
+    E_cts = EC->getEnthalpyCTS(p);
+
+  softness.resize(N + 1);
+  hardness.resize(N + 1);
+
+  for (int j = 0; j <= N; ++j) {
+    PetscReal x = a + j * h;
+    if (j == 0)
+      x = a + eps;
+    if (j == N)
+      x = b - eps;
+
+    softness[j] = softness_parameter(E_cts + x, p);
+    hardness[j] = hardness_parameter(E_cts + x, p);
+  }
+}
+
+//! \brief Returns the maximum relative error of softness and hardness values
+//! from `t` at pressure `p`, sampling the segment \f$[a, b]\f$ with `N`
+//! intervals at three points per interval (including midpoints).
+/*! Must be called while the table is empty (so that exact formulas are used). */
+PetscReal IceFlowLaw::table_error(const IceFlowLawTable &t, PetscReal a, PetscReal b, int N,
+                                  PetscReal p) const {
+  const int M = 3 * N;
+  const PetscReal E_cts = EC->getEnthalpyCTS(p);
+  PetscReal result = 0.0;
+
+  for (int i = 0; i < M; ++i) {
+    const PetscReal
+      E = E_cts + a + (i + 0.5) * (b - a) / M,
+      x = E - E_cts,
+      softness = softness_parameter(E, p),
+      hardness = hardness_parameter(E, p);
+
+    result = PetscMax(result, PetscAbs((t.softness(x) - softness) / softness));
+    result = PetscMax(result, PetscAbs((t.hardness(x) - hardness) / hardness));
+  }
+
+  return result;
+}
+
+//! \brief Builds the table of softness and hardness values (see \ref
+//! flow_law_table) and reports its size and error.
+/*!
+  The softness of flow laws supporting tables depends on the enthalpy and
+  the pressure through \f$x = E - E_{\text{cts}}(p)\f$ only (with the default
+  EnthalpyConverter), so the table is one-dimensional.
+
+  The number of intervals in each segment is doubled until the error at zero
+  pressure is below half of the tolerance. Then the error is measured at
+  pressures corresponding to depths from 0 to 5000 m; if it exceeds the
+  tolerance (for example with an EnthalpyConverter using a
+  temperature-dependent heat capacity) the table is not used.
+ */
+PetscErrorCode IceFlowLaw::build_table() {
+  PetscErrorCode ierr;
+  const int max_intervals = 65536;
+  std::vector<PetscReal> breakpoints, softness, hardness;
+  std::vector<int> intervals;
+  IceFlowLawTable result;
+
+  // softness_parameter() and hardness_parameter() use exact formulas while
+  // the table is empty:
+  table.clear();
+
+  if (EC == NULL)
+    return 0;
+
+  ierr = table_breakpoints(breakpoints); CHKERRQ(ierr);
+
+  if (breakpoints.size() < 2) {
+    ierr = verbPrintf(2, com,
+                      "  %sflow_law: tabulated softness is not supported; using exact formulas\n",
+                      prefix); CHKERRQ(ierr);
+    return 0;
+  }
+
+  for (unsigned int s = 0; s + 1 < breakpoints.size(); ++s) {
+    const PetscReal a = breakpoints[s], b = breakpoints[s + 1];
+    int N = 4;
+
+    while (true) {
+      IceFlowLawTable segment;
+      table_nodes(a, b, N, 0.0, softness, hardness);
+      segment.add_segment(a, b, softness, hardness);
+
+      if (table_error(segment, a, b, N, 0.0) <= 0.5 * table_tolerance || N >= max_intervals)
+        break;
+
+      N *= 2;
+    }
+
+    result.add_segment(a, b, softness, hardness);
+    intervals.push_back(N);
+  }
+
+  PetscReal max_error = 0.0;
+  for (int j = 0; j <= 5; ++j) {
+    const PetscReal p = EC->getPressureFromDepth(1000.0 * j);
+
+    for (unsigned int s = 0; s < intervals.size(); ++s)
+      max_error = PetscMax(max_error, table_error(result, breakpoints[s], breakpoints[s + 1],
+                                                  intervals[s], p));
+  }
+
+  if (max_error > table_tolerance) {
+    ierr = verbPrintf(2, com,
+                      "PISM WARNING: %sflow_law: max. relative error of tabulated softness (%.2e)\n"
+                      "              exceeds the tolerance (%.2e); using exact formulas\n",
+                      prefix, max_error, table_tolerance); CHKERRQ(ierr);
+    return 0;
+  }
+
+  table = result;
+
+  ierr = verbPrintf(2, com,
+                    "  %sflow_law: tabulated softness and hardness (%d nodes),"
+                    " max. relative error %.2e (tolerance %.2e)\n",
+                    prefix, table.size(), max_error, table_tolerance); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! \brief Computes softness (or hardness, if `hardness` is true) at `n`
+//! levels using the table; values outside of the table are computed exactly.
+void IceFlowLaw::table_column(int N, const PetscReal *E, const PetscReal *p, bool hardness,
+                              PetscReal *result) const {
+  EC->getEnthalpyCTS_column(N, p, result);
+
+  for (int k = 0; k < N; ++k) {
+    const PetscReal x = E[k] - result[k];
+
+    if (table.covers(x))
+      result[k] = hardness ? table.hardness(x) : table.softness(x);
+    else
+      result[k] = hardness ? hardness_parameter(E[k], p[k]) : softness_parameter(E[k], p[k]);
+  }
+}
+
 //! Returns viscosity and \b not the nu * H product.
 PetscReal IceFlowLaw::effective_viscosity(PetscReal hardness,
                                          PetscReal u_x, PetscReal u_y,
@@ -108,6 +299,24 @@ PetscReal IceFlowLaw::softness_parameter_paterson_budd(PetscReal T_pa) const {
   return A_warm * exp(-Q_warm/(ideal_gas_constant * T_pa));
 }
 
+//! Column version of softness_parameter_paterson_budd(); `T_pa` and `result` may be the same array.
+void IceFlowLaw::softness_parameter_paterson_budd_column(int N, const PetscReal *T_pa,
+                                                         PetscReal *result) const {
+  for (int k = 0; k < N; ++k) {
+    const bool cold = T_pa[k] < crit_temp;
+    const PetscReal
+      A = cold ? A_cold : A_warm,
+      Q = cold ? Q_cold : Q_warm;
+    result[k] = A * exp(-Q/(ideal_gas_constant * T_pa[k]));
+  }
+}
+
+//! Replaces softness values with corresponding hardness values (see hardness_parameter()).
+void IceFlowLaw::hardness_from_softness_column(int N, PetscReal *softness) const {
+  for (int k = 0; k < N; ++k)
+    softness[k] = pow(softness[k], -1.0/n);
+}
+
 //! The flow law itself.
 PetscReal IceFlowLaw::flow(PetscReal stress, PetscReal enthalpy,
                            PetscReal pressure, PetscReal /* gs */) const {
@@ -115,32 +324,61 @@ PetscReal IceFlowLaw::flow(PetscReal stress, PetscReal enthalpy,
 }
 
 PetscReal IceFlowLaw::hardness_parameter(PetscReal E, PetscReal p) const {
+  if (table.empty() == false) {
+    const PetscReal x = E - EC->getEnthalpyCTS(p);
+    if (table.covers(x))
+      return table.hardness(x);
+  }
   return pow(softness_parameter(E, p), -1.0/n);
 }
 
+void IceFlowLaw::flow_column(int N, const PetscReal *stress, const PetscReal *E,
+                             const PetscReal *pressure, const PetscReal *grainsize,
+                             PetscReal *result) const {
+  for (int k = 0; k < N; ++k)
+    result[k] = flow(stress[k], E[k], pressure[k], grainsize[k]);
+}
+
+void IceFlowLaw::hardness_parameter_column(int N, const PetscReal *E, const PetscReal *p,
+                                           PetscReal *result) const {
+  for (int k = 0; k < N; ++k)
+    result[k] = hardness_parameter(E[k], p[k]);
+}
+
+void IceFlowLaw::softness_parameter_column(int N, const PetscReal *E, const PetscReal *p,
+                                           PetscReal *result) const {
+  for (int k = 0; k < N; ++k)
+    result[k] = softness_parameter(E[k], p[k]);
+}
+
 //! Computes vertical average of B(E, pressure) ice hardness, namely \f$\bar
 //! B(E, p)\f$. See comment for hardness_parameter().
-/*! Note E[0], ..., E[kbelowH] must be valid.  */
+/*! Note E[0], ..., E[kbelowH] must be valid and zlevels[0] must be zero.
+
+  Ice hardness is computed using hardness_parameter_column(), in blocks of
+  levels.
+ */
 PetscReal IceFlowLaw::averaged_hardness(PetscReal thickness, PetscInt kbelowH,
                                                  const PetscReal *zlevels,
                                                  const PetscReal *enthalpy) const {
-  PetscReal B = 0;
+  PetscReal B = 0, p[column_block_size], hardness[column_block_size];
+  PetscReal h0 = 0;             // ice hardness at the left endpoint
 
   // Use trapezoidal rule to integrate from 0 to zlevels[kbelowH]:
-  if (kbelowH > 0) {
-    PetscReal
-      p0 = EC->getPressureFromDepth(thickness),
-      E0 = enthalpy[0],
-      h0 = hardness_parameter(E0, p0); // ice hardness at the left endpoint
+  for (int start = 0; start <= kbelowH; start += column_block_size) {
+    const int N = PetscMin(column_block_size, kbelowH + 1 - start);
+
+    EC->getPressureFromDepth_column(N, thickness, zlevels + start, p);
+    hardness_parameter_column(N, enthalpy + start, p, hardness);
 
-    for (int i = 1; i <= kbelowH; ++i) { // note the "1" and the "<="
-      const PetscReal
-        p1 = EC->getPressureFromDepth(thickness - zlevels[i]), // pressure at the right endpoint
-        E1 = enthalpy[i], // enthalpy at the right endpoint
-        h1 = hardness_parameter(E1, p1); // ice hardness at the right endpoint
+    for (int k = 0; k < N; ++k) {
+      const int i = start + k;
+      const PetscReal h1 = hardness[k]; // ice hardness at the right endpoint
 
-      // The midpoint rule sans the "1/2":
-      B += (zlevels[i] - zlevels[i-1]) * (h0 + h1);
+      if (i > 0) {
+        // The midpoint rule sans the "1/2":
+        B += (zlevels[i] - zlevels[i-1]) * (h0 + h1);
+      }
 
       h0 = h1;
     }
@@ -150,12 +388,11 @@ PetscReal IceFlowLaw::averaged_hardness(PetscReal thickness, PetscInt kbelowH,
   B *= 0.5;
 
   // use the "rectangle method" to integrate from
-  // zlevels[kbelowH] to thickness:
+  // zlevels[kbelowH] to thickness; h0 is the hardness at zlevels[kbelowH]
   PetscReal
-    depth = thickness - zlevels[kbelowH],
-    p = EC->getPressureFromDepth(depth);
+    depth = thickness - zlevels[kbelowH];
 
-  B += depth * hardness_parameter(enthalpy[kbelowH], p);
+  B += depth * h0;
 
   // Now B is an integral of ice hardness; next, compute the average:
   if (thickness > 0)
@@ -184,8 +421,6 @@ PetscErrorCode GPBLDIce::setFromOptions() {
   PetscErrorCode ierr;
   bool flag;
 
-  ierr = IceFlowLaw::setFromOptions(); CHKERRQ(ierr);
-
   ierr = PetscOptionsBegin(com, prefix, "GPBLDIce options", NULL); CHKERRQ(ierr);
   {
     ierr = PISMOptionsReal("-ice_gpbld_water_frac_coeff",
@@ -199,6 +434,37 @@ PetscErrorCode GPBLDIce::setFromOptions() {
                            water_frac_observed_limit, flag); CHKERRQ(ierr);
   }
   ierr = PetscOptionsEnd(); CHKERRQ(ierr);
+
+  // this builds the table (if requested) using parameters set above
+  ierr = IceFlowLaw::setFromOptions(); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! Segments: cold ice below and above the Paterson-Budd critical temperature,
+//! temperate ice below and above the observed limit of the liquid water fraction.
+PetscErrorCode GPBLDIce::table_breakpoints(std::vector<PetscReal> &result) const {
+  PetscErrorCode ierr;
+  PetscReal x;
+
+  result.clear();
+
+  ierr = table_coordinate(table_min_temperature, 0.0, x); CHKERRQ(ierr);
+  result.push_back(x);
+
+  if (crit_temp > table_min_temperature && crit_temp < melting_point_temp) {
+    ierr = table_coordinate(crit_temp, 0.0, x); CHKERRQ(ierr);
+    result.push_back(x);
+  }
+
+  result.push_back(0.0);        // the CTS
+
+  ierr = table_coordinate(melting_point_temp, water_frac_observed_limit, x); CHKERRQ(ierr);
+  result.push_back(x);
+
+  ierr = table_coordinate(melting_point_temp, 1.0, x); CHKERRQ(ierr);
+  result.push_back(x);
+
   return 0;
 }
 
@@ -220,6 +486,10 @@ PetscReal GPBLDIce::softness_parameter(
   }
   PetscReal E_s, E_l;
   EC->getEnthalpyInterval(pressure, E_s, E_l);
+
+  if (table.covers(enthalpy - E_s))
+    return table.softness(enthalpy - E_s);
+
   if (enthalpy < E_s) {       // cold ice
     PetscReal T_pa;
     ierr = EC->getPATemp(enthalpy, pressure, T_pa);
@@ -239,18 +509,85 @@ PetscReal GPBLDIce::softness_parameter(
   }
 }
 
+//! Column version of softness_parameter(); processes blocks of levels.
+/*!
+  Computes the cold and the temperate ice softness at all levels and selects
+  one, so that the loop has no branches.
+ */
+void GPBLDIce::softness_parameter_column(int N, const PetscReal *E, const PetscReal *p,
+                                         PetscReal *result) const {
+  if (table.empty() == false) {
+    table_column(N, E, p, false, result);
+    return;
+  }
+
+  PetscReal E_s[column_block_size], T_pa[column_block_size], omega[column_block_size];
+  const PetscReal A_T0 = softness_parameter_paterson_budd(T_0);
+
+  for (int start = 0; start < N; start += column_block_size) {
+    const int M = PetscMin(column_block_size, N - start);
+    const PetscReal *E_block = E + start, *p_block = p + start;
+    PetscReal *result_block = result + start;
+
+    // Return values are ignored here: a non-zero value means that one of the
+    // values corresponds to liquid water, and only temperate ice formulas
+    // are used in this case (exactly as in softness_parameter()).
+    EC->getEnthalpyCTS_column(M, p_block, E_s);
+    EC->getPATemp_column(M, E_block, p_block, T_pa);
+    EC->getWaterFraction_column(M, E_block, p_block, omega);
+
+    softness_parameter_paterson_budd_column(M, T_pa, T_pa);
+
+    for (int k = 0; k < M; ++k) {
+      // as stated in \ref AschwandenBuelerBlatter, cap omega at max of observations:
+      const PetscReal w = PetscMin(omega[k], water_frac_observed_limit);
+      result_block[k] = (E_block[k] < E_s[k]) ? T_pa[k] : A_T0 * (1.0 + water_frac_coeff * w);
+    }
+  }
+}
+
+void GPBLDIce::hardness_parameter_column(int N, const PetscReal *E, const PetscReal *p,
+                                         PetscReal *result) const {
+  if (table.empty() == false) {
+    table_column(N, E, p, true, result);
+    return;
+  }
+
+  softness_parameter_column(N, E, p, result);
+  hardness_from_softness_column(N, result);
+}
+
+void GPBLDIce::flow_column(int N, const PetscReal *stress, const PetscReal *E,
+                           const PetscReal *pressure, const PetscReal *,
+                           PetscReal *result) const {
+  softness_parameter_column(N, E, pressure, result);
+  for (int k = 0; k < N; ++k)
+    result[k] = result[k] * pow(stress[k], n-1);
+}
+
 // ThermoGlenIce
 
 /*! Converts enthalpy to temperature and uses the Paterson-Budd formula. */
 PetscReal ThermoGlenIce::softness_parameter(PetscReal E, PetscReal pressure) const {
+  if (table.empty() == false) {
+    const PetscReal x = E - EC->getEnthalpyCTS(pressure);
+    if (table.covers(x))
+      return table.softness(x);
+  }
+
   PetscReal T_pa;
   EC->getPATemp(E, pressure, T_pa);
   return softness_parameter_from_temp(T_pa);
 }
 
-/*! Converts enthalpy to temperature and calls flow_from_temp. */
+/*! Converts enthalpy to temperature and calls flow_from_temp. (With the
+  pressure-adjusted temperature this is equivalent to using
+  softness_parameter(), which is what is done if the table is in use.) */
 PetscReal ThermoGlenIce::flow(PetscReal stress, PetscReal E,
                                         PetscReal pressure, PetscReal gs) const {
+  if (table.empty() == false)
+    return softness_parameter(E, pressure) * pow(stress, n-1);
+
   PetscReal temp;
   EC->getAbsTemp(E, pressure, temp);
   return flow_from_temp(stress, temp, pressure, gs);
@@ -264,6 +601,98 @@ PetscReal ThermoGlenIce::flow_from_temp(PetscReal stress, PetscReal temp,
   return softness_parameter_from_temp(T_pa) * pow(stress, n-1);
 }
 
+/*! `temp` and `result` may be the same array. */
+void ThermoGlenIce::flow_from_temp_column(int N, const PetscReal *stress, const PetscReal *temp,
+                                          const PetscReal *pressure, const PetscReal *,
+                                          PetscReal *result) const {
+  const PetscReal C = beta_CC_grad / (rho * standard_gravity);
+  // pressure-adjusted temperature:
+  for (int k = 0; k < N; ++k)
+    result[k] = temp[k] + C * pressure[k];
+
+  softness_parameter_from_temp_column(N, result, result);
+
+  for (int k = 0; k < N; ++k)
+    result[k] = result[k] * pow(stress[k], n-1);
+}
+
+//! Segments: cold ice below and above the Paterson-Budd critical
+//! temperature and temperate ice.
+PetscErrorCode ThermoGlenIce::table_breakpoints(std::vector<PetscReal> &result) const {
+  PetscErrorCode ierr;
+  PetscReal x;
+
+  result.clear();
+
+  ierr = table_coordinate(table_min_temperature, 0.0, x); CHKERRQ(ierr);
+  result.push_back(x);
+
+  if (crit_temp > table_min_temperature && crit_temp < melting_point_temp) {
+    ierr = table_coordinate(crit_temp, 0.0, x); CHKERRQ(ierr);
+    result.push_back(x);
+  }
+
+  result.push_back(0.0);        // the CTS
+
+  ierr = table_coordinate(melting_point_temp, 1.0, x); CHKERRQ(ierr);
+  result.push_back(x);
+
+  return 0;
+}
+
+void ThermoGlenIce::softness_parameter_column(int N, const PetscReal *E, const PetscReal *p,
+                                              PetscReal *result) const {
+  if (table.empty() == false) {
+    table_column(N, E, p, false, result);
+    return;
+  }
+
+  EC->getPATemp_column(N, E, p, result);
+  softness_parameter_from_temp_column(N, result, result);
+}
+
+void ThermoGlenIce::hardness_parameter_column(int N, const PetscReal *E, const PetscReal *p,
+                                              PetscReal *result) const {
+  if (table.empty() == false) {
+    table_column(N, E, p, true, result);
+    return;
+  }
+
+  softness_parameter_column(N, E, p, result);
+  hardness_from_softness_column(N, result);
+}
+
+void ThermoGlenIce::flow_column(int N, const PetscReal *stress, const PetscReal *E,
+                                const PetscReal *pressure, const PetscReal *gs,
+                                PetscReal *result) const {
+  if (table.empty() == false) {
+    softness_parameter_column(N, E, pressure, result);
+    for (int k = 0; k < N; ++k)
+      result[k] = result[k] * pow(stress[k], n-1);
+    return;
+  }
+
+  EC->getAbsTemp_column(N, E, pressure, result);
+  flow_from_temp_column(N, stress, result, pressure, gs, result);
+}
+
+// ThermoGlenArrIce
+
+void ThermoGlenArrIce::softness_parameter_from_temp_column(int N, const PetscReal *T_pa,
+                                                           PetscReal *result) const {
+  const PetscReal my_A = A(), my_Q = Q();
+  for (int k = 0; k < N; ++k)
+    result[k] = my_A * exp(-my_Q/(ideal_gas_constant * T_pa[k]));
+}
+
+void ThermoGlenArrIce::flow_from_temp_column(int N, const PetscReal *stress, const PetscReal *temp,
+                                             const PetscReal *, const PetscReal *,
+                                             PetscReal *result) const {
+  softness_parameter_from_temp_column(N, temp, result);
+  for (int k = 0; k < N; ++k)
+    result[k] = result[k] * pow(stress[k], n-1);
+}
+
 // IsothermalGlenIce
 
 IsothermalGlenIce::IsothermalGlenIce(MPI_Comm c, const char pre[],
@@ -273,6 +702,25 @@ IsothermalGlenIce::IsothermalGlenIce(MPI_Comm c, const char pre[],
   hardness_B = pow(softness_A, -1/n);
 }
 
+void IsothermalGlenIce::hardness_parameter_column(int N, const PetscReal *, const PetscReal *,
+                                                  PetscReal *result) const {
+  for (int k = 0; k < N; ++k)
+    result[k] = hardness_B;
+}
+
+void IsothermalGlenIce::softness_parameter_column(int N, const PetscReal *, const PetscReal *,
+                                                  PetscReal *result) const {
+  for (int k = 0; k < N; ++k)
+    result[k] = softness_A;
+}
+
+void IsothermalGlenIce::flow_column(int N, const PetscReal *stress, const PetscReal *,
+                                    const PetscReal *, const PetscReal *,
+                                    PetscReal *result) const {
+  for (int k = 0; k < N; ++k)
+    result[k] = softness_A * pow(stress[k], n-1);
+}
+
 // HookeIce
 
 HookeIce::HookeIce(MPI_Comm c, const char pre[],
@@ -290,6 +738,13 @@ PetscReal HookeIce::softness_parameter_from_temp(PetscReal T_pa) const {
                         + 3.0 * C_Hooke * pow(Tr_Hooke - T_pa, -K_Hooke));
 }
 
+void HookeIce::softness_parameter_from_temp_column(int N, const PetscReal *T_pa,
+                                                   PetscReal *result) const {
+  for (int k = 0; k < N; ++k)
+    result[k] = A_Hooke * exp( -Q_Hooke/(ideal_gas_constant * T_pa[k])
+                               + 3.0 * C_Hooke * pow(Tr_Hooke - T_pa[k], -K_Hooke));
+}
+
 // Goldsby-Kohlstedt (forward) ice flow law
 
 GoldsbyKohlstedtIce::GoldsbyKohlstedtIce(MPI_Comm c, const char pre[],
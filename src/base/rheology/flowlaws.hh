@@ -20,6 +20,8 @@
 #define __flowlaws_hh
 
 #include <petscsys.h>
+#include <vector>
+#include "flowlaw_table.hh"
 
 class EnthalpyConverter;
 class NCConfigVariable;
@@ -53,8 +55,25 @@ static inline PetscReal secondInvariantDu(const PetscReal Du[])
   \note IceFlowLaw derived classes should implement hardness_parameter... in
   terms of softness_parameter... That way in many cases we only need to
   re-implement softness_parameter... to turn one flow law into another.
+
+  Methods with names ending in "_column" evaluate the method of the same name
+  at \c n points (levels in a column). Implementations in this class call the
+  scalar methods. Derived classes re-implement them using
+  EnthalpyConverter "_column" methods, producing identical results; a class
+  re-implementing a scalar method has to re-implement the corresponding
+  "_column" method as well.
+
+  \section flow_law_table Tabulated softness and hardness
+
+  If the configuration flag `flow_law_use_table` is set, setFromOptions()
+  replaces the softness and hardness computations with a linear
+  interpolation in a table (see IceFlowLawTable and build_table()), provided
+  that the flow law class supports it (i.e. implements table_breakpoints()).
+  The table is refined until the relative error is below
+  `flow_law_table_tolerance`; if this fails, exact formulas are used.
  */
 class IceFlowLaw {
+  friend class IceFlowLawKernels;
 public:
   IceFlowLaw(MPI_Comm c, const char pre[], const NCConfigVariable &config,
              EnthalpyConverter *EC);
@@ -80,6 +99,14 @@ public:
   virtual PetscReal flow(PetscReal stress, PetscReal E,
                          PetscReal pressure, PetscReal grainsize) const;
 
+  virtual void hardness_parameter_column(int n, const PetscReal *E, const PetscReal *p,
+                                         PetscReal *result) const;
+  virtual void softness_parameter_column(int n, const PetscReal *E, const PetscReal *p,
+                                         PetscReal *result) const;
+  virtual void flow_column(int n, const PetscReal *stress, const PetscReal *E,
+                           const PetscReal *pressure, const PetscReal *grainsize,
+                           PetscReal *result) const;
+
 protected:
   PetscReal rho,          //!< ice density
     beta_CC_grad, //!< Clausius-Clapeyron gradient
@@ -87,6 +114,24 @@ protected:
   EnthalpyConverter *EC;
 
   PetscReal softness_parameter_paterson_budd(PetscReal T_pa) const;
+  void softness_parameter_paterson_budd_column(int n, const PetscReal *T_pa,
+                                               PetscReal *result) const;
+  void hardness_from_softness_column(int n, PetscReal *softness) const;
+
+  virtual PetscErrorCode table_breakpoints(std::vector<PetscReal> &result) const;
+  PetscErrorCode table_coordinate(PetscReal T, PetscReal omega, PetscReal &result) const;
+  PetscErrorCode build_table();
+  void table_nodes(PetscReal a, PetscReal b, int N, PetscReal p,
+                   std::vector<PetscReal> &softness, std::vector<PetscReal> &hardness) const;
+  PetscReal table_error(const IceFlowLawTable &t, PetscReal a, PetscReal b, int N,
+                        PetscReal p) const;
+  void table_column(int n, const PetscReal *E, const PetscReal *p, bool hardness,
+                    PetscReal *result) const;
+
+  bool use_table;               //!< build the table in setFromOptions()
+  PetscReal table_tolerance,    //!< maximum relative error of tabulated values
+    table_min_temperature;      //!< lowest (pressure-adjusted) temperature in the table
+  IceFlowLawTable table;        //!< empty unless in use
 
   PetscReal schoofLen,schoofVel,schoofReg,
     A_cold, A_warm, Q_cold, Q_warm,  // see Paterson & Budd (1982)
@@ -111,6 +156,7 @@ PetscBool IceFlowLawUsesGrainSize(IceFlowLaw *);
   PatersonBudd] and [\ref LliboutryDuval1985].
  */
 class GPBLDIce : public IceFlowLaw {
+  friend class IceFlowLawKernels;
 public:
   GPBLDIce(MPI_Comm c, const char pre[], const NCConfigVariable &config,
            EnthalpyConverter *EC);
@@ -119,7 +165,17 @@ public:
   virtual PetscErrorCode setFromOptions();
   virtual PetscReal softness_parameter(PetscReal enthalpy,
                                        PetscReal pressure) const;
+
+  virtual void hardness_parameter_column(int n, const PetscReal *E, const PetscReal *p,
+                                         PetscReal *result) const;
+  virtual void softness_parameter_column(int n, const PetscReal *E, const PetscReal *p,
+                                         PetscReal *result) const;
+  virtual void flow_column(int n, const PetscReal *stress, const PetscReal *E,
+                           const PetscReal *pressure, const PetscReal *grainsize,
+                           PetscReal *result) const;
 protected:
+  virtual PetscErrorCode table_breakpoints(std::vector<PetscReal> &result) const;
+
   PetscReal T_0, water_frac_coeff, water_frac_observed_limit;
 };
 
@@ -139,20 +195,39 @@ public:
   virtual PetscReal flow(PetscReal stress, PetscReal E,
                          PetscReal pressure, PetscReal gs) const;
 
+  virtual void hardness_parameter_column(int n, const PetscReal *E, const PetscReal *p,
+                                         PetscReal *result) const;
+  virtual void softness_parameter_column(int n, const PetscReal *E, const PetscReal *p,
+                                         PetscReal *result) const;
+  virtual void flow_column(int n, const PetscReal *stress, const PetscReal *E,
+                           const PetscReal *pressure, const PetscReal *grainsize,
+                           PetscReal *result) const;
+
 protected:
+  virtual PetscErrorCode table_breakpoints(std::vector<PetscReal> &result) const;
+
   virtual PetscReal softness_parameter_from_temp(PetscReal T_pa) const
   { return softness_parameter_paterson_budd(T_pa); }
 
+  virtual void softness_parameter_from_temp_column(int N, const PetscReal *T_pa,
+                                                   PetscReal *result) const
+  { softness_parameter_paterson_budd_column(N, T_pa, result); }
+
   virtual PetscReal hardness_parameter_from_temp(PetscReal T_pa) const
   { return pow(softness_parameter_from_temp(T_pa), -1.0/n); }
 
   // special temperature-dependent method
   virtual PetscReal flow_from_temp(PetscReal stress, PetscReal temp,
                                    PetscReal pressure, PetscReal gs) const;
+
+  virtual void flow_from_temp_column(int n, const PetscReal *stress, const PetscReal *temp,
+                                     const PetscReal *pressure, const PetscReal *gs,
+                                     PetscReal *result) const;
 };
 
 //! Isothermal Glen ice allowing extra customization.
 class IsothermalGlenIce : public ThermoGlenIce {
+  friend class IceFlowLawKernels;
 public:
   IsothermalGlenIce(MPI_Comm c, const char pre[], const NCConfigVariable &config,
                     EnthalpyConverter *my_EC);
@@ -172,23 +247,43 @@ public:
   virtual PetscReal hardness_parameter(PetscReal, PetscReal) const
   { return hardness_B; }
 
+  virtual void hardness_parameter_column(int n, const PetscReal *, const PetscReal *,
+                                         PetscReal *result) const;
+  virtual void softness_parameter_column(int n, const PetscReal *, const PetscReal *,
+                                         PetscReal *result) const;
+  virtual void flow_column(int n, const PetscReal *stress, const PetscReal *,
+                           const PetscReal *, const PetscReal *,
+                           PetscReal *result) const;
+
 protected:
+  //! Softness is constant: there is nothing to tabulate.
+  virtual PetscErrorCode table_breakpoints(std::vector<PetscReal> &result) const
+  { result.clear(); return 0; }
+
   virtual PetscReal flow_from_temp(PetscReal stress, PetscReal,
                                    PetscReal, PetscReal ) const
   { return softness_A * pow(stress,n-1); }
 
+  virtual void flow_from_temp_column(int N, const PetscReal *stress, const PetscReal *,
+                                     const PetscReal *, const PetscReal *,
+                                     PetscReal *result) const
+  { flow_column(N, stress, NULL, NULL, NULL, result); }
+
 protected:
   PetscReal softness_A, hardness_B;
 };
 
 //! The Hooke flow law.
 class HookeIce : public ThermoGlenIce {
+  friend class IceFlowLawKernels;
 public:
   HookeIce(MPI_Comm c, const char pre[], const NCConfigVariable &config,
            EnthalpyConverter *EC);
   virtual ~HookeIce() {}
 protected:
   virtual PetscReal softness_parameter_from_temp(PetscReal T_pa) const;
+  virtual void softness_parameter_from_temp_column(int n, const PetscReal *T_pa,
+                                                   PetscReal *result) const;
 
   PetscReal A_Hooke, Q_Hooke, C_Hooke, K_Hooke, Tr_Hooke; // constants from Hooke (1981)
   // R_Hooke is the ideal_gas_constant.
@@ -207,6 +302,11 @@ public:
   { return - Q() / (ideal_gas_constant * (log(myA) - log(A()))); }
 
 protected:
+  //! flow() uses the temperature that is not pressure-adjusted, so it is not
+  //! a function of \f$E - E_{\text{cts}}(p)\f$ alone: no table.
+  virtual PetscErrorCode table_breakpoints(std::vector<PetscReal> &result) const
+  { result.clear(); return 0; }
+
   virtual PetscReal A() const { return A_cold; }
   virtual PetscReal Q() const { return Q_cold; }
 
@@ -214,11 +314,17 @@ protected:
   virtual PetscReal softness_parameter_from_temp(PetscReal T_pa) const
   { return A() * exp(-Q()/(ideal_gas_constant * T_pa)); }
 
+  virtual void softness_parameter_from_temp_column(int n, const PetscReal *T_pa,
+                                                   PetscReal *result) const;
 
   // ignores pressure and uses non-pressure-adjusted temperature
   virtual PetscReal flow_from_temp(PetscReal stress, PetscReal temp,
                                    PetscReal , PetscReal ) const
   { return softness_parameter_from_temp(temp) * pow(stress,n-1); }
+
+  virtual void flow_from_temp_column(int n, const PetscReal *stress, const PetscReal *temp,
+                                     const PetscReal *, const PetscReal *,
+                                     PetscReal *result) const;
 };
 
 //! Warm case of Paterson-Budd
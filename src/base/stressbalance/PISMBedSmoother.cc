@@ -134,6 +134,27 @@ PetscErrorCode PISMBedSmoother::deallocate() {
   return 0;
 }
 
+//! \brief Re-create Vecs used to transfer data to and from processor 0 after
+//! a change of the domain decomposition.
+/*!
+ * Vecs on processor 0 use the natural ordering, so they are kept.
+ */
+PetscErrorCode PISMBedSmoother::redistribute() {
+  PetscErrorCode ierr;
+  Vec tmp;
+
+  ierr = VecDestroy(&g2); CHKERRQ(ierr);
+  ierr = VecDestroy(&g2natural); CHKERRQ(ierr);
+  ierr = VecScatterDestroy(&scatter); CHKERRQ(ierr);
+
+  ierr = DMCreateGlobalVector(grid.da2, &g2); CHKERRQ(ierr);
+  ierr = DMDACreateNaturalVector(grid.da2, &g2natural); CHKERRQ(ierr);
+  ierr = VecScatterCreateToZero(g2natural, &scatter, &tmp); CHKERRQ(ierr);
+  ierr = VecDestroy(&tmp); CHKERRQ(ierr);
+
+  return 0;
+}
+
 
 /*!
 Input lambda gives physical half-width (in m) of square over which to do the
@@ -182,6 +182,17 @@ PetscErrorCode PISMStressBalance::extend_the_grid(PetscInt old_Mz) {
   return 0;
 }
 
+//! \brief Re-create internal objects after a change of the domain decomposition.
+PetscErrorCode PISMStressBalance::redistribute() {
+  PetscErrorCode ierr;
+
+  ierr = stress_balance->redistribute(); CHKERRQ(ierr);
+
+  ierr = modifier->redistribute(); CHKERRQ(ierr);
+
+  return 0;
+}
+
 //! Compute vertical velocity using incompressibility of the ice.
 /*!
 The vertical velocity \f$w(x,y,z,t)\f$ is the velocity <i>relative to the
@@ -114,8 +114,12 @@ public:
   //! \brief Extends the computational grid (vertically).
   virtual PetscErrorCode extend_the_grid(PetscInt old_Mz);
 
+  virtual PetscErrorCode redistribute();
+
   virtual void get_diagnostics(map<string, PISMDiagnostic*> &/*dict*/);
 
+  virtual void get_ts_diagnostics(map<string, PISMTSDiagnostic*> &dict);
+
   //! \brief Returns a pointer to a stress balance solver implementation.
   virtual ShallowStressBalance* get_stressbalance()
   { return stress_balance; }
@@ -51,6 +51,11 @@ void PISMStressBalance::get_diagnostics(map<string, PISMDiagnostic*> &dict) {
   modifier->get_diagnostics(dict);
 }
 
+void PISMStressBalance::get_ts_diagnostics(map<string, PISMTSDiagnostic*> &dict) {
+  stress_balance->get_ts_diagnostics(dict);
+  modifier->get_ts_diagnostics(dict);
+}
+
 PSB_velbar::PSB_velbar(PISMStressBalance *m, IceGrid &g, PISMVars &my_vars)
   : PISMDiag<PISMStressBalance>(m, g, my_vars) {
 
@@ -19,13 +19,19 @@
 #include "SIAFD.hh"
 #include "Mask.hh"
 #include "PISMBedSmoother.hh"
+#include "PISMColumnList.hh"
+#include "PISMColumnChunks.hh"
+#include "PISMGhostCommGroup.hh"
 #include "enthalpyConverter.hh"
 #include "PISMVars.hh"
 #include "PISMProf.hh"
 #include "flowlaw_factory.hh"
+#include "flowlaw_kernels.hh"
 
 SIAFD::~SIAFD() {
   delete bed_smoother;
+  delete columns;
+  delete flow_law_kernels;
   if (flow_law != NULL) {
     delete flow_law;
     flow_law = NULL;
@@ -50,16 +56,18 @@ PetscErrorCode SIAFD::allocate() {
     ierr = work_2d_stag[i].set_name(namestr); CHKERRQ(ierr);
   }
 
-  ierr = delta[0].create(grid, "delta_0", true); CHKERRQ(ierr);
-  ierr = delta[1].create(grid, "delta_1", true); CHKERRQ(ierr);
+  ierr = delta[0].create(grid, "delta_0"); CHKERRQ(ierr);
+  ierr = delta[1].create(grid, "delta_1"); CHKERRQ(ierr);
 
   // 3D temporary storage:
-  ierr = work_3d[0].create(grid, "work_3d_0", true); CHKERRQ(ierr);
-  ierr = work_3d[1].create(grid, "work_3d_1", true); CHKERRQ(ierr);
+  ierr = work_3d[0].create(grid, "work_3d_0"); CHKERRQ(ierr);
+  ierr = work_3d[1].create(grid, "work_3d_1"); CHKERRQ(ierr);
 
   // bed smoother
   bed_smoother = new PISMBedSmoother(grid, config, WIDE_STENCIL);
 
+  columns = new PISMColumnList(grid, static_cast<int>(config.get("grid_column_tile_size")));
+
   second_to_kiloyear = convert(1, "second", "1000 years");
 
   {
@@ -71,9 +79,98 @@ PetscErrorCode SIAFD::allocate() {
     ierr = ice_factory.create(&flow_law); CHKERRQ(ierr);
   }
 
+  // select the flow law kernel used in compute_diffusive_flux() and
+  // compute_sigma() once
+  flow_law_kernels = new IceFlowLawKernels(*flow_law);
+
   return 0;
 }
 
+//! \brief Computes \f$\delta\f$ in a column at a staggered grid point and
+//! returns the diffusivity \f$D\f$; see SIAFD::compute_diffusive_flux().
+/*!
+ * The flow law is a template parameter so that the loop over levels can be
+ * inlined; see IceFlowLawKernels.
+ */
+class SIAFD_delta_column {
+public:
+  template <class FlowLaw>
+  double operator()(const FlowLaw &flow_law) const {
+    for (PetscInt k = 0; k <= ks; ++k) {
+      const PetscReal depth = thk - zlevels[k]; // FIXME issue #15
+      // pressure added by the ice (i.e. pressure difference between the
+      // current level and the top of the column)
+      pressure[k] = rho_g * depth;
+      stress[k]   = alpha * pressure[k];
+      E[k]        = 0.5 * (E_ij[k] + E_offset[k]);
+    }
+
+    // If the flow law does not use grain size, it will just ignore it,
+    // no harm there
+    flow_column(flow_law, ks + 1, stress, E, pressure, grain_size, delta);
+
+    for (PetscInt k = 0; k <= ks; ++k) {
+      delta[k] = factor * pressure[k] * delta[k];
+    }
+
+    PetscScalar D = 0.0;
+    for (PetscInt k = 1; k <= ks; ++k) { // trapezoidal rule
+      const PetscReal depth = thk - zlevels[k];
+      const PetscScalar dz = zlevels[k] - zlevels[k-1];
+      D += 0.5 * dz * ((depth + dz) * delta[k-1] + depth * delta[k]);
+    }
+    // finish off D with (1/2) dz (0 + (H-z[ks])*delta[ks]), but dz=H-z[ks]:
+    const PetscScalar dz = thk - zlevels[ks];
+    D += 0.5 * dz * dz * delta[ks];
+
+    return D;
+  }
+
+  PetscInt ks;
+  const double *zlevels;
+  const PetscScalar *E_ij, *E_offset, *grain_size;
+  PetscScalar thk,
+    alpha,                      //!< magnitude of the surface gradient
+    factor,                     //!< 2 * enhancement factor * theta
+    rho_g;                      //!< ice density * standard gravity
+  PetscScalar *pressure, *stress, *E; //!< temporary storage (Mz each)
+  PetscScalar *delta;           //!< output
+};
+
+//! \brief Computes the strain heating \f$\Sigma\f$ in a column at a
+//! staggered grid point; see SIAFD::compute_sigma().
+class SIAFD_sigma_column {
+public:
+  template <class FlowLaw>
+  double operator()(const FlowLaw &flow_law) const {
+    getPressureFromDepth_column(flow_law, ks + 1, thk, zlevels, pressure);
+    hardness_parameter_column(flow_law, ks + 1, E, pressure, hardness);
+
+    for (PetscInt k = 0; k <= ks; ++k) {
+      PetscReal sigma_sia = delta[k] * alpha_squared * pressure[k],
+        BofT = hardness[k] * e_to_a_power;
+
+      if (grounded) {
+        // combine SIA and SSA contributions
+        PetscReal D2_sia = pow(sigma_sia / (2 * BofT), 1.0 / Sig_pow);
+        sigma[k] = 2.0 * BofT * pow(D2_sia + D2_ssa, Sig_pow);
+      } else {
+        // must be floating or ice-free, use the SSA contribution only
+        sigma[k] = 2.0 * BofT * pow(D2_ssa, Sig_pow);
+      }
+    }
+    return 0.0;
+  }
+
+  PetscInt ks;
+  bool grounded;
+  const double *zlevels;
+  const PetscScalar *E, *delta;
+  PetscScalar thk, alpha_squared, D2_ssa, Sig_pow, e_to_a_power;
+  PetscScalar *pressure, *hardness; //!< temporary storage (Mz each)
+  PetscScalar *sigma;           //!< output
+};
+
 //! \brief Initialize the SIA module.
 PetscErrorCode SIAFD::init(PISMVars &vars) {
   PetscErrorCode ierr;
@@ -83,6 +180,10 @@ PetscErrorCode SIAFD::init(PISMVars &vars) {
   ierr = verbPrintf(2, grid.com,
                     "* Initializing the SIA stress balance modifier...\n"); CHKERRQ(ierr);
 
+  ierr = verbPrintf(3, grid.com,
+                    "  using the '%s' flow law kernel\n",
+                    flow_law_kernels->name()); CHKERRQ(ierr);
+
   mask = dynamic_cast<IceModelVec2Int*>(vars.get("mask"));
   if (mask == NULL) SETERRQ(grid.com, 1, "mask is not available");
 
@@ -132,6 +233,10 @@ PetscErrorCode SIAFD::update(IceModelVec2V *vel_input, IceModelVec2S *D2_input,
     bed_state_counter = bed->get_state_counter();
   }
 
+  // Loops below visit only the columns (and staggered grid points) that can
+  // contain ice.
+  ierr = columns->update(*thickness); CHKERRQ(ierr);
+
   ierr = compute_surface_gradient(h_x, h_y); CHKERRQ(ierr);
 
   ierr = compute_diffusive_flux(h_x, h_y, diffusive_flux, fast); CHKERRQ(ierr);
@@ -466,11 +571,7 @@ PetscErrorCode SIAFD::compute_diffusive_flux(IceModelVec2Stag &h_x, IceModelVec2
 
   ierr = result.set(0.0); CHKERRQ(ierr);
 
-  PetscScalar *delta_ij;
-  delta_ij = new PetscScalar[grid.Mz];
-
-  const double enhancement_factor = flow_law->enhancement_factor(),
-    standard_gravity = config.get("standard_gravity"),
+  const double standard_gravity = config.get("standard_gravity"),
     ice_rho = config.get("ice_density");
 
   double ice_grain_size = config.get("ice_grain_size");
@@ -499,6 +600,16 @@ PetscErrorCode SIAFD::compute_diffusive_flux(IceModelVec2Stag &h_x, IceModelVec2
                                         WIDE_STENCIL,
                                         &thk_smooth); CHKERRQ(ierr);
 
+  // Columns of delta and work_3d store levels up to the (smoothed) ice
+  // surface at the staggered grid points plus one level above it, all values
+  // above the ice being equal.
+  if (full_update) {
+    for (int o = 0; o < 2; ++o) {
+      ierr = delta[o].reshape(thk_smooth, 1, true, false); CHKERRQ(ierr);
+      ierr = work_3d[o].reshape(thk_smooth, 1, true, false); CHKERRQ(ierr);
+    }
+  }
+
   ierr = theta.begin_access(); CHKERRQ(ierr);
   ierr = thk_smooth.begin_access(); CHKERRQ(ierr);
   ierr = result.begin_access(); CHKERRQ(ierr);
@@ -506,7 +617,6 @@ PetscErrorCode SIAFD::compute_diffusive_flux(IceModelVec2Stag &h_x, IceModelVec2
   ierr = h_x.begin_access(); CHKERRQ(ierr);
   ierr = h_y.begin_access(); CHKERRQ(ierr);
 
-  PetscScalar *age_ij, *age_offset;
   if (use_age) {
     ierr = age->begin_access(); CHKERRQ(ierr);
   }
@@ -517,89 +627,31 @@ PetscErrorCode SIAFD::compute_diffusive_flux(IceModelVec2Stag &h_x, IceModelVec2
   }
 
   // some flow laws use enthalpy while some ("cold ice methods") use temperature
-  PetscScalar *E_ij, *E_offset;
   ierr = enthalpy->begin_access(); CHKERRQ(ierr);
 
-  PetscScalar my_D_max = 0.0;
-  for (PetscInt o=0; o<2; o++) {
-    PetscInt GHOSTS = 1;
-    for (PetscInt   i = grid.xs - GHOSTS; i < grid.xs+grid.xm + GHOSTS; ++i) {
-      for (PetscInt j = grid.ys - GHOSTS; j < grid.ys+grid.ym + GHOSTS; ++j) {
-        // staggered point: o=0 is i+1/2, o=1 is j+1/2, (i,j) and (i+oi,j+oj)
-        //   are regular grid neighbors of a staggered point:
-        const PetscInt oi = 1 - o, oj = o;
-
-        const PetscScalar
-          thk = 0.5 * ( thk_smooth(i,j) + thk_smooth(i+oi,j+oj) );
-
-        // zero thickness case:
-        if (thk == 0.0) {
-          result(i,j,o) = 0.0;
-          if (full_update) {
-            ierr = delta[o].setColumn(i, j, 0.0); CHKERRQ(ierr);
-          }
-          continue;
-        }
-
-        if (use_age) {
-          ierr = age->getInternalColumn(i, j, &age_ij); CHKERRQ(ierr);
-          ierr = age->getInternalColumn(i+oi, j+oj, &age_offset); CHKERRQ(ierr);
-        }
-
-        ierr = enthalpy->getInternalColumn(i, j, &E_ij); CHKERRQ(ierr);
-        ierr = enthalpy->getInternalColumn(i+oi, j+oj, &E_offset); CHKERRQ(ierr);
-
-        const PetscScalar slope = (o==0) ? h_x(i,j,o) : h_y(i,j,o);
-        const PetscInt      ks = grid.kBelowHeight(thk);
-        const PetscScalar   alpha =
-          sqrt(PetscSqr(h_x(i,j,o)) + PetscSqr(h_y(i,j,o)));
-        const PetscReal theta_local = 0.5 * ( theta(i,j) + theta(i+oi,j+oj) );
-
-        PetscScalar  Dfoffset = 0.0;  // diffusivity for deformational SIA flow
-        for (PetscInt k = 0; k <= ks; ++k) {
-          PetscReal depth = thk - grid.zlevels[k]; // FIXME issue #15
-          // pressure added by the ice (i.e. pressure difference between the
-          // current level and the top of the column)
-          const PetscScalar pressure = ice_rho * standard_gravity * depth;
-
-          PetscScalar flow;
-          if (use_age) {
-            ice_grain_size = grainSizeVostok(0.5 * (age_ij[k] + age_offset[k]));
-          }
-          // If the flow law does not use grain size, it will just ignore it,
-          // no harm there
-          PetscScalar E = 0.5 * (E_ij[k] + E_offset[k]);
-          flow = flow_law->flow(alpha * pressure, E, pressure, ice_grain_size);
-
-          delta_ij[k] = enhancement_factor * theta_local * 2.0 * pressure * flow;
-
-          if (k > 0) { // trapezoidal rule
-            const PetscScalar dz = grid.zlevels[k] - grid.zlevels[k-1];
-            Dfoffset += 0.5 * dz * ((depth + dz) * delta_ij[k-1] + depth * delta_ij[k]);
-          }
-        }
-        // finish off D with (1/2) dz (0 + (H-z[ks])*delta_ij[ks]), but dz=H-z[ks]:
-        const PetscScalar dz = thk - grid.zlevels[ks];
-        Dfoffset += 0.5 * dz * dz * delta_ij[ks];
-
-        my_D_max = PetscMax(my_D_max, Dfoffset);
-
-        // vertically-averaged SIA-only flux, sans sliding; note
-        //   result(i,j,0) is  u  at E (east)  staggered point (i+1/2,j)
-        //   result(i,j,1) is  v  at N (north) staggered point (i,j+1/2)
-        result(i,j,o) = - Dfoffset * slope;
+  // The flux is zero at staggered points not in columns->staggered(); delta
+  // is not used at these points. Columns are processed in chunks, possibly
+  // by several threads at once; see PISMColumnChunks.
+  PISMColumnChunks chunks(config, columns->staggered().size());
+  vector<PetscErrorCode> errors(chunks.size(), 0);
+  vector<PetscScalar> D_max_chunk(chunks.size(), 0.0);
+
+#if (PISM_USE_OPENMP==1)
+#pragma omp parallel for schedule(dynamic, 1) num_threads(chunks.threads())
+#endif
+  for (int c = 0; c < chunks.size(); ++c) {
+    errors[c] = compute_diffusive_flux_columns(chunks.begin(c), chunks.end(c),
+                                               h_x, h_y, thk_smooth, theta,
+                                               ice_grain_size, ice_rho * standard_gravity,
+                                               full_update, use_age,
+                                               result, D_max_chunk[c]);
+  }
 
-        // if doing the full update, fill the delta column above the ice and
-        // store it:
-        if (full_update) {
-          for (PetscInt k = ks + 1; k < grid.Mz; ++k) {
-            delta_ij[k] = 0.0;
-          }
-          ierr = delta[o].setInternalColumn(i,j,delta_ij); CHKERRQ(ierr);
-        }
-      } // o
-    } // j
-  } // i
+  PetscScalar my_D_max = 0.0;
+  for (int c = 0; c < chunks.size(); ++c) {
+    CHKERRQ(errors[c]);
+    my_D_max = PetscMax(my_D_max, D_max_chunk[c]);
+  }
 
   ierr = h_y.end_access(); CHKERRQ(ierr);
   ierr = h_x.end_access(); CHKERRQ(ierr);
@@ -621,7 +673,124 @@ PetscErrorCode SIAFD::compute_diffusive_flux(IceModelVec2Stag &h_x, IceModelVec2
 
   ierr = PISMGlobalMax(&my_D_max, &D_max, grid.com); CHKERRQ(ierr);
 
+  return 0;
+}
+
+//! \brief Computes the diffusive flux (and delta, if `full_update` is set)
+//! at staggered grid points `begin`, ..., `end - 1` in columns->staggered().
+/*!
+ * Called by compute_diffusive_flux(), possibly by several threads at once
+ * (processing different columns). Sets `D_max_local` to the maximum
+ * diffusivity in these columns.
+ */
+PetscErrorCode SIAFD::compute_diffusive_flux_columns(unsigned int begin, unsigned int end,
+                                                     IceModelVec2Stag &h_x, IceModelVec2Stag &h_y,
+                                                     IceModelVec2S &thk_smooth,
+                                                     IceModelVec2S &theta,
+                                                     double ice_grain_size, double rho_g,
+                                                     bool full_update, bool use_age,
+                                                     IceModelVec2Stag &result,
+                                                     PetscScalar &D_max_local) {
+  PetscErrorCode  ierr;
+
+  PetscScalar *delta_ij, *grain_size, *work;
+  delta_ij = new PetscScalar[grid.Mz];
+  grain_size = new PetscScalar[grid.Mz];
+  work = new PetscScalar[3 * grid.Mz];
+
+  const double enhancement_factor = flow_law->enhancement_factor();
+
+  for (PetscInt k = 0; k < grid.Mz; ++k) {
+    grain_size[k] = ice_grain_size;
+  }
+
+  SIAFD_delta_column column;
+  column.zlevels    = &grid.zlevels[0];
+  column.grain_size = grain_size;
+  column.rho_g      = rho_g;
+  column.pressure   = work;
+  column.stress     = work + grid.Mz;
+  column.E          = work + 2 * grid.Mz;
+  column.delta      = delta_ij;
+
+  PetscScalar *age_ij, *age_offset;
+  PetscScalar *E_ij, *E_offset;
+
+  const vector<PISMColumnList::Column> &cols = columns->staggered();
+
+  PetscScalar my_D_max = 0.0;
+  for (PetscInt o=0; o<2; o++) {
+    for (unsigned int n = begin; n < end; ++n) {
+      const PetscInt i = cols[n].i, j = cols[n].j;
+      // staggered point: o=0 is i+1/2, o=1 is j+1/2, (i,j) and (i+oi,j+oj)
+      //   are regular grid neighbors of a staggered point:
+      const PetscInt oi = 1 - o, oj = o;
+
+      const PetscScalar
+        thk = 0.5 * ( thk_smooth(i,j) + thk_smooth(i+oi,j+oj) );
+
+      // zero thickness case:
+      if (thk == 0.0) {
+        result(i,j,o) = 0.0;
+        if (full_update) {
+          ierr = delta[o].setColumn(i, j, 0.0); CHKERRQ(ierr);
+        }
+        continue;
+      }
+
+      if (use_age) {
+        ierr = age->getInternalColumn(i, j, &age_ij); CHKERRQ(ierr);
+        ierr = age->getInternalColumn(i+oi, j+oj, &age_offset); CHKERRQ(ierr);
+      }
+
+      ierr = enthalpy->getInternalColumn(i, j, &E_ij); CHKERRQ(ierr);
+      ierr = enthalpy->getInternalColumn(i+oi, j+oj, &E_offset); CHKERRQ(ierr);
+
+      const PetscScalar slope = (o==0) ? h_x(i,j,o) : h_y(i,j,o);
+      const PetscInt      ks = grid.kBelowHeight(thk);
+      const PetscScalar   alpha =
+        sqrt(PetscSqr(h_x(i,j,o)) + PetscSqr(h_y(i,j,o)));
+      const PetscReal theta_local = 0.5 * ( theta(i,j) + theta(i+oi,j+oj) );
+
+      if (use_age) {
+        for (PetscInt k = 0; k <= ks; ++k) {
+          grain_size[k] = grainSizeVostok(0.5 * (age_ij[k] + age_offset[k]));
+        }
+      }
+
+      column.ks       = ks;
+      column.E_ij     = E_ij;
+      column.E_offset = E_offset;
+      column.thk      = thk;
+      column.alpha    = alpha;
+      column.factor   = enhancement_factor * theta_local * 2.0;
+
+      // diffusivity for deformational SIA flow
+      const PetscScalar Dfoffset = flow_law_kernels->apply(column);
+
+      my_D_max = PetscMax(my_D_max, Dfoffset);
+
+      // vertically-averaged SIA-only flux, sans sliding; note
+      //   result(i,j,0) is  u  at E (east)  staggered point (i+1/2,j)
+      //   result(i,j,1) is  v  at N (north) staggered point (i,j+1/2)
+      result(i,j,o) = - Dfoffset * slope;
+
+      // if doing the full update, fill the delta column above the ice and
+      // store it:
+      if (full_update) {
+        for (PetscInt k = ks + 1; k < delta[o].n_stored(i, j); ++k) {
+          delta_ij[k] = 0.0;
+        }
+        ierr = delta[o].setInternalColumn(i,j,delta_ij); CHKERRQ(ierr);
+      }
+    } // n
+  } // o
+
+  D_max_local = my_D_max;
+
   delete [] delta_ij;
+  delete [] grain_size;
+  delete [] work;
 
   return 0;
 }
@@ -643,6 +812,7 @@ PetscErrorCode SIAFD::compute_diffusivity(IceModelVec2S &result) {
   // delta on the staggered grid:
   IceModelVec2Stag D_stag = work_2d_stag[0];
   PetscScalar *delta_ij;
+  PetscInt n;
   IceModelVec2S thk_smooth = work_2d[0];
 
   ierr = bed_smoother->get_smoothed_thk(*surface, *thickness, *mask,
@@ -658,7 +828,7 @@ PetscErrorCode SIAFD::compute_diffusivity(IceModelVec2S &result) {
       for (int o = 0; o < 2; ++o) {
         const PetscInt oi = 1 - o, oj = o;
 
-        ierr = delta[o].getInternalColumn(i,j,&delta_ij); CHKERRQ(ierr);
+        ierr = delta[o].getInternalColumn(i,j,&delta_ij,n); CHKERRQ(ierr);
 
         const PetscScalar
           thk = 0.5 * ( thk_smooth(i,j) + thk_smooth(i+oi,j+oj) );
@@ -668,7 +838,9 @@ PetscErrorCode SIAFD::compute_diffusivity(IceModelVec2S &result) {
           continue;
         }
 
-        const PetscInt ks = grid.kBelowHeight(thk);
+        // delta was stored during the last full update and may have fewer
+        // levels than needed here
+        const PetscInt ks = PetscMin(grid.kBelowHeight(thk), n - 1);
         PetscScalar Dfoffset = 0.0;
 
         for (PetscInt k = 1; k <= ks; ++k) {
@@ -706,11 +878,23 @@ PetscErrorCode SIAFD::extend_the_grid(PetscInt old_Mz) {
 
   ierr = SSB_Modifier::extend_the_grid(old_Mz); CHKERRQ(ierr);
 
-  ierr = delta[0].extend_vertically(old_Mz, 0.0); CHKERRQ(ierr);
-  ierr = delta[1].extend_vertically(old_Mz, 0.0); CHKERRQ(ierr);
+  // delta and work_3d are re-shaped (using the new grid) during the next
+  // full update; see compute_diffusive_flux()
+
+  return 0;
+}
+
+//! \brief Re-create internal objects after a change of the domain decomposition.
+PetscErrorCode SIAFD::redistribute() {
+  PetscErrorCode ierr;
+
+  ierr = bed_smoother->redistribute(); CHKERRQ(ierr);
 
-  ierr = work_3d[0].extend_vertically(old_Mz, 0.0); CHKERRQ(ierr);
-  ierr = work_3d[1].extend_vertically(old_Mz, 0.0); CHKERRQ(ierr);
+  // values in delta and work_3d are re-computed during the next full update
+  for (int o = 0; o < 2; ++o) {
+    ierr = delta[o].redistribute(); CHKERRQ(ierr);
+    ierr = work_3d[o].redistribute(); CHKERRQ(ierr);
+  }
 
   return 0;
 }
@@ -739,10 +923,11 @@ PetscErrorCode SIAFD::compute_sigma(IceModelVec2S *D2_input,
                                     IceModelVec2Stag &h_y) {
   PetscErrorCode ierr;
   PetscScalar *sigma_ij, *delta_ij, *E;
+  PetscInt n_sigma, n_delta;
 
   // aliases
   IceModelVec2S thk_smooth = work_2d[0];
-  IceModelVec3 sigma[2] = {work_3d[0], work_3d[1]};
+  IceModelVec3Ragged *sigma = work_3d;
 
   ierr = bed_smoother->get_smoothed_thk(*surface, *thickness, *mask,
                                         WIDE_STENCIL,
@@ -767,51 +952,54 @@ PetscErrorCode SIAFD::compute_sigma(IceModelVec2S *D2_input,
     Sig_pow = (1.0 + n_glen) / (2.0 * n_glen),
     e_to_a_power = pow(enhancement_factor,-1/n_glen);
 
-  for (PetscInt o = 0; o < 2; ++o) {
-    PetscInt GHOSTS = 1;
-    for (PetscInt   i = grid.xs - GHOSTS; i < grid.xs+grid.xm + GHOSTS; ++i) {
-      for (PetscInt j = grid.ys - GHOSTS; j < grid.ys+grid.ym + GHOSTS; ++j) {
-        const PetscInt oi = 1-o, oj=o;
-
-        ierr = delta[o].getInternalColumn(i,j,&delta_ij); CHKERRQ(ierr);
-        ierr = sigma[o].getInternalColumn(i,j,&sigma_ij); CHKERRQ(ierr);
-        ierr = enthalpy->getInternalColumn(i,j,&E); CHKERRQ(ierr);
+  // sigma is computed at staggered points in columns->staggered() only;
+  // these are the ones used to compute Sigma in icy columns below
+  const vector<PISMColumnList::Column> &cols = columns->staggered();
 
-        const PetscScalar
-          thk = 0.5 * ( thk_smooth(i,j) + thk_smooth(i+oi,j+oj) );
+  PetscScalar *work = new PetscScalar[2 * grid.Mz];
 
-        const PetscInt ks = grid.kBelowHeight(thk);
+  SIAFD_sigma_column column;
+  column.zlevels      = &grid.zlevels[0];
+  column.Sig_pow      = Sig_pow;
+  column.e_to_a_power = e_to_a_power;
+  column.pressure     = work;
+  column.hardness     = work + grid.Mz;
 
-        // alpha_squared is the square of the magnitude of the surface gradient
-        const PetscScalar alpha_squared =
-          PetscSqr(h_x(i,j,o)) + PetscSqr(h_y(i,j,o));
-
-        // in the ice:
-        for (PetscInt k=0; k<=ks; ++k) {
-          PetscReal depth = thk - grid.zlevels[k];
-          PetscReal pressure = EC.getPressureFromDepth(depth);
-
-          PetscReal sigma_sia = delta_ij[k] * alpha_squared * pressure,
-            BofT = flow_law->hardness_parameter(E[k], pressure) * e_to_a_power,
-            D2_ssa = (*D2_input)(i,j);
-
-          if (M.grounded_ice(i, j)) {
-            // combine SIA and SSA contributions
-            PetscReal D2_sia = pow(sigma_sia / (2 * BofT), 1.0 / Sig_pow);
-            sigma_ij[k] = 2.0 * BofT * pow(D2_sia + D2_ssa, Sig_pow);
-          } else {
-            // must be floating or ice-free, use the SSA contribution only
-            sigma_ij[k] = 2.0 * BofT * pow(D2_ssa, Sig_pow);
-          }
-        }
-
-        // above the ice:
-        for (PetscInt k=ks+1; k<grid.Mz; ++k) {
-          sigma_ij[k] = 0.0;
-        }
-      } // j
-    }   // i
-  }     // o
+  for (PetscInt o = 0; o < 2; ++o) {
+    for (unsigned int n = 0; n < cols.size(); ++n) {
+      const PetscInt i = cols[n].i, j = cols[n].j;
+      const PetscInt oi = 1-o, oj=o;
+
+      ierr = delta[o].getInternalColumn(i,j,&delta_ij,n_delta); CHKERRQ(ierr);
+      ierr = sigma[o].getInternalColumn(i,j,&sigma_ij,n_sigma); CHKERRQ(ierr);
+      ierr = enthalpy->getInternalColumn(i,j,&E); CHKERRQ(ierr);
+
+      const PetscScalar
+        thk = 0.5 * ( thk_smooth(i,j) + thk_smooth(i+oi,j+oj) );
+
+      const PetscInt ks = grid.kBelowHeight(thk);
+
+      // alpha_squared is the square of the magnitude of the surface gradient
+      const PetscScalar alpha_squared =
+        PetscSqr(h_x(i,j,o)) + PetscSqr(h_y(i,j,o));
+
+      // in the ice:
+      column.ks            = ks;
+      column.grounded      = M.grounded_ice(i, j);
+      column.E             = E;
+      column.delta         = delta_ij;
+      column.thk           = thk;
+      column.alpha_squared = alpha_squared;
+      column.D2_ssa        = (*D2_input)(i,j);
+      column.sigma         = sigma_ij;
+      flow_law_kernels->apply(column);
+
+      // above the ice (stored levels only):
+      for (PetscInt k=ks+1; k<n_sigma; ++k) {
+        sigma_ij[k] = 0.0;
+      }
+    } // n
+  }   // o
 
   ierr = mask->end_access(); CHKERRQ(ierr);
   ierr = D2_input->end_access(); CHKERRQ(ierr);
@@ -822,31 +1010,40 @@ PetscErrorCode SIAFD::compute_sigma(IceModelVec2S *D2_input,
   ierr = delta[0].end_access(); CHKERRQ(ierr);
   ierr = enthalpy->end_access(); CHKERRQ(ierr);
 
+  delete [] work;
+
   // Now transfer Sigma from the staggered onto the regular grid.
+  // sigma columns next to an icy column store all the levels in the ice there
   PetscScalar *Sigmareg, *SigmaEAST, *SigmaWEST, *SigmaNORTH, *SigmaSOUTH;
+  PetscInt n_E, n_W, n_N, n_S;
+  const vector<PISMColumnList::Column> &owned = columns->owned();
+  const unsigned int n_icy = columns->icy_count();
   ierr = Sigma.begin_access(); CHKERRQ(ierr);
-  for (PetscInt i=grid.xs; i<grid.xs+grid.xm; ++i) {
-    for (PetscInt j=grid.ys; j<grid.ys+grid.ym; ++j) {
-      PetscReal thk = thk_smooth(i,j);
-      if (thk > 0.0) {
-        // horizontally average Sigma onto regular grid
-        const PetscInt ks = grid.kBelowHeight(thk);
-        ierr = Sigma.getInternalColumn(i,j,&Sigmareg); CHKERRQ(ierr);
-        ierr = sigma[0].getInternalColumn(i,j,&SigmaEAST); CHKERRQ(ierr);
-        ierr = sigma[0].getInternalColumn(i-1,j,&SigmaWEST); CHKERRQ(ierr);
-        ierr = sigma[1].getInternalColumn(i,j,&SigmaNORTH); CHKERRQ(ierr);
-        ierr = sigma[1].getInternalColumn(i,j-1,&SigmaSOUTH); CHKERRQ(ierr);
-        for (PetscInt k = 0; k <= ks; ++k) {
-          Sigmareg[k] = 0.25 * (SigmaEAST[k] + SigmaWEST[k] + SigmaNORTH[k] + SigmaSOUTH[k]);
-        }
-        for (PetscInt k = ks+1; k < grid.Mz; ++k) {
-          Sigmareg[k] = 0.0;
-        }
-      } else { // zero thickness case
-        ierr = Sigma.setColumn(i,j,0.0); CHKERRQ(ierr);
+  for (unsigned int n = 0; n < n_icy; ++n) {
+    const PetscInt i = owned[n].i, j = owned[n].j;
+    PetscReal thk = thk_smooth(i,j);
+    if (thk > 0.0) {
+      // horizontally average Sigma onto regular grid
+      const PetscInt ks = grid.kBelowHeight(thk);
+      ierr = Sigma.getInternalColumn(i,j,&Sigmareg); CHKERRQ(ierr);
+      ierr = sigma[0].getInternalColumn(i,j,&SigmaEAST,n_E); CHKERRQ(ierr);
+      ierr = sigma[0].getInternalColumn(i-1,j,&SigmaWEST,n_W); CHKERRQ(ierr);
+      ierr = sigma[1].getInternalColumn(i,j,&SigmaNORTH,n_N); CHKERRQ(ierr);
+      ierr = sigma[1].getInternalColumn(i,j-1,&SigmaSOUTH,n_S); CHKERRQ(ierr);
+      for (PetscInt k = 0; k <= ks; ++k) {
+        Sigmareg[k] = 0.25 * (SigmaEAST[k] + SigmaWEST[k] + SigmaNORTH[k] + SigmaSOUTH[k]);
+      }
+      for (PetscInt k = ks+1; k < grid.Mz; ++k) {
+        Sigmareg[k] = 0.0;
       }
+    } else { // zero (smoothed) thickness case
+      ierr = Sigma.setColumn(i,j,0.0); CHKERRQ(ierr);
     }
   }
+  // ice-free columns
+  for (unsigned int n = n_icy; n < owned.size(); ++n) {
+    ierr = Sigma.setColumn(owned[n].i, owned[n].j, 0.0); CHKERRQ(ierr);
+  }
   ierr = Sigma.end_access(); CHKERRQ(ierr);
 
   ierr = thk_smooth.end_access(); CHKERRQ(ierr);
@@ -871,44 +1068,49 @@ PetscErrorCode SIAFD::compute_sigma(IceModelVec2S *D2_input,
 PetscErrorCode SIAFD::compute_I() {
   PetscErrorCode ierr;
   PetscScalar *I_ij, *delta_ij;
+  PetscInt n_I, n_delta;
 
   IceModelVec2S thk_smooth = work_2d[0];
-  IceModelVec3 I[2] = {work_3d[0], work_3d[1]};
+  IceModelVec3Ragged *I = work_3d;
 
   ierr = bed_smoother->get_smoothed_thk(*surface, *thickness, *mask,
                                         WIDE_STENCIL,
                                         &thk_smooth); CHKERRQ(ierr);
 
+  // I is zero at staggered points that are not in columns->staggered()
+  ierr = I[0].set(0.0); CHKERRQ(ierr);
+  ierr = I[1].set(0.0); CHKERRQ(ierr);
+
   ierr = delta[0].begin_access(); CHKERRQ(ierr);
   ierr = delta[1].begin_access(); CHKERRQ(ierr);
   ierr = I[0].begin_access(); CHKERRQ(ierr);
   ierr = I[1].begin_access(); CHKERRQ(ierr);
   ierr = thk_smooth.begin_access(); CHKERRQ(ierr);
 
-  for (PetscInt o = 0; o < 2; ++o) {
-    PetscInt GHOSTS = 1;
-    for (PetscInt   i = grid.xs - GHOSTS; i < grid.xs+grid.xm + GHOSTS; ++i) {
-      for (PetscInt j = grid.ys - GHOSTS; j < grid.ys+grid.ym + GHOSTS; ++j) {
-        const PetscInt oi = 1-o, oj=o;
-        const PetscReal
-          thk = 0.5 * ( thk_smooth(i,j) + thk_smooth(i+oi,j+oj) );
-
-        ierr = delta[o].getInternalColumn(i,j,&delta_ij); CHKERRQ(ierr);
-        ierr = I[o].getInternalColumn(i,j,&I_ij); CHKERRQ(ierr);
+  const vector<PISMColumnList::Column> &cols = columns->staggered();
 
-        const PetscInt ks = grid.kBelowHeight(thk);
-
-        // within the ice:
-        I_ij[0] = 0.0;
-        for (int k = 1; k <= ks; ++k) {
-          const PetscReal dz = grid.zlevels[k] - grid.zlevels[k-1];
-          // trapezoidal rule
-          I_ij[k] = I_ij[k-1] + 0.5 * dz * (delta_ij[k-1] + delta_ij[k]);
-        }
-        // above the ice:
-        for (PetscInt k = ks + 1; k < grid.Mz; ++k) {
-          I_ij[k] = I_ij[ks];
-        }
+  for (PetscInt o = 0; o < 2; ++o) {
+    for (unsigned int n = 0; n < cols.size(); ++n) {
+      const PetscInt i = cols[n].i, j = cols[n].j;
+      const PetscInt oi = 1-o, oj=o;
+      const PetscReal
+        thk = 0.5 * ( thk_smooth(i,j) + thk_smooth(i+oi,j+oj) );
+
+      ierr = delta[o].getInternalColumn(i,j,&delta_ij,n_delta); CHKERRQ(ierr);
+      ierr = I[o].getInternalColumn(i,j,&I_ij,n_I); CHKERRQ(ierr);
+
+      const PetscInt ks = grid.kBelowHeight(thk);
+
+      // within the ice:
+      I_ij[0] = 0.0;
+      for (int k = 1; k <= ks; ++k) {
+        const PetscReal dz = grid.zlevels[k] - grid.zlevels[k-1];
+        // trapezoidal rule
+        I_ij[k] = I_ij[k-1] + 0.5 * dz * (delta_ij[k-1] + delta_ij[k]);
+      }
+      // above the ice (stored levels only):
+      for (PetscInt k = ks + 1; k < n_I; ++k) {
+        I_ij[k] = I_ij[ks];
       }
     }
   }
@@ -947,9 +1149,10 @@ PetscErrorCode SIAFD::compute_3d_horizontal_velocity(IceModelVec2Stag &h_x, IceM
 
   ierr = compute_I(); CHKERRQ(ierr);
   // after the compute_I() call work_3d[0,1] contains I on the staggered grid
-  IceModelVec3 I[2] = {work_3d[0], work_3d[1]};
+  IceModelVec3Ragged *I = work_3d;
 
   PetscScalar *u_ij, *v_ij, *IEAST, *IWEST, *INORTH, *ISOUTH;
+  PetscInt n_E, n_W, n_N, n_S;
 
   ierr = u_out.begin_access(); CHKERRQ(ierr);
   ierr = v_out.begin_access(); CHKERRQ(ierr);
@@ -961,12 +1164,36 @@ PetscErrorCode SIAFD::compute_3d_horizontal_velocity(IceModelVec2Stag &h_x, IceM
   ierr = I[0].begin_access(); CHKERRQ(ierr);
   ierr = I[1].begin_access(); CHKERRQ(ierr);
 
-  for (PetscInt i=grid.xs; i<grid.xs+grid.xm; ++i) {
-    for (PetscInt j=grid.ys; j<grid.ys+grid.ym; ++j) {
-      ierr = I[0].getInternalColumn(i, j, &IEAST); CHKERRQ(ierr);
-      ierr = I[0].getInternalColumn(i - 1, j, &IWEST); CHKERRQ(ierr);
-      ierr = I[1].getInternalColumn(i, j, &INORTH); CHKERRQ(ierr);
-      ierr = I[1].getInternalColumn(i, j - 1, &ISOUTH); CHKERRQ(ierr);
+  // I is zero at all four staggered points around a column that is neither
+  // icy nor next to an icy column
+  const vector<PISMColumnList::Column> &owned = columns->owned();
+  const unsigned int n_near_ice = columns->icy_count() + columns->margin_count();
+
+  // Ghost values of the result come from columns in the strip along
+  // sub-domain edges. If requested, these are computed first so that the
+  // ghost update can proceed while the interior is computed.
+  const bool overlap = config.get_flag("grid_overlap_communication");
+  const PetscInt width = PetscMax(u_out.get_stencil_width(), v_out.get_stencil_width());
+  PISMGhostCommGroup ghosts(grid);
+  ierr = ghosts.add(u_out); CHKERRQ(ierr);
+  ierr = ghosts.add(v_out); CHKERRQ(ierr);
+
+  for (int pass = 0; pass < (overlap ? 2 : 1); ++pass) {
+    const bool interior_pass = (pass == 1);
+
+    if (interior_pass) {
+      ierr = ghosts.beginGhostComm(); CHKERRQ(ierr);
+    }
+
+    for (unsigned int n = 0; n < n_near_ice; ++n) {
+      const PetscInt i = owned[n].i, j = owned[n].j;
+      if (overlap && grid.is_interior(i, j, width) != interior_pass)
+        continue;
+
+      ierr = I[0].getInternalColumn(i, j, &IEAST, n_E); CHKERRQ(ierr);
+      ierr = I[0].getInternalColumn(i - 1, j, &IWEST, n_W); CHKERRQ(ierr);
+      ierr = I[1].getInternalColumn(i, j, &INORTH, n_N); CHKERRQ(ierr);
+      ierr = I[1].getInternalColumn(i, j - 1, &ISOUTH, n_S); CHKERRQ(ierr);
 
       ierr = u_out.getInternalColumn(i, j, &u_ij); CHKERRQ(ierr);
       ierr = v_out.getInternalColumn(i, j, &v_ij); CHKERRQ(ierr);
@@ -982,16 +1209,30 @@ PetscErrorCode SIAFD::compute_3d_horizontal_velocity(IceModelVec2Stag &h_x, IceM
         vel_input_v = (*vel_input)(i, j).v;
 
       for (PetscInt k = 0; k < grid.Mz; ++k) {
-        u_ij[k] = - 0.25 * ( IEAST[k]  * h_x_e + IWEST[k]  * h_x_w +
-                             INORTH[k] * h_x_n + ISOUTH[k] * h_x_s );
-        v_ij[k] = - 0.25 * ( IEAST[k]  * h_y_e + IWEST[k]  * h_y_w +
-                             INORTH[k] * h_y_n + ISOUTH[k] * h_y_s );
+        // I is constant above the top stored level
+        const PetscScalar
+          I_e = IEAST[PetscMin(k, n_E - 1)], I_w = IWEST[PetscMin(k, n_W - 1)],
+          I_n = INORTH[PetscMin(k, n_N - 1)], I_s = ISOUTH[PetscMin(k, n_S - 1)];
+
+        u_ij[k] = - 0.25 * ( I_e * h_x_e + I_w * h_x_w +
+                             I_n * h_x_n + I_s * h_x_s );
+        v_ij[k] = - 0.25 * ( I_e * h_y_e + I_w * h_y_w +
+                             I_n * h_y_n + I_s * h_y_s );
 
         // Add the "SSA" velocity:
         u_ij[k] += vel_input_u;
         v_ij[k] += vel_input_v;
       }
     }
+
+    // far from the ice the velocity is just the "SSA" velocity
+    for (unsigned int n = n_near_ice; n < owned.size(); ++n) {
+      const PetscInt i = owned[n].i, j = owned[n].j;
+      if (overlap && grid.is_interior(i, j, width) != interior_pass)
+        continue;
+      ierr = u_out.setColumn(i, j, (*vel_input)(i, j).u); CHKERRQ(ierr);
+      ierr = v_out.setColumn(i, j, (*vel_input)(i, j).v); CHKERRQ(ierr);
+    }
   }
 
   ierr = I[1].end_access(); CHKERRQ(ierr);
@@ -1005,10 +1246,10 @@ PetscErrorCode SIAFD::compute_3d_horizontal_velocity(IceModelVec2Stag &h_x, IceM
   ierr = v_out.end_access(); CHKERRQ(ierr);
 
   // Communicate to get ghosts:
-  ierr = u_out.beginGhostComm(); CHKERRQ(ierr);
-  ierr = v_out.beginGhostComm(); CHKERRQ(ierr);
-  ierr = u_out.endGhostComm(); CHKERRQ(ierr);
-  ierr = v_out.endGhostComm(); CHKERRQ(ierr);
+  if (!overlap) {
+    ierr = ghosts.beginGhostComm(); CHKERRQ(ierr);
+  }
+  ierr = ghosts.endGhostComm(); CHKERRQ(ierr);
 
   return 0;
 }
@@ -21,8 +21,11 @@
 
 #include "SSB_Modifier.hh"      // derivesfrom SSB_Modifier
 #include "PISMDiagnostic.hh"    // derives from PISMDiag
+#include "iceModelVec3Ragged.hh"
 
 class PISMBedSmoother;
+class PISMColumnList;
+class IceFlowLawKernels;
 
 class SIAFD : public SSB_Modifier
 {
@@ -48,6 +51,8 @@ public:
   //! \brief Extends the computational grid (vertically).
   virtual PetscErrorCode extend_the_grid(PetscInt old_Mz);
 
+  virtual PetscErrorCode redistribute();
+
   //! Add pointers to diagnostic quantities to a dictionary.
   virtual void get_diagnostics(map<string, PISMDiagnostic*> &dict);
 
@@ -77,6 +82,14 @@ protected:
 
   virtual PetscErrorCode compute_diffusive_flux(IceModelVec2Stag &h_x, IceModelVec2Stag &h_y,
                                                 IceModelVec2Stag &result, bool fast);
+  virtual PetscErrorCode compute_diffusive_flux_columns(unsigned int begin, unsigned int end,
+                                                        IceModelVec2Stag &h_x, IceModelVec2Stag &h_y,
+                                                        IceModelVec2S &thk_smooth,
+                                                        IceModelVec2S &theta,
+                                                        double ice_grain_size, double rho_g,
+                                                        bool full_update, bool use_age,
+                                                        IceModelVec2Stag &result,
+                                                        PetscScalar &D_max_local);
 
   virtual PetscErrorCode compute_3d_horizontal_velocity(IceModelVec2Stag &h_x, IceModelVec2Stag &h_y,
                                                         IceModelVec2V *vel_input,
@@ -98,11 +111,15 @@ protected:
   // temporary storage:
   IceModelVec2S work_2d[2];         // for eta, theta and the smoothed thickness
   IceModelVec2Stag work_2d_stag[2]; // for the surface gradient
-  IceModelVec3 delta[2];            // store delta on the staggered grid
-  IceModelVec3 work_3d[2];      // replaces old Sigmastag3 and Istag3; used to
-                                // store I and Sigma on the staggered grid
+  // 3D fields on the staggered grid store levels up to the ice surface only;
+  // see compute_diffusive_flux()
+  IceModelVec3Ragged delta[2];   // store delta on the staggered grid
+  IceModelVec3Ragged work_3d[2]; // replaces old Sigmastag3 and Istag3; used to
+                                 // store I and Sigma on the staggered grid
 
   PISMBedSmoother *bed_smoother;
+  PISMColumnList *columns;      //!< columns of the current ice geometry; see update()
+  IceFlowLawKernels *flow_law_kernels; //!< non-virtual copy of flow_law; see allocate()
   const PetscInt WIDE_STENCIL;
   int bed_state_counter;
 
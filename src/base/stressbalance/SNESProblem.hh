@@ -171,6 +171,7 @@ PetscErrorCode SNESProblem<DOF,U>::finalize() {
 
   ierr = SNESDestroy(&m_snes);CHKERRQ(ierr);
   ierr = VecDestroy(&m_X); CHKERRQ(ierr);
+  ierr = DMDestroy(&m_DA); CHKERRQ(ierr);
 
   return 0;
 }
@@ -25,6 +25,8 @@
 #include "flowlaw_factory.hh"
 #include "PIO.hh"
 
+#include "pism_petsc32_compat.hh"
+
 SSA::SSA(IceGrid &g, IceBasalResistancePlasticLaw &b,
          EnthalpyConverter &e,
          const NCConfigVariable &c)
@@ -38,6 +40,7 @@ SSA::SSA(IceGrid &g, IceBasalResistancePlasticLaw &b,
   enthalpy = NULL;
   driving_stress_x = NULL;
   driving_stress_y = NULL;
+  history_length = 0;
 
   strength_extension = new SSAStrengthExtension(config);
   allocate();
@@ -143,12 +146,46 @@ PetscErrorCode SSA::allocate() {
                                 "old SSA velocity field; used for re-trying with a different epsilon",
                                 "m s-1", ""); CHKERRQ(ierr);
 
+  // solutions used to extrapolate the initial guess (see
+  // extrapolate_velocity()); allocated only if needed
+  const int history_size = PetscMin(static_cast<int>(config.get("ssa_extrapolation_order")), 2) + 1;
+  for (int k = 0; k < history_size && history_size > 1; ++k) {
+    char name[TEMPORARY_STRING_LENGTH];
+    snprintf(name, TEMPORARY_STRING_LENGTH, "velocity_history_%d", k);
+    ierr = velocity_history[k].create(grid, name, true); CHKERRQ(ierr);
+    ierr = velocity_history[k].set_attrs("internal",
+                                         "SSA velocity computed by a recent solve",
+                                         "m s-1", ""); CHKERRQ(ierr);
+  }
+
   // override velocity metadata
   vector<string> long_names;
   long_names.push_back("SSA model ice velocity in the X direction");
   long_names.push_back("SSA model ice velocity in the Y direction");
   ierr = velocity.rename("_ssa",long_names,""); CHKERRQ(ierr);
 
+  ierr = create_da(SSADA); CHKERRQ(ierr);
+
+  ierr = DMCreateGlobalVector(SSADA, &SSAX); CHKERRQ(ierr);
+
+  {
+    IceFlowLawFactory ice_factory(grid.com, "ssa_", config, &EC);
+    ice_factory.removeType(ICE_GOLDSBY_KOHLSTEDT);
+
+    ierr = ice_factory.setType(config.get_string("ssa_flow_law").c_str()); CHKERRQ(ierr);
+
+    ierr = ice_factory.setFromOptions(); CHKERRQ(ierr);
+    ierr = ice_factory.create(&flow_law); CHKERRQ(ierr);
+  }
+
+  return 0;
+}
+
+
+//! \brief Create the dof=2 DA used by the SSA solver.
+PetscErrorCode SSA::create_da(DM &result) {
+  PetscErrorCode ierr;
+
   // mimic IceGrid::createDA() with TRANSPOSE :
   PetscInt dof=2, stencil_width=1;
   ierr = DMDACreate2d(grid.com,
@@ -158,23 +195,169 @@ PetscErrorCode SSA::allocate() {
                       grid.Ny, grid.Nx,
                       dof, stencil_width,
                       &grid.procs_y[0], &grid.procs_x[0],
-                      &SSADA); CHKERRQ(ierr);
+                      &result); CHKERRQ(ierr);
 
-  ierr = DMCreateGlobalVector(SSADA, &SSAX); CHKERRQ(ierr);
+  return 0;
+}
 
-  {
-    IceFlowLawFactory ice_factory(grid.com, "ssa_", config, &EC);
-    ice_factory.removeType(ICE_GOLDSBY_KOHLSTEDT);
+//! \brief Selects the multigrid preconditioner for a KSP solving a system on
+//! SSADA, if requested (see the configuration parameter \c ssa_preconditioner).
+/*!
+ * The hierarchy of grids is obtained by coarsening SSADA (by a factor of two
+ * in each direction, see mg_levels()); PETSc computes interpolation operators
+ * from it. Coarse level operators are Galerkin (\f$ R A P \f$) products, so
+ * the coefficients of the SSA (nu*H, the basal resistance and the masks) are
+ * restricted to coarse levels implicitly. This includes ice-free and Dirichlet
+ * boundary condition rows (scaled identity rows), so all SSA solvers can use
+ * this preconditioner without level-specific assembly code.
+ *
+ * Leaves the preconditioner unchanged if the multigrid preconditioner is not
+ * requested or the grid cannot be coarsened. Runtime options (e.g.
+ * <tt>-pc_mg_levels</tt> and <tt>-mg_levels_ksp_type</tt>) can override these
+ * settings.
+ *
+ * Galerkin products require AIJ matrices.
+ */
+PetscErrorCode SSA::set_preconditioner(KSP ksp) {
+  PetscErrorCode ierr;
+  PC pc;
 
-    ierr = ice_factory.setType(config.get_string("ssa_flow_law").c_str()); CHKERRQ(ierr);
+  if (config.get_string("ssa_preconditioner") != "mg")
+    return 0;
 
-    ierr = ice_factory.setFromOptions(); CHKERRQ(ierr);
-    ierr = ice_factory.create(&flow_law); CHKERRQ(ierr);
+  const PetscInt levels = mg_levels();
+  if (levels < 2) {
+    ierr = verbPrintf(2, grid.com,
+                      "PISM WARNING: cannot coarsen the %d x %d grid to build the SSA multigrid\n"
+                      "  preconditioner (see -ssa_mg_coarse_size). Using the default preconditioner...\n",
+                      grid.Mx, grid.My); CHKERRQ(ierr);
+    return 0;
   }
 
+  ierr = KSPGetPC(ksp, &pc); CHKERRQ(ierr);
+  ierr = PCSetType(pc, PCMG); CHKERRQ(ierr);
+  ierr = PCMGSetLevels(pc, levels, PETSC_NULL); CHKERRQ(ierr);
+  ierr = PCMGSetGalerkin(pc, PETSC_TRUE); CHKERRQ(ierr);
+  // PCMG gets the hierarchy of grids and interpolation operators from SSADA
+  ierr = PCSetDM(pc, SSADA); CHKERRQ(ierr);
+
+  ierr = verbPrintf(3, grid.com,
+                    "  SSA: using a %d-level multigrid preconditioner\n", levels); CHKERRQ(ierr);
+
   return 0;
 }
 
+//! \brief Computes ownership ranges of a periodic DMDA coarsened by a factor
+//! of two, mimicking the way PETSc's DMCoarsen() does it.
+/*!
+ * Returns false if PETSc would fail to find compatible ranges (coarse
+ * subdomains have to cover the fine ones within `stencil_width`) or if a
+ * coarse subdomain would have fewer than two points.
+ */
+static bool coarsen_ownership_ranges(const vector<int> &fine, int stencil_width,
+                                     vector<int> &coarse) {
+  const int m = static_cast<int>(fine.size()), ratio = 2;
+
+  int total = 0;
+  for (int i = 0; i < m; ++i)
+    total += fine[i];
+
+  coarse.resize(m);
+  int remaining = total / ratio, start_coarse = 0, start_fine = 0;
+  for (int i = 0; i < m; ++i) {
+    int want = remaining / (m - i) + (remaining % (m - i) != 0);
+
+    if (i < m - 1) {
+      const int next_fine = start_fine + fine[i];
+
+      while (next_fine / ratio < start_coarse + want - stencil_width)
+        want--;
+      while ((next_fine - 1 + ratio - 1) / ratio > start_coarse + want - 1 + stencil_width)
+        want++;
+
+      if (want < 0 || want > remaining ||
+          next_fine / ratio < start_coarse + want - stencil_width ||
+          (next_fine - 1 + ratio - 1) / ratio > start_coarse + want - 1 + stencil_width)
+        return false;
+    }
+
+    if (want < 2)
+      return false;
+
+    coarse[i] = want;
+    start_coarse += want;
+    start_fine += fine[i];
+    remaining -= want;
+  }
+
+  return true;
+}
+
+//! \brief Returns the number of multigrid levels (including the fine one) the
+//! SSA grid can be split into.
+/*!
+ * Each coarsening halves the number of grid points in each direction. SSADA
+ * is periodic, so Mx and My have to be divisible by \f$2^{L-1}\f$ (\f$L\f$
+ * is the number of levels). The coarsest grid has at least \c
+ * ssa_mg_coarse_size points in each direction. Ownership ranges of each
+ * coarse level are computed from the actual ones (grid.procs_x and
+ * grid.procs_y, which need not be uniform); every processor has to own at
+ * least two points of every level. Uses at most \c ssa_mg_levels levels (if
+ * positive).
+ */
+PetscInt SSA::mg_levels() {
+  const PetscInt max_levels = static_cast<PetscInt>(config.get("ssa_mg_levels")),
+    min_size = static_cast<PetscInt>(config.get("ssa_mg_coarse_size"));
+  // stencil width of SSADA, see create_da()
+  const int stencil_width = 1;
+  PetscInt levels = 1, factor = 1;
+
+  vector<int> procs_x = grid.procs_x, procs_y = grid.procs_y, coarse_x, coarse_y;
+
+  while (max_levels <= 0 || levels < max_levels) {
+    const PetscInt f = 2 * factor;
+
+    if (grid.Mx % f != 0 || grid.My % f != 0)
+      break;
+
+    if (grid.Mx / f < min_size || grid.My / f < min_size)
+      break;
+
+    if (coarsen_ownership_ranges(procs_x, stencil_width, coarse_x) == false ||
+        coarsen_ownership_ranges(procs_y, stencil_width, coarse_y) == false)
+      break;
+
+    procs_x.swap(coarse_x);
+    procs_y.swap(coarse_y);
+    factor = f;
+    levels++;
+  }
+
+  return levels;
+}
+
+//! \brief Re-create SSADA and SSAX after a change of the domain decomposition.
+/*!
+ * Keeps the values in SSAX (the last solution).
+ */
+PetscErrorCode SSA::redistribute() {
+  PetscErrorCode ierr;
+  DM da_new;
+  Vec x_new;
+
+  ierr = create_da(da_new); CHKERRQ(ierr);
+  ierr = DMCreateGlobalVector(da_new, &x_new); CHKERRQ(ierr);
+
+  ierr = grid.redistribute_vec(SSADA, SSAX, da_new, x_new, false); CHKERRQ(ierr);
+
+  ierr = VecDestroy(&SSAX); CHKERRQ(ierr);
+  ierr = DMDestroy(&SSADA); CHKERRQ(ierr);
+
+  SSADA = da_new;
+  SSAX  = x_new;
+
+  return 0;
+}
 
 PetscErrorCode SSA::deallocate() {
   PetscErrorCode ierr;
@@ -207,6 +390,8 @@ PetscErrorCode SSA::update(bool fast) {
 
   ierr = solve(); CHKERRQ(ierr); 
 
+  ierr = record_velocity(); CHKERRQ(ierr);
+
   ierr = compute_basal_frictional_heating(basal_frictional_heating); CHKERRQ(ierr);
   ierr = compute_D2(D2); CHKERRQ(ierr);
 
@@ -537,6 +722,90 @@ PetscErrorCode SSA::stdout_report(string &result) {
 PetscErrorCode SSA::set_initial_guess(IceModelVec2V &guess) {
   PetscErrorCode ierr;
   ierr = velocity.copy_from(guess); CHKERRQ(ierr);
+  // recent solutions should not be used to replace this guess
+  history_length = 0;
+  return 0;
+}
+
+//! \brief Saves the solution of the last solve, to be used by
+//! extrapolate_velocity().
+PetscErrorCode SSA::record_velocity() {
+  PetscErrorCode ierr;
+  const int history_size = PetscMin(static_cast<int>(config.get("ssa_extrapolation_order")), 2) + 1;
+
+  if (history_size < 2)
+    return 0;
+
+  history_length = PetscMin(history_length + 1, history_size);
+
+  for (int k = history_length - 1; k > 0; --k) {
+    ierr = velocity_history[k].copy_from(velocity_history[k - 1]); CHKERRQ(ierr);
+    history_time[k] = history_time[k - 1];
+  }
+
+  ierr = velocity_history[0].copy_from(velocity); CHKERRQ(ierr);
+  history_time[0] = grid.time->current();
+
+  return 0;
+}
+
+//! \brief Replaces the initial guess of a solve (`velocity`) with a
+//! prediction extrapolated from solutions of recent solves.
+/*!
+ * If \c ssa_extrapolation_order is positive, the prediction is the value
+ * at the current model time of the polynomial of this degree (or lower, if
+ * there are not enough recent solutions) interpolating recent solutions in
+ * time. On smooth transient runs it is much closer to the solution than the
+ * solution of the last solve.
+ *
+ * The prediction is used only if the residual (see residual_norm()) is
+ * smaller there than at the solution of the last solve. Otherwise `velocity`
+ * is set to the latter.
+ *
+ * Solvers call this after setting up the system to solve (the residual
+ * depends on it). Uses `velocity_old` as storage.
+ */
+PetscErrorCode SSA::extrapolate_velocity() {
+  PetscErrorCode ierr;
+  const PetscReal t = grid.time->current();
+  const int order = PetscMin(history_length - 1,
+                             static_cast<int>(config.get("ssa_extrapolation_order")));
+
+  if (order < 1 || t <= history_time[0])
+    return 0;
+
+  // Lagrange interpolation weights
+  PetscReal weight[3];
+  for (int m = 0; m <= order; ++m) {
+    weight[m] = 1.0;
+    for (int n = 0; n <= order; ++n) {
+      if (n != m)
+        weight[m] *= (t - history_time[n]) / (history_time[m] - history_time[n]);
+    }
+  }
+
+  ierr = velocity_old.copy_from(velocity_history[0]); CHKERRQ(ierr);
+  ierr = velocity_old.scale(weight[0]); CHKERRQ(ierr);
+  for (int m = 1; m <= order; ++m) {
+    ierr = velocity_old.add(weight[m], velocity_history[m]); CHKERRQ(ierr);
+  }
+
+  PetscReal norm_last, norm_predicted;
+  ierr = residual_norm(velocity_history[0], norm_last); CHKERRQ(ierr);
+  ierr = residual_norm(velocity_old, norm_predicted); CHKERRQ(ierr);
+
+  if (norm_predicted < norm_last) {
+    ierr = velocity.copy_from(velocity_old); CHKERRQ(ierr);
+  } else {
+    ierr = velocity.copy_from(velocity_history[0]); CHKERRQ(ierr);
+  }
+
+  ierr = verbPrintf(3, grid.com,
+                    "  SSA: residual norms: %e at the extrapolated initial guess (%s),\n"
+                    "       %e at the last solution\n",
+                    norm_predicted, norm_predicted < norm_last ? "used" : "not used",
+                    norm_last); CHKERRQ(ierr);
+
   return 0;
 }
 
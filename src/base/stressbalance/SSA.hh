@@ -21,6 +21,7 @@
 
 #include "ShallowStressBalance.hh"
 #include "PISMDiagnostic.hh"
+#include <petscksp.h>
 
 //! Gives an extension coefficient to maintain ellipticity of SSA where ice is thin.
 /*!
@@ -167,9 +168,25 @@ public:
   virtual PetscErrorCode compute_principal_strain_rates(
                 IceModelVec2S &result_e1, IceModelVec2S &result_e2);
 
+  virtual PetscErrorCode redistribute();
+
 protected:
   virtual PetscErrorCode allocate();
 
+  virtual PetscErrorCode create_da(DM &result);
+
+  virtual PetscErrorCode set_preconditioner(KSP ksp);
+
+  virtual PetscInt mg_levels();
+
+  virtual PetscErrorCode extrapolate_velocity();
+
+  virtual PetscErrorCode record_velocity();
+
+  //! \brief Computes the 2-norm of the residual of the discretized SSA at
+  //! `u` (used by extrapolate_velocity()).
+  virtual PetscErrorCode residual_norm(IceModelVec2V &u, PetscReal &result) = 0;
+
   virtual PetscErrorCode deallocate();
 
   virtual PetscErrorCode solve()  = 0;
@@ -191,6 +208,12 @@ protected:
 
   string stdout_ssa;
 
+  //! solutions of the last few solves (the most recent first) and model
+  //! times they correspond to; see extrapolate_velocity()
+  IceModelVec2V velocity_history[3];
+  PetscReal history_time[3];
+  int history_length;
+
   // objects used by the SSA solver (internally)
   DM  SSADA;                    // dof=2 DA (grid.da2 has dof=1)
   Vec SSAX;  // global vector for solution
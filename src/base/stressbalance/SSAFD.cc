@@ -38,28 +38,19 @@ and Mat are used directly.  In particular we set up \f$A\f$
 (Mat SSAStiffnessMatrix) and a \f$b\f$ (= Vec SSARHS) and iteratively solve
 linear systems
   \f[ A x = b \f]
-where \f$x\f$ (= Vec SSAX).  A PETSc SNES object is never created.
+where \f$x\f$ (= Vec SSAX).  A PETSc SNES object is created only if
+Newton's method is used (see solve_newton()).
  */
 PetscErrorCode SSAFD::allocate_fd() {
   PetscErrorCode ierr;
 
-  // note SSADA and SSAX are allocated in SSA::allocate()
-  ierr = VecDuplicate(SSAX, &SSARHS); CHKERRQ(ierr);
-
-  ierr = DMCreateMatrix(SSADA, MATAIJ, &SSAStiffnessMatrix); CHKERRQ(ierr);
-
-  ierr = KSPCreate(grid.com, &SSAKSP); CHKERRQ(ierr);
-  // the default PC type somehow is ILU, which now fails (?) while block jacobi
-  //   seems to work; runtime options can override (see test J in vfnow.py)
-  PC pc;
-  ierr = KSPGetPC(SSAKSP,&pc); CHKERRQ(ierr);
-  ierr = PCSetType(pc,PCBJACOBI); CHKERRQ(ierr);
-  ierr = KSPSetFromOptions(SSAKSP); CHKERRQ(ierr);
+  ierr = allocate_linear_system(); CHKERRQ(ierr);
 
   const PetscScalar power = 1.0 / flow_law->exponent();
   char unitstr[TEMPORARY_STRING_LENGTH];
   snprintf(unitstr, sizeof(unitstr), "Pa s%f", power);
-  ierr = hardness.create(grid, "hardness", false); CHKERRQ(ierr);
+  // ghosts are used by Newton's method (see nuH_derivative())
+  ierr = hardness.create(grid, "hardness", true); CHKERRQ(ierr);
   ierr = hardness.set_attrs("diagnostic",
                             "vertically-averaged ice hardness",
                             unitstr, ""); CHKERRQ(ierr);
@@ -76,6 +67,10 @@ PetscErrorCode SSAFD::allocate_fd() {
 
   scaling = 1.0e9;  // comparable to typical beta for an ice stream;
 
+  solve_outer_iterations = 0;
+  solve_ksp_iterations   = 0;
+  solve_wall_time        = 0.0;
+
   // The nuH viewer:
   view_nuh = false;
   nuh_viewer_size = 300;
@@ -83,6 +78,64 @@ PetscErrorCode SSAFD::allocate_fd() {
 
   dump_system_matlab = false;
 
+  if (config.get_flag("ssafd_restricted_domain")) {
+    ierr = restricted_mask.create(grid, "ssafd_restricted_mask", true); CHKERRQ(ierr);
+    ierr = restricted_mask.set_attrs("internal",
+                                     "points where the SSA is solved (if positive)",
+                                     "", ""); CHKERRQ(ierr);
+  }
+
+  return 0;
+}
+
+//! \brief Allocate the KSP, the matrix and the right hand side (they depend on SSADA).
+PetscErrorCode SSAFD::allocate_linear_system() {
+  PetscErrorCode ierr;
+
+  // note SSADA and SSAX are allocated in SSA::allocate()
+  ierr = VecDuplicate(SSAX, &SSARHS); CHKERRQ(ierr);
+
+  ierr = DMCreateMatrix(SSADA, MATAIJ, &SSAStiffnessMatrix); CHKERRQ(ierr);
+
+  ierr = KSPCreate(grid.com, &SSAKSP); CHKERRQ(ierr);
+  // the default PC type somehow is ILU, which now fails (?) while block jacobi
+  //   seems to work; runtime options can override (see test J in vfnow.py)
+  PC pc;
+  ierr = KSPGetPC(SSAKSP,&pc); CHKERRQ(ierr);
+  ierr = PCSetType(pc,PCBJACOBI); CHKERRQ(ierr);
+  ierr = set_preconditioner(SSAKSP); CHKERRQ(ierr);
+  ierr = KSPSetFromOptions(SSAKSP); CHKERRQ(ierr);
+
+  // the KSP used to solve restricted systems (see solve_restricted()); the
+  // rest is allocated by setup_restricted_domain(); it uses its own options
+  // prefix because options meant for SSAKSP (such as -pc_type mg) do not
+  // work on restricted systems
+  ierr = KSPCreate(grid.com, &restricted_ksp); CHKERRQ(ierr);
+  ierr = KSPSetOptionsPrefix(restricted_ksp, "ssafd_restricted_"); CHKERRQ(ierr);
+  ierr = KSPGetPC(restricted_ksp, &pc); CHKERRQ(ierr);
+  ierr = PCSetType(pc, PCBJACOBI); CHKERRQ(ierr);
+  ierr = KSPSetFromOptions(restricted_ksp); CHKERRQ(ierr);
+
+  restricted_matrix  = PETSC_NULL;
+  restricted_x       = PETSC_NULL;
+  restricted_rhs     = PETSC_NULL;
+  restricted_fixed   = PETSC_NULL;
+  restricted_is      = PETSC_NULL;
+  restricted_scatter = PETSC_NULL;
+
+  return 0;
+}
+
+//! \brief Re-create SSADA and the linear system after a change of the domain
+//! decomposition.
+PetscErrorCode SSAFD::redistribute() {
+  PetscErrorCode ierr;
+
+  ierr = SSA::redistribute(); CHKERRQ(ierr);
+
+  ierr = deallocate_fd(); CHKERRQ(ierr);
+  ierr = allocate_linear_system(); CHKERRQ(ierr);
+
   return 0;
 }
 
@@ -102,6 +155,16 @@ PetscErrorCode SSAFD::deallocate_fd() {
     ierr = VecDestroy(&SSARHS); CHKERRQ(ierr);
   }
 
+  ierr = deallocate_restricted_domain(); CHKERRQ(ierr);
+
+  if (restricted_ksp != PETSC_NULL) {
+    ierr = KSPDestroy(&restricted_ksp); CHKERRQ(ierr);
+  }
+
+  // uses the domain decomposition, so it is re-created when needed
+  delete newton;
+  newton = NULL;
+
   return 0;
 }
 
@@ -399,10 +462,6 @@ FIXME:  document use of DAGetMatrix and MatStencil and MatSetValuesStencil
 PetscErrorCode SSAFD::assemble_matrix(bool include_basal_shear, Mat A) {
   PetscErrorCode  ierr;
 
-  const PetscScalar   dx=grid.dx, dy=grid.dy;
-  const PetscScalar   beta_ice_free_bedrock = config.get("beta_ice_free_bedrock");
-  const bool use_cfbc = config.get_flag("calving_front_stress_boundary_condition");
-
   // shortcut:
   IceModelVec2V &vel = velocity;
 
@@ -410,217 +469,39 @@ PetscErrorCode SSAFD::assemble_matrix(bool include_basal_shear, Mat A) {
 
   /* matrix assembly loop */
 
-  ierr = nuH.begin_access(); CHKERRQ(ierr);
-  ierr = tauc->begin_access(); CHKERRQ(ierr);
+  ierr = fd_begin_access(); CHKERRQ(ierr);
   ierr = vel.begin_access(); CHKERRQ(ierr);
-  ierr = mask->begin_access(); CHKERRQ(ierr);
-
-  Mask M;
-
-  const bool bedrock_boundary = config.get_flag("ssa_dirichlet_bc");
-
-  if (vel_bc && bc_locations) {
-    ierr = bc_locations->begin_access(); CHKERRQ(ierr);
-  }
-
-  // handles friction of the ice cell along ice-free bedrock margins when bedrock higher than ice surface (in simplified setups)
-  bool nuBedrockSet=config.get_flag("nuBedrockSet");
-  if (nuBedrockSet) {
-    ierr =    thickness->begin_access();  CHKERRQ(ierr);
-    ierr =    bed->begin_access();        CHKERRQ(ierr);
-    ierr =    surface->begin_access();    CHKERRQ(ierr);
-  }
-  PetscScalar nuBedrock=config.get("nuBedrock");
-  PetscScalar HminFrozen=0.0;
 
   for (PetscInt i=grid.xs; i<grid.xs+grid.xm; ++i) {
     for (PetscInt j=grid.ys; j<grid.ys+grid.ym; ++j) {
+      FDStencil s;
+      ierr = fd_stencil(i, j, s); CHKERRQ(ierr);
 
-      // Handle the easy case: provided Dirichlet boundary conditions
-      if (vel_bc && bc_locations && bc_locations->as_int(i,j) == 1) {
+      // Handle the easy case: provided Dirichlet boundary conditions (and
+      // ice-free cells if the CFBC is used)
+      if (s.diagonal) {
         // set diagonal entry to one (scaled); RHS entry will be known velocity;
         ierr = set_diagonal_matrix_entry(A, i, j, scaling); CHKERRQ(ierr);
         continue;
       }
 
-      /* Provide shorthand for the following staggered coefficients  nu H:
-       *      c_n
-       *  c_w     c_e
-       *      c_s
-       */
-      // const
-      PetscScalar c_w = nuH(i-1,j,0);
-      PetscScalar c_e = nuH(i,j,0);
-      PetscScalar c_s = nuH(i,j-1,1);
-      PetscScalar c_n = nuH(i,j,1);
-
-      if (nuBedrockSet){
-       // if option is set, the viscosity at ice-bedrock boundary layer will
-       // be prescribed and is a temperature-independent free (user determined) parameter
-
-	// direct neighbors
-	PetscInt  M_e = mask->as_int(i + 1,j),
-	          M_w = mask->as_int(i - 1,j),
-	          M_n = mask->as_int(i,j + 1),
-		  M_s = mask->as_int(i,j - 1);
-
-        if ((*thickness)(i,j) > HminFrozen) {  
-	  if ((*bed)(i-1,j) > (*surface)(i,j) && M.ice_free_land(M_w)) {
-	    c_w = nuBedrock * 0.5 * ((*thickness)(i,j)+(*thickness)(i-1,j));	    
-	  }
-	  if ((*bed)(i+1,j) > (*surface)(i,j) && M.ice_free_land(M_e)) {
-	   c_e = nuBedrock * 0.5 * ((*thickness)(i,j)+(*thickness)(i+1,j));
-	  }
-	  if ((*bed)(i,j+1) > (*surface)(i,j) && M.ice_free_land(M_n)) {
-	    c_n = nuBedrock * 0.5 * ((*thickness)(i,j)+(*thickness)(i,j+1));
-  	  }
-	  if ((*bed)(i,j-1) > (*surface)(i,j) && M.ice_free_land(M_s)) {
-	    c_s = nuBedrock * 0.5 * ((*thickness)(i,j)+(*thickness)(i+1,j));
-	  }
-        }
-      }
-
       // We use DAGetMatrix to obtain the SSA matrix, which means that all 18
       // non-zeros get allocated, even though we use only 13 (or 14). The
       // remaining 5 (or 4) coefficients are zeros, but we set them anyway,
       // because this makes the code easier to understand.
       const PetscInt sten = 18;
       MatStencil row, col[sten];
+      PetscReal eq1[sten], eq2[sten];
 
-      PetscInt aMn = 1, aPn = 1, aMM = 1, aPP = 1, aMs = 1, aPs = 1;
-      PetscInt bPw = 1, bPP = 1, bPe = 1, bMw = 1, bMM = 1, bMe = 1;
-
-      PetscInt M_ij = mask->as_int(i,j);
-
-      if (use_cfbc) {
-        int
-          // direct neighbors
-          M_e = mask->as_int(i + 1,j),
-          M_w = mask->as_int(i - 1,j),
-          M_n = mask->as_int(i,j + 1),
-          M_s = mask->as_int(i,j - 1),
-          // "diagonal" neighbors
-          M_ne = mask->as_int(i + 1,j + 1),
-          M_se = mask->as_int(i + 1,j - 1),
-          M_nw = mask->as_int(i - 1,j + 1),
-          M_sw = mask->as_int(i - 1,j - 1);
-
-        // Note: this sets velocities at both ice-free ocean and ice-free
-        // bedrock to zero. This means that we need to set boundary conditions
-        // at both ice/ice-free-ocean and ice/ice-free-bedrock interfaces below
-        // to be consistent.
-        if (M.ice_free(M_ij)) {
-          ierr = set_diagonal_matrix_entry(A, i, j, scaling); CHKERRQ(ierr);
-          continue;
-        }
-
-        if (is_marginal(i, j, bedrock_boundary)) {
-          // If at least one of the following four conditions is "true", we're
-          // at a CFBC location.
-	  if (bedrock_boundary) {
-
-            if (M.ice_free_ocean(M_e)) aPP = 0;
-            if (M.ice_free_ocean(M_w)) aMM = 0;
-            if (M.ice_free_ocean(M_n)) bPP = 0;
-            if (M.ice_free_ocean(M_s)) bMM = 0;
-
-            // decide whether to use centered or one-sided differences
-            if (M.ice_free_ocean(M_n) || M.ice_free_ocean(M_ne)) aPn = 0;
-            if (M.ice_free_ocean(M_e) || M.ice_free_ocean(M_ne)) bPe = 0;
-            if (M.ice_free_ocean(M_e) || M.ice_free_ocean(M_se)) bMe = 0;
-            if (M.ice_free_ocean(M_s) || M.ice_free_ocean(M_se)) aPs = 0;
-            if (M.ice_free_ocean(M_s) || M.ice_free_ocean(M_sw)) aMs = 0;
-            if (M.ice_free_ocean(M_w) || M.ice_free_ocean(M_sw)) bMw = 0;
-            if (M.ice_free_ocean(M_w) || M.ice_free_ocean(M_nw)) bPw = 0;
-            if (M.ice_free_ocean(M_n) || M.ice_free_ocean(M_nw)) aMn = 0;}
-
-	  else {
-
-            if (M.ice_free(M_e)) aPP = 0;
-            if (M.ice_free(M_w)) aMM = 0;
-            if (M.ice_free(M_n)) bPP = 0;
-            if (M.ice_free(M_s)) bMM = 0;
-
-            // decide whether to use centered or one-sided differences
-            if (M.ice_free(M_n) || M.ice_free(M_ne)) aPn = 0;
-            if (M.ice_free(M_e) || M.ice_free(M_ne)) bPe = 0;
-            if (M.ice_free(M_e) || M.ice_free(M_se)) bMe = 0;
-            if (M.ice_free(M_s) || M.ice_free(M_se)) aPs = 0;
-            if (M.ice_free(M_s) || M.ice_free(M_sw)) aMs = 0;
-            if (M.ice_free(M_w) || M.ice_free(M_sw)) bMw = 0;
-            if (M.ice_free(M_w) || M.ice_free(M_nw)) bPw = 0;
-            if (M.ice_free(M_n) || M.ice_free(M_nw)) aMn = 0;				}
-           }
-      } // end of "if (use_cfbc)"
-
-      /* begin Maxima-generated code */
-      const PetscReal dx2 = dx*dx, dy2 = dy*dy, d4 = 4*dx*dy, d2 = 2*dx*dy;
-
-      /* Coefficients of the discretization of the first equation; u first, then v. */
-      PetscReal eq1[] = {
-        0,  -c_n*bPP/dy2,  0,
-        -4*c_w*aMM/dx2,  (c_n*bPP+c_s*bMM)/dy2+(4*c_e*aPP+4*c_w*aMM)/dx2,  -4*c_e*aPP/dx2,
-        0,  -c_s*bMM/dy2,  0,
-        c_w*aMM*bPw/d2+c_n*aMn*bPP/d4,  (c_n*aPn*bPP-c_n*aMn*bPP)/d4+(c_w*aMM*bPP-c_e*aPP*bPP)/d2,  -c_e*aPP*bPe/d2-c_n*aPn*bPP/d4,
-        (c_w*aMM*bMw-c_w*aMM*bPw)/d2+(c_n*aMM*bPP-c_s*aMM*bMM)/d4,  (c_n*aPP*bPP-c_n*aMM*bPP-c_s*aPP*bMM+c_s*aMM*bMM)/d4+(c_e*aPP*bPP-c_w*aMM*bPP-c_e*aPP*bMM+c_w*aMM*bMM)/d2,  (c_e*aPP*bPe-c_e*aPP*bMe)/d2+(c_s*aPP*bMM-c_n*aPP*bPP)/d4,
-        -c_w*aMM*bMw/d2-c_s*aMs*bMM/d4,  (c_s*aMs*bMM-c_s*aPs*bMM)/d4+(c_e*aPP*bMM-c_w*aMM*bMM)/d2,  c_e*aPP*bMe/d2+c_s*aPs*bMM/d4,
-      };
-
-      /* Coefficients of the discretization of the second equation; u first, then v. */
-      PetscReal eq2[] = {
-        c_w*aMM*bPw/d4+c_n*aMn*bPP/d2,  (c_n*aPn*bPP-c_n*aMn*bPP)/d2+(c_w*aMM*bPP-c_e*aPP*bPP)/d4,  -c_e*aPP*bPe/d4-c_n*aPn*bPP/d2,
-        (c_w*aMM*bMw-c_w*aMM*bPw)/d4+(c_n*aMM*bPP-c_s*aMM*bMM)/d2,  (c_n*aPP*bPP-c_n*aMM*bPP-c_s*aPP*bMM+c_s*aMM*bMM)/d2+(c_e*aPP*bPP-c_w*aMM*bPP-c_e*aPP*bMM+c_w*aMM*bMM)/d4,  (c_e*aPP*bPe-c_e*aPP*bMe)/d4+(c_s*aPP*bMM-c_n*aPP*bPP)/d2,
-        -c_w*aMM*bMw/d4-c_s*aMs*bMM/d2,  (c_s*aMs*bMM-c_s*aPs*bMM)/d2+(c_e*aPP*bMM-c_w*aMM*bMM)/d4,  c_e*aPP*bMe/d4+c_s*aPs*bMM/d2,
-        0,  -4*c_n*bPP/dy2,  0,
-        -c_w*aMM/dx2,  (4*c_n*bPP+4*c_s*bMM)/dy2+(c_e*aPP+c_w*aMM)/dx2,  -c_e*aPP/dx2,
-        0,  -4*c_s*bMM/dy2,  0,
-      };
-
-      /* i indices */
-      const PetscInt I[] = {
-        i-1,  i,  i+1,
-        i-1,  i,  i+1,
-        i-1,  i,  i+1,
-        i-1,  i,  i+1,
-        i-1,  i,  i+1,
-        i-1,  i,  i+1,
-      };
-
-      /* j indices */
-      const PetscInt J[] = {
-        j+1,  j+1,  j+1,
-        j,  j,  j,
-        j-1,  j-1,  j-1,
-        j+1,  j+1,  j+1,
-        j,  j,  j,
-        j-1,  j-1,  j-1,
-      };
-
-      /* component indices */
-      const PetscInt C[] = {
-        0,  0,  0,
-        0,  0,  0,
-        0,  0,  0,
-        1,  1,  1,
-        1,  1,  1,
-        1,  1,  1,
-      };
-      /* end Maxima-generated code */
+      fd_coefficients(s, s.c, eq1, eq2);
 
       /* Dragging ice experiences friction at the bed determined by the
        *    IceBasalResistancePlasticLaw::drag() methods.  These may be a plastic,
        *    pseudo-plastic, or linear friction law.  Dragging is done implicitly
        *    (i.e. on left side of SSA eqns).  */
       PetscReal beta = 0.0;
-      if (include_basal_shear) {
-        if (M.grounded_ice(M_ij)) {
-          beta = basal.drag((*tauc)(i,j), vel(i,j).u, vel(i,j).v);
-        } else if (M.ice_free_land(M_ij)) {
-          // apply drag even in this case, to help with margins; note ice free
-          // areas already have a strength extension
-          beta = beta_ice_free_bedrock;
-        }
-      }
+      if (include_basal_shear)
+        fd_basal_drag(i, j, vel(i,j).u, vel(i,j).v, beta, NULL);
 
       // add beta to diagonal entries
       eq1[4]  += beta;
@@ -628,9 +509,7 @@ PetscErrorCode SSAFD::assemble_matrix(bool include_basal_shear, Mat A) {
 
       // build equations: NOTE TRANSPOSE
       row.j = i; row.i = j;
-      for (PetscInt m = 0; m < sten; m++) {
-        col[m].j = I[m]; col[m].i = J[m]; col[m].c = C[m];
-      }
+      fd_columns(i, j, col);
 
       // set coefficients of the first equation:
       row.c = 0;
@@ -642,26 +521,566 @@ PetscErrorCode SSAFD::assemble_matrix(bool include_basal_shear, Mat A) {
     }
   }
 
+  ierr = vel.end_access(); CHKERRQ(ierr);
+  ierr = fd_end_access(); CHKERRQ(ierr);
+
+  ierr = MatAssemblyBegin(A, MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A, MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+#if (PISM_DEBUG==1)
+  ierr = MatSetOption(A,MAT_NEW_NONZERO_LOCATION_ERR,PETSC_TRUE);CHKERRQ(ierr);
+#endif
+
+  return 0;
+}
+
+//! \brief Starts access to fields used by fd_stencil() and fd_basal_drag();
+//! reads settings used by these methods.
+PetscErrorCode SSAFD::fd_begin_access() {
+  PetscErrorCode ierr;
+
+  fd_use_cfbc = config.get_flag("calving_front_stress_boundary_condition");
+  fd_bedrock_boundary = config.get_flag("ssa_dirichlet_bc");
+  fd_nu_bedrock_set = config.get_flag("nuBedrockSet");
+  fd_nu_bedrock = config.get("nuBedrock");
+  fd_beta_ice_free_bedrock = config.get("beta_ice_free_bedrock");
+
+  ierr = nuH.begin_read_access(); CHKERRQ(ierr);
+  ierr = tauc->begin_read_access(); CHKERRQ(ierr);
+  ierr = mask->begin_read_access(); CHKERRQ(ierr);
+
+  if (vel_bc && bc_locations) {
+    ierr = bc_locations->begin_read_access(); CHKERRQ(ierr);
+  }
+
+  if (fd_nu_bedrock_set) {
+    ierr = thickness->begin_read_access(); CHKERRQ(ierr);
+    ierr = bed->begin_read_access(); CHKERRQ(ierr);
+    ierr = surface->begin_read_access(); CHKERRQ(ierr);
+  }
+
+  return 0;
+}
+
+//! \brief Ends access started by fd_begin_access().
+PetscErrorCode SSAFD::fd_end_access() {
+  PetscErrorCode ierr;
+
+  if (fd_nu_bedrock_set) {
+    ierr = surface->end_access(); CHKERRQ(ierr);
+    ierr = bed->end_access(); CHKERRQ(ierr);
+    ierr = thickness->end_access(); CHKERRQ(ierr);
+  }
+
   if (vel_bc && bc_locations) {
     ierr = bc_locations->end_access(); CHKERRQ(ierr);
   }
 
   ierr = mask->end_access(); CHKERRQ(ierr);
-  ierr = vel.end_access(); CHKERRQ(ierr);
   ierr = tauc->end_access(); CHKERRQ(ierr);
   ierr = nuH.end_access(); CHKERRQ(ierr);
 
-  if (nuBedrockSet) {
-  	ierr =    thickness->end_access();    CHKERRQ(ierr);
-  	ierr =  		bed->end_access();  CHKERRQ(ierr);
-  	ierr =    	surface->end_access();    CHKERRQ(ierr);
+  return 0;
+}
+
+//! \brief Describes the discretization of the SSA at the point (i,j), using
+//! the current values of nuH.
+/*!
+ * Has to be called between fd_begin_access() and fd_end_access().
+ */
+PetscErrorCode SSAFD::fd_stencil(PetscInt i, PetscInt j, FDStencil &s) {
+  Mask M;
+
+  s.diagonal = false;
+  s.aMn = s.aPn = s.aMM = s.aPP = s.aMs = s.aPs = 1;
+  s.bPw = s.bPP = s.bPe = s.bMw = s.bMM = s.bMe = 1;
+
+  if (vel_bc && bc_locations && bc_locations->as_int(i,j) == 1) {
+    s.diagonal = true;
+    return 0;
   }
 
-  ierr = MatAssemblyBegin(A, MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
-  ierr = MatAssemblyEnd(A, MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
-#if (PISM_DEBUG==1)
-  ierr = MatSetOption(A,MAT_NEW_NONZERO_LOCATION_ERR,PETSC_TRUE);CHKERRQ(ierr);
-#endif
+  /* Provide shorthand for the following staggered coefficients  nu H:
+   *      c_n
+   *  c_w     c_e
+   *      c_s
+   */
+  PetscReal &c_w = s.c[0], &c_e = s.c[1], &c_s = s.c[2], &c_n = s.c[3];
+  c_w = nuH(i-1,j,0);
+  c_e = nuH(i,j,0);
+  c_s = nuH(i,j-1,1);
+  c_n = nuH(i,j,1);
+  for (int n = 0; n < 4; ++n)
+    s.c_fixed[n] = false;
+
+  if (fd_nu_bedrock_set) {
+    // if option is set, the viscosity at ice-bedrock boundary layer will
+    // be prescribed and is a temperature-independent free (user determined) parameter
+    const PetscReal HminFrozen = 0.0;
+
+    // direct neighbors
+    PetscInt  M_e = mask->as_int(i + 1,j),
+      M_w = mask->as_int(i - 1,j),
+      M_n = mask->as_int(i,j + 1),
+      M_s = mask->as_int(i,j - 1);
+
+    if ((*thickness)(i,j) > HminFrozen) {
+      if ((*bed)(i-1,j) > (*surface)(i,j) && M.ice_free_land(M_w)) {
+        c_w = fd_nu_bedrock * 0.5 * ((*thickness)(i,j)+(*thickness)(i-1,j));
+        s.c_fixed[0] = true;
+      }
+      if ((*bed)(i+1,j) > (*surface)(i,j) && M.ice_free_land(M_e)) {
+        c_e = fd_nu_bedrock * 0.5 * ((*thickness)(i,j)+(*thickness)(i+1,j));
+        s.c_fixed[1] = true;
+      }
+      if ((*bed)(i,j+1) > (*surface)(i,j) && M.ice_free_land(M_n)) {
+        c_n = fd_nu_bedrock * 0.5 * ((*thickness)(i,j)+(*thickness)(i,j+1));
+        s.c_fixed[3] = true;
+      }
+      if ((*bed)(i,j-1) > (*surface)(i,j) && M.ice_free_land(M_s)) {
+        c_s = fd_nu_bedrock * 0.5 * ((*thickness)(i,j)+(*thickness)(i+1,j));
+        s.c_fixed[2] = true;
+      }
+    }
+  }
+
+  if (fd_use_cfbc) {
+    const PetscInt M_ij = mask->as_int(i,j),
+      // direct neighbors
+      M_e = mask->as_int(i + 1,j),
+      M_w = mask->as_int(i - 1,j),
+      M_n = mask->as_int(i,j + 1),
+      M_s = mask->as_int(i,j - 1),
+      // "diagonal" neighbors
+      M_ne = mask->as_int(i + 1,j + 1),
+      M_se = mask->as_int(i + 1,j - 1),
+      M_nw = mask->as_int(i - 1,j + 1),
+      M_sw = mask->as_int(i - 1,j - 1);
+
+    // Note: this sets velocities at both ice-free ocean and ice-free
+    // bedrock to zero. This means that we need to set boundary conditions
+    // at both ice/ice-free-ocean and ice/ice-free-bedrock interfaces below
+    // to be consistent.
+    if (M.ice_free(M_ij)) {
+      s.diagonal = true;
+      return 0;
+    }
+
+    if (is_marginal(i, j, fd_bedrock_boundary)) {
+      // If at least one of the following four conditions is "true", we're
+      // at a CFBC location.
+      if (fd_bedrock_boundary) {
+
+        if (M.ice_free_ocean(M_e)) s.aPP = 0;
+        if (M.ice_free_ocean(M_w)) s.aMM = 0;
+        if (M.ice_free_ocean(M_n)) s.bPP = 0;
+        if (M.ice_free_ocean(M_s)) s.bMM = 0;
+
+        // decide whether to use centered or one-sided differences
+        if (M.ice_free_ocean(M_n) || M.ice_free_ocean(M_ne)) s.aPn = 0;
+        if (M.ice_free_ocean(M_e) || M.ice_free_ocean(M_ne)) s.bPe = 0;
+        if (M.ice_free_ocean(M_e) || M.ice_free_ocean(M_se)) s.bMe = 0;
+        if (M.ice_free_ocean(M_s) || M.ice_free_ocean(M_se)) s.aPs = 0;
+        if (M.ice_free_ocean(M_s) || M.ice_free_ocean(M_sw)) s.aMs = 0;
+        if (M.ice_free_ocean(M_w) || M.ice_free_ocean(M_sw)) s.bMw = 0;
+        if (M.ice_free_ocean(M_w) || M.ice_free_ocean(M_nw)) s.bPw = 0;
+        if (M.ice_free_ocean(M_n) || M.ice_free_ocean(M_nw)) s.aMn = 0;
+      } else {
+
+        if (M.ice_free(M_e)) s.aPP = 0;
+        if (M.ice_free(M_w)) s.aMM = 0;
+        if (M.ice_free(M_n)) s.bPP = 0;
+        if (M.ice_free(M_s)) s.bMM = 0;
+
+        // decide whether to use centered or one-sided differences
+        if (M.ice_free(M_n) || M.ice_free(M_ne)) s.aPn = 0;
+        if (M.ice_free(M_e) || M.ice_free(M_ne)) s.bPe = 0;
+        if (M.ice_free(M_e) || M.ice_free(M_se)) s.bMe = 0;
+        if (M.ice_free(M_s) || M.ice_free(M_se)) s.aPs = 0;
+        if (M.ice_free(M_s) || M.ice_free(M_sw)) s.aMs = 0;
+        if (M.ice_free(M_w) || M.ice_free(M_sw)) s.bMw = 0;
+        if (M.ice_free(M_w) || M.ice_free(M_nw)) s.bPw = 0;
+        if (M.ice_free(M_n) || M.ice_free(M_nw)) s.aMn = 0;
+      }
+    }
+  } // end of "if (fd_use_cfbc)"
+
+  return 0;
+}
+
+//! \brief Computes coefficients of the two equations at a grid point
+//! (without the basal drag), given the stencil `s` and nu*H at the four
+//! staggered grid points around it (`c`; west, east, south, north).
+/*!
+ * Coefficients are linear in `c`. Columns are listed by fd_columns().
+ */
+void SSAFD::fd_coefficients(const FDStencil &s, const PetscReal c[4],
+                            PetscReal eq1[18], PetscReal eq2[18]) {
+  const PetscReal dx = grid.dx, dy = grid.dy;
+  const PetscReal c_w = c[0], c_e = c[1], c_s = c[2], c_n = c[3];
+  const PetscInt aMn = s.aMn, aPn = s.aPn, aMM = s.aMM, aPP = s.aPP, aMs = s.aMs, aPs = s.aPs,
+    bPw = s.bPw, bPP = s.bPP, bPe = s.bPe, bMw = s.bMw, bMM = s.bMM, bMe = s.bMe;
+
+  /* begin Maxima-generated code */
+  const PetscReal dx2 = dx*dx, dy2 = dy*dy, d4 = 4*dx*dy, d2 = 2*dx*dy;
+
+  /* Coefficients of the discretization of the first equation; u first, then v. */
+  const PetscReal e1[] = {
+    0,  -c_n*bPP/dy2,  0,
+    -4*c_w*aMM/dx2,  (c_n*bPP+c_s*bMM)/dy2+(4*c_e*aPP+4*c_w*aMM)/dx2,  -4*c_e*aPP/dx2,
+    0,  -c_s*bMM/dy2,  0,
+    c_w*aMM*bPw/d2+c_n*aMn*bPP/d4,  (c_n*aPn*bPP-c_n*aMn*bPP)/d4+(c_w*aMM*bPP-c_e*aPP*bPP)/d2,  -c_e*aPP*bPe/d2-c_n*aPn*bPP/d4,
+    (c_w*aMM*bMw-c_w*aMM*bPw)/d2+(c_n*aMM*bPP-c_s*aMM*bMM)/d4,  (c_n*aPP*bPP-c_n*aMM*bPP-c_s*aPP*bMM+c_s*aMM*bMM)/d4+(c_e*aPP*bPP-c_w*aMM*bPP-c_e*aPP*bMM+c_w*aMM*bMM)/d2,  (c_e*aPP*bPe-c_e*aPP*bMe)/d2+(c_s*aPP*bMM-c_n*aPP*bPP)/d4,
+    -c_w*aMM*bMw/d2-c_s*aMs*bMM/d4,  (c_s*aMs*bMM-c_s*aPs*bMM)/d4+(c_e*aPP*bMM-c_w*aMM*bMM)/d2,  c_e*aPP*bMe/d2+c_s*aPs*bMM/d4,
+  };
+
+  /* Coefficients of the discretization of the second equation; u first, then v. */
+  const PetscReal e2[] = {
+    c_w*aMM*bPw/d4+c_n*aMn*bPP/d2,  (c_n*aPn*bPP-c_n*aMn*bPP)/d2+(c_w*aMM*bPP-c_e*aPP*bPP)/d4,  -c_e*aPP*bPe/d4-c_n*aPn*bPP/d2,
+    (c_w*aMM*bMw-c_w*aMM*bPw)/d4+(c_n*aMM*bPP-c_s*aMM*bMM)/d2,  (c_n*aPP*bPP-c_n*aMM*bPP-c_s*aPP*bMM+c_s*aMM*bMM)/d2+(c_e*aPP*bPP-c_w*aMM*bPP-c_e*aPP*bMM+c_w*aMM*bMM)/d4,  (c_e*aPP*bPe-c_e*aPP*bMe)/d4+(c_s*aPP*bMM-c_n*aPP*bPP)/d2,
+    -c_w*aMM*bMw/d4-c_s*aMs*bMM/d2,  (c_s*aMs*bMM-c_s*aPs*bMM)/d2+(c_e*aPP*bMM-c_w*aMM*bMM)/d4,  c_e*aPP*bMe/d4+c_s*aPs*bMM/d2,
+    0,  -4*c_n*bPP/dy2,  0,
+    -c_w*aMM/dx2,  (4*c_n*bPP+4*c_s*bMM)/dy2+(c_e*aPP+c_w*aMM)/dx2,  -c_e*aPP/dx2,
+    0,  -4*c_s*bMM/dy2,  0,
+  };
+  /* end Maxima-generated code */
+
+  for (PetscInt m = 0; m < 18; ++m) {
+    eq1[m] = e1[m];
+    eq2[m] = e2[m];
+  }
+}
+
+//! \brief Lists columns corresponding to coefficients computed by
+//! fd_coefficients() for the point (i,j).
+/*!
+ * Column `m` corresponds to the component `m / 9` (u, then v) at the point
+ * `(i + (m % 3) - 1, j + 1 - (m % 9) / 3)`.
+ */
+void SSAFD::fd_columns(PetscInt i, PetscInt j, MatStencil col[18]) {
+  for (PetscInt m = 0; m < 18; ++m) {
+    // NOTE TRANSPOSE
+    col[m].j = i + (m % 3) - 1;
+    col[m].i = j + 1 - (m % 9) / 3;
+    col[m].c = m / 9;
+  }
+}
+
+
+//! \brief Computes the basal drag coefficient `beta` at the point (i,j) and,
+//! if `dbeta` is not NULL, its derivative (see
+//! IceBasalResistancePlasticLaw::dragWithDerivative()).
+/*!
+ * Has to be called between fd_begin_access() and fd_end_access().
+ */
+void SSAFD::fd_basal_drag(PetscInt i, PetscInt j, PetscReal u, PetscReal v,
+                          PetscReal &beta, PetscReal *dbeta) {
+  Mask M;
+  const PetscInt M_ij = mask->as_int(i,j);
+
+  /* Dragging ice experiences friction at the bed determined by the
+   *    IceBasalResistancePlasticLaw::drag() methods.  These may be a plastic,
+   *    pseudo-plastic, or linear friction law.  Dragging is done implicitly
+   *    (i.e. on left side of SSA eqns).  */
+  beta = 0.0;
+  if (dbeta)
+    *dbeta = 0.0;
+
+  if (M.grounded_ice(M_ij)) {
+    if (dbeta)
+      basal.dragWithDerivative((*tauc)(i,j), u, v, &beta, dbeta);
+    else
+      beta = basal.drag((*tauc)(i,j), u, v);
+  } else if (M.ice_free_land(M_ij)) {
+    // apply drag even in this case, to help with margins; note ice free
+    // areas already have a strength extension
+    beta = fd_beta_ice_free_bedrock;
+  }
+}
+
+//! \brief Collects values of the unknowns in the order used by fd_columns().
+static inline void fd_values(const PISMVector2 **x, PetscInt i, PetscInt j,
+                             PetscReal result[18]) {
+  for (PetscInt m = 0; m < 9; ++m) {
+    const PISMVector2 &X = x[i + (m % 3) - 1][j + 1 - m / 3];
+    result[m]     = X.u;
+    result[m + 9] = X.v;
+  }
+}
+
+//! \brief Computes derivatives of nu*H at the staggered grid point (i,j,o)
+//! with respect to the velocity at the points it depends on.
+/*!
+ * Uses velocity values `x`, which have to have ghosts. Mirrors
+ * compute_nuH_staggered(): the derivative of nu*H with respect to the
+ * velocity at the point `(i + di[n], j + dj[n])` is `(du[n], dv[n])`.
+ *
+ * Returns the number of points (zero in the "strength extension" area, where
+ * nu*H does not depend on the velocity).
+ *
+ * Needs access to `hardness` and `thickness`.
+ */
+PetscInt SSAFD::nuH_derivative(const PISMVector2 **x, PetscInt i, PetscInt j, PetscInt o,
+                               PetscInt di[6], PetscInt dj[6], PetscReal du[6], PetscReal dv[6]) {
+  const PetscInt oi = 1 - o, oj = o;
+  const PetscReal dx = grid.dx, dy = grid.dy;
+
+  const PetscReal H = 0.5 * ((*thickness)(i,j) + (*thickness)(i+oi,j+oj));
+  if (H < strength_extension->get_min_thickness())
+    return 0;
+
+  const PetscReal ssa_enhancement_factor = flow_law->enhancement_factor(),
+    n_glen = flow_law->exponent(),
+    nu_enhancement_scaling = 1.0 / pow(ssa_enhancement_factor, 1.0/n_glen);
+
+  // weights of the finite difference approximations of d/dx and d/dy
+  PetscReal wx[6], wy[6];
+  if (o == 0) {
+    const PetscInt I[] = {0, 1, 0, 1, 0, 1}, J[] = {0, 0, 1, 1, -1, -1};
+    const PetscReal WX[] = {-1.0/dx, 1.0/dx, 0, 0, 0, 0},
+      WY[] = {0, 0, 1.0/(4*dy), 1.0/(4*dy), -1.0/(4*dy), -1.0/(4*dy)};
+    for (int n = 0; n < 6; ++n) {
+      di[n] = I[n]; dj[n] = J[n]; wx[n] = WX[n]; wy[n] = WY[n];
+    }
+  } else {
+    const PetscInt I[] = {0, 0, 1, 1, -1, -1}, J[] = {0, 1, 0, 1, 0, 1};
+    const PetscReal WX[] = {0, 0, 1.0/(4*dx), 1.0/(4*dx), -1.0/(4*dx), -1.0/(4*dx)},
+      WY[] = {-1.0/dy, 1.0/dy, 0, 0, 0, 0};
+    for (int n = 0; n < 6; ++n) {
+      di[n] = I[n]; dj[n] = J[n]; wx[n] = WX[n]; wy[n] = WY[n];
+    }
+  }
+
+  PetscReal u_x = 0, u_y = 0, v_x = 0, v_y = 0;
+  for (int n = 0; n < 6; ++n) {
+    const PISMVector2 &X = x[i + di[n]][j + dj[n]];
+    u_x += wx[n] * X.u;
+    u_y += wy[n] * X.u;
+    v_x += wx[n] * X.v;
+    v_y += wy[n] * X.v;
+  }
+
+  // strain rates in the compressed form used by effective_viscosity_with_derivative()
+  const PetscReal Du[] = {u_x, v_y, 0.5 * (u_y + v_x)};
+  PetscReal nu, dnu;
+  flow_law->effective_viscosity_with_derivative(hardness(i,j,o), Du, &nu, &dnu);
+
+  // dnu is the derivative with respect to the second invariant alpha; use
+  // d(alpha)/d(u_x) = 2 u_x + v_y, d(alpha)/d(v_y) = 2 v_y + u_x,
+  // d(alpha)/d(u_y) = d(alpha)/d(v_x) = 0.5 (u_y + v_x).
+  const PetscReal K = H * dnu * nu_enhancement_scaling;
+  for (int n = 0; n < 6; ++n) {
+    du[n] = K * (wx[n] * (2*Du[0] + Du[1]) + wy[n] * Du[2]);
+    dv[n] = K * (wx[n] * Du[2] + wy[n] * (2*Du[1] + Du[0]));
+  }
+
+  return 6;
+}
+
+//! \brief Sets `velocity` (including ghosts) to `x`.
+PetscErrorCode SSAFD::set_velocity(const PISMVector2 **x) {
+  PetscErrorCode ierr;
+
+  ierr = velocity.begin_access(); CHKERRQ(ierr);
+  for (PetscInt i=grid.xs; i<grid.xs+grid.xm; ++i) {
+    for (PetscInt j=grid.ys; j<grid.ys+grid.ym; ++j) {
+      velocity(i,j) = x[i][j];
+    }
+  }
+  ierr = velocity.end_access(); CHKERRQ(ierr);
+
+  ierr = velocity.beginGhostComm(); CHKERRQ(ierr);
+  ierr = velocity.endGhostComm(); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! \brief Computes the residual of the discretized SSA (the system solved by
+//! solve_picard(), with the matrix evaluated at `x`).
+/*!
+ * Uses the right hand side computed by assemble_rhs() and the hardness
+ * computed by compute_hardav_staggered(). Sets `velocity` and `nuH`.
+ */
+PetscErrorCode SSAFD::compute_residual(const PISMVector2 **x, PISMVector2 **f) {
+  PetscErrorCode ierr;
+  PISMVector2 **rhs;
+
+  ierr = set_velocity(x); CHKERRQ(ierr);
+  ierr = compute_nuH_staggered(nuH, newton_epsilon); CHKERRQ(ierr);
+
+  ierr = DMDAVecGetArray(SSADA, SSARHS, &rhs); CHKERRQ(ierr);
+  ierr = fd_begin_access(); CHKERRQ(ierr);
+
+  for (PetscInt i=grid.xs; i<grid.xs+grid.xm; ++i) {
+    for (PetscInt j=grid.ys; j<grid.ys+grid.ym; ++j) {
+      FDStencil s;
+      ierr = fd_stencil(i, j, s); CHKERRQ(ierr);
+
+      if (s.diagonal) {
+        f[i][j].u = scaling * x[i][j].u - rhs[i][j].u;
+        f[i][j].v = scaling * x[i][j].v - rhs[i][j].v;
+        continue;
+      }
+
+      PetscReal eq1[18], eq2[18], X[18], beta;
+      fd_coefficients(s, s.c, eq1, eq2);
+      fd_values(x, i, j, X);
+      fd_basal_drag(i, j, x[i][j].u, x[i][j].v, beta, NULL);
+
+      PetscReal F1 = 0.0, F2 = 0.0;
+      for (PetscInt m = 0; m < 18; ++m) {
+        F1 += eq1[m] * X[m];
+        F2 += eq2[m] * X[m];
+      }
+
+      f[i][j].u = F1 + beta * x[i][j].u - rhs[i][j].u;
+      f[i][j].v = F2 + beta * x[i][j].v - rhs[i][j].v;
+    }
+  }
+
+  ierr = fd_end_access(); CHKERRQ(ierr);
+  ierr = DMDAVecRestoreArray(SSADA, SSARHS, &rhs); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! \brief Computes the 2-norm of the residual computed by compute_residual()
+//! at `u`.
+/*!
+ * Sets `velocity` and `nuH`.
+ */
+PetscErrorCode SSAFD::residual_norm(IceModelVec2V &u, PetscReal &result) {
+  PetscErrorCode ierr;
+  PISMVector2 **x, **f;
+  Vec F;
+
+  newton_epsilon = config.get("epsilon_ssa");
+
+  ierr = VecDuplicate(SSARHS, &F); CHKERRQ(ierr);
+
+  ierr = u.get_array(x); CHKERRQ(ierr);
+  ierr = DMDAVecGetArray(SSADA, F, &f); CHKERRQ(ierr);
+
+  ierr = compute_residual(const_cast<const PISMVector2**>(x), f); CHKERRQ(ierr);
+
+  ierr = DMDAVecRestoreArray(SSADA, F, &f); CHKERRQ(ierr);
+  ierr = u.end_access(); CHKERRQ(ierr);
+
+  ierr = VecNorm(F, NORM_2, &result); CHKERRQ(ierr);
+  ierr = VecDestroy(&F); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! \brief Assembles the Jacobian of compute_residual() at `x` (or, if
+//! `picard` is true, the matrix used by solve_picard()).
+/*!
+ * The residual at a point is linear in the four nu*H values around it
+ * (fd_coefficients() is linear in `c`), so the derivative of the viscosity
+ * term is the Picard matrix plus, for each of these nu*H values, the
+ * discretization with this value set to one (applied to `x`) times the
+ * derivative of nu*H (see nuH_derivative()). All the points involved are
+ * within the 9-point stencil, so the Jacobian has the same non-zero pattern
+ * as the Picard matrix.
+ */
+PetscErrorCode SSAFD::assemble_jacobian(const PISMVector2 **x, bool picard, Mat J) {
+  PetscErrorCode ierr;
+
+  ierr = set_velocity(x); CHKERRQ(ierr);
+  ierr = compute_nuH_staggered(nuH, newton_epsilon); CHKERRQ(ierr);
+
+  if (picard) {
+    ierr = assemble_matrix(true, J); CHKERRQ(ierr);
+    return 0;
+  }
+
+  ierr = MatZeroEntries(J); CHKERRQ(ierr);
+
+  ierr = fd_begin_access(); CHKERRQ(ierr);
+  ierr = hardness.begin_read_access(); CHKERRQ(ierr);
+  ierr = thickness->begin_read_access(); CHKERRQ(ierr);
+
+  // staggered grid points (relative to (i,j)) corresponding to c_w, c_e,
+  // c_s, c_n
+  const PetscInt stag_i[] = {-1, 0, 0, 0}, stag_j[] = {0, 0, -1, 0}, stag_o[] = {0, 0, 1, 1};
+
+  for (PetscInt i=grid.xs; i<grid.xs+grid.xm; ++i) {
+    for (PetscInt j=grid.ys; j<grid.ys+grid.ym; ++j) {
+      FDStencil s;
+      ierr = fd_stencil(i, j, s); CHKERRQ(ierr);
+
+      if (s.diagonal) {
+        ierr = set_diagonal_matrix_entry(J, i, j, scaling); CHKERRQ(ierr);
+        continue;
+      }
+
+      const PetscInt sten = 18;
+      MatStencil row, col[sten];
+      PetscReal eq1[sten], eq2[sten], X[sten];
+
+      fd_coefficients(s, s.c, eq1, eq2);
+      fd_values(x, i, j, X);
+
+      for (PetscInt n = 0; n < 4; ++n) {
+        if (s.c_fixed[n])
+          continue;
+
+        PetscInt di[6], dj[6];
+        PetscReal du[6], dv[6];
+        const PetscInt N = nuH_derivative(x, i + stag_i[n], j + stag_j[n], stag_o[n],
+                                          di, dj, du, dv);
+        if (N == 0)
+          continue;
+
+        // discretization with c[n] = 1 and other coefficients set to zero,
+        // applied to x
+        PetscReal c_unit[4] = {0, 0, 0, 0}, e1[sten], e2[sten];
+        c_unit[n] = 1.0;
+        fd_coefficients(s, c_unit, e1, e2);
+
+        PetscReal G1 = 0.0, G2 = 0.0;
+        for (PetscInt m = 0; m < sten; ++m) {
+          G1 += e1[m] * X[m];
+          G2 += e2[m] * X[m];
+        }
+
+        for (PetscInt k = 0; k < N; ++k) {
+          // offsets of the point relative to (i,j); always within the stencil
+          const PetscInt I = stag_i[n] + di[k], Jo = stag_j[n] + dj[k],
+            m = (1 - Jo) * 3 + (I + 1);
+          eq1[m]     += G1 * du[k];
+          eq1[m + 9] += G1 * dv[k];
+          eq2[m]     += G2 * du[k];
+          eq2[m + 9] += G2 * dv[k];
+        }
+      }
+
+      // basal drag: the derivative of beta*(u,v) with respect to (u,v)
+      PetscReal beta, dbeta;
+      const PetscReal u = x[i][j].u, v = x[i][j].v;
+      fd_basal_drag(i, j, u, v, beta, &dbeta);
+      eq1[4]  += beta + dbeta * u * u;
+      eq1[13] += dbeta * u * v;
+      eq2[4]  += dbeta * u * v;
+      eq2[13] += beta + dbeta * v * v;
+
+      // build equations: NOTE TRANSPOSE
+      row.j = i; row.i = j;
+      fd_columns(i, j, col);
+
+      row.c = 0;
+      ierr = MatSetValuesStencil(J, 1, &row, sten, col, eq1, INSERT_VALUES); CHKERRQ(ierr);
+
+      row.c = 1;
+      ierr = MatSetValuesStencil(J, 1, &row, sten, col, eq2, INSERT_VALUES); CHKERRQ(ierr);
+    }
+  }
+
+  ierr = thickness->end_access(); CHKERRQ(ierr);
+  ierr = hardness.end_access(); CHKERRQ(ierr);
+  ierr = fd_end_access(); CHKERRQ(ierr);
+
+  ierr = MatAssemblyBegin(J, MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(J, MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
 
   return 0;
 }
@@ -719,33 +1138,129 @@ revert to a direct linear solve, either for the whole domain (not scalable) or
 on the subdomains.  This recovery alternative requires a more nontrivial choice
 but it may be worthwhile.  Note the user can already do <tt>-pc_type asm
 -sub_pc_type lu</tt> at the command line, forcing subdomain direct solves.)
+
+The configuration parameter \c ssafd_nonlinear_solver (option
+<tt>-ssafd_solver</tt>) selects Newton's method instead (see solve_newton()).
+If it fails, the Picard iteration described above is used.
  */
 PetscErrorCode SSAFD::solve() {
+  PetscErrorCode ierr;
+  PetscLogDouble start_time, end_time;
+
+  ierr = PetscGetTime(&start_time); CHKERRQ(ierr);
+
+  // iteration counts reported by get_ts_diagnostics() are per call
+  solve_outer_iterations = 0;
+  solve_ksp_iterations   = 0;
+
+  stdout_ssa.clear();
+
+  // computation of RHS only needs to be done once; does not depend on
+  // solution; but matrix changes under nonlinear iteration
+  ierr = assemble_rhs(SSARHS); CHKERRQ(ierr);
+
+  ierr = compute_hardav_staggered(hardness); CHKERRQ(ierr);
+
+  ierr = extrapolate_velocity(); CHKERRQ(ierr);
+
+  ierr = velocity.copy_to(velocity_old); CHKERRQ(ierr);
+
+  bool newton_converged = false;
+  if (config.get_string("ssafd_nonlinear_solver") != "picard") {
+    ierr = solve_newton(newton_converged); CHKERRQ(ierr);
+
+    if (newton_converged == false) {
+      ierr = velocity.copy_from(velocity_old); CHKERRQ(ierr);
+      stdout_ssa.clear();
+    }
+  }
+
+  if (newton_converged == false) {
+    ierr = solve_picard(); CHKERRQ(ierr);
+  }
+
+  if (config.get_flag("write_ssa_system_to_matlab")) {
+    if (newton_converged) {
+      // the Picard matrix at the solution
+      ierr = assemble_matrix(true, SSAStiffnessMatrix); CHKERRQ(ierr);
+    }
+    ierr = writeSSAsystemMatlab(); CHKERRQ(ierr);
+  }
+
+  if (config.get_flag("scalebrutalSet")){
+    const PetscScalar sliding_scale_brutalFactor = config.get("sliding_scale_brutal");
+    ierr = velocity.scale(sliding_scale_brutalFactor); CHKERRQ(ierr);
+
+    ierr = velocity.beginGhostComm(); CHKERRQ(ierr);
+    ierr = velocity.endGhostComm(); CHKERRQ(ierr);
+  }
+
+  ierr = PetscGetTime(&end_time); CHKERRQ(ierr);
+  solve_wall_time = end_time - start_time;
+
+  return 0;
+}
+
+//! \brief Solves the SSA using the Picard iteration described in solve().
+/*!
+ * Assumes that the right hand side and the hardness are up to date.
+ *
+ * If \c ssafd_ksp_forcing is set, early linear solves are inexact: the
+ * relative tolerance of a linear solve is
+ * \f[ \eta_k = \gamma \left( \frac{\|\Delta (\nu H)\|}{\|\nu H\|} \right)^\alpha, \f]
+ * using the change of \f$\nu H\f$ in the previous iteration, with the
+ * safeguard \f$\eta_k \ge \gamma \eta_{k-1}^\alpha\f$ if the latter
+ * exceeds 0.1 (as in Eisenstat and Walker's "choice 2"), limited by
+ * \c ssafd_ksp_forcing_max from above and by the KSP tolerance (see
+ * <tt>-ksp_rtol</tt>) from below. The first solve uses
+ * \c ssafd_ksp_forcing_max. Linear solves near convergence of the
+ * effective viscosity are as accurate as without the forcing term.
+ *
+ * If \c ssafd_restricted_domain is set, linear systems are solved only for
+ * velocities at some of the grid points (see setup_restricted_domain() and
+ * solve_restricted()).
+ */
+PetscErrorCode SSAFD::solve_picard() {
   PetscErrorCode ierr;
   Mat A = SSAStiffnessMatrix; // solve  A SSAX = SSARHS
   PetscReal   norm, normChange;
   PetscInt    ksp_iterations, ksp_iterations_total = 0, outer_iterations;
   KSPConvergedReason  reason;
 
-  stdout_ssa.clear();
-
   PetscReal ssaRelativeTolerance = config.get("ssafd_relative_convergence"),
             epsilon              = config.get("epsilon_ssa");
   PetscInt ssaMaxIterations = static_cast<PetscInt>(config.get("max_iterations_ssafd"));
   // this has no units; epsilon goes up by this ratio when previous value failed
   const PetscScalar DEFAULT_EPSILON_MULTIPLIER_SSA = 4.0;
 
-  ierr = velocity.copy_to(velocity_old); CHKERRQ(ierr);
-
-  // computation of RHS only needs to be done once; does not depend on
-  // solution; but matrix changes under nonlinear iteration (loop over k below)
-  ierr = assemble_rhs(SSARHS); CHKERRQ(ierr);
+  // inexact linear solves
+  const bool use_forcing = config.get_flag("ssafd_ksp_forcing");
+  const PetscReal forcing_max = config.get("ssafd_ksp_forcing_max"),
+    forcing_gamma = config.get("ssafd_ksp_forcing_gamma"),
+    forcing_alpha = config.get("ssafd_ksp_forcing_alpha");
+  PetscReal ksp_rtol, ksp_abstol, ksp_dtol, eta = 0.0;
+  PetscInt ksp_maxits;
+
+  // restricted-domain solves
+  bool restricted = config.get_flag("ssafd_restricted_domain");
+  if (restricted) {
+    PetscInt size, full_size;
+    ierr = setup_restricted_domain(size); CHKERRQ(ierr);
+    ierr = VecGetSize(SSAX, &full_size); CHKERRQ(ierr);
+    ierr = verbPrintf(3, grid.com,
+                      "  SSA: solving for %d of %d unknowns\n", size, full_size); CHKERRQ(ierr);
+    // there is no ice: solve the full system (it is cheap)
+    restricted = size > 0;
+  }
+  KSP ksp = restricted ? restricted_ksp : SSAKSP;
 
-  ierr = compute_hardav_staggered(hardness); CHKERRQ(ierr);
+  ierr = KSPGetTolerances(ksp, &ksp_rtol, &ksp_abstol, &ksp_dtol, &ksp_maxits); CHKERRQ(ierr);
 
   for (PetscInt l=0; ; ++l) { // iterate with increasing regularization parameter
     ierr = compute_nuH_staggered(nuH, epsilon); CHKERRQ(ierr);
 
+    eta = PetscMax(forcing_max, ksp_rtol);
+
     ierr = update_nuH_viewers(); CHKERRQ(ierr);
     // iterate on effective viscosity: "outer nonlinear iteration":
     for (PetscInt k = 0; k < ssaMaxIterations; ++k) {
@@ -763,12 +1278,20 @@ PetscErrorCode SSAFD::solve() {
         if (getVerbosityLevel() > 2)
           stdout_ssa += "A:";
 
+        if (use_forcing) {
+          ierr = KSPSetTolerances(ksp, eta, ksp_abstol, ksp_dtol, ksp_maxits); CHKERRQ(ierr);
+        }
+
         // call PETSc to solve linear system by iterative method; "inner iteration"
-        ierr = KSPSetOperators(SSAKSP, A, A, SAME_NONZERO_PATTERN); CHKERRQ(ierr);
-        ierr = KSPSolve(SSAKSP, SSARHS, SSAX); CHKERRQ(ierr); // SOLVE
+        if (restricted) {
+          ierr = solve_restricted(A); CHKERRQ(ierr);
+        } else {
+          ierr = KSPSetOperators(SSAKSP, A, A, SAME_NONZERO_PATTERN); CHKERRQ(ierr);
+          ierr = KSPSolve(SSAKSP, SSARHS, SSAX); CHKERRQ(ierr); // SOLVE
+        }
 
         // check if diverged; report to standard out about iteration
-        ierr = KSPGetConvergedReason(SSAKSP, &reason); CHKERRQ(ierr);
+        ierr = KSPGetConvergedReason(ksp, &reason); CHKERRQ(ierr);
         if (reason < 0) {
           // KSP diverged
           ierr = verbPrintf(1,grid.com,
@@ -800,10 +1323,14 @@ PetscErrorCode SSAFD::solve() {
           ierr = compute_nuH_staggered(nuH, epsilon); CHKERRQ(ierr);
         } else {
           // report on KSP success; the "inner" iteration is done
-          ierr = KSPGetIterationNumber(SSAKSP, &ksp_iterations); CHKERRQ(ierr);
+          ierr = KSPGetIterationNumber(ksp, &ksp_iterations); CHKERRQ(ierr);
           ksp_iterations_total += ksp_iterations;
           if (getVerbosityLevel() > 2) {
-            char tempstr[50] = "";  snprintf(tempstr,50, "S:%d,%d: ", ksp_iterations, reason);
+            char tempstr[50] = "";
+            if (use_forcing)
+              snprintf(tempstr,50, "S:%d,%d,%7.1e: ", ksp_iterations, reason, eta);
+            else
+              snprintf(tempstr,50, "S:%d,%d: ", ksp_iterations, reason);
             stdout_ssa += tempstr;
           }
         }
@@ -835,8 +1362,17 @@ PetscErrorCode SSAFD::solve() {
       }
 
       outer_iterations = k + 1;
+      solve_outer_iterations += 1;
       if (norm == 0 || normChange / norm < ssaRelativeTolerance) goto done;
 
+      if (use_forcing) {
+        const PetscReal eta_safe = forcing_gamma * pow(eta, forcing_alpha);
+        eta = forcing_gamma * pow(normChange / norm, forcing_alpha);
+        if (eta_safe > 0.1)
+          eta = PetscMax(eta, eta_safe);
+        eta = PetscMax(PetscMin(eta, forcing_max), ksp_rtol);
+      }
+
     } // end of the "outer loop" (index: k)
 
     if (epsilon > 0.0) {
@@ -857,6 +1393,12 @@ PetscErrorCode SSAFD::solve() {
 
   done:
 
+  solve_ksp_iterations += ksp_iterations_total;
+
+  if (use_forcing) {
+    ierr = KSPSetTolerances(ksp, ksp_rtol, ksp_abstol, ksp_dtol, ksp_maxits); CHKERRQ(ierr);
+  }
+
   if (getVerbosityLevel() > 2) {
     char tempstr[100] = "";
     snprintf(tempstr, 100, "... =%5d outer iterations, ~%3.1f KSP iterations each\n",
@@ -872,16 +1414,307 @@ PetscErrorCode SSAFD::solve() {
   if (getVerbosityLevel() >= 2)
     stdout_ssa = "  SSA: " + stdout_ssa;
 
-  if (config.get_flag("write_ssa_system_to_matlab")) {
-    ierr = writeSSAsystemMatlab(); CHKERRQ(ierr);
+  return 0;
+}
+
+//! \brief Chooses grid points at which solve_restricted() computes
+//! velocities and allocates objects it uses.
+/*!
+ * Linear systems solved in the Picard iteration contain equations of the form
+ * "velocity = known value" at points where the velocity is known (ice-free
+ * points if \c calving_front_stress_boundary_condition is set, Dirichlet
+ * boundary condition locations). These equations still cost memory and
+ * iterations of the linear solver. Moreover, velocities at points with
+ * frozen beds are negligible.
+ *
+ * Restricted-domain solves compute velocities only at points that
+ *
+ * - are not points where the velocity is known, and
+ * - contain ice which is floating or (if \c ssafd_restricted_tauc_max is
+ *   positive) has the yield stress at most \c ssafd_restricted_tauc_max,
+ *   or are at most \c ssafd_restricted_buffer grid cells away from such
+ *   points.
+ *
+ * Velocities at other points are set to the known value or zero.
+ *
+ * Sets `size` to the number of unknowns of the restricted system. Uses the
+ * right hand side computed by assemble_rhs().
+ */
+PetscErrorCode SSAFD::setup_restricted_domain(PetscInt &size) {
+  PetscErrorCode ierr;
+  PISMVector2 **marker_a, **fixed, **rhs;
+  Vec marker;
+  MaskQuery M(*mask);
+
+  const PetscInt buffer = static_cast<PetscInt>(config.get("ssafd_restricted_buffer"));
+  const PetscReal tauc_max = config.get("ssafd_restricted_tauc_max");
+
+  ierr = deallocate_restricted_domain(); CHKERRQ(ierr);
+
+  // points where ice can slide get restricted_mask = buffer + 1
+  ierr = fd_begin_access(); CHKERRQ(ierr);
+  ierr = restricted_mask.begin_access(); CHKERRQ(ierr);
+  for (PetscInt i=grid.xs; i<grid.xs+grid.xm; ++i) {
+    for (PetscInt j=grid.ys; j<grid.ys+grid.ym; ++j) {
+      FDStencil s;
+      ierr = fd_stencil(i, j, s); CHKERRQ(ierr);
+
+      const bool sliding = M.icy(i, j) &&
+        (M.ocean(i, j) || tauc_max <= 0.0 || (*tauc)(i, j) <= tauc_max);
+
+      restricted_mask(i, j) = (s.diagonal == false && sliding) ? buffer + 1 : 0;
+    }
   }
+  ierr = restricted_mask.end_access(); CHKERRQ(ierr);
+  ierr = fd_end_access(); CHKERRQ(ierr);
 
-  if (config.get_flag("scalebrutalSet")){
-    const PetscScalar sliding_scale_brutalFactor = config.get("sliding_scale_brutal");
-    ierr = velocity.scale(sliding_scale_brutalFactor); CHKERRQ(ierr);
+  // add the buffer: restricted_mask is positive at most buffer grid cells
+  // away from the points above
+  for (PetscInt n = 0; n < buffer; ++n) {
+    ierr = restricted_mask.beginGhostComm(); CHKERRQ(ierr);
+    ierr = restricted_mask.endGhostComm(); CHKERRQ(ierr);
+
+    ierr = restricted_mask.begin_access(); CHKERRQ(ierr);
+    for (PetscInt i=grid.xs; i<grid.xs+grid.xm; ++i) {
+      for (PetscInt j=grid.ys; j<grid.ys+grid.ym; ++j) {
+        const PetscReal neighbors = PetscMax(PetscMax(restricted_mask(i-1,j), restricted_mask(i+1,j)),
+                                             PetscMax(restricted_mask(i,j-1), restricted_mask(i,j+1)));
+        restricted_mask(i, j) = PetscMax(restricted_mask(i, j), neighbors - 1);
+      }
+    }
+    ierr = restricted_mask.end_access(); CHKERRQ(ierr);
+  }
+
+  // mark unknowns of the restricted system and store values of the others
+  ierr = VecDuplicate(SSAX, &marker); CHKERRQ(ierr);
+  ierr = VecDuplicate(SSAX, &restricted_fixed); CHKERRQ(ierr);
+
+  ierr = DMDAVecGetArray(SSADA, marker, &marker_a); CHKERRQ(ierr);
+  ierr = DMDAVecGetArray(SSADA, restricted_fixed, &fixed); CHKERRQ(ierr);
+  ierr = DMDAVecGetArray(SSADA, SSARHS, &rhs); CHKERRQ(ierr);
+  ierr = restricted_mask.begin_access(); CHKERRQ(ierr);
+  ierr = fd_begin_access(); CHKERRQ(ierr);
+  for (PetscInt i=grid.xs; i<grid.xs+grid.xm; ++i) {
+    for (PetscInt j=grid.ys; j<grid.ys+grid.ym; ++j) {
+      FDStencil s;
+      ierr = fd_stencil(i, j, s); CHKERRQ(ierr);
+
+      const PetscReal active = (s.diagonal == false && restricted_mask(i, j) > 0.5) ? 1.0 : 0.0;
+      marker_a[i][j].u = active;
+      marker_a[i][j].v = active;
+
+      if (s.diagonal) {
+        fixed[i][j].u = rhs[i][j].u / scaling;
+        fixed[i][j].v = rhs[i][j].v / scaling;
+      } else {
+        fixed[i][j].u = 0.0;
+        fixed[i][j].v = 0.0;
+      }
+    }
+  }
+  ierr = fd_end_access(); CHKERRQ(ierr);
+  ierr = restricted_mask.end_access(); CHKERRQ(ierr);
+  ierr = DMDAVecRestoreArray(SSADA, SSARHS, &rhs); CHKERRQ(ierr);
+  ierr = DMDAVecRestoreArray(SSADA, restricted_fixed, &fixed); CHKERRQ(ierr);
+  ierr = DMDAVecRestoreArray(SSADA, marker, &marker_a); CHKERRQ(ierr);
+
+  // global indices of unknowns of the restricted system
+  vector<PetscInt> indices;
+  {
+    PetscInt low, high;
+    PetscScalar *a;
+    ierr = VecGetOwnershipRange(marker, &low, &high); CHKERRQ(ierr);
+    ierr = VecGetArray(marker, &a); CHKERRQ(ierr);
+    for (PetscInt k = 0; k < high - low; ++k) {
+      if (a[k] > 0.5)
+        indices.push_back(low + k);
+    }
+    ierr = VecRestoreArray(marker, &a); CHKERRQ(ierr);
+  }
+  ierr = VecDestroy(&marker); CHKERRQ(ierr);
+
+  const PetscInt local_size = static_cast<PetscInt>(indices.size());
+  ierr = ISCreateGeneral(grid.com, local_size, local_size > 0 ? &indices[0] : PETSC_NULL,
+                         PETSC_COPY_VALUES, &restricted_is); CHKERRQ(ierr);
+
+  ierr = VecCreateMPI(grid.com, local_size, PETSC_DETERMINE, &restricted_x); CHKERRQ(ierr);
+  ierr = VecDuplicate(restricted_x, &restricted_rhs); CHKERRQ(ierr);
+  ierr = VecScatterCreate(SSAX, restricted_is, restricted_x, PETSC_NULL,
+                          &restricted_scatter); CHKERRQ(ierr);
+
+  ierr = VecGetSize(restricted_x, &size); CHKERRQ(ierr);
+
+  // the size of the system changed
+  ierr = KSPReset(restricted_ksp); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! \brief Solves the system with the matrix `A` and the right hand side
+//! SSARHS for velocities at points chosen by setup_restricted_domain().
+/*!
+ * Sets SSAX, including velocities at other points. Uses restricted_ksp
+ * (options prefix <tt>-ssafd_restricted_</tt>, e.g.
+ * <tt>-ssafd_restricted_ksp_type</tt>).
+ */
+PetscErrorCode SSAFD::solve_restricted(Mat A) {
+  PetscErrorCode ierr;
+
+  // the right hand side: b - A x_fixed at the unknowns (SSAX is used as
+  // storage)
+  ierr = MatMult(A, restricted_fixed, SSAX); CHKERRQ(ierr);
+  ierr = VecAYPX(SSAX, -1.0, SSARHS); CHKERRQ(ierr);
+  ierr = VecScatterBegin(restricted_scatter, SSAX, restricted_rhs,
+                         INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+  ierr = VecScatterEnd(restricted_scatter, SSAX, restricted_rhs,
+                       INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+
+  ierr = MatGetSubMatrix(A, restricted_is, restricted_is,
+                         restricted_matrix == PETSC_NULL ? MAT_INITIAL_MATRIX : MAT_REUSE_MATRIX,
+                         &restricted_matrix); CHKERRQ(ierr);
+
+  ierr = KSPSetOperators(restricted_ksp, restricted_matrix, restricted_matrix,
+                         SAME_NONZERO_PATTERN); CHKERRQ(ierr);
+  ierr = KSPSolve(restricted_ksp, restricted_rhs, restricted_x); CHKERRQ(ierr);
+
+  ierr = VecCopy(restricted_fixed, SSAX); CHKERRQ(ierr);
+  ierr = VecScatterBegin(restricted_scatter, restricted_x, SSAX,
+                         INSERT_VALUES, SCATTER_REVERSE); CHKERRQ(ierr);
+  ierr = VecScatterEnd(restricted_scatter, restricted_x, SSAX,
+                       INSERT_VALUES, SCATTER_REVERSE); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! \brief De-allocate objects allocated by setup_restricted_domain().
+PetscErrorCode SSAFD::deallocate_restricted_domain() {
+  PetscErrorCode ierr;
+
+  if (restricted_matrix != PETSC_NULL) {
+    ierr = MatDestroy(&restricted_matrix); CHKERRQ(ierr);
+  }
+
+  if (restricted_scatter != PETSC_NULL) {
+    ierr = VecScatterDestroy(&restricted_scatter); CHKERRQ(ierr);
+  }
+
+  if (restricted_is != PETSC_NULL) {
+    ierr = ISDestroy(&restricted_is); CHKERRQ(ierr);
+  }
+
+  if (restricted_x != PETSC_NULL) {
+    ierr = VecDestroy(&restricted_x); CHKERRQ(ierr);
+  }
+
+  if (restricted_rhs != PETSC_NULL) {
+    ierr = VecDestroy(&restricted_rhs); CHKERRQ(ierr);
+  }
 
+  if (restricted_fixed != PETSC_NULL) {
+    ierr = VecDestroy(&restricted_fixed); CHKERRQ(ierr);
+  }
+
+  return 0;
+}
+
+//! \brief Solves the SSA using a few Picard iterations followed by Newton's
+//! method.
+/*!
+ * Newton's method solves the same discrete system as solve_picard() (with
+ * the regularization \c epsilon_ssa fixed), using a PETSc SNES (options
+ * prefix <tt>-ssafd_</tt>) with a line search. The Jacobian is assembled by
+ * assemble_jacobian(); the "jfnk" variant uses finite-difference
+ * matrix-vector products instead, preconditioned by the Picard matrix.
+ *
+ * Picard iterations (\c ssafd_picard_iterations of them) provide a starting
+ * point in the region of convergence of Newton's method.
+ *
+ * Sets `success` to false (and leaves `velocity` in an unspecified state) if
+ * a linear solve in a Picard iteration or Newton's method failed.
+ */
+PetscErrorCode SSAFD::solve_newton(bool &success) {
+  PetscErrorCode ierr;
+  KSPConvergedReason ksp_reason;
+  SNESConvergedReason reason;
+  PetscInt ksp_iterations, ksp_iterations_total = 0,
+    newton_iterations = 0, linear_iterations = 0;
+
+  const bool jfnk = config.get_string("ssafd_nonlinear_solver") == "jfnk";
+  const PetscInt picard_iterations = static_cast<PetscInt>(config.get("ssafd_picard_iterations"));
+
+  success = false;
+  newton_epsilon = config.get("epsilon_ssa");
+
+  if (newton == NULL) {
+    newton = new SSAFD_SNES(*this);
+    ierr = newton->setup(jfnk, config.get("ssafd_newton_relative_tolerance"),
+                         static_cast<PetscInt>(config.get("max_iterations_ssafd"))); CHKERRQ(ierr);
+  }
+
+  ierr = compute_nuH_staggered(nuH, newton_epsilon); CHKERRQ(ierr);
+
+  for (PetscInt k = 0; k < picard_iterations; ++k) {
+    ierr = assemble_matrix(true, SSAStiffnessMatrix); CHKERRQ(ierr);
+
+    ierr = KSPSetOperators(SSAKSP, SSAStiffnessMatrix, SSAStiffnessMatrix,
+                           SAME_NONZERO_PATTERN); CHKERRQ(ierr);
+    ierr = KSPSolve(SSAKSP, SSARHS, SSAX); CHKERRQ(ierr);
+
+    ierr = KSPGetConvergedReason(SSAKSP, &ksp_reason); CHKERRQ(ierr);
+    if (ksp_reason < 0) {
+      ierr = verbPrintf(1, grid.com,
+                        "PISM WARNING: KSPSolve() reports 'diverged' (reason = '%s') during\n"
+                        "  Picard iterations preceding Newton's method. Using Picard iterations only...\n",
+                        KSPConvergedReasons[ksp_reason]); CHKERRQ(ierr);
+      return 0;
+    }
+
+    ierr = KSPGetIterationNumber(SSAKSP, &ksp_iterations); CHKERRQ(ierr);
+    ksp_iterations_total += ksp_iterations;
+    solve_ksp_iterations += ksp_iterations;
+    solve_outer_iterations += 1;
+
+    ierr = velocity.copy_from(SSAX); CHKERRQ(ierr);
     ierr = velocity.beginGhostComm(); CHKERRQ(ierr);
     ierr = velocity.endGhostComm(); CHKERRQ(ierr);
+
+    ierr = compute_nuH_staggered(nuH, newton_epsilon); CHKERRQ(ierr);
+  }
+
+  ierr = velocity.copy_to(newton->solution()); CHKERRQ(ierr);
+
+  ierr = newton->try_solve(reason, newton_iterations, linear_iterations); CHKERRQ(ierr);
+  solve_outer_iterations += newton_iterations;
+  solve_ksp_iterations += linear_iterations;
+
+  if (reason < 0) {
+    ierr = verbPrintf(1, grid.com,
+                      "PISM WARNING: SSAFD: Newton's method failed (SNES reason = '%s').\n"
+                      "  Using Picard iterations only...\n",
+                      SNESConvergedReasons[reason]); CHKERRQ(ierr);
+    return 0;
+  }
+
+  success = true;
+
+  ierr = VecCopy(newton->solution(), SSAX); CHKERRQ(ierr);
+  ierr = velocity.copy_from(SSAX); CHKERRQ(ierr);
+  ierr = velocity.beginGhostComm(); CHKERRQ(ierr);
+  ierr = velocity.endGhostComm(); CHKERRQ(ierr);
+
+  ierr = compute_nuH_staggered(nuH, newton_epsilon); CHKERRQ(ierr);
+  ierr = update_nuH_viewers(); CHKERRQ(ierr);
+
+  // Report the number of "outer" iterations (Picard iterations and Newton
+  // steps), comparable to the number reported by solve_picard().
+  const PetscInt outer_iterations = picard_iterations + newton_iterations;
+  if (getVerbosityLevel() >= 2) {
+    char tempstr[150] = "";
+    snprintf(tempstr, 150, "%5d outer iterations (%d Picard + %d %s), ~%3.1f KSP iterations each\n",
+             outer_iterations, picard_iterations, newton_iterations,
+             jfnk ? "JFNK" : "Newton",
+             ((double) (ksp_iterations_total + linear_iterations)) / PetscMax(outer_iterations, 1));
+    stdout_ssa = "  SSA: " + string(tempstr);
   }
 
   return 0;
@@ -1048,6 +1881,9 @@ PetscErrorCode SSAFD::compute_hardav_staggered(IceModelVec2Stag &result) {
   ierr = enthalpy->end_access(); CHKERRQ(ierr);
   ierr = thickness->end_access(); CHKERRQ(ierr);
 
+  ierr = result.beginGhostComm(); CHKERRQ(ierr);
+  ierr = result.endGhostComm(); CHKERRQ(ierr);
+
   delete [] E;
   return 0;
 }
@@ -1306,3 +2142,148 @@ void SSAFD::get_diagnostics(map<string, PISMDiagnostic*> &dict) {
   dict["nuH"] = new SSAFD_nuH(this, grid, *variables);
 }
 
+void SSAFD::get_ts_diagnostics(map<string, PISMTSDiagnostic*> &dict) {
+  SSA::get_ts_diagnostics(dict);
+
+  dict["ssafd_outer_iterations"] = new SSAFD_outer_iterations(this, grid, *variables);
+  dict["ssafd_ksp_iterations"]   = new SSAFD_ksp_iterations(this, grid, *variables);
+  dict["ssafd_solve_time"]       = new SSAFD_solve_time(this, grid, *variables);
+}
+
+SSAFD_outer_iterations::SSAFD_outer_iterations(SSAFD *m, IceGrid &g, PISMVars &my_vars)
+  : PISMTSDiag<SSAFD>(m, g, my_vars) {
+
+  // set metadata:
+  ts = new DiagnosticTimeseries(&grid, "ssafd_outer_iterations", time_dimension_name);
+
+  ts->set_units("1", "");
+  ts->set_dimension_units(time_units, "");
+  ts->set_attr("long_name", "number of outer (nonlinear) iterations of the most recent SSAFD solve");
+}
+
+PetscErrorCode SSAFD_outer_iterations::update(PetscReal a, PetscReal b) {
+  PetscErrorCode ierr;
+
+  ierr = ts->append(model->solve_outer_iterations, a, b); CHKERRQ(ierr);
+
+  return 0;
+}
+
+SSAFD_ksp_iterations::SSAFD_ksp_iterations(SSAFD *m, IceGrid &g, PISMVars &my_vars)
+  : PISMTSDiag<SSAFD>(m, g, my_vars) {
+
+  // set metadata:
+  ts = new DiagnosticTimeseries(&grid, "ssafd_ksp_iterations", time_dimension_name);
+
+  ts->set_units("1", "");
+  ts->set_dimension_units(time_units, "");
+  ts->set_attr("long_name", "number of KSP (linear) iterations of the most recent SSAFD solve");
+}
+
+PetscErrorCode SSAFD_ksp_iterations::update(PetscReal a, PetscReal b) {
+  PetscErrorCode ierr;
+
+  ierr = ts->append(model->solve_ksp_iterations, a, b); CHKERRQ(ierr);
+
+  return 0;
+}
+
+SSAFD_solve_time::SSAFD_solve_time(SSAFD *m, IceGrid &g, PISMVars &my_vars)
+  : PISMTSDiag<SSAFD>(m, g, my_vars) {
+
+  // set metadata:
+  ts = new DiagnosticTimeseries(&grid, "ssafd_solve_time", time_dimension_name);
+
+  ts->set_units("second", "");
+  ts->set_dimension_units(time_units, "");
+  ts->set_attr("long_name", "wall-clock time of the most recent SSAFD solve (processor 0)");
+}
+
+PetscErrorCode SSAFD_solve_time::update(PetscReal a, PetscReal b) {
+  PetscErrorCode ierr;
+
+  ierr = ts->append(model->solve_wall_time, a, b); CHKERRQ(ierr);
+
+  return 0;
+}
+
+
+SSAFD_SNES::SSAFD_SNES(SSAFD &ssa)
+  : SNESVectorProblem(ssa.grid), m_ssa(ssa), m_jfnk(false) {
+}
+
+const char *SSAFD_SNES::name() {
+  return "SSAFD";
+}
+
+//! \brief Sets tolerances and the preconditioner; use `jfnk` to approximate
+//! Jacobian-vector products by finite differences.
+/*!
+ * Uses the options prefix <tt>-ssafd_</tt>, so runtime options such as
+ * <tt>-ssafd_snes_monitor</tt> and <tt>-ssafd_snes_linesearch_type</tt>
+ * override these settings.
+ */
+PetscErrorCode SSAFD_SNES::setup(bool jfnk, PetscReal rtol, PetscInt max_iterations) {
+  PetscErrorCode ierr;
+  KSP ksp;
+  PC pc;
+
+  m_jfnk = jfnk;
+
+  ierr = SNESSetOptionsPrefix(m_snes, "ssafd_"); CHKERRQ(ierr);
+
+  ierr = SNESSetTolerances(m_snes, PETSC_DEFAULT, rtol, PETSC_DEFAULT,
+                           max_iterations, PETSC_DEFAULT); CHKERRQ(ierr);
+
+  // same default preconditioner as in the Picard iteration (see
+  // SSAFD::allocate_linear_system())
+  ierr = SNESGetKSP(m_snes, &ksp); CHKERRQ(ierr);
+  ierr = KSPGetPC(ksp, &pc); CHKERRQ(ierr);
+  ierr = PCSetType(pc, PCBJACOBI); CHKERRQ(ierr);
+
+  if (m_jfnk) {
+    // Jacobian-vector products are approximated by finite differences;
+    // compute_local_jacobian() assembles the Picard matrix, which is then
+    // used as the preconditioner only (same as -ssafd_snes_mf_operator, but
+    // without changing the global options database)
+    Mat J_mf, B;
+    ierr = MatCreateSNESMF(m_snes, &J_mf); CHKERRQ(ierr);
+    ierr = MatMFFDSetOptionsPrefix(J_mf, "ssafd_"); CHKERRQ(ierr);
+    ierr = MatSetFromOptions(J_mf); CHKERRQ(ierr);
+
+    // keep the preconditioner matrix (if it is already allocated)
+    ierr = SNESGetJacobian(m_snes, PETSC_NULL, &B, PETSC_NULL, PETSC_NULL); CHKERRQ(ierr);
+    ierr = SNESSetJacobian(m_snes, J_mf, B, PETSC_NULL, PETSC_NULL); CHKERRQ(ierr);
+    // the SNES keeps a reference
+    ierr = MatDestroy(&J_mf); CHKERRQ(ierr);
+  }
+
+  ierr = SNESSetFromOptions(m_snes); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! \brief Runs Newton's method starting from solution(); does not stop if it
+//! fails to converge.
+PetscErrorCode SSAFD_SNES::try_solve(SNESConvergedReason &reason, PetscInt &iterations,
+                                     PetscInt &linear_iterations) {
+  PetscErrorCode ierr;
+
+  ierr = SNESSolve(m_snes, NULL, m_X); CHKERRQ(ierr);
+
+  ierr = SNESGetConvergedReason(m_snes, &reason); CHKERRQ(ierr);
+  ierr = SNESGetIterationNumber(m_snes, &iterations); CHKERRQ(ierr);
+  ierr = SNESGetLinearSolveIterations(m_snes, &linear_iterations); CHKERRQ(ierr);
+
+  return 0;
+}
+
+PetscErrorCode SSAFD_SNES::compute_local_function(DMDALocalInfo *, const PISMVector2 **x,
+                                                  PISMVector2 **f) {
+  return m_ssa.compute_residual(x, f);
+}
+
+PetscErrorCode SSAFD_SNES::compute_local_jacobian(DMDALocalInfo *, const PISMVector2 **x,
+                                                  Mat J) {
+  return m_ssa.assemble_jacobian(x, m_jfnk, J);
+}
@@ -20,17 +20,51 @@
 #define _SSAFD_H_
 
 #include "SSA.hh"
+#include "SNESProblem.hh"
 #include <petscksp.h>
 
+class SSAFD;
+
+//! \brief The nonlinear problem solved by SSAFD using Newton's method (see
+//! SSAFD::solve_newton()).
+/*!
+ * Residuals and Jacobians are computed by SSAFD::compute_residual() and
+ * SSAFD::assemble_jacobian().
+ */
+class SSAFD_SNES : public SNESVectorProblem
+{
+public:
+  SSAFD_SNES(SSAFD &ssa);
+  virtual ~SSAFD_SNES() {}
+
+  PetscErrorCode setup(bool jfnk, PetscReal rtol, PetscInt max_iterations);
+
+  PetscErrorCode try_solve(SNESConvergedReason &reason, PetscInt &iterations,
+                           PetscInt &linear_iterations);
+
+  virtual const char *name();
+protected:
+  virtual PetscErrorCode compute_local_function(DMDALocalInfo *info, const PISMVector2 **x,
+                                                PISMVector2 **f);
+  virtual PetscErrorCode compute_local_jacobian(DMDALocalInfo *info, const PISMVector2 **x,
+                                                Mat J);
+  SSAFD &m_ssa;
+  bool m_jfnk;
+};
+
 
 //! PISM's SSA solver: the finite difference implementation
 class SSAFD : public SSA
 {
   friend class SSAFD_nuH;
+  friend class SSAFD_SNES;
+  friend class SSAFD_outer_iterations;
+  friend class SSAFD_ksp_iterations;
+  friend class SSAFD_solve_time;
 public:
   SSAFD(IceGrid &g, IceBasalResistancePlasticLaw &b, EnthalpyConverter &e,
         const NCConfigVariable &c) :
-    SSA(g,b,e,c)
+    SSA(g,b,e,c), newton(NULL)
   {
     PetscErrorCode ierr = allocate_fd();
     if (ierr != 0) {
@@ -51,13 +85,23 @@ public:
   virtual PetscErrorCode init(PISMVars &vars);
 
   virtual void get_diagnostics(map<string, PISMDiagnostic*> &dict);
+
+  virtual void get_ts_diagnostics(map<string, PISMTSDiagnostic*> &dict);
+
+  virtual PetscErrorCode redistribute();
 protected:
   virtual PetscErrorCode allocate_fd();
 
+  virtual PetscErrorCode allocate_linear_system();
+
   virtual PetscErrorCode deallocate_fd();
 
   virtual PetscErrorCode solve();
 
+  virtual PetscErrorCode solve_picard();
+
+  virtual PetscErrorCode solve_newton(bool &success);
+
   virtual PetscErrorCode compute_hardav_staggered(IceModelVec2Stag &result);
 
   virtual PetscErrorCode compute_nuH_staggered(IceModelVec2Stag &result,
@@ -79,6 +123,50 @@ protected:
 
   virtual bool is_marginal(int i, int j, bool ssa_dirichlet_bc);
 
+  //! \brief Description of the discretization of the SSA at a grid point;
+  //! see fd_stencil().
+  struct FDStencil {
+    //! true if the equations at this point are "velocity = known value"
+    bool diagonal;
+    //! nu * H at the staggered grid points west, east, south and north of the point
+    PetscReal c[4];
+    //! true if c[n] does not depend on the velocity
+    bool c_fixed[4];
+    //! weights selecting centered or one-sided differences (see assemble_matrix())
+    PetscInt aMn, aPn, aMM, aPP, aMs, aPs, bPw, bPP, bPe, bMw, bMM, bMe;
+  };
+
+  PetscErrorCode fd_begin_access();
+
+  PetscErrorCode fd_end_access();
+
+  PetscErrorCode fd_stencil(PetscInt i, PetscInt j, FDStencil &s);
+
+  void fd_coefficients(const FDStencil &s, const PetscReal c[4],
+                       PetscReal eq1[18], PetscReal eq2[18]);
+
+  void fd_columns(PetscInt i, PetscInt j, MatStencil col[18]);
+
+  void fd_basal_drag(PetscInt i, PetscInt j, PetscReal u, PetscReal v,
+                     PetscReal &beta, PetscReal *dbeta);
+
+  PetscInt nuH_derivative(const PISMVector2 **x, PetscInt i, PetscInt j, PetscInt o,
+                          PetscInt di[6], PetscInt dj[6], PetscReal du[6], PetscReal dv[6]);
+
+  PetscErrorCode set_velocity(const PISMVector2 **x);
+
+  PetscErrorCode compute_residual(const PISMVector2 **x, PISMVector2 **f);
+
+  virtual PetscErrorCode residual_norm(IceModelVec2V &u, PetscReal &result);
+
+  PetscErrorCode assemble_jacobian(const PISMVector2 **x, bool picard, Mat J);
+
+  PetscErrorCode setup_restricted_domain(PetscInt &size);
+
+  PetscErrorCode solve_restricted(Mat A);
+
+  PetscErrorCode deallocate_restricted_domain();
+
   // objects used internally
   IceModelVec2Stag hardness, nuH, nuH_old;
   KSP SSAKSP;
@@ -86,11 +174,32 @@ protected:
   Vec SSARHS;
   PetscScalar scaling;
 
+  // objects used by restricted-domain linear solves (see
+  // setup_restricted_domain())
+  KSP restricted_ksp;
+  Mat restricted_matrix;
+  Vec restricted_x, restricted_rhs, restricted_fixed;
+  IS restricted_is;
+  VecScatter restricted_scatter;
+  IceModelVec2Int restricted_mask;
+
   bool view_nuh;
   PetscViewer nuh_viewer;
   PetscInt nuh_viewer_size;
 
   bool dump_system_matlab;
+
+  SSAFD_SNES *newton;           //!< allocated on first use
+  PetscReal newton_epsilon;     //!< regularization used by Newton's method
+
+  // convergence history of the most recent call of solve(); see
+  // get_ts_diagnostics()
+  PetscInt solve_outer_iterations, solve_ksp_iterations;
+  PetscReal solve_wall_time;
+
+  // settings used by fd_stencil() and fd_basal_drag(); see fd_begin_access()
+  bool fd_use_cfbc, fd_bedrock_boundary, fd_nu_bedrock_set;
+  PetscReal fd_nu_bedrock, fd_beta_ice_free_bedrock;
 };
 
 //! Constructs a new SSAFD
@@ -106,5 +215,30 @@ public:
   virtual PetscErrorCode compute(IceModelVec* &result);
 };
 
+//! \brief Reports the total number of outer (nonlinear) iterations of the
+//! SSAFD solver.
+class SSAFD_outer_iterations : public PISMTSDiag<SSAFD>
+{
+public:
+  SSAFD_outer_iterations(SSAFD *m, IceGrid &g, PISMVars &my_vars);
+  virtual PetscErrorCode update(PetscReal a, PetscReal b);
+};
+
+//! \brief Reports the total number of KSP iterations of the SSAFD solver.
+class SSAFD_ksp_iterations : public PISMTSDiag<SSAFD>
+{
+public:
+  SSAFD_ksp_iterations(SSAFD *m, IceGrid &g, PISMVars &my_vars);
+  virtual PetscErrorCode update(PetscReal a, PetscReal b);
+};
+
+//! \brief Reports the total wall-clock time spent in SSAFD::solve().
+class SSAFD_solve_time : public PISMTSDiag<SSAFD>
+{
+public:
+  SSAFD_solve_time(SSAFD *m, IceGrid &g, PISMVars &my_vars);
+  virtual PetscErrorCode update(PetscReal a, PetscReal b);
+};
+
 #endif /* _SSAFD_H_ */
 
@@ -38,6 +38,23 @@ PetscErrorCode SSAFEM::allocate_fem() {
   earth_grav = config.get("standard_gravity");
   m_beta_ice_free_bedrock = config.get("beta_ice_free_bedrock");
 
+  ierr = allocate_snes(); CHKERRQ(ierr);
+
+  // hardav IceModelVec2S is not used (so far).
+  const PetscScalar power = 1.0 / flow_law->exponent();
+  char unitstr[TEMPORARY_STRING_LENGTH];
+  snprintf(unitstr, sizeof(unitstr), "Pa s%f", power);
+  ierr = hardav.create(grid, "hardav", true); CHKERRQ(ierr);
+  ierr = hardav.set_attrs("internal", "vertically-averaged ice hardness", unitstr, ""); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! \brief Allocate the SNES and per-element storage (they depend on SSADA and
+//! the domain decomposition).
+PetscErrorCode SSAFEM::allocate_snes() {
+  PetscErrorCode ierr;
+
   ierr = SNESCreate(grid.com, &snes);CHKERRQ(ierr);
 
   // Set the SNES callbacks to call into our compute_local_function and compute_local_jacobian
@@ -47,10 +64,14 @@ PetscErrorCode SSAFEM::allocate_fem() {
   ierr = DMDASetLocalFunction(SSADA, (DMDALocalFunction1)SSAFEFunction); CHKERRQ(ierr);
   ierr = DMDASetLocalJacobian(SSADA, (DMDALocalFunction1)SSAFEJacobian); CHKERRQ(ierr);
 
+  // Galerkin coarse operators of the multigrid preconditioner (see
+  // SSA::set_preconditioner()) need AIJ matrices
+  const char *mat_type = config.get_string("ssa_preconditioner") == "mg" ? "aij" : "baij";
+
 #if PISM_PETSC32_COMPAT==1
   Mat J;
   Vec r;
-  ierr = DMGetMatrix(SSADA, "baij",  &J); CHKERRQ(ierr);
+  ierr = DMGetMatrix(SSADA, mat_type,  &J); CHKERRQ(ierr);
   ierr = DMCreateGlobalVector(SSADA, &r); CHKERRQ(ierr);
 
   ierr = SNESSetFunction(snes, r,    SNESDAFormFunction,   &callback_data); CHKERRQ(ierr);
@@ -60,7 +81,7 @@ PetscErrorCode SSAFEM::allocate_fem() {
   ierr = MatDestroy(&J); CHKERRQ(ierr);
   ierr = VecDestroy(&r); CHKERRQ(ierr);
 #else
-  ierr = DMSetMatType(SSADA, "baij"); CHKERRQ(ierr);
+  ierr = DMSetMatType(SSADA, mat_type); CHKERRQ(ierr);
   ierr = DMSetApplicationContext(SSADA, &callback_data); CHKERRQ(ierr);
 #endif
 
@@ -72,6 +93,10 @@ PetscErrorCode SSAFEM::allocate_fem() {
                            snes_max_it,PETSC_DEFAULT);
   // ierr = SNESSetOptionsPrefix(snes,((PetscObject)this)->prefix);CHKERRQ(ierr);
 
+  KSP ksp;
+  ierr = SNESGetKSP(snes, &ksp); CHKERRQ(ierr);
+  ierr = set_preconditioner(ksp); CHKERRQ(ierr);
+
   ierr = SNESSetFromOptions(snes);CHKERRQ(ierr);
 
   // Allocate feStore, which contains coefficient data at the quadrature points of all the elements.
@@ -79,13 +104,6 @@ PetscErrorCode SSAFEM::allocate_fem() {
   PetscInt nElements = element_index.element_count();
   feStore = new FEStoreNode[FEQuadrature::Nq*nElements];
 
-  // hardav IceModelVec2S is not used (so far).
-  const PetscScalar power = 1.0 / flow_law->exponent();
-  char unitstr[TEMPORARY_STRING_LENGTH];
-  snprintf(unitstr, sizeof(unitstr), "Pa s%f", power);
-  ierr = hardav.create(grid, "hardav", true); CHKERRQ(ierr);
-  ierr = hardav.set_attrs("internal", "vertically-averaged ice hardness", unitstr, ""); CHKERRQ(ierr);
-
   return 0;
 }
 
@@ -99,6 +117,22 @@ PetscErrorCode SSAFEM::deallocate_fem() {
   return 0;
 }
 
+//! \brief Re-create SSADA, the SNES and per-element storage after a change of
+//! the domain decomposition.
+PetscErrorCode SSAFEM::redistribute() {
+  PetscErrorCode ierr;
+
+  ierr = SSA::redistribute(); CHKERRQ(ierr);
+
+  ierr = deallocate_fem(); CHKERRQ(ierr);
+
+  element_index = FEElementMap(grid);
+
+  ierr = allocate_snes(); CHKERRQ(ierr);
+
+  return 0;
+}
+
 // Initialize the solver, called once by the client before use.
 PetscErrorCode SSAFEM::init(PISMVars &vars) {
   PetscErrorCode ierr;
@@ -169,6 +203,10 @@ PetscErrorCode SSAFEM::solve()
   // Set up the system to solve (store coefficient data at the quadrature points):
   ierr = setup(); CHKERRQ(ierr);
 
+  // Choose the initial guess:
+  ierr = extrapolate_velocity(); CHKERRQ(ierr);
+  ierr = velocity.copy_to(SSAX); CHKERRQ(ierr);
+
   // Solve:
   ierr = SNESSolve(snes,NULL,SSAX);CHKERRQ(ierr);
 
@@ -203,6 +241,23 @@ PetscErrorCode SSAFEM::solve()
   return 0;
 }
 
+//! \brief Computes the 2-norm of the residual (as computed by the SNES) at `u`.
+/*!
+ * Requires data stored by setup(). Sets `SSAX`.
+ */
+PetscErrorCode SSAFEM::residual_norm(IceModelVec2V &u, PetscReal &result) {
+  PetscErrorCode ierr;
+  Vec r;
+
+  ierr = SNESGetFunction(snes, &r, PETSC_NULL, PETSC_NULL); CHKERRQ(ierr);
+
+  ierr = u.copy_to(SSAX); CHKERRQ(ierr);
+  ierr = SNESComputeFunction(snes, SSAX, r); CHKERRQ(ierr);
+  ierr = VecNorm(r, NORM_2, &result); CHKERRQ(ierr);
+
+  return 0;
+}
+
 //! Initialize stored data from the coefficients in the SSA.  Called by SSAFEM::solve.
 /* This method is should be called after SSAFEM::init and whenever
 any geometry or temperature related coefficients have changed. The method
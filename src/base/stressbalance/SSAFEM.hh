@@ -84,6 +84,8 @@ public:
 
   virtual PetscErrorCode init(PISMVars &vars);
 
+  virtual PetscErrorCode redistribute();
+
 protected:
   PetscErrorCode setup();
 
@@ -96,6 +98,8 @@ protected:
 
   virtual PetscErrorCode allocate_fem();
 
+  virtual PetscErrorCode allocate_snes();
+
   virtual PetscErrorCode deallocate_fem();
 
   virtual PetscErrorCode compute_local_function(DMDALocalInfo *info, const PISMVector2 **xg, PISMVector2 **yg);
@@ -103,6 +107,8 @@ protected:
   virtual PetscErrorCode compute_local_jacobian(DMDALocalInfo *info, const PISMVector2 **xg, Mat J);
 
   virtual PetscErrorCode solve();
+
+  virtual PetscErrorCode residual_norm(IceModelVec2V &u, PetscReal &result);
   
   virtual PetscErrorCode setFromOptions();
 
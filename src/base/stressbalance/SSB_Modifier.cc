@@ -21,6 +21,7 @@
 #include "PISMVars.hh"
 #include "IceGrid.hh"
 #include "flowlaw_factory.hh"
+#include "PISMGhostCommGroup.hh"
 
 PetscErrorCode SSB_Modifier::allocate() {
   PetscErrorCode ierr;
@@ -139,10 +140,11 @@ PetscErrorCode SSBM_Trivial::update(IceModelVec2V *vel_input,
   ierr = u.end_access(); CHKERRQ(ierr);  
 
   // Communicate to get ghosts (needed to compute w):
-  ierr = u.beginGhostComm(); CHKERRQ(ierr);
-  ierr = v.beginGhostComm(); CHKERRQ(ierr);
-  ierr = u.endGhostComm(); CHKERRQ(ierr);
-  ierr = v.endGhostComm(); CHKERRQ(ierr);
+  PISMGhostCommGroup ghosts(grid);
+  ierr = ghosts.add(u); CHKERRQ(ierr);
+  ierr = ghosts.add(v); CHKERRQ(ierr);
+  ierr = ghosts.beginGhostComm(); CHKERRQ(ierr);
+  ierr = ghosts.endGhostComm(); CHKERRQ(ierr);
 
   ierr = PISMGlobalMax(&my_u_max, &u_max, grid.com); CHKERRQ(ierr);
   ierr = PISMGlobalMax(&my_v_max, &v_max, grid.com); CHKERRQ(ierr);
@@ -0,0 +1,769 @@
+// Copyright (C) 2012 PISM Authors
+//
+// This file is part of PISM.
+//
+// PISM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 2 of the License, or (at your option) any later
+// version.
+//
+// PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License
+// along with PISM; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include <cmath>
+#include <algorithm>
+#include <set>
+
+#include "PISMTracerParticles.hh"
+#include "PISMVars.hh"
+#include "PISMStressBalance.hh"
+#include "enthalpyConverter.hh"
+#include "PISMTime.hh"
+#include "PIO.hh"
+#include "IceGrid.hh"
+#include "pism_const.hh"
+
+//! Returns a pointer to the first element of `v` (NULL if `v` is empty).
+static inline PetscReal* data_pointer(vector<PetscReal> &v) {
+  return v.empty() ? NULL : &v[0];
+}
+
+PISMTracerParticles::PISMTracerParticles(IceGrid &g, const NCConfigVariable &conf,
+                                         EnthalpyConverter &my_EC,
+                                         PISMStressBalance *my_stress_balance)
+  : PISMComponent_TS(g, conf), EC(my_EC), stress_balance(my_stress_balance) {
+  thickness = NULL;
+  enthalpy = NULL;
+
+  m_record_size = N_POSITION_FIELDS;
+  m_seed_round = 0;
+  m_next_seed = m_next_output = 0;
+  m_file_is_ready = false;
+
+  // the order has to match T_ORIGIN, ..., TEMP_MAX
+  add_attribute("t_origin", "s", "model time of seeding");
+  add_attribute("x_origin", "m", "x-coordinate of the seeding location");
+  add_attribute("y_origin", "m", "y-coordinate of the seeding location");
+  add_attribute("z_origin", "m", "height above the ice base at the seeding location");
+  add_attribute("temp_max", "K", "maximum ice temperature seen by the particle");
+
+  m_w.create(grid, "tracer_wvel", true);
+}
+
+//! \brief Adds a particle attribute (stored after the ones added before).
+/*!
+ * Has to be called before particles are seeded, i.e. in constructors.
+ */
+PetscErrorCode PISMTracerParticles::add_attribute(string name, string units, string long_name) {
+  if (m_particles.empty() == false)
+    SETERRQ(grid.com, 1, "PISMTracerParticles::add_attribute(): particles are already seeded");
+
+  m_attributes.push_back(Attribute(name, units, long_name));
+  m_record_size++;
+
+  return 0;
+}
+
+//! \brief Initialize tracer particles: seed them and write initial positions.
+PetscErrorCode PISMTracerParticles::init(PISMVars &vars) {
+  PetscErrorCode ierr;
+
+  ierr = verbPrintf(2, grid.com,
+                    "* Initializing Lagrangian tracer particles...\n"); CHKERRQ(ierr);
+
+  thickness = dynamic_cast<IceModelVec2S*>(vars.get("thk"));
+  if (thickness == NULL) SETERRQ(grid.com, 1, "thk is not available");
+
+  enthalpy = dynamic_cast<IceModelVec3*>(vars.get("enthalpy"));
+  if (enthalpy == NULL) SETERRQ(grid.com, 2, "enthalpy is not available");
+
+  ierr = compute_owners(); CHKERRQ(ierr);
+
+  // every re-init restarts the clock
+  t = grid.time->current();
+  dt = 0.0;
+
+  m_particles.clear();
+  m_seed_round = 0;
+  m_file_is_ready = false;
+
+  ierr = seed(t, m_seed_round++); CHKERRQ(ierr);
+  ierr = migrate(); CHKERRQ(ierr);
+  ierr = sort(); CHKERRQ(ierr);
+  ierr = update_attributes(); CHKERRQ(ierr);
+
+  PetscReal my_count = size(), count;
+  ierr = PISMGlobalSum(&my_count, &count, grid.com); CHKERRQ(ierr);
+  ierr = verbPrintf(2, grid.com,
+                    "  seeded %d particles; writing trajectories to '%s'\n",
+                    static_cast<int>(count),
+                    config.get_string("tracer_file").c_str()); CHKERRQ(ierr);
+
+  ierr = write_trajectories(t); CHKERRQ(ierr);
+
+  m_next_seed   = t + config.get("tracer_seed_interval", "years", "seconds");
+  m_next_output = t + config.get("tracer_output_interval", "years", "seconds");
+
+  return 0;
+}
+
+//! \brief Advect particles from the end of the previous update to `my_t + my_dt`.
+/*!
+ * IceModel calls this at steps updating the 3D velocity only, so the interval
+ * covered can be longer than `my_dt`; particles are advected using the
+ * current velocity over all of it (like the age, see IceModel::ageStep()).
+ *
+ * Seeds new particles and writes trajectories if it is time to do so.
+ */
+PetscErrorCode PISMTracerParticles::update(PetscReal my_t, PetscReal my_dt) {
+  PetscErrorCode ierr;
+
+  const PetscReal t_start = t + dt, t_end = my_t + my_dt;
+  if (t_end <= t_start)
+    return 0;
+
+  t = t_start;
+  dt = t_end - t_start;
+
+  IceModelVec3 *u3, *v3, *w3;
+  ierr = stress_balance->get_3d_velocity(u3, v3, w3); CHKERRQ(ierr);
+
+  // the velocity is interpolated using ghost columns next to the subdomain
+  // edges: update ghosts of u3 and v3, and get a ghosted copy of w3
+  ierr = u3->beginGhostComm(); CHKERRQ(ierr);
+  ierr = u3->endGhostComm(); CHKERRQ(ierr);
+  ierr = v3->beginGhostComm(); CHKERRQ(ierr);
+  ierr = v3->endGhostComm(); CHKERRQ(ierr);
+
+  if (m_w.get_nlevels() != w3->get_nlevels()) {
+    // the vertical grid was extended since the last update
+    ierr = m_w.extend_vertically(m_w.get_nlevels(), 0.0); CHKERRQ(ierr);
+  }
+  ierr = m_w.beginGhostCommTransfer(*w3); CHKERRQ(ierr);
+  ierr = m_w.endGhostCommTransfer(*w3); CHKERRQ(ierr);
+
+  PetscReal remaining = dt;
+  while (remaining > 0.0) {
+    PetscReal dt_taken;
+    ierr = advect(remaining, u3, v3, &m_w, dt_taken); CHKERRQ(ierr);
+    ierr = migrate(); CHKERRQ(ierr);
+    ierr = remove_outside_ice(); CHKERRQ(ierr);
+    remaining -= dt_taken;
+  }
+
+  const PetscReal seed_interval = config.get("tracer_seed_interval", "years", "seconds");
+  if (seed_interval > 0.0 && t_end >= m_next_seed) {
+    ierr = seed(t_end, m_seed_round++); CHKERRQ(ierr);
+    ierr = migrate(); CHKERRQ(ierr);
+    while (m_next_seed <= t_end)
+      m_next_seed += seed_interval;
+  }
+
+  ierr = sort(); CHKERRQ(ierr);
+  ierr = update_attributes(); CHKERRQ(ierr);
+
+  if (t_end >= m_next_output) {
+    ierr = write_trajectories(t_end); CHKERRQ(ierr);
+    m_next_output = t_end + config.get("tracer_output_interval", "years", "seconds");
+  }
+
+  return 0;
+}
+
+//! \brief Move particles to the processors owning their positions after the
+//! domain decomposition changed (see IceModel::repartition()).
+PetscErrorCode PISMTracerParticles::redistribute() {
+  PetscErrorCode ierr;
+
+  ierr = compute_owners(); CHKERRQ(ierr);
+
+  vector<int> destination(size());
+  for (unsigned int p = 0; p < destination.size(); ++p) {
+    const PetscReal *P = &m_particles[p * m_record_size];
+    destination[p] = owner(P[X], P[Y]);
+  }
+
+  ierr = exchange(destination, false); CHKERRQ(ierr);
+  ierr = sort(); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! \brief Seed particles on the lattice described by `tracer_seed_stride`
+//! and `tracer_seed_levels`.
+/*!
+ * Particle identifiers depend on the seeding round and the location only,
+ * so they do not depend on the number of processors.
+ */
+PetscErrorCode PISMTracerParticles::seed(PetscReal time, unsigned int round) {
+  PetscErrorCode ierr;
+
+  const PetscInt
+    stride = PetscMax(static_cast<PetscInt>(config.get("tracer_seed_stride")), 1),
+    levels = PetscMax(static_cast<PetscInt>(config.get("tracer_seed_levels")), 1);
+
+  vector<PetscReal> particle(m_record_size);
+
+  ierr = thickness->begin_read_access(); CHKERRQ(ierr);
+  for (PetscInt i=grid.xs; i<grid.xs+grid.xm; ++i) {
+    for (PetscInt j=grid.ys; j<grid.ys+grid.ym; ++j) {
+      const PetscScalar H = (*thickness)(i,j);
+
+      if (i % stride != 0 || j % stride != 0 || H <= 0.0)
+        continue;
+
+      for (PetscInt k = 0; k < levels; ++k) {
+        particle[ID] = ((static_cast<double>(round) * grid.Mx + i) * grid.My + j) * levels + k;
+        particle[X]  = grid.x[i];
+        particle[Y]  = grid.y[j];
+        particle[Z]  = H * (k + 0.5) / levels;
+
+        ierr = init_attributes(time, &particle[0]); CHKERRQ(ierr);
+
+        m_particles.insert(m_particles.end(), particle.begin(), particle.end());
+      }
+    }
+  }
+  ierr = thickness->end_access(); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! \brief Set attributes of a particle seeded at `time`.
+/*!
+ * The maximum temperature is set by update_attributes().
+ */
+PetscErrorCode PISMTracerParticles::init_attributes(PetscReal time, PetscReal *particle) {
+  particle[T_ORIGIN] = time;
+  particle[X_ORIGIN] = particle[X];
+  particle[Y_ORIGIN] = particle[Y];
+  particle[Z_ORIGIN] = particle[Z];
+  particle[TEMP_MAX] = 0.0;
+  return 0;
+}
+
+//! \brief Update attributes of all particles using fields at their current
+//! positions.
+PetscErrorCode PISMTracerParticles::update_attributes() {
+  PetscErrorCode ierr;
+
+  ierr = thickness->begin_read_access(); CHKERRQ(ierr);
+  ierr = enthalpy->begin_read_access(); CHKERRQ(ierr);
+
+  for (unsigned int p = 0; p < size(); ++p) {
+    PetscReal *P = &m_particles[p * m_record_size];
+
+    Stencil s;
+    get_stencil(P[X], P[Y], P[Z], s);
+
+    PetscReal E, T;
+    ierr = interpolate(*enthalpy, s, E); CHKERRQ(ierr);
+
+    const PetscReal H = interpolate(*thickness, s),
+      pressure = EC.getPressureFromDepth(PetscMax(H - P[Z], 0.0));
+    // return value is ignored: getAbsTemp() returns the melting temperature
+    // if the enthalpy exceeds the enthalpy of liquid water
+    EC.getAbsTemp(E, pressure, T);
+
+    P[TEMP_MAX] = PetscMax(P[TEMP_MAX], T);
+  }
+
+  ierr = enthalpy->end_access(); CHKERRQ(ierr);
+  ierr = thickness->end_access(); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! \brief Move particles along the velocity field for at most `dt` seconds.
+/*!
+ * Uses the forward Euler method. The time step `dt_taken` is chosen so that
+ * no particle moves more than one grid cell in the map-plane; it is the same
+ * on all processors.
+ *
+ * Removes particles that left the computational domain (unless it is
+ * periodic) or went below the ice base.
+ */
+PetscErrorCode PISMTracerParticles::advect(PetscReal dt_max, IceModelVec3 *u3, IceModelVec3 *v3,
+                                           IceModelVec3 *w3, PetscReal &dt_taken) {
+  PetscErrorCode ierr;
+  const unsigned int n = size();
+  vector<PetscReal> velocity(3 * n);
+  PetscReal my_max_speed = 0.0, max_speed; // in grid cells per second
+
+  ierr = u3->begin_read_access(); CHKERRQ(ierr);
+  ierr = v3->begin_read_access(); CHKERRQ(ierr);
+  ierr = w3->begin_read_access(); CHKERRQ(ierr);
+  for (unsigned int p = 0; p < n; ++p) {
+    const PetscReal *P = &m_particles[p * m_record_size];
+    PetscReal *V = &velocity[3 * p];
+
+    Stencil s;
+    get_stencil(P[X], P[Y], P[Z], s);
+
+    ierr = interpolate(*u3, s, V[0]); CHKERRQ(ierr);
+    ierr = interpolate(*v3, s, V[1]); CHKERRQ(ierr);
+    ierr = interpolate(*w3, s, V[2]); CHKERRQ(ierr);
+
+    my_max_speed = PetscMax(my_max_speed,
+                            PetscMax(PetscAbs(V[0]) / grid.dx, PetscAbs(V[1]) / grid.dy));
+  }
+  ierr = w3->end_access(); CHKERRQ(ierr);
+  ierr = v3->end_access(); CHKERRQ(ierr);
+  ierr = u3->end_access(); CHKERRQ(ierr);
+
+  ierr = PISMGlobalMax(&my_max_speed, &max_speed, grid.com); CHKERRQ(ierr);
+
+  dt_taken = dt_max;
+  if (max_speed * dt_max > 1.0)
+    dt_taken = 1.0 / max_speed;
+
+  vector<bool> remove(n, false);
+  for (unsigned int p = 0; p < n; ++p) {
+    PetscReal *P = &m_particles[p * m_record_size];
+    const PetscReal *V = &velocity[3 * p];
+
+    P[X] += V[0] * dt_taken;
+    P[Y] += V[1] * dt_taken;
+    P[Z] += V[2] * dt_taken;
+
+    remove[p] = wrap(P[X], P[Y]) == false || P[Z] < 0.0;
+  }
+
+  ierr = remove_particles(remove); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! \brief Remove particles above the ice surface (this includes particles in
+//! ice-free columns).
+/*!
+ * All particles have to be in this processor's subdomain (see migrate()).
+ */
+PetscErrorCode PISMTracerParticles::remove_outside_ice() {
+  PetscErrorCode ierr;
+  vector<bool> remove(size(), false);
+
+  ierr = thickness->begin_read_access(); CHKERRQ(ierr);
+  for (unsigned int p = 0; p < remove.size(); ++p) {
+    const PetscReal *P = &m_particles[p * m_record_size];
+
+    Stencil s;
+    get_stencil(P[X], P[Y], P[Z], s);
+
+    remove[p] = P[Z] > interpolate(*thickness, s);
+  }
+  ierr = thickness->end_access(); CHKERRQ(ierr);
+
+  ierr = remove_particles(remove); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! \brief Remove particles `p` such that `remove[p]` is true, preserving the
+//! order of the rest.
+PetscErrorCode PISMTracerParticles::remove_particles(const vector<bool> &remove) {
+  unsigned int n_kept = 0;
+
+  for (unsigned int p = 0; p < remove.size(); ++p) {
+    if (remove[p])
+      continue;
+
+    if (n_kept != p)
+      std::copy(m_particles.begin() + p * m_record_size,
+                m_particles.begin() + (p + 1) * m_record_size,
+                m_particles.begin() + n_kept * m_record_size);
+    n_kept++;
+  }
+
+  m_particles.resize(n_kept * m_record_size);
+
+  return 0;
+}
+
+//! \brief Send particles that left this processor's subdomain to neighbors
+//! owning their new positions.
+PetscErrorCode PISMTracerParticles::migrate() {
+  PetscErrorCode ierr;
+
+  vector<int> destination(size());
+  for (unsigned int p = 0; p < destination.size(); ++p) {
+    const PetscReal *P = &m_particles[p * m_record_size];
+    destination[p] = owner(P[X], P[Y]);
+  }
+
+  ierr = exchange(destination, true); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! \brief Send particle `p` to the processor `destination[p]` (for all `p`).
+/*!
+ * If `neighbors_only` is set, all destinations have to be in
+ * `m_neighbors`. Then each processor sends one message (all the particles
+ * leaving its subdomain in that direction) to each neighbor (and only if
+ * there is something to send). Otherwise uses all-to-all communication.
+ *
+ * Received particles are appended in the order of sender ranks.
+ */
+PetscErrorCode PISMTracerParticles::exchange(const vector<int> &destination, bool neighbors_only) {
+  const int tag = 1;
+  vector<PetscReal> kept;
+  map<int, vector<PetscReal> > outgoing;
+
+  kept.reserve(m_particles.size());
+  for (unsigned int p = 0; p < destination.size(); ++p) {
+    vector<PetscReal> &buffer = destination[p] == grid.rank ? kept : outgoing[destination[p]];
+    buffer.insert(buffer.end(),
+                  m_particles.begin() + p * m_record_size,
+                  m_particles.begin() + (p + 1) * m_record_size);
+  }
+
+  if (neighbors_only) {
+    const int n_neighbors = static_cast<int>(m_neighbors.size());
+    vector<int> send_count(n_neighbors), recv_count(n_neighbors);
+    vector<vector<PetscReal> > incoming(n_neighbors);
+    vector<MPI_Request> requests;
+
+    map<int, vector<PetscReal> >::iterator j;
+    for (j = outgoing.begin(); j != outgoing.end(); ++j) {
+      if (std::find(m_neighbors.begin(), m_neighbors.end(), j->first) == m_neighbors.end())
+        SETERRQ1(grid.com, 1,
+                 "PISMTracerParticles::exchange(): a particle moved to the subdomain of processor %d"
+                 " (not a neighbor)", j->first);
+    }
+
+    // exchange particle counts
+    requests.resize(2 * n_neighbors);
+    for (int k = 0; k < n_neighbors; ++k) {
+      send_count[k] = static_cast<int>(outgoing[m_neighbors[k]].size());
+      MPI_Irecv(&recv_count[k], 1, MPI_INT, m_neighbors[k], tag, grid.com, &requests[k]);
+      MPI_Isend(&send_count[k], 1, MPI_INT, m_neighbors[k], tag, grid.com,
+                &requests[n_neighbors + k]);
+    }
+    MPI_Waitall(2 * n_neighbors, &requests[0], MPI_STATUSES_IGNORE);
+
+    // exchange particles
+    requests.clear();
+    for (int k = 0; k < n_neighbors; ++k) {
+      MPI_Request request;
+      if (recv_count[k] > 0) {
+        incoming[k].resize(recv_count[k]);
+        MPI_Irecv(&incoming[k][0], recv_count[k], MPIU_REAL, m_neighbors[k], tag, grid.com, &request);
+        requests.push_back(request);
+      }
+      if (send_count[k] > 0) {
+        MPI_Isend(&outgoing[m_neighbors[k]][0], send_count[k], MPIU_REAL, m_neighbors[k], tag,
+                  grid.com, &request);
+        requests.push_back(request);
+      }
+    }
+    if (requests.empty() == false)
+      MPI_Waitall(static_cast<int>(requests.size()), &requests[0], MPI_STATUSES_IGNORE);
+
+    for (int k = 0; k < n_neighbors; ++k)
+      kept.insert(kept.end(), incoming[k].begin(), incoming[k].end());
+  } else {
+    vector<int> send_count(grid.size, 0), recv_count(grid.size),
+      send_offset(grid.size), recv_offset(grid.size);
+    vector<PetscReal> send_buffer, recv_buffer;
+
+    for (int r = 0; r < grid.size; ++r) {
+      send_offset[r] = static_cast<int>(send_buffer.size());
+      if (outgoing.find(r) != outgoing.end()) {
+        send_buffer.insert(send_buffer.end(), outgoing[r].begin(), outgoing[r].end());
+        send_count[r] = static_cast<int>(outgoing[r].size());
+      }
+    }
+
+    MPI_Alltoall(&send_count[0], 1, MPI_INT, &recv_count[0], 1, MPI_INT, grid.com);
+
+    int recv_size = 0;
+    for (int r = 0; r < grid.size; ++r) {
+      recv_offset[r] = recv_size;
+      recv_size += recv_count[r];
+    }
+    recv_buffer.resize(recv_size);
+
+    MPI_Alltoallv(data_pointer(send_buffer), &send_count[0], &send_offset[0], MPIU_REAL,
+                  data_pointer(recv_buffer), &recv_count[0], &recv_offset[0], MPIU_REAL,
+                  grid.com);
+
+    kept.insert(kept.end(), recv_buffer.begin(), recv_buffer.end());
+  }
+
+  m_particles.swap(kept);
+
+  return 0;
+}
+
+//! \brief Sort particles by column (and by identifier within a column), so
+//! that particles using the same columns of 3D fields are next to each other.
+PetscErrorCode PISMTracerParticles::sort() {
+  const unsigned int n = size();
+  // ((column, identifier), index)
+  vector<pair<pair<PetscInt, PetscReal>, unsigned int> > keys(n);
+
+  for (unsigned int p = 0; p < n; ++p) {
+    const PetscReal *P = &m_particles[p * m_record_size];
+
+    Stencil s;
+    get_stencil(P[X], P[Y], P[Z], s);
+
+    keys[p] = make_pair(make_pair((s.i0 - grid.xs) * grid.ym + (s.j0 - grid.ys), P[ID]), p);
+  }
+
+  std::sort(keys.begin(), keys.end());
+
+  vector<PetscReal> sorted(m_particles.size());
+  for (unsigned int p = 0; p < n; ++p) {
+    std::copy(m_particles.begin() + keys[p].second * m_record_size,
+              m_particles.begin() + (keys[p].second + 1) * m_record_size,
+              sorted.begin() + p * m_record_size);
+  }
+
+  m_particles.swap(sorted);
+
+  return 0;
+}
+
+//! \brief Append positions and attributes of all particles to `tracer_file`.
+/*!
+ * Uses the CF "indexed ragged array" representation of trajectories: each
+ * call appends one record per particle (along the unlimited dimension `obs`)
+ * containing the time, the particle identifier (`particle_id`), its position
+ * and attributes.
+ */
+PetscErrorCode PISMTracerParticles::write_trajectories(PetscReal time) {
+  PetscErrorCode ierr;
+  const string filename = config.get_string("tracer_file");
+  const unsigned int n = size();
+  PIO nc(grid.com, grid.rank, config.get_string("output_format"));
+
+  vector<string> names(m_record_size);
+  names[ID] = "particle_id";
+  names[X]  = "x";
+  names[Y]  = "y";
+  names[Z]  = "z";
+  for (unsigned int a = 0; a < m_attributes.size(); ++a)
+    names[N_POSITION_FIELDS + a] = m_attributes[a].name;
+
+  if (m_file_is_ready == false) {
+    map<string,string> attrs;
+    vector<string> dims(1, "obs");
+
+    ierr = nc.open(filename, PISM_WRITE); CHKERRQ(ierr);
+
+    attrs["long_name"] = "observation number";
+    ierr = nc.def_dim("obs", PISM_UNLIMITED, attrs); CHKERRQ(ierr);
+
+    ierr = nc.def_var("t", PISM_DOUBLE, dims); CHKERRQ(ierr);
+    ierr = nc.put_att_text("t", "long_name", "time"); CHKERRQ(ierr);
+    ierr = nc.put_att_text("t", "standard_name", "time"); CHKERRQ(ierr);
+    ierr = nc.put_att_text("t", "units", grid.time->CF_units()); CHKERRQ(ierr);
+    ierr = nc.put_att_text("t", "calendar", config.get_string("calendar")); CHKERRQ(ierr);
+
+    for (unsigned int f = 0; f < m_record_size; ++f) {
+      ierr = nc.def_var(names[f], PISM_DOUBLE, dims); CHKERRQ(ierr);
+    }
+
+    ierr = nc.put_att_text(names[ID], "long_name", "particle identifier"); CHKERRQ(ierr);
+    ierr = nc.put_att_text(names[ID], "cf_role", "trajectory_id"); CHKERRQ(ierr);
+    ierr = nc.put_att_text(names[X], "long_name", "x-coordinate"); CHKERRQ(ierr);
+    ierr = nc.put_att_text(names[X], "units", "m"); CHKERRQ(ierr);
+    ierr = nc.put_att_text(names[Y], "long_name", "y-coordinate"); CHKERRQ(ierr);
+    ierr = nc.put_att_text(names[Y], "units", "m"); CHKERRQ(ierr);
+    ierr = nc.put_att_text(names[Z], "long_name", "height above the ice base"); CHKERRQ(ierr);
+    ierr = nc.put_att_text(names[Z], "units", "m"); CHKERRQ(ierr);
+
+    for (unsigned int a = 0; a < m_attributes.size(); ++a) {
+      ierr = nc.put_att_text(m_attributes[a].name, "long_name", m_attributes[a].long_name); CHKERRQ(ierr);
+      ierr = nc.put_att_text(m_attributes[a].name, "units", m_attributes[a].units); CHKERRQ(ierr);
+    }
+
+    ierr = nc.put_att_text("PISM_GLOBAL", "featureType", "trajectory"); CHKERRQ(ierr);
+    ierr = nc.close(); CHKERRQ(ierr);
+
+    m_file_is_ready = true;
+  }
+
+  // records of this processor's particles follow the ones of processors
+  // with lower ranks
+  int my_count = static_cast<int>(n), offset = 0;
+  MPI_Exscan(&my_count, &offset, 1, MPI_INT, MPI_SUM, grid.com);
+  if (grid.rank == 0)
+    offset = 0;
+
+  unsigned int start = 0;
+  vector<double> buffer(PetscMax(n, 1u));
+
+  ierr = nc.open(filename, PISM_WRITE, true); CHKERRQ(ierr);
+  ierr = nc.inq_dimlen("obs", start); CHKERRQ(ierr);
+  start += offset;
+
+  for (unsigned int p = 0; p < n; ++p)
+    buffer[p] = start + p;
+  ierr = nc.put_1d_var("obs", start, n, buffer); CHKERRQ(ierr);
+
+  for (unsigned int p = 0; p < n; ++p)
+    buffer[p] = time;
+  ierr = nc.put_1d_var("t", start, n, buffer); CHKERRQ(ierr);
+
+  for (unsigned int f = 0; f < m_record_size; ++f) {
+    for (unsigned int p = 0; p < n; ++p)
+      buffer[p] = m_particles[p * m_record_size + f];
+    ierr = nc.put_1d_var(names[f], start, n, buffer); CHKERRQ(ierr);
+  }
+
+  ierr = nc.close(); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! \brief Compute tables of owners of grid rows and columns and the list of
+//! neighbors using the current domain decomposition.
+PetscErrorCode PISMTracerParticles::compute_owners() {
+  m_x_owner.resize(grid.Mx);
+  m_y_owner.resize(grid.My);
+
+  for (int p = 0, i = 0; p < grid.Nx; ++p)
+    for (int c = 0; c < grid.procs_x[p]; ++c)
+      m_x_owner[i++] = p;
+
+  for (int p = 0, j = 0; p < grid.Ny; ++p)
+    for (int c = 0; c < grid.procs_y[p]; ++c)
+      m_y_owner[j++] = p;
+
+  // see IceGrid::createDA(): the DA is transposed, so ranks go along the
+  // y-direction first
+  const int p_x = m_x_owner[grid.xs], p_y = m_y_owner[grid.ys];
+  if (p_y + grid.Ny * p_x != grid.rank)
+    SETERRQ(grid.com, 1, "PISMTracerParticles::compute_owners(): inconsistent domain decomposition");
+
+  const bool
+    x_periodic = (grid.periodicity & X_PERIODIC) != 0,
+    y_periodic = (grid.periodicity & Y_PERIODIC) != 0;
+
+  set<int> neighbors;
+  for (int d_x = -1; d_x <= 1; ++d_x) {
+    for (int d_y = -1; d_y <= 1; ++d_y) {
+      int q_x = p_x + d_x, q_y = p_y + d_y;
+
+      if (x_periodic)
+        q_x = (q_x + grid.Nx) % grid.Nx;
+      if (y_periodic)
+        q_y = (q_y + grid.Ny) % grid.Ny;
+
+      if (q_x < 0 || q_x >= grid.Nx || q_y < 0 || q_y >= grid.Ny)
+        continue;
+
+      const int r = q_y + grid.Ny * q_x;
+      if (r != grid.rank)
+        neighbors.insert(r);
+    }
+  }
+  m_neighbors.assign(neighbors.begin(), neighbors.end());
+
+  return 0;
+}
+
+//! \brief Map a position into the computational domain if it is periodic;
+//! returns false if the position is outside the (non-periodic) domain.
+bool PISMTracerParticles::wrap(PetscReal &x, PetscReal &y) const {
+  const PetscReal
+    x_min = grid.x[0], x_max = grid.x[grid.Mx - 1], x_period = grid.Mx * grid.dx,
+    y_min = grid.y[0], y_max = grid.y[grid.My - 1], y_period = grid.My * grid.dy;
+
+  if (grid.periodicity & X_PERIODIC) {
+    x = x_min + fmod(fmod(x - x_min, x_period) + x_period, x_period);
+  } else if (x < x_min || x > x_max) {
+    return false;
+  }
+
+  if (grid.periodicity & Y_PERIODIC) {
+    y = y_min + fmod(fmod(y - y_min, y_period) + y_period, y_period);
+  } else if (y < y_min || y > y_max) {
+    return false;
+  }
+
+  return true;
+}
+
+//! Rank of the processor owning the grid cell containing the point (x, y).
+int PISMTracerParticles::owner(PetscReal x, PetscReal y) const {
+  Stencil s;
+  get_stencil(x, y, 0.0, s);
+  return m_y_owner[s.j0] + grid.Ny * m_x_owner[s.i0];
+}
+
+//! \brief Find the grid cell containing the point (x, y, z) and linear
+//! interpolation weights.
+/*!
+ * The point (x, y) has to be in the computational domain (see wrap()).
+ * Heights outside of [0, Lz] are moved to the nearest end of this interval.
+ */
+void PISMTracerParticles::get_stencil(PetscReal x, PetscReal y, PetscReal z, Stencil &s) const {
+  const PetscReal
+    x_index = (x - grid.x[0]) / grid.dx,
+    y_index = (y - grid.y[0]) / grid.dy;
+
+  s.i0 = PetscMin(PetscMax(static_cast<PetscInt>(floor(x_index)), 0), grid.Mx - 1);
+  s.j0 = PetscMin(PetscMax(static_cast<PetscInt>(floor(y_index)), 0), grid.My - 1);
+  s.f_x = PetscMin(PetscMax(x_index - s.i0, 0.0), 1.0);
+  s.f_y = PetscMin(PetscMax(y_index - s.j0, 0.0), 1.0);
+  s.i1 = s.i0 + 1;
+  s.j1 = s.j0 + 1;
+
+  // cells at the (non-periodic) domain edges have no neighbors beyond the edge
+  if ((grid.periodicity & X_PERIODIC) == 0 && s.i0 == grid.Mx - 1) {
+    s.i1 = s.i0;
+    s.f_x = 0.0;
+  }
+  if ((grid.periodicity & Y_PERIODIC) == 0 && s.j0 == grid.My - 1) {
+    s.j1 = s.j0;
+    s.f_y = 0.0;
+  }
+
+  const PetscReal height = PetscMin(PetscMax(z, 0.0), grid.Lz);
+  s.k0 = PetscMin(grid.level_below(height), grid.Mz - 2);
+  s.f_z = (height - grid.zlevels[s.k0]) / (grid.zlevels[s.k0 + 1] - grid.zlevels[s.k0]);
+}
+
+//! Trilinear interpolation of a 3D field (which has to be accessible).
+PetscErrorCode PISMTracerParticles::interpolate(IceModelVec3 &field, const Stencil &s,
+                                                PetscReal &result) const {
+  PetscErrorCode ierr;
+  PetscScalar *a00, *a10, *a01, *a11;
+
+  ierr = field.getInternalColumn(s.i0, s.j0, &a00); CHKERRQ(ierr);
+  ierr = field.getInternalColumn(s.i1, s.j0, &a10); CHKERRQ(ierr);
+  ierr = field.getInternalColumn(s.i0, s.j1, &a01); CHKERRQ(ierr);
+  ierr = field.getInternalColumn(s.i1, s.j1, &a11); CHKERRQ(ierr);
+
+  const PetscInt k0 = s.k0, k1 = s.k0 + 1;
+  const PetscScalar
+    b00 = a00[k0] + s.f_z * (a00[k1] - a00[k0]),
+    b10 = a10[k0] + s.f_z * (a10[k1] - a10[k0]),
+    b01 = a01[k0] + s.f_z * (a01[k1] - a01[k0]),
+    b11 = a11[k0] + s.f_z * (a11[k1] - a11[k0]),
+    b0 = b00 + s.f_x * (b10 - b00),
+    b1 = b01 + s.f_x * (b11 - b01);
+
+  result = b0 + s.f_y * (b1 - b0);
+
+  return 0;
+}
+
+//! Bilinear interpolation of a 2D field (which has to be accessible).
+PetscReal PISMTracerParticles::interpolate(IceModelVec2S &field, const Stencil &s) const {
+  const PetscScalar
+    b0 = field(s.i0, s.j0) + s.f_x * (field(s.i1, s.j0) - field(s.i0, s.j0)),
+    b1 = field(s.i0, s.j1) + s.f_x * (field(s.i1, s.j1) - field(s.i0, s.j1));
+
+  return b0 + s.f_y * (b1 - b0);
+}
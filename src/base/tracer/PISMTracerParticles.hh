@@ -0,0 +1,155 @@
+// Copyright (C) 2012 PISM Authors
+//
+// This file is part of PISM.
+//
+// PISM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 2 of the License, or (at your option) any later
+// version.
+//
+// PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License
+// along with PISM; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef _PISMTRACERPARTICLES_H_
+#define _PISMTRACERPARTICLES_H_
+
+#include "PISMComponent.hh"
+#include "iceModelVec.hh"
+
+class PISMVars;
+class PISMStressBalance;
+class EnthalpyConverter;
+
+//! \brief Lagrangian tracer particles advected by the 3D ice velocity.
+/*!
+  Tracer particles are a cheap alternative to additional Eulerian 3D tracer
+  fields (like the age) in provenance studies: particles do not diffuse and
+  cost nothing where there are none.
+
+  Particles are seeded on a lattice: in every `tracer_seed_stride`-th column
+  in both directions (where there is ice), at `tracer_seed_levels` heights
+  equally spaced in the ice. Seeding is repeated every
+  `tracer_seed_interval` years (if positive).
+
+  Each particle is a record of `m_record_size` numbers: its identifier,
+  position (x, y, height above the ice base) and attributes. Attributes are
+  listed in `m_attributes`; the base class records the origin (time and
+  position) and the maximum temperature of each particle. Derived classes can
+  add attributes in their constructors and update them in
+  update_attributes().
+
+  Each processor stores the particles in its subdomain in one contiguous
+  array, sorted by column (see sort()). Particles are advected using the
+  forward Euler method with the velocity interpolated (trilinearly) at their
+  positions. Sub-steps are short enough for particles to move at most one
+  grid cell, so particles leaving a subdomain go to one of its neighbors;
+  they are sent in one message per neighbor (see migrate()). Particles
+  leaving the ice through the surface, the base or the edge of the
+  computational domain are removed.
+
+  Particle positions and attributes are appended to the file `tracer_file`
+  every `tracer_output_interval` years, as an "indexed ragged array" of
+  trajectories (see write_trajectories()).
+
+  Particles are not saved in the model state: every run seeds them anew.
+ */
+class PISMTracerParticles : public PISMComponent_TS {
+public:
+  PISMTracerParticles(IceGrid &g, const NCConfigVariable &conf,
+                      EnthalpyConverter &my_EC, PISMStressBalance *my_stress_balance);
+  virtual ~PISMTracerParticles() {}
+
+  virtual PetscErrorCode init(PISMVars &vars);
+
+  virtual PetscErrorCode update(PetscReal my_t, PetscReal my_dt);
+
+  virtual PetscErrorCode redistribute();
+
+  // particles are written to their own file (see write_trajectories())
+  virtual void add_vars_to_output(string /*keyword*/,
+                                  map<string,NCSpatialVariable> &/*result*/) {}
+
+  virtual PetscErrorCode define_variables(set<string> /*vars*/, const PIO &/*nc*/,
+                                          PISM_IO_Type /*nctype*/)
+  { return 0; }
+
+  virtual PetscErrorCode write_variables(set<string> /*vars*/, string /*filename*/)
+  { return 0; }
+
+  //! Number of particles in this processor's subdomain.
+  unsigned int size() const
+  { return static_cast<unsigned int>(m_particles.size() / m_record_size); }
+
+protected:
+  //! Indices of the fields of a particle record: the identifier, the
+  //! position and attributes added by the base class.
+  enum {ID = 0, X, Y, Z, T_ORIGIN, X_ORIGIN, Y_ORIGIN, Z_ORIGIN, TEMP_MAX,
+        N_POSITION_FIELDS = T_ORIGIN};
+
+  //! A particle attribute.
+  struct Attribute {
+    Attribute(string n, string u, string l)
+      : name(n), units(u), long_name(l) {}
+    string name, units, long_name;
+  };
+
+  //! Grid cell containing a point and interpolation weights.
+  struct Stencil {
+    PetscInt i0, i1, j0, j1, k0;
+    PetscReal f_x, f_y, f_z;
+  };
+
+  PetscErrorCode add_attribute(string name, string units, string long_name);
+
+  virtual PetscErrorCode seed(PetscReal time, unsigned int round);
+  virtual PetscErrorCode init_attributes(PetscReal time, PetscReal *particle);
+  virtual PetscErrorCode update_attributes();
+
+  PetscErrorCode advect(PetscReal dt, IceModelVec3 *u3, IceModelVec3 *v3,
+                        IceModelVec3 *w3, PetscReal &dt_taken);
+  PetscErrorCode remove_outside_ice();
+  PetscErrorCode remove_particles(const vector<bool> &remove);
+  PetscErrorCode migrate();
+  PetscErrorCode exchange(const vector<int> &destination, bool neighbors_only);
+  PetscErrorCode sort();
+
+  PetscErrorCode write_trajectories(PetscReal time);
+
+  PetscErrorCode compute_owners();
+  bool wrap(PetscReal &x, PetscReal &y) const;
+  int owner(PetscReal x, PetscReal y) const;
+  void get_stencil(PetscReal x, PetscReal y, PetscReal z, Stencil &s) const;
+  PetscErrorCode interpolate(IceModelVec3 &field, const Stencil &s, PetscReal &result) const;
+  PetscReal interpolate(IceModelVec2S &field, const Stencil &s) const;
+
+  EnthalpyConverter &EC;
+  PISMStressBalance *stress_balance;
+  IceModelVec2S *thickness;
+  IceModelVec3 *enthalpy;
+  //! ghosted copy of the vertical velocity (the stress balance stores it
+  //! without ghosts); interpolation at particle positions uses ghost columns
+  IceModelVec3 m_w;
+
+  //! particle attributes, in the order of storage (after the position)
+  vector<Attribute> m_attributes;
+  unsigned int m_record_size;
+  //! particle records of this processor's subdomain, one after another
+  vector<PetscReal> m_particles;
+
+  //! processor columns (rows) owning grid columns (rows) of the grid
+  vector<int> m_x_owner, m_y_owner;
+  //! ranks of processors owning subdomains next to this one
+  vector<int> m_neighbors;
+
+  unsigned int m_seed_round;
+  PetscReal m_next_seed, m_next_output;
+  bool m_file_is_ready;
+};
+
+#endif /* _PISMTRACERPARTICLES_H_ */
@@ -23,6 +23,9 @@
 #include "PISMGregorianTime.hh"
 #include "PISMProf.hh"
 #include "NCVariable.hh"
+#include "iceModelVec.hh"
+
+const unsigned int IceGrid::max_cached_dms;
 
 
 
@@ -81,6 +84,11 @@ IceGrid::IceGrid(MPI_Comm c, PetscMPIInt r, PetscMPIInt s,
 
   Mz_fine = 0;
 
+  ghost_updates = 0;
+  ghost_updates_elided = 0;
+
+  dm_requests = 0;
+
   compute_vertical_levels();
   compute_horizontal_spacing();
 
@@ -103,6 +111,8 @@ IceGrid::~IceGrid() {
     DMDestroy(&da2);
   }
 
+  destroy_dms();
+
   delete time;
   delete profiler;
 }
@@ -227,12 +237,7 @@ PetscInt IceGrid::kBelowHeight(PetscScalar height) {
        height,Lz);
     PISMEnd();
   }
-  PetscInt mcurr = 0;
-//  while ((zlevels[mcurr+1] <= height) && (mcurr+1 < Mz)) {
-  while (zlevels[mcurr+1] < height) {
-    mcurr++;
-  }
-  return mcurr;
+  return level_below(height);
 }
 
 //! \brief From given vertical grid zlevels[], determine \c dzMIN, \c dzMAX, and
@@ -312,6 +317,67 @@ void IceGrid::compute_ownership_ranges() {
   }
 }
 
+//! \brief Split `weights` into `N` contiguous pieces with (approximately)
+//! equal sums. Each piece is at least `min_width` long.
+static void split_weighted(const vector<double> &weights, int N, int min_width,
+                           vector<int> &result) {
+  int M = (int)weights.size();
+  double total = 0.0;
+
+  for (int i = 0; i < M; ++i)
+    total += weights[i];
+
+  result.resize(N);
+
+  // Fall back to the equal split if weights are useless or the grid is too small.
+  if (total <= 0.0 || M < N * min_width) {
+    for (int b = 0; b < N; ++b)
+      result[b] = M / N + ((M % N) > b);
+    return;
+  }
+
+  int start = 0;
+  double cumulative = 0.0;
+  for (int b = 0; b < N - 1; ++b) {
+    double target = total * (b + 1) / N;
+    int end = start + min_width;
+
+    for (int i = start; i < end; ++i)
+      cumulative += weights[i];
+
+    // grow this piece while it gets us closer to the target, leaving enough
+    // points for the remaining pieces
+    while (end < M - (N - 1 - b) * min_width &&
+           fabs(cumulative + weights[end] - target) < fabs(cumulative - target)) {
+      cumulative += weights[end];
+      end++;
+    }
+
+    result[b] = end - start;
+    start = end;
+  }
+  result[N - 1] = M - start;
+}
+
+//! \brief Computes processor ownership ranges balancing the estimated cost of
+//! computations instead of the number of grid points.
+/*!
+ * \param cost_x estimated cost of each grid "column" in the x-direction (summed over all j), size Mx
+ * \param cost_y estimated cost of each grid "row" in the y-direction (summed over all i), size My
+ *
+ * Expects grid.Nx and grid.Ny to be valid. DMDA ownership ranges are a tensor
+ * product of ranges in the x and y directions, so each direction is split
+ * independently.
+ */
+void IceGrid::compute_weighted_ownership_ranges(const vector<double> &cost_x,
+                                                const vector<double> &cost_y) {
+  // the DA requires each subdomain to be at least as wide as the stencil
+  int min_width = PetscMax(2, max_stencil_width);
+
+  split_weighted(cost_x, Nx, min_width, procs_x);
+  split_weighted(cost_y, Ny, min_width, procs_y);
+}
+
 //! \brief Create the PETSc DA \c da2 for the horizontal grid. Determine how
 //! the horizontal grid is divided among processors.
 /*!
@@ -439,6 +505,252 @@ PetscErrorCode IceGrid::createDA(PetscInt my_procs_x, PetscInt my_procs_y,
   return 0;
 }
 
+//! \brief Re-create \c da2 using current ownership ranges (procs_x and
+//! procs_y) and move all the IceModelVecs allocated on this grid to the new
+//! domain decomposition.
+/*!
+ * Values (including the ones in ghost points of IceModelVecs with ghosts) are
+ * preserved; xs, xm, ys and ym are updated.
+ *
+ * This only takes care of IceModelVecs. Objects holding other data that
+ * depends on the domain decomposition (PETSc Mats, KSPs, scatters to
+ * processor 0, etc) have to be re-created by their owners; see
+ * PISMComponent::redistribute().
+ *
+ * Shallow copies of IceModelVecs are not updated and must not be used after
+ * this call.
+ */
+PetscErrorCode IceGrid::redistribute() {
+  PetscErrorCode ierr;
+  DM da2_old = da2;
+
+  da2 = PETSC_NULL;
+  ierr = createDA(); CHKERRQ(ierr);
+
+  // cached DAs use the old decomposition
+  ierr = destroy_dms(); CHKERRQ(ierr);
+
+  for (unsigned int k = 0; k < vecs.size(); ++k) {
+    ierr = vecs[k]->redistribute(da2_old); CHKERRQ(ierr);
+  }
+
+  ierr = DMDestroy(&da2_old); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! \brief Get a DA with \c dof degrees of freedom and the stencil width \c
+//! stencil_width using the current domain decomposition.
+/*!
+ * DAs are created on the first request and re-used after that; they are
+ * owned by the grid and should not be destroyed by the caller. Use
+ * DMGetGlobalVector() and DMGetLocalVector() to get (cached) work vectors.
+ *
+ * At most max_cached_dms DAs are kept: creating one more destroys the least
+ * recently used one (with its cached work vectors). A caller that needs a DA
+ * after other calls to get_dm() has to keep a reference to it (see
+ * PetscObjectReference()).
+ */
+PetscErrorCode IceGrid::get_dm(PetscInt dof, PetscInt stencil_width, DM &result) {
+  PetscErrorCode ierr;
+  pair<PetscInt,PetscInt> key(dof, stencil_width);
+
+  if (dms.find(key) == dms.end()) {
+    if (dms.size() >= max_cached_dms) {
+      map<pair<PetscInt,PetscInt>, unsigned int>::iterator k, oldest = dms_last_use.begin();
+      for (k = dms_last_use.begin(); k != dms_last_use.end(); ++k) {
+        if (k->second < oldest->second)
+          oldest = k;
+      }
+
+      ierr = DMDestroy(&dms[oldest->first]); CHKERRQ(ierr);
+      dms.erase(oldest->first);
+      dms_last_use.erase(oldest);
+    }
+
+    DM da;
+    ierr = DMDACreate2d(com,
+                        DMDA_BOUNDARY_PERIODIC, DMDA_BOUNDARY_PERIODIC,
+                        DMDA_STENCIL_BOX,
+                        My, Mx,
+                        Ny, Nx,
+                        dof, stencil_width,
+                        &procs_y[0], &procs_x[0],
+                        &da); CHKERRQ(ierr);
+    dms[key] = da;
+  }
+
+  result = dms[key];
+  dms_last_use[key] = ++dm_requests;
+
+  return 0;
+}
+
+PetscErrorCode IceGrid::destroy_dms() {
+  PetscErrorCode ierr;
+
+  map<pair<PetscInt,PetscInt>, DM>::iterator k;
+  for (k = dms.begin(); k != dms.end(); ++k) {
+    ierr = DMDestroy(&k->second); CHKERRQ(ierr);
+  }
+  dms.clear();
+  dms_last_use.clear();
+
+  return 0;
+}
+
+//! \brief Returns true if (i,j) is an owned point at least \c width points
+//! away from the edges of the sub-domain.
+/*!
+ * Values at other owned points are sent to neighbors during ghost updates of
+ * fields with stencil width of at most \c width.
+ */
+bool IceGrid::is_interior(PetscInt i, PetscInt j, PetscInt width) const {
+  return (i >= xs + width && i < xs + xm - width &&
+          j >= ys + width && j < ys + ym - width);
+}
+
+PISMSplitLoop::PISMSplitLoop(IceGrid &grid, PetscInt width) {
+  m_xs = grid.xs;
+  m_xe = grid.xs + grid.xm;
+  m_ys = grid.ys;
+  m_ye = grid.ys + grid.ym;
+
+  m_i0 = m_xs + width;
+  m_i1 = m_xe - width;
+  m_j0 = m_ys + width;
+  m_j1 = m_ye - width;
+  if (m_i0 >= m_i1 || m_j0 >= m_j1) {
+    // empty interior
+    m_i0 = m_i1 = m_j0 = m_j1 = m_xs;
+  }
+
+  m_done = (m_xs >= m_xe || m_ys >= m_ye);
+
+  if (width <= 0) {
+    // no strip; start with the interior
+    m_interior = true;
+    m_i = m_i0;
+    m_j = m_j0;
+    m_done = m_done || m_i0 >= m_i1;
+  } else {
+    m_interior = false;
+    m_i = m_xs;
+    m_j = m_ys;
+  }
+}
+
+void PISMSplitLoop::next() {
+  if (m_done)
+    return;
+
+  ++m_j;
+
+  if (m_interior) {
+    if (m_j >= m_j1) {
+      m_j = m_j0;
+      ++m_i;
+    }
+    m_done = (m_i >= m_i1);
+    return;
+  }
+
+  // in the strip: skip the interior part of the current row
+  if (in_interior(m_i, m_j))
+    m_j = m_j1;
+
+  if (m_j >= m_ye) {
+    m_j = m_ys;
+    ++m_i;
+  }
+
+  if (m_i >= m_xe) {
+    // the strip is done; go to the interior if it is not empty
+    m_interior = true;
+    m_i = m_i0;
+    m_j = m_j0;
+    m_done = (m_i0 >= m_i1);
+  }
+}
+
+//! \brief Copy values from \c v_old (on \c da_old) to \c v_new (on \c da_new).
+/*!
+ * Both DAs have to describe the same grid (and have the same number of
+ * degrees of freedom) and may differ in ownership ranges and stencil widths
+ * only. Both Vecs are local if \c local is true and global otherwise; ghosts
+ * of \c v_new are updated.
+ *
+ * Data is moved through the natural ordering, which does not depend on the
+ * domain decomposition.
+ */
+PetscErrorCode IceGrid::redistribute_vec(DM da_old, Vec v_old, DM da_new, Vec v_new,
+                                         bool local) {
+  PetscErrorCode ierr;
+  Vec g_old, g_new, natural_old, natural_new;
+  PetscInt low, high;
+  IS is;
+  VecScatter scatter;
+
+  if (local) {
+    ierr = DMGetGlobalVector(da_old, &g_old); CHKERRQ(ierr);
+    ierr = DMLocalToGlobalBegin(da_old, v_old, INSERT_VALUES, g_old); CHKERRQ(ierr);
+    ierr =   DMLocalToGlobalEnd(da_old, v_old, INSERT_VALUES, g_old); CHKERRQ(ierr);
+
+    ierr = DMGetGlobalVector(da_new, &g_new); CHKERRQ(ierr);
+  } else {
+    g_old = v_old;
+    g_new = v_new;
+  }
+
+  ierr = DMDACreateNaturalVector(da_old, &natural_old); CHKERRQ(ierr);
+  ierr = DMDACreateNaturalVector(da_new, &natural_new); CHKERRQ(ierr);
+
+  ierr = DMDAGlobalToNaturalBegin(da_old, g_old, INSERT_VALUES, natural_old); CHKERRQ(ierr);
+  ierr =   DMDAGlobalToNaturalEnd(da_old, g_old, INSERT_VALUES, natural_old); CHKERRQ(ierr);
+
+  // each processor gets the part of the natural vector it owns in the new
+  // decomposition
+  ierr = VecGetOwnershipRange(natural_new, &low, &high); CHKERRQ(ierr);
+  ierr = ISCreateStride(com, high - low, low, 1, &is); CHKERRQ(ierr);
+  ierr = VecScatterCreate(natural_old, is, natural_new, is, &scatter); CHKERRQ(ierr);
+
+  ierr = VecScatterBegin(scatter, natural_old, natural_new, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+  ierr =   VecScatterEnd(scatter, natural_old, natural_new, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+
+  ierr = DMDANaturalToGlobalBegin(da_new, natural_new, INSERT_VALUES, g_new); CHKERRQ(ierr);
+  ierr =   DMDANaturalToGlobalEnd(da_new, natural_new, INSERT_VALUES, g_new); CHKERRQ(ierr);
+
+  ierr = VecScatterDestroy(&scatter); CHKERRQ(ierr);
+  ierr = ISDestroy(&is); CHKERRQ(ierr);
+  ierr = VecDestroy(&natural_old); CHKERRQ(ierr);
+  ierr = VecDestroy(&natural_new); CHKERRQ(ierr);
+
+  if (local) {
+    ierr = DMGlobalToLocalBegin(da_new, g_new, INSERT_VALUES, v_new); CHKERRQ(ierr);
+    ierr =   DMGlobalToLocalEnd(da_new, g_new, INSERT_VALUES, v_new); CHKERRQ(ierr);
+
+    ierr = DMRestoreGlobalVector(da_new, &g_new); CHKERRQ(ierr);
+    ierr = DMRestoreGlobalVector(da_old, &g_old); CHKERRQ(ierr);
+  }
+
+  return 0;
+}
+
+//! Add an IceModelVec to the list of fields moved by redistribute(). Called by IceModelVec::create().
+void IceGrid::add_vec(IceModelVec *v) {
+  vecs.push_back(v);
+}
+
+//! Remove an IceModelVec from the list of fields moved by redistribute(). Called by IceModelVec::destroy().
+void IceGrid::remove_vec(IceModelVec *v) {
+  for (unsigned int k = 0; k < vecs.size(); ++k) {
+    if (vecs[k] == v) {
+      vecs.erase(vecs.begin() + k);
+      return;
+    }
+  }
+}
+
 //! Sets grid vertical levels; sets Mz and Lz from input.  Checks input for consistency.
 PetscErrorCode IceGrid::set_vertical_levels(vector<double> new_zlevels) {
   PetscErrorCode ierr;
@@ -22,6 +22,7 @@
 #include <petscdmda.h>
 #include <vector>
 #include <string>
+#include <map>
 
 // use namespace std BUT remove trivial namespace browser from doxygen-erated HTML source browser
 /// @cond NAMESPACE_BROWSER
@@ -31,6 +32,7 @@ using namespace std;
 class PISMTime;
 class PISMProf;
 class NCConfigVariable;
+class IceModelVec;
 
 typedef enum {UNKNOWN = 0, EQUAL, QUADRATIC} SpacingType;
 typedef enum {NONE = 0, NOT_PERIODIC =0, X_PERIODIC = 1, Y_PERIODIC = 2, XY_PERIODIC = 3} Periodicity;
@@ -123,10 +125,40 @@ public:
 
   void compute_nprocs();
   void compute_ownership_ranges();
+  void compute_weighted_ownership_ranges(const vector<double> &cost_x,
+                                         const vector<double> &cost_y);
+  PetscErrorCode redistribute();
+  PetscErrorCode redistribute_vec(DM da_old, Vec v_old, DM da_new, Vec v_new,
+                                  bool local);
+  void add_vec(IceModelVec *v);
+  void remove_vec(IceModelVec *v);
+  PetscErrorCode get_dm(PetscInt dof, PetscInt stencil_width, DM &result);
+  bool is_interior(PetscInt i, PetscInt j, PetscInt width) const;
   PetscErrorCode compute_viewer_size(int target, int &x, int &y);
   PetscErrorCode printInfo(int verbosity); 
   PetscErrorCode printVertLevels(int verbosity); 
   int       kBelowHeight(PetscScalar height);
+
+  //! \brief Returns the index `k` of the storage grid level such that
+  //! `zlevels[k] < z <= zlevels[k+1]` (0 if `z <= 0`).
+  /*!
+   * Does not check if `z` is in the valid range; see kBelowHeight(). Uses
+   * ice_storage2fine as a lookup table: fine grid levels are equally spaced
+   * and at most dzMIN apart, so the search starting at the storage level
+   * below the fine level just under `z` takes at most a couple of steps.
+   */
+  inline PetscInt level_below(PetscScalar z) const {
+    if (z <= 0.0)
+      return 0;
+    if (z >= Lz)
+      return z > Lz ? Mz - 1 : Mz - 2;
+
+    PetscInt m = ice_storage2fine[PetscMin(static_cast<PetscInt>(z / dz_fine), Mz_fine - 1)];
+    m = PetscMin(m, Mz - 2);
+    while (zlevels[m + 1] < z)
+      m++;
+    return m;
+  }
   PetscErrorCode create_viewer(int viewer_size, string title, PetscViewer &viewer);
   PetscReal      radius(int i, int j);
 
@@ -188,6 +220,9 @@ public:
   int max_stencil_width;   //!< \brief maximum stencil width supported by
                                 //!< the DA in this IceGrid object
 
+  int ghost_updates,            //!< number of ghost updates of IceModelVecs on this grid
+    ghost_updates_elided;       //!< number of those skipped because ghosts were up to date
+
   PISMProf *profiler;           //!< PISM profiler object; allows tracking how long a computation takes
   PISMTime *time;               //!< The time management object (hides calendar computations)
 protected:
@@ -197,6 +232,18 @@ protected:
   PetscErrorCode compute_fine_vertical_grid();
   PetscErrorCode init_interpolation();
 
+  //! IceModelVecs allocated on this grid, in the order of allocation; see redistribute()
+  vector<IceModelVec*> vecs;
+
+  //! DAs created by get_dm(), indexed by (dof, stencil width)
+  map<pair<PetscInt,PetscInt>, DM> dms;
+  //! number of the get_dm() call that last returned each of the cached DAs
+  map<pair<PetscInt,PetscInt>, unsigned int> dms_last_use;
+  unsigned int dm_requests;
+  //! maximum number of DAs cached by get_dm()
+  static const unsigned int max_cached_dms = 16;
+  PetscErrorCode destroy_dms();
+
 private:
   // Hide copy constructor / assignment operator.
   IceGrid(IceGrid const &);
@@ -204,5 +251,56 @@ private:
 
 };
 
+//! \brief Visits owned grid points, the strip along sub-domain edges first and
+//! the interior last.
+/*!
+  Neighbors use values in the strip of width `width` along the edges of a
+  sub-domain to fill ghosts of fields with stencil width up to `width`. So a
+  ghost update can be started as soon as the strip is done and proceed while
+  the interior is computed:
+
+  \code
+  for (PISMSplitLoop p(grid, WIDE_STENCIL); !p.done(); p.next()) {
+    const PetscInt i = p.i(), j = p.j();
+    if (p.interior_starts()) {
+      ierr = field.end_access(); CHKERRQ(ierr);
+      ierr = field.beginGhostComm(); CHKERRQ(ierr);
+      ierr = field.begin_access(); CHKERRQ(ierr);
+    }
+    field(i,j) = ...;
+  }
+  ierr = field.endGhostComm(); CHKERRQ(ierr);
+  \endcode
+
+  interior_starts() is true at the first interior point only. If the interior
+  is empty (sub-domain narrower than 2 * width + 1 points) all the points are
+  in the strip and interior_starts() is never true, so the ghost update has to
+  be started after the loop if it was not started inside it.
+
+  Uses the same storage order (j fastest) within each part.
+ */
+class PISMSplitLoop {
+public:
+  PISMSplitLoop(IceGrid &grid, PetscInt width);
+
+  bool done() const { return m_done; }
+  void next();
+
+  PetscInt i() const { return m_i; }
+  PetscInt j() const { return m_j; }
+  //! True if the current point is in the interior.
+  bool interior() const { return m_interior; }
+  //! True at the first point of the interior.
+  bool interior_starts() const { return m_interior && m_i == m_i0 && m_j == m_j0; }
+private:
+  PetscInt m_xs, m_xe, m_ys, m_ye, //!< owned points
+    m_i0, m_i1, m_j0, m_j1,         //!< interior points
+    m_i, m_j;
+  bool m_interior, m_done;
+  bool in_interior(PetscInt i, PetscInt j) const {
+    return i >= m_i0 && i < m_i1 && j >= m_j0 && j < m_j1;
+  }
+};
+
 #endif	/* __grid_hh */
 
@@ -0,0 +1,48 @@
+// Copyright (C) 2012 PISM Authors
+//
+// This file is part of PISM.
+//
+// PISM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 2 of the License, or (at your option) any later
+// version.
+//
+// PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License
+// along with PISM; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "PISMColumnChunks.hh"
+#include "NCVariable.hh"
+
+const unsigned int PISMColumnChunks::min_chunk_size;
+
+//! Splits `column_count` columns into chunks.
+/*!
+  With one thread all the columns form one chunk. Otherwise there are about
+  four chunks per thread (but no fewer than min_chunk_size columns in a
+  chunk): costs of columns vary a lot (lists of columns start with icy ones),
+  so threads take chunks one at a time until none are left.
+ */
+PISMColumnChunks::PISMColumnChunks(const NCConfigVariable &config, unsigned int column_count) {
+  m_threads = PetscMax(static_cast<int>(config.get("grid_column_threads")), 1);
+#if (PISM_USE_OPENMP==0)
+  m_threads = 1;                // built without OpenMP
+#endif
+
+  unsigned int chunk_size = column_count;
+  if (m_threads > 1) {
+    const unsigned int n_chunks = 4 * m_threads;
+    chunk_size = PetscMax((column_count + n_chunks - 1) / n_chunks, min_chunk_size);
+  }
+
+  m_begin.push_back(0);
+  for (unsigned int n = chunk_size; n < column_count; n += chunk_size)
+    m_begin.push_back(n);
+  if (column_count > 0)
+    m_begin.push_back(column_count);
+}
@@ -0,0 +1,98 @@
+// Copyright (C) 2012 PISM Authors
+//
+// This file is part of PISM.
+//
+// PISM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 2 of the License, or (at your option) any later
+// version.
+//
+// PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License
+// along with PISM; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef __PISMColumnChunks_hh
+#define __PISMColumnChunks_hh
+
+#include <vector>
+#include <petsc.h>
+
+#if (PISM_USE_OPENMP==1)
+#include <omp.h>
+#endif
+
+class NCConfigVariable;
+
+//! \brief Splits a loop over a list of columns into chunks processed by
+//! OpenMP threads.
+/*!
+  Column-local computations (energy, age, bedrock temperature, SIA) can use
+  several threads on each processor (see the configuration parameter
+  `grid_column_threads` and the option `-column_threads`); this requires
+  building PISM with `Pism_USE_OPENMP`.
+
+  Each chunk is a contiguous range of the column list; chunks are processed
+  independently, in any order and by any thread. Code processing a chunk must
+  not call PETSc functions that are not thread-safe (creating objects,
+  communicating, reading the configuration database), use scratch objects
+  private to the calling thread (see thread()) and store per-column results
+  only. Statistics should be accumulated per chunk and added up in chunk
+  order after the loop (use counts, which add up exactly, so that results do
+  not depend on the number of threads).
+
+  PETSc error handling macros return from the enclosing function, which is
+  not allowed inside a parallel loop, so a chunk has to be processed by a
+  function returning an error code; these codes are checked after the loop.
+
+  Use like this:
+  \code
+  PISMColumnChunks chunks(config, cols.size());
+  vector<PetscErrorCode> errors(chunks.size(), 0);
+  // create chunks.threads() scratch objects here
+
+#if (PISM_USE_OPENMP==1)
+#pragma omp parallel for schedule(dynamic, 1) num_threads(chunks.threads())
+#endif
+  for (int c = 0; c < chunks.size(); ++c) {
+    errors[c] = process(chunks.begin(c), chunks.end(c), scratch[PISMColumnChunks::thread()]);
+  }
+
+  for (int c = 0; c < chunks.size(); ++c) {
+    CHKERRQ(errors[c]);
+  }
+  \endcode
+ */
+class PISMColumnChunks {
+public:
+  PISMColumnChunks(const NCConfigVariable &config, unsigned int column_count);
+
+  //! Number of threads to use.
+  int threads() const { return m_threads; }
+  //! Number of chunks.
+  int size() const { return static_cast<int>(m_begin.size()) - 1; }
+  //! Index of the first column in chunk `c`.
+  unsigned int begin(int c) const { return m_begin[c]; }
+  //! Index of the column following the last column in chunk `c`.
+  unsigned int end(int c) const { return m_begin[c + 1]; }
+
+  //! Index (from 0 to threads() - 1) of the calling thread.
+  static int thread() {
+#if (PISM_USE_OPENMP==1)
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+  }
+
+  static const unsigned int min_chunk_size = 64;
+protected:
+  int m_threads;
+  std::vector<unsigned int> m_begin;
+};
+
+#endif /* __PISMColumnChunks_hh */
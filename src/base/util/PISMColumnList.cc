@@ -0,0 +1,118 @@
+// Copyright (C) 2012 PISM Authors
+//
+// This file is part of PISM.
+//
+// PISM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 2 of the License, or (at your option) any later
+// version.
+//
+// PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License
+// along with PISM; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "PISMColumnList.hh"
+#include "IceGrid.hh"
+
+PISMColumnList::PISMColumnList(IceGrid &g, int t)
+  : grid(g) {
+  tile_size = t > 0 ? t : 1;
+  n_icy = n_margin = 0;
+  ks_max = 0;
+}
+
+void PISMColumnList::add_column(vector<Column> &list, PetscInt i, PetscInt j, PetscScalar H) {
+  Column c;
+  c.i = i;
+  c.j = j;
+  if (H > 0.0) {
+    c.ks  = grid.kBelowHeight(H);
+    // this should *not* be replaced by a call to grid.kBelowHeight()
+    c.fks = static_cast<PetscInt>(floor(H / grid.dz_fine));
+  } else {
+    c.ks = c.fks = 0;
+  }
+  list.push_back(c);
+}
+
+//! \brief Re-build all the lists using `thickness`.
+/*!
+ * Does not use the domain decomposition saved from an earlier call, so
+ * update() has to be called after the grid is re-partitioned.
+ *
+ * Requires ghosts of `thickness` (stencil width of at least 2).
+ */
+PetscErrorCode PISMColumnList::update(IceModelVec2S &thickness) {
+  PetscErrorCode ierr;
+
+  if (thickness.get_stencil_width() < 2)
+    SETERRQ(grid.com, 1, "PISMColumnList::update() needs thickness with stencil width of at least 2");
+
+  owned_columns.clear();
+  margin_columns.clear();
+  ice_free_columns.clear();
+  staggered_columns.clear();
+
+  ierr = thickness.begin_access(); CHKERRQ(ierr);
+
+  // owned columns
+  for (PetscInt i0 = grid.xs; i0 < grid.xs + grid.xm; i0 += tile_size) {
+    for (PetscInt j0 = grid.ys; j0 < grid.ys + grid.ym; j0 += tile_size) {
+      const PetscInt
+        i1 = PetscMin(i0 + tile_size, grid.xs + grid.xm),
+        j1 = PetscMin(j0 + tile_size, grid.ys + grid.ym);
+
+      for (PetscInt i = i0; i < i1; ++i) {
+        for (PetscInt j = j0; j < j1; ++j) {
+          const PetscScalar H = thickness(i, j);
+
+          if (H > 0.0) {
+            add_column(owned_columns, i, j, H);
+          } else if (thickness(i + 1, j) > 0.0 || thickness(i - 1, j) > 0.0 ||
+                     thickness(i, j + 1) > 0.0 || thickness(i, j - 1) > 0.0) {
+            add_column(margin_columns, i, j, H);
+          } else {
+            add_column(ice_free_columns, i, j, H);
+          }
+        }
+      }
+    }
+  }
+
+  ks_max = 0;
+  for (unsigned int n = 0; n < owned_columns.size(); ++n)
+    ks_max = PetscMax(ks_max, owned_columns[n].ks);
+
+  n_icy    = owned_columns.size();
+  n_margin = margin_columns.size();
+  owned_columns.insert(owned_columns.end(), margin_columns.begin(), margin_columns.end());
+  owned_columns.insert(owned_columns.end(), ice_free_columns.begin(), ice_free_columns.end());
+
+  // columns next to staggered grid points affected by the ice, including one
+  // row of ghosts
+  const PetscInt GHOSTS = 1;
+  for (PetscInt i0 = grid.xs - GHOSTS; i0 < grid.xs + grid.xm + GHOSTS; i0 += tile_size) {
+    for (PetscInt j0 = grid.ys - GHOSTS; j0 < grid.ys + grid.ym + GHOSTS; j0 += tile_size) {
+      const PetscInt
+        i1 = PetscMin(i0 + tile_size, grid.xs + grid.xm + GHOSTS),
+        j1 = PetscMin(j0 + tile_size, grid.ys + grid.ym + GHOSTS);
+
+      for (PetscInt i = i0; i < i1; ++i) {
+        for (PetscInt j = j0; j < j1; ++j) {
+          const PetscScalar H = thickness(i, j);
+          if (H > 0.0 || thickness(i + 1, j) > 0.0 || thickness(i, j + 1) > 0.0)
+            add_column(staggered_columns, i, j, H);
+        }
+      }
+    }
+  }
+
+  ierr = thickness.end_access(); CHKERRQ(ierr);
+
+  return 0;
+}
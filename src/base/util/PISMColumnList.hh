@@ -0,0 +1,87 @@
+// Copyright (C) 2012 PISM Authors
+//
+// This file is part of PISM.
+//
+// PISM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 2 of the License, or (at your option) any later
+// version.
+//
+// PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License
+// along with PISM; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef __PISMColumnList_hh
+#define __PISMColumnList_hh
+
+#include <vector>
+#include "iceModelVec.hh"
+
+//! \brief Lists of map-plane columns, classified using the ice thickness.
+/*!
+  Most 3D computations do real work in icy columns only, but sweep over the
+  whole subdomain and test the thickness in every column. update() classifies
+  columns once so that loops can visit just the columns they need.
+
+  The owned() list contains all the columns owned by this processor:
+  - icy columns (positive thickness) come first; there are icy_count() of them,
+  - then margin_count() ice-free columns with an icy neighbor (in the
+    five-point stencil),
+  - then all the other (ice-free) columns.
+
+  The staggered() list contains columns (i,j) in the owned part of the
+  subdomain extended by one ghost cell such that at least one of (i,j),
+  (i+1,j), (i,j+1) is icy. These are the only points at which staggered-grid
+  quantities at (i+1/2,j) and (i,j+1/2) can depend on the ice.
+
+  Each part of each list is ordered tile by tile (tiles are `tile_size`
+  columns wide in both directions) and in the storage order within a tile, so
+  that neighboring entries are close in memory.
+
+  Loops over columns look like this:
+  \code
+  const vector<PISMColumnList::Column> &cols = columns.owned();
+  for (int n = 0; n < columns.icy_count(); ++n) {
+    const PetscInt i = cols[n].i, j = cols[n].j, ks = cols[n].ks;
+    ...
+  }
+  \endcode
+ */
+class PISMColumnList {
+public:
+  struct Column {
+    PetscInt i, j;
+    PetscInt ks;                //!< storage grid level just below the ice surface
+    PetscInt fks;               //!< fine (equally-spaced) grid level just below the ice surface
+  };
+
+  PISMColumnList(IceGrid &g, int tile_size);
+
+  PetscErrorCode update(IceModelVec2S &thickness);
+
+  //! Owned columns: icy ones, then ice-free ones next to ice, then all the others.
+  const vector<Column>& owned() const { return owned_columns; }
+  //! Columns near which staggered-grid quantities can be non-trivial.
+  const vector<Column>& staggered() const { return staggered_columns; }
+
+  int icy_count() const { return n_icy; }
+  int margin_count() const { return n_margin; }
+  //! Maximum of `ks` over owned columns (on this processor).
+  PetscInt max_ks() const { return ks_max; }
+
+protected:
+  IceGrid &grid;
+  int tile_size, n_icy, n_margin;
+  PetscInt ks_max;
+  vector<Column> owned_columns, staggered_columns;
+  vector<Column> margin_columns, ice_free_columns; // temporary storage used by update()
+
+  void add_column(vector<Column> &list, PetscInt i, PetscInt j, PetscScalar H);
+};
+
+#endif /* __PISMColumnList_hh */
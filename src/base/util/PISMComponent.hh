@@ -36,6 +36,7 @@ class IceGrid;
 class NCConfigVariable;
 class NCSpatialVariable;
 class PISMDiagnostic;
+class PISMTSDiagnostic;
 class PISMVars;
 
 //! \brief A class defining a common interface for most PISM sub-models.
@@ -129,6 +130,18 @@ public:
   //! Add pointers to available diagnostic quantities to a dictionary.
   virtual void get_diagnostics(map<string, PISMDiagnostic*> &/*dict*/) {}
 
+  //! Add pointers to available scalar time-series diagnostics to a dictionary.
+  virtual void get_ts_diagnostics(map<string, PISMTSDiagnostic*> &/*dict*/) {}
+
+  //! \brief Re-create internal objects depending on the domain decomposition
+  //! after a call to IceGrid::redistribute().
+  /*!
+    IceModelVecs are moved by IceGrid::redistribute(), so only components
+    owning other objects built using the grid's DA (PETSc Mats, KSPs, Vecs
+    used to gather data on processor 0, etc) need to re-implement this.
+   */
+  virtual PetscErrorCode redistribute() { return 0; }
+
   // //! Add pointers to scalar diagnostic quantities to a dictionary.
   // virtual void get_scalar_diagnostics(map<string, PISMDiagnostic_Scalar*> &/*dict*/) {}
 protected:
@@ -231,6 +244,21 @@ public:
     }
   }
 
+  virtual void get_ts_diagnostics(map<string, PISMTSDiagnostic*> &dict)
+  {
+    if (input_model != NULL) {
+      input_model->get_ts_diagnostics(dict);
+    }
+  }
+
+  virtual PetscErrorCode redistribute()
+  {
+    if (input_model != NULL) {
+      PetscErrorCode ierr = input_model->redistribute(); CHKERRQ(ierr);
+    }
+    return 0;
+  }
+
   virtual PetscErrorCode max_timestep(PetscReal my_t, PetscReal &my_dt, bool &restrict)
   {
     if (input_model != NULL) {
@@ -0,0 +1,206 @@
+// Copyright (C) 2012 PISM Authors
+//
+// This file is part of PISM.
+//
+// PISM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 2 of the License, or (at your option) any later
+// version.
+//
+// PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License
+// along with PISM; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "PISMGhostCommGroup.hh"
+#include "IceGrid.hh"
+
+PISMGhostCommGroup::PISMGhostCommGroup(IceGrid &g)
+  : grid(g) {
+  dof = 0;
+  width = 0;
+  da = PETSC_NULL;
+  global = PETSC_NULL;
+  local = PETSC_NULL;
+}
+
+//! Add a field; its ghosts are updated using its own owned values.
+PetscErrorCode PISMGhostCommGroup::add(IceModelVec &field) {
+  PetscErrorCode ierr;
+  ierr = add(field, field); CHKERRQ(ierr);
+  return 0;
+}
+
+//! \brief Add a pair of fields; owned values of `source` are copied to
+//! `destination`, including ghosts.
+PetscErrorCode PISMGhostCommGroup::add(IceModelVec &source, IceModelVec &destination) {
+  PetscErrorCode ierr;
+  Member m;
+
+  if (global != PETSC_NULL)
+    SETERRQ(grid.com, 1, "PISMGhostCommGroup::add(): communication is in progress");
+
+  if (source.grid != &grid || destination.grid != &grid)
+    SETERRQ1(grid.com, 1, "PISMGhostCommGroup::add(): '%s' is defined on a different grid",
+             source.name.c_str());
+
+  if (!destination.localp)
+    SETERRQ1(grid.com, 1, "PISMGhostCommGroup::add(): '%s' has no ghosts",
+             destination.name.c_str());
+
+  ierr = source.checkAllocated(); CHKERRQ(ierr);
+  ierr = destination.checkAllocated(); CHKERRQ(ierr);
+
+  PetscInt dest_dof;
+  ierr = DMDAGetInfo(source.da, PETSC_NULL, PETSC_NULL, PETSC_NULL, PETSC_NULL,
+                     PETSC_NULL, PETSC_NULL, PETSC_NULL,
+                     &m.dof, PETSC_NULL,
+                     PETSC_NULL, PETSC_NULL, PETSC_NULL, PETSC_NULL); CHKERRQ(ierr);
+  ierr = DMDAGetInfo(destination.da, PETSC_NULL, PETSC_NULL, PETSC_NULL, PETSC_NULL,
+                     PETSC_NULL, PETSC_NULL, PETSC_NULL,
+                     &dest_dof, &m.width,
+                     PETSC_NULL, PETSC_NULL, PETSC_NULL, PETSC_NULL); CHKERRQ(ierr);
+
+  if (dest_dof != m.dof)
+    SETERRQ2(grid.com, 1, "PISMGhostCommGroup::add(): '%s' and '%s' have different numbers of dof",
+             source.name.c_str(), destination.name.c_str());
+
+  m.source = &source;
+  m.destination = &destination;
+  m.skip = false;
+  members.push_back(m);
+
+  return 0;
+}
+
+//! Starts the communication of ghost points of all the fields in the group.
+PetscErrorCode PISMGhostCommGroup::beginGhostComm() {
+  PetscErrorCode ierr;
+
+  if (members.empty())
+    return 0;
+
+  if (global != PETSC_NULL)
+    SETERRQ(grid.com, 1, "PISMGhostCommGroup::beginGhostComm(): communication is in progress");
+
+  dof = 0;
+  width = 0;
+  for (unsigned int n = 0; n < members.size(); ++n) {
+    Member &m = members[n];
+
+    if (m.source == m.destination) {
+      m.skip = m.source->elide_ghost_update();
+      if (m.skip)
+        continue;
+    } else {
+      m.skip = false;
+      grid.ghost_updates++;
+    }
+
+    dof += m.dof;
+    width = PetscMax(width, m.width);
+  }
+
+  if (dof == 0)
+    return 0;
+
+  // the DA is looked up every time because the grid may have been
+  // re-partitioned since the last update
+  ierr = grid.get_dm(dof, width, da); CHKERRQ(ierr);
+  // keep the DA until endGhostComm(), even if the grid evicts it from its
+  // cache in the meantime
+  ierr = PetscObjectReference((PetscObject)da); CHKERRQ(ierr);
+  ierr = DMGetGlobalVector(da, &global); CHKERRQ(ierr);
+  ierr = DMGetLocalVector(da, &local); CHKERRQ(ierr);
+
+  PetscScalar ***buffer;
+  ierr = DMDAVecGetArrayDOF(da, global, &buffer); CHKERRQ(ierr);
+
+  PetscInt offset = 0;
+  for (unsigned int n = 0; n < members.size(); ++n) {
+    Member &m = members[n];
+    PetscScalar ***values;
+
+    if (m.skip)
+      continue;
+
+    ierr = DMDAVecGetArrayDOF(m.source->da, m.source->v, &values); CHKERRQ(ierr);
+    for (PetscInt i = grid.xs; i < grid.xs + grid.xm; ++i) {
+      for (PetscInt j = grid.ys; j < grid.ys + grid.ym; ++j) {
+        ierr = PetscMemcpy(&buffer[i][j][offset], values[i][j],
+                           m.dof * sizeof(PetscScalar)); CHKERRQ(ierr);
+      }
+    }
+    ierr = DMDAVecRestoreArrayDOF(m.source->da, m.source->v, &values); CHKERRQ(ierr);
+
+    offset += m.dof;
+  }
+
+  ierr = DMDAVecRestoreArrayDOF(da, global, &buffer); CHKERRQ(ierr);
+
+  ierr = DMGlobalToLocalBegin(da, global, INSERT_VALUES, local); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! Ends the communication of ghost points of all the fields in the group.
+PetscErrorCode PISMGhostCommGroup::endGhostComm() {
+  PetscErrorCode ierr;
+
+  if (members.empty() || dof == 0)
+    return 0;
+
+  if (global == PETSC_NULL)
+    SETERRQ(grid.com, 1, "PISMGhostCommGroup::endGhostComm(): beginGhostComm() was not called");
+
+  ierr = DMGlobalToLocalEnd(da, global, INSERT_VALUES, local); CHKERRQ(ierr);
+
+  PetscScalar ***buffer;
+  ierr = DMDAVecGetArrayDOF(da, local, &buffer); CHKERRQ(ierr);
+
+  PetscInt offset = 0;
+  for (unsigned int n = 0; n < members.size(); ++n) {
+    Member &m = members[n];
+    PetscScalar ***values;
+
+    if (m.skip)
+      continue;
+
+    // owned values are copied only if the source differs from the
+    // destination: they may have changed since beginGhostComm() was called
+    const bool copy_owned = (m.source != m.destination);
+
+    ierr = DMDAVecGetArrayDOF(m.destination->da, m.destination->v, &values); CHKERRQ(ierr);
+    for (PetscInt i = grid.xs - m.width; i < grid.xs + grid.xm + m.width; ++i) {
+      for (PetscInt j = grid.ys - m.width; j < grid.ys + grid.ym + m.width; ++j) {
+        if (!copy_owned &&
+            i >= grid.xs && i < grid.xs + grid.xm &&
+            j >= grid.ys && j < grid.ys + grid.ym)
+          continue;
+
+        ierr = PetscMemcpy(values[i][j], &buffer[i][j][offset],
+                           m.dof * sizeof(PetscScalar)); CHKERRQ(ierr);
+      }
+    }
+    ierr = DMDAVecRestoreArrayDOF(m.destination->da, m.destination->v, &values); CHKERRQ(ierr);
+
+    m.destination->ghost_state->valid = (m.destination->access_counter == 0);
+
+    offset += m.dof;
+  }
+
+  ierr = DMDAVecRestoreArrayDOF(da, local, &buffer); CHKERRQ(ierr);
+
+  ierr = DMRestoreLocalVector(da, &local); CHKERRQ(ierr);
+  ierr = DMRestoreGlobalVector(da, &global); CHKERRQ(ierr);
+  local = PETSC_NULL;
+  global = PETSC_NULL;
+
+  ierr = DMDestroy(&da); CHKERRQ(ierr);
+
+  return 0;
+}
@@ -0,0 +1,78 @@
+// Copyright (C) 2012 PISM Authors
+//
+// This file is part of PISM.
+//
+// PISM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 2 of the License, or (at your option) any later
+// version.
+//
+// PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License
+// along with PISM; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef __PISMGhostCommGroup_hh
+#define __PISMGhostCommGroup_hh
+
+#include <vector>
+#include "iceModelVec.hh"
+
+//! \brief Updates ghosts of several IceModelVecs using one exchange.
+/*!
+  Each beginGhostComm()/endGhostComm() pair sends its own messages to all
+  the neighbors. This class packs owned values of all the fields in a group
+  into one vector on a DA with the combined number of degrees of freedom, so
+  that each neighbor gets one message per update:
+
+  \code
+  PISMGhostCommGroup ghosts(grid);
+  ierr = ghosts.add(vMask); CHKERRQ(ierr);
+  ierr = ghosts.add(vH); CHKERRQ(ierr);
+  ierr = ghosts.add(vHnew, vH); CHKERRQ(ierr); // like vHnew.beginGhostComm(vH)
+  ierr = ghosts.beginGhostComm(); CHKERRQ(ierr);
+  ierr = ghosts.endGhostComm(); CHKERRQ(ierr);
+  \endcode
+
+  Fields have to be defined on the same grid; they may have different numbers
+  of degrees of freedom and stencil widths (the group uses the widest
+  stencil). Destinations have to have ghosts.
+
+  Fields updated in place whose ghosts are up to date (see
+  IceModelVec::ghosts_are_valid()) are skipped.
+
+  Owned values of a field updated in place may be modified between
+  beginGhostComm() and endGhostComm() as long as values neighbors need (see
+  PISMSplitLoop) are not. Owned values of a destination that differs from its
+  source are overwritten by endGhostComm().
+ */
+class PISMGhostCommGroup {
+public:
+  PISMGhostCommGroup(IceGrid &g);
+
+  PetscErrorCode add(IceModelVec &field);
+  PetscErrorCode add(IceModelVec &source, IceModelVec &destination);
+
+  PetscErrorCode beginGhostComm();
+  PetscErrorCode endGhostComm();
+
+protected:
+  IceGrid &grid;
+  struct Member {
+    IceModelVec *source, *destination;
+    PetscInt dof, width;
+    bool skip;                  //!< true if this member is skipped by the current update
+  };
+  vector<Member> members;
+  PetscInt dof, width;          //!< combined number of dof and stencil width of
+                                //!< members included in the current update
+
+  DM da;                        //!< from IceGrid::get_dm(); referenced between begin and end
+  Vec global, local;            //!< work vectors; valid between begin and end
+};
+
+#endif /* __PISMGhostCommGroup_hh */
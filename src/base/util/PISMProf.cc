@@ -48,13 +48,48 @@ PISMProf::PISMProf(MPI_Comm c, PetscMPIInt r, PetscMPIInt s) {
 }
 
 void PISMProf::set_grid_size(int n) {
+  set_value("processor_grid_size",
+            "number of map-plane grid points in a processor's subdomain",
+            "count", n);
+}
 
-  PISMEvent tmp;
-  tmp.name = "processor_grid_size";
-  tmp.description = "number of map-plane grid points in a processor's subdomain";
-  tmp.total_time = n;
-  tmp.units = "count";
-  events.push_back(tmp);
+//! \brief Store a per-processor value (not a timing) in the profiling report.
+/*!
+ * Replaces the value if a variable with this name was set before.
+ */
+void PISMProf::set_value(string name, string description, string units, double value) {
+  int index = get(name);
+
+  if (index == -1) {
+    PISMEvent tmp;
+    tmp.name = name;
+    events.push_back(tmp);
+    index = (int)events.size() - 1;
+  }
+
+  events[index].description = description;
+  events[index].units = units;
+  events[index].total_time = value;
+}
+
+//! \brief Compute the load imbalance of an event: the maximum over
+//! processors of the time spent in it, divided by the mean.
+/*!
+ * Returns 1 (perfect balance) if no time was spent in this event yet.
+ */
+PetscErrorCode PISMProf::get_imbalance(int index, double &result) {
+  PetscErrorCode ierr;
+  double time = events[index].total_time, max_time, total_time;
+
+  ierr = PISMGlobalMax(&time, &max_time, com); CHKERRQ(ierr);
+  ierr = PISMGlobalSum(&time, &total_time, com); CHKERRQ(ierr);
+
+  if (total_time > 0.0)
+    result = max_time / (total_time / size);
+  else
+    result = 1.0;
+
+  return 0;
 }
 
 
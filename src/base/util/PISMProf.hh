@@ -77,6 +77,8 @@ public:
   PetscErrorCode barrier();
   PetscErrorCode save_report(string filename);
   void set_grid_size(int n);
+  void set_value(string name, string description, string units, double value);
+  PetscErrorCode get_imbalance(int index, double &result);
   int Nx, Ny;
 protected:
   vector<PISMEvent> events;
@@ -0,0 +1,347 @@
+// Copyright (C) 2012 PISM Authors
+//
+// This file is part of PISM.
+//
+// PISM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 2 of the License, or (at your option) any later
+// version.
+//
+// PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License
+// along with PISM; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "PISMRefinedPatches.hh"
+#include "IceGrid.hh"
+
+PISMRefinedPatches::PISMRefinedPatches(IceGrid &g, int r, int t)
+  : grid(g) {
+  refinement = r > 0 ? r : 1;
+  tile_size  = t > 0 ? t : 1;
+  halo       = 1;
+
+  n_tiles_x = (grid.xm + tile_size - 1) / tile_size;
+  n_tiles_y = (grid.ym + tile_size - 1) / tile_size;
+
+  padded_width = tile_size * refinement + 2 * halo;
+  padded_size  = padded_width * padded_width;
+
+  tile_index.resize(n_tiles_x * n_tiles_y, -1);
+
+  edges_global = PETSC_NULL;
+  edges_local  = PETSC_NULL;
+  edges_da     = PETSC_NULL;
+}
+
+PISMRefinedPatches::~PISMRefinedPatches() {
+  for (unsigned int n = 0; n < tiles.size(); ++n)
+    delete tiles[n];
+
+  if (edges_global != PETSC_NULL)
+    VecDestroy(&edges_global);
+  if (edges_local != PETSC_NULL)
+    VecDestroy(&edges_local);
+  if (edges_da != PETSC_NULL)
+    DMDestroy(&edges_da);
+}
+
+//! Register a field stored in every tile. Returns the index used by accessors.
+/*!
+ * Fields should be added before the first call to update().
+ */
+int PISMRefinedPatches::add_field(string name) {
+  field_names.push_back(name);
+
+  for (unsigned int n = 0; n < tiles.size(); ++n)
+    tiles[n]->data.resize(field_names.size() * padded_size, 0.0);
+
+  return field_names.size() - 1;
+}
+
+//! Returns the index of the field called `name` or -1 if there is no such field.
+int PISMRefinedPatches::get_field(string name) const {
+  for (unsigned int n = 0; n < field_names.size(); ++n)
+    if (field_names[n] == name)
+      return n;
+  return -1;
+}
+
+void PISMRefinedPatches::allocate_tile(int ti, int tj) {
+  Tile *t = new Tile;
+
+  int i0 = grid.xs + ti * tile_size,
+    j0 = grid.ys + tj * tile_size,
+    i1 = PetscMin(i0 + tile_size, grid.xs + grid.xm),
+    j1 = PetscMin(j0 + tile_size, grid.ys + grid.ym);
+
+  t->ti     = ti;
+  t->tj     = tj;
+  t->k0     = i0 * refinement;
+  t->l0     = j0 * refinement;
+  t->width  = (i1 - i0) * refinement;
+  t->height = (j1 - j0) * refinement;
+  t->data.resize(field_names.size() * padded_size, 0.0);
+
+  tile_index[ti * n_tiles_y + tj] = tiles.size();
+  tiles.push_back(t);
+}
+
+//! \brief Allocate tiles around cells where `glmask` is 1 or 2; free all the others.
+/*!
+ * Values stored in tiles that stay active are preserved. Newly-allocated tiles
+ * are set to zero; use refine() to initialize them from coarse fields.
+ *
+ * Tiles are kept in the order of their position in the subdomain, so loops
+ * over tiles visit refined cells in the same order every time.
+ */
+PetscErrorCode PISMRefinedPatches::update(IceModelVec2Int &glmask, int &allocated, int &freed) {
+  PetscErrorCode ierr;
+  vector<int> needed(tile_index.size(), 0);
+
+  ierr = glmask.begin_access(); CHKERRQ(ierr);
+  for (PetscInt i = grid.xs; i < grid.xs + grid.xm; ++i) {
+    for (PetscInt j = grid.ys; j < grid.ys + grid.ym; ++j) {
+      int m = glmask.as_int(i, j);
+      if (m == 1 || m == 2) {
+        needed[((i - grid.xs) / tile_size) * n_tiles_y + (j - grid.ys) / tile_size] = 1;
+      }
+    }
+  }
+  ierr = glmask.end_access(); CHKERRQ(ierr);
+
+  allocated = freed = 0;
+
+  vector<Tile*> old_tiles = tiles;
+  vector<int> old_index = tile_index;
+  tiles.clear();
+
+  for (int ti = 0; ti < n_tiles_x; ++ti) {
+    for (int tj = 0; tj < n_tiles_y; ++tj) {
+      int slot = ti * n_tiles_y + tj;
+
+      if (needed[slot] == 1 && old_index[slot] >= 0) {
+        tile_index[slot] = tiles.size();
+        tiles.push_back(old_tiles[old_index[slot]]);
+      } else if (needed[slot] == 1) {
+        allocate_tile(ti, tj);
+        allocated++;
+      } else {
+        if (old_index[slot] >= 0) {
+          delete old_tiles[old_index[slot]];
+          freed++;
+        }
+        tile_index[slot] = -1;
+      }
+    }
+  }
+
+  return 0;
+}
+
+//! \brief Copy coarse values to all the sub-cells of cells that have just been
+//! flagged for refinement.
+/*!
+ * Mirrors IceModel::update_refined_variable(): a coarse cell is (re-)injected
+ * if it is flagged 1 or 2 now and was flagged 0 or 2 before.
+ */
+PetscErrorCode PISMRefinedPatches::refine(int field, IceModelVec2S &coarse,
+                                          IceModelVec2Int &glmask_new,
+                                          IceModelVec2Int &glmask_old) {
+  PetscErrorCode ierr;
+
+  ierr = coarse.begin_access(); CHKERRQ(ierr);
+  ierr = glmask_new.begin_access(); CHKERRQ(ierr);
+  ierr = glmask_old.begin_access(); CHKERRQ(ierr);
+  for (PetscInt i = grid.xs; i < grid.xs + grid.xm; ++i) {
+    for (PetscInt j = grid.ys; j < grid.ys + grid.ym; ++j) {
+      int m_new = glmask_new.as_int(i, j),
+        m_old = glmask_old.as_int(i, j);
+
+      if ((m_new == 1 || m_new == 2) && (m_old == 0 || m_old == 2)) {
+        for (PetscInt k = i * refinement; k < (i + 1) * refinement; ++k)
+          for (PetscInt l = j * refinement; l < (j + 1) * refinement; ++l)
+            (*this)(field, k, l) = coarse(i, j);
+      }
+    }
+  }
+  ierr = glmask_old.end_access(); CHKERRQ(ierr);
+  ierr = glmask_new.end_access(); CHKERRQ(ierr);
+  ierr = coarse.end_access(); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! \brief Replace coarse values at grounding line cells (`glmask` == 1) by
+//! averages over their sub-cells.
+PetscErrorCode PISMRefinedPatches::coarsen(int field, IceModelVec2S &coarse,
+                                           IceModelVec2Int &glmask) {
+  PetscErrorCode ierr;
+  const PetscScalar weight = 1.0 / (refinement * refinement);
+
+  ierr = coarse.begin_access(); CHKERRQ(ierr);
+  ierr = glmask.begin_access(); CHKERRQ(ierr);
+  for (PetscInt i = grid.xs; i < grid.xs + grid.xm; ++i) {
+    for (PetscInt j = grid.ys; j < grid.ys + grid.ym; ++j) {
+      if (glmask.as_int(i, j) != 1)
+        continue;
+
+      PetscScalar sum = 0.0;
+      for (PetscInt k = i * refinement; k < (i + 1) * refinement; ++k)
+        for (PetscInt l = j * refinement; l < (j + 1) * refinement; ++l)
+          sum += (*this)(field, k, l);
+
+      coarse(i, j) = sum * weight;
+    }
+  }
+  ierr = glmask.end_access(); CHKERRQ(ierr);
+  ierr = coarse.end_access(); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! \brief Fill the halo of every active tile.
+/*!
+ * Halo cells in coarse cells flagged in `glmask` (1 or 2) get refined
+ * values; all the other halo cells get the value of the coarse cell
+ * containing them, so `coarse` has to have up-to-date ghosts.
+ *
+ * Refined values of flagged cells owned by other processors are
+ * communicated using a ghosted coarse-grid Vec holding a flag and the
+ * values at the four edges of each coarse cell (halo cells of a tile are
+ * next to the tile, so they are at the edge of the coarse cell containing
+ * them). Results therefore do not depend on the domain decomposition or on
+ * the tile layout.
+ */
+PetscErrorCode PISMRefinedPatches::fill_halo(int field, IceModelVec2S &coarse,
+                                             IceModelVec2Int &glmask) {
+  PetscErrorCode ierr;
+  // dof 0: flag; then west, east, south and north edges, refinement values each
+  const int r = refinement, WEST = 1, EAST = 1 + r, SOUTH = 1 + 2 * r, NORTH = 1 + 3 * r;
+  PetscScalar ***e;
+  DM da;
+
+  ierr = grid.get_dm(4 * r + 1, 1, da); CHKERRQ(ierr);
+
+  // the grid may have evicted the DA used last time from its cache (or
+  // re-partitioned); work vectors have to match the current one
+  if (da != edges_da) {
+    if (edges_da != PETSC_NULL) {
+      ierr = VecDestroy(&edges_global); CHKERRQ(ierr);
+      ierr = VecDestroy(&edges_local); CHKERRQ(ierr);
+      ierr = DMDestroy(&edges_da); CHKERRQ(ierr);
+    }
+    ierr = PetscObjectReference((PetscObject)da); CHKERRQ(ierr);
+    edges_da = da;
+    ierr = DMCreateGlobalVector(da, &edges_global); CHKERRQ(ierr);
+    ierr = DMCreateLocalVector(da, &edges_local); CHKERRQ(ierr);
+  }
+
+  ierr = DMDAVecGetArrayDOF(da, edges_global, &e); CHKERRQ(ierr);
+  ierr = glmask.begin_read_access(); CHKERRQ(ierr);
+  for (PetscInt i = grid.xs; i < grid.xs + grid.xm; ++i) {
+    for (PetscInt j = grid.ys; j < grid.ys + grid.ym; ++j) {
+      const int m = glmask.as_int(i, j);
+      const bool flagged = (m == 1 || m == 2);
+
+      e[i][j][0] = flagged ? 1.0 : 0.0;
+      for (int n = 0; n < r; ++n) {
+        if (flagged) {
+          e[i][j][WEST + n]  = (*this)(field, i * r, j * r + n);
+          e[i][j][EAST + n]  = (*this)(field, (i + 1) * r - 1, j * r + n);
+          e[i][j][SOUTH + n] = (*this)(field, i * r + n, j * r);
+          e[i][j][NORTH + n] = (*this)(field, i * r + n, (j + 1) * r - 1);
+        } else {
+          e[i][j][WEST + n] = e[i][j][EAST + n] = e[i][j][SOUTH + n] = e[i][j][NORTH + n] = 0.0;
+        }
+      }
+    }
+  }
+  ierr = glmask.end_access(); CHKERRQ(ierr);
+  ierr = DMDAVecRestoreArrayDOF(da, edges_global, &e); CHKERRQ(ierr);
+
+  ierr = DMGlobalToLocalBegin(da, edges_global, INSERT_VALUES, edges_local); CHKERRQ(ierr);
+  ierr = DMGlobalToLocalEnd(da, edges_global, INSERT_VALUES, edges_local); CHKERRQ(ierr);
+
+  ierr = DMDAVecGetArrayDOF(da, edges_local, &e); CHKERRQ(ierr);
+  ierr = coarse.begin_read_access(); CHKERRQ(ierr);
+  for (unsigned int n = 0; n < tiles.size(); ++n) {
+    Tile *t = tiles[n];
+    PetscScalar *p = &t->data[field * padded_size];
+
+    for (int a = 0; a < t->width + 2 * halo; ++a) {
+      for (int b = 0; b < t->height + 2 * halo; ++b) {
+        if (a >= halo && a < t->width + halo &&
+            b >= halo && b < t->height + halo)
+          continue;             // owned cell
+
+        int k = t->k0 + a - halo,
+          l = t->l0 + b - halo,
+          // floor(k / refinement), also for negative k
+          i = (k >= 0) ? k / r : -((-k + r - 1) / r),
+          j = (l >= 0) ? l / r : -((-l + r - 1) / r);
+        PetscScalar &result = p[a * padded_width + b];
+
+        if (e[i][j][0] < 0.5) {
+          result = coarse(i, j);
+        } else if (i < grid.xs) {
+          result = e[i][j][EAST + (l - j * r)];
+        } else if (i >= grid.xs + grid.xm) {
+          result = e[i][j][WEST + (l - j * r)];
+        } else if (j < grid.ys) {
+          result = e[i][j][NORTH + (k - i * r)];
+        } else if (j >= grid.ys + grid.ym) {
+          result = e[i][j][SOUTH + (k - i * r)];
+        } else {
+          result = (*this)(field, k, l);
+        }
+      }
+    }
+  }
+  ierr = coarse.end_access(); CHKERRQ(ierr);
+  ierr = DMDAVecRestoreArrayDOF(da, edges_local, &e); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! Copy all the values (including halos) of one field to another.
+PetscErrorCode PISMRefinedPatches::copy(int source, int destination) {
+  for (unsigned int n = 0; n < tiles.size(); ++n) {
+    vector<PetscScalar> &data = tiles[n]->data;
+    for (int m = 0; m < padded_size; ++m)
+      data[destination * padded_size + m] = data[source * padded_size + m];
+  }
+  return 0;
+}
+
+//! Returns true if the coarse cell (i,j) is owned and covered by an active tile.
+bool PISMRefinedPatches::is_active(int i, int j) const {
+  if (i < grid.xs || i >= grid.xs + grid.xm ||
+      j < grid.ys || j >= grid.ys + grid.ym)
+    return false;
+
+  return tile_index[((i - grid.xs) / tile_size) * n_tiles_y + (j - grid.ys) / tile_size] >= 0;
+}
+
+//! Number of active tiles on this processor.
+int PISMRefinedPatches::tile_count() const {
+  return tiles.size();
+}
+
+//! Refined-grid index ranges of owned cells in the active tile number `n`.
+void PISMRefinedPatches::tile_bounds(int n, int &xs, int &xm, int &ys, int &ym) const {
+  xs = tiles[n]->k0;
+  xm = tiles[n]->width;
+  ys = tiles[n]->l0;
+  ym = tiles[n]->height;
+}
+
+//! Memory used by tile storage on this processor, in bytes.
+size_t PISMRefinedPatches::memory_bytes() const {
+  return tiles.size() * field_names.size() * padded_size * sizeof(PetscScalar)
+    + tile_index.size() * sizeof(int);
+}
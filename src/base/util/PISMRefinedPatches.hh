@@ -0,0 +1,133 @@
+// Copyright (C) 2012 PISM Authors
+//
+// This file is part of PISM.
+//
+// PISM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 2 of the License, or (at your option) any later
+// version.
+//
+// PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License
+// along with PISM; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef __PISMRefinedPatches_hh
+#define __PISMRefinedPatches_hh
+
+#include <vector>
+#include <string>
+#include "iceModelVec.hh"
+
+//! \brief Block-sparse storage for fields on the grounding-line refined grid.
+/*!
+  The grounding-line refinement only ever touches coarse cells flagged 1
+  (grounding line) or 2 (grounding line neighbor) in the grounding line mask.
+  Instead of allocating whole-domain IceModelVecs at `refinement_factor`
+  squared resolution this class splits the processor's part of the coarse
+  grid into square tiles of `tile_size` coarse cells and allocates refined
+  storage only for tiles containing at least one flagged cell. Tiles are
+  created and freed by update() as the grounding line migrates.
+
+  Refined cells are addressed using indices on the (global) refined grid,
+  i.e. the sub-cells of the coarse cell (i,j) are (k,l) with
+  i*refinement <= k < (i+1)*refinement and j*refinement <= l < (j+1)*refinement.
+
+  Each tile carries a halo one refined cell wide so that star() can be used
+  at every owned refined cell of an active tile. fill_halo() copies refined
+  values of flagged coarse cells into the halo (communicating them across
+  processor boundaries) and injects the (ghosted) coarse field at all the other
+  halo cells, so halos do not depend on the domain decomposition.
+
+  Loops over refined cells should use tile_count() and tile_bounds():
+  \code
+  for (int n = 0; n < patches.tile_count(); ++n) {
+    int xs, xm, ys, ym;
+    patches.tile_bounds(n, xs, xm, ys, ym);
+    for (int k = xs; k < xs + xm; ++k)
+      for (int l = ys; l < ys + ym; ++l)
+        ...
+  }
+  \endcode
+ */
+class PISMRefinedPatches {
+public:
+  PISMRefinedPatches(IceGrid &g, int refinement, int tile_size);
+  ~PISMRefinedPatches();
+
+  int add_field(string name);
+  int get_field(string name) const;
+
+  PetscErrorCode update(IceModelVec2Int &glmask, int &allocated, int &freed);
+  PetscErrorCode refine(int field, IceModelVec2S &coarse,
+                        IceModelVec2Int &glmask_new, IceModelVec2Int &glmask_old);
+  PetscErrorCode coarsen(int field, IceModelVec2S &coarse, IceModelVec2Int &glmask);
+  PetscErrorCode fill_halo(int field, IceModelVec2S &coarse, IceModelVec2Int &glmask);
+  PetscErrorCode copy(int source, int destination);
+
+  bool is_active(int i, int j) const;
+  int tile_count() const;
+  void tile_bounds(int n, int &xs, int &xm, int &ys, int &ym) const;
+  size_t memory_bytes() const;
+
+  //! Value of the field `field` at the owned refined cell (k,l).
+  inline PetscScalar& operator()(int field, int k, int l) {
+    Tile *t = tiles[tile_index[tile_of(k, l)]];
+    return t->data[field * padded_size + offset(t, k, l)];
+  }
+
+  //! Values of the field `field` at (k,l) and its four neighbors; uses the tile halo.
+  inline planeStar<PetscScalar> star(int field, int k, int l) {
+    Tile *t = tiles[tile_index[tile_of(k, l)]];
+    PetscScalar *p = &t->data[field * padded_size + offset(t, k, l)];
+    planeStar<PetscScalar> result;
+
+    result.ij = p[0];
+    result.e  = p[padded_width];
+    result.w  = p[-padded_width];
+    result.n  = p[1];
+    result.s  = p[-1];
+
+    return result;
+  }
+
+protected:
+  struct Tile {
+    int ti, tj;                 //!< tile indices within the processor's subdomain
+    int k0, l0;                 //!< refined-grid indices of the first owned cell
+    int width, height;          //!< number of owned refined cells
+    vector<PetscScalar> data;   //!< all fields, each padded_width x padded_width
+  };
+
+  IceGrid &grid;
+  int refinement, tile_size, halo,
+    n_tiles_x, n_tiles_y,
+    padded_width, padded_size;
+  vector<string> field_names;
+  vector<int> tile_index;       //!< position in "tiles" for each tile slot; -1 if inactive
+  vector<Tile*> tiles;
+  //! refined values at the edges of flagged coarse cells, sent to neighbors
+  //! by fill_halo() (global and ghosted), and the DA they were created with
+  //! (referenced; see IceGrid::get_dm())
+  Vec edges_global, edges_local;
+  DM edges_da;
+
+  //! Tile slot containing the refined cell (k,l); the cell has to be owned.
+  inline int tile_of(int k, int l) const {
+    int ti = (k / refinement - grid.xs) / tile_size,
+      tj = (l / refinement - grid.ys) / tile_size;
+    return ti * n_tiles_y + tj;
+  }
+
+  inline int offset(const Tile *t, int k, int l) const {
+    return (k - t->k0 + halo) * padded_width + (l - t->l0 + halo);
+  }
+
+  void allocate_tile(int ti, int tj);
+};
+
+#endif /* __PISMRefinedPatches_hh */
@@ -46,6 +46,10 @@ IceModelVec::IceModelVec() {
   shallow_copy = false;
   state_counter = 0;
 
+  ghost_state = new GhostState;
+  ghost_state->valid = false;
+  ghost_state->update_elided = false;
+
   v = PETSC_NULL;
 
   zlevels.resize(1);
@@ -83,6 +87,8 @@ IceModelVec::IceModelVec(const IceModelVec &other) {
   shallow_copy = true;
   state_counter = other.state_counter;
 
+  ghost_state = other.ghost_state;
+
   time_independent = other.time_independent;
 
   v = other.v;
@@ -136,7 +142,10 @@ PetscErrorCode IceModelVec::create_2d_da(DM &result, PetscInt da_dof, PetscInt s
 
 IceModelVec::~IceModelVec() {
   // Only destroy the IceModelVec if it is not a shallow copy:
-  if (!shallow_copy) destroy();
+  if (!shallow_copy) {
+    destroy();
+    delete ghost_state;
+  }
 }
 
 //! Returns true if create() was called and false otherwise.
@@ -156,6 +165,7 @@ PetscErrorCode  IceModelVec::destroy() {
   PetscErrorCode ierr;
 
   if (v != PETSC_NULL) {
+    grid->remove_vec(this);
     ierr = VecDestroy(&v); CHKERRQ(ierr);
     v = PETSC_NULL;
   }
@@ -275,6 +285,7 @@ PetscErrorCode IceModelVec::add(PetscScalar alpha, IceModelVec &x) {
   ierr = checkCompatibility("add", x); CHKERRQ(ierr);
 
   ierr = VecAXPY(v, alpha, x.v); CHKERRQ(ierr);
+  ghost_state->valid = ghost_state->valid && x.ghost_state->valid;
   return 0;
 }
 
@@ -288,6 +299,7 @@ PetscErrorCode IceModelVec::add(PetscScalar alpha, IceModelVec &x, IceModelVec &
   ierr = checkCompatibility("add", result); CHKERRQ(ierr);
 
   ierr = VecWAXPY(result.v, alpha, x.v, v); CHKERRQ(ierr);
+  result.ghost_state->valid = ghost_state->valid && x.ghost_state->valid;
   return 0;
 }
 
@@ -318,6 +330,7 @@ PetscErrorCode  IceModelVec::multiply_by(IceModelVec &x, IceModelVec &result) {
   ierr = checkCompatibility("multiply_by", result); CHKERRQ(ierr);
 
   ierr = VecPointwiseMult(result.v, v, x.v); CHKERRQ(ierr);
+  result.ghost_state->valid = ghost_state->valid && x.ghost_state->valid;
   return 0;
 }
 
@@ -329,6 +342,7 @@ PetscErrorCode  IceModelVec::multiply_by(IceModelVec &x) {
   ierr = checkCompatibility("multiply_by", x); CHKERRQ(ierr);
 
   ierr = VecPointwiseMult(v, v, x.v); CHKERRQ(ierr);
+  ghost_state->valid = ghost_state->valid && x.ghost_state->valid;
   return 0;
 }
 
@@ -356,6 +370,7 @@ PetscErrorCode IceModelVec::copy_from(Vec source) {
   if (localp) {
     ierr =   DMGlobalToLocalBegin(da, source, INSERT_VALUES, v);  CHKERRQ(ierr);
     ierr =     DMGlobalToLocalEnd(da, source, INSERT_VALUES, v);  CHKERRQ(ierr);
+    ghost_state->valid = true;
   } else {
     ierr = VecCopy(source, v); CHKERRQ(ierr);
   }
@@ -370,6 +385,7 @@ PetscErrorCode  IceModelVec::copy_to(IceModelVec &destination) {
   ierr = checkCompatibility("copy_to", destination); CHKERRQ(ierr);
 
   ierr = VecCopy(v, destination.v); CHKERRQ(ierr);
+  destination.ghost_state->valid = ghost_state->valid;
   return 0;
 }
 
@@ -381,6 +397,7 @@ PetscErrorCode  IceModelVec::copy_from(IceModelVec &source) {
   ierr = checkCompatibility("copy_from", source); CHKERRQ(ierr);
 
   ierr = VecCopy(source.v, v); CHKERRQ(ierr);
+  ghost_state->valid = source.ghost_state->valid;
   return 0;
 }
 
@@ -547,6 +564,7 @@ PetscErrorCode IceModelVec::regrid(string filename, bool critical, int start) {
 
     ierr = DMGlobalToLocalBegin(da, g, INSERT_VALUES, v); CHKERRQ(ierr);
     ierr = DMGlobalToLocalEnd(da, g, INSERT_VALUES, v); CHKERRQ(ierr);
+    ghost_state->valid = true;
 
     ierr = VecDestroy(&g); CHKERRQ(ierr);
   } else {
@@ -582,6 +600,7 @@ PetscErrorCode IceModelVec::regrid(string filename, PetscScalar default_value) {
 
     ierr = DMGlobalToLocalBegin(da, g, INSERT_VALUES, v); CHKERRQ(ierr);
     ierr = DMGlobalToLocalEnd(da, g, INSERT_VALUES, v); CHKERRQ(ierr);
+    ghost_state->valid = true;
 
     ierr = VecDestroy(&g); CHKERRQ(ierr);
   } else {
@@ -612,6 +631,7 @@ PetscErrorCode IceModelVec::read(string filename, const unsigned int time) {
 
     ierr = DMGlobalToLocalBegin(da, g, INSERT_VALUES, v); CHKERRQ(ierr);
     ierr = DMGlobalToLocalEnd(da, g, INSERT_VALUES, v); CHKERRQ(ierr);
+    ghost_state->valid = true;
 
     ierr = VecDestroy(&g); CHKERRQ(ierr);
   } else {
@@ -786,6 +806,25 @@ PetscErrorCode  IceModelVec::begin_access() {
 
   access_counter++;
 
+  // values may be modified: ghosts have to be updated again
+  ghost_state->valid = false;
+
+  return 0;
+}
+
+//! \brief Starts access to values of an IceModelVec that will not be
+//! modified. Unlike begin_access(), keeps ghosts marked as up to date.
+/*!
+ * Has to be followed by end_access().
+ */
+PetscErrorCode IceModelVec::begin_read_access() {
+  PetscErrorCode ierr;
+  bool valid = ghost_state->valid;
+
+  ierr = begin_access(); CHKERRQ(ierr);
+
+  ghost_state->valid = valid;
+
   return 0;
 }
 
@@ -811,7 +850,64 @@ PetscErrorCode  IceModelVec::end_access() {
   return 0;
 }
 
+//! \brief Returns true if the ghost update that is about to start can be
+//! skipped because ghosts are up to date.
+/*!
+ * Updates ghost update counters in the grid.
+ */
+bool IceModelVec::elide_ghost_update() {
+  bool elide = ghost_state->valid && grid->config.get_flag("grid_elide_ghost_updates");
+
+#if (PISM_DEBUG==1)
+  // processors have to agree, otherwise some of them would wait for messages
+  // that are never sent
+  PetscScalar my_flag = elide ? 1.0 : 0.0, min_flag, max_flag;
+  PISMGlobalMin(&my_flag, &min_flag, grid->com);
+  PISMGlobalMax(&my_flag, &max_flag, grid->com);
+  if (min_flag != max_flag) {
+    PetscPrintf(grid->com,
+                "PISM ERROR: processors disagree about the validity of ghosts of '%s'\n",
+                name.c_str());
+    PISMEnd();
+  }
+
+  if (elide) {
+    // check that ghosts really are up to date (all writes have to go through
+    // begin_access(), set(), copy_from() and other IceModelVec methods)
+    PetscErrorCode ierr;
+    Vec g, l;
+    PetscBool equal;
+    ierr = DMGetGlobalVector(da, &g); CHKERRABORT(grid->com, ierr);
+    ierr = DMGetLocalVector(da, &l); CHKERRABORT(grid->com, ierr);
+    ierr = DMLocalToGlobalBegin(da, v, INSERT_VALUES, g); CHKERRABORT(grid->com, ierr);
+    ierr = DMLocalToGlobalEnd(da, v, INSERT_VALUES, g); CHKERRABORT(grid->com, ierr);
+    ierr = DMGlobalToLocalBegin(da, g, INSERT_VALUES, l); CHKERRABORT(grid->com, ierr);
+    ierr = DMGlobalToLocalEnd(da, g, INSERT_VALUES, l); CHKERRABORT(grid->com, ierr);
+    ierr = VecEqual(v, l, &equal); CHKERRABORT(grid->com, ierr);
+    ierr = DMRestoreLocalVector(da, &l); CHKERRABORT(grid->com, ierr);
+    ierr = DMRestoreGlobalVector(da, &g); CHKERRABORT(grid->com, ierr);
+
+    if (equal == PETSC_FALSE) {
+      PetscPrintf(grid->com,
+                  "PISM ERROR: ghosts of '%s' are marked as up to date, but they are not\n",
+                  name.c_str());
+      PISMEnd();
+    }
+  }
+#endif
+
+  if (elide)
+    grid->ghost_updates_elided++;
+  else
+    grid->ghost_updates++;
+
+  return elide;
+}
+
 //! Starts the communication of ghost points.
+/*!
+ * Does nothing if ghosts are up to date; see elide_ghost_update().
+ */
 PetscErrorCode  IceModelVec::beginGhostComm() {
   PetscErrorCode ierr;
   if (!localp) {
@@ -819,6 +915,11 @@ PetscErrorCode  IceModelVec::beginGhostComm() {
                name.c_str());
   }
   ierr = checkAllocated(); CHKERRQ(ierr);
+
+  ghost_state->update_elided = elide_ghost_update();
+  if (ghost_state->update_elided)
+    return 0;
+
   ierr = DMDALocalToLocalBegin(da, v, INSERT_VALUES, v);  CHKERRQ(ierr);
   return 0;
 }
@@ -831,7 +932,15 @@ PetscErrorCode  IceModelVec::endGhostComm() {
                name.c_str());
   }
   ierr = checkAllocated(); CHKERRQ(ierr);
+
+  if (ghost_state->update_elided) {
+    ghost_state->update_elided = false;
+    return 0;
+  }
+
   ierr = DMDALocalToLocalEnd(da, v, INSERT_VALUES, v); CHKERRQ(ierr);
+  // values may still be modified if the update overlaps computations
+  ghost_state->valid = (access_counter == 0);
   return 0;
 }
 
@@ -849,6 +958,7 @@ PetscErrorCode  IceModelVec::beginGhostComm(IceModelVec &destination) {
 
   ierr = checkAllocated(); CHKERRQ(ierr);
   ierr = DMDALocalToLocalBegin(da, v, INSERT_VALUES, destination.v);  CHKERRQ(ierr);
+  grid->ghost_updates++;
   return 0;
 }
 
@@ -866,6 +976,7 @@ PetscErrorCode  IceModelVec::endGhostComm(IceModelVec &destination) {
 
   ierr = checkAllocated(); CHKERRQ(ierr);
   ierr = DMDALocalToLocalEnd(da, v, INSERT_VALUES, destination.v); CHKERRQ(ierr);
+  destination.ghost_state->valid = (destination.access_counter == 0);
   return 0;
 }
 
@@ -874,6 +985,58 @@ PetscErrorCode  IceModelVec::set(const PetscScalar c) {
   PetscErrorCode ierr;
   ierr = checkAllocated(); CHKERRQ(ierr);
   ierr = VecSet(v,c); CHKERRQ(ierr);
+  // VecSet() sets ghosts, too
+  ghost_state->valid = true;
+  return 0;
+}
+
+//! \brief Move data to the domain decomposition described by the current
+//! ownership ranges of the grid. Called by IceGrid::redistribute().
+/*!
+ * \c da2_old is the DA the grid used before the change; IceModelVecs sharing
+ * it switch to the new \c grid->da2, all others get a new DA with the same
+ * number of degrees of freedom and stencil width.
+ */
+PetscErrorCode IceModelVec::redistribute(DM da2_old) {
+  PetscErrorCode ierr;
+  DM da_new;
+  Vec v_new;
+
+  if (v == PETSC_NULL || shallow_copy)
+    return 0;
+
+  if (access_counter != 0)
+    SETERRQ1(grid->com, 1, "IceModelVec::redistribute(): '%s' is being accessed", name.c_str());
+
+  bool shared_da = (da == da2_old);
+  if (shared_da) {
+    da_new = grid->da2;
+  } else {
+    PetscInt da_dof, width;
+    ierr = DMDAGetInfo(da, PETSC_NULL, PETSC_NULL, PETSC_NULL, PETSC_NULL,
+                       PETSC_NULL, PETSC_NULL, PETSC_NULL,
+                       &da_dof, &width,
+                       PETSC_NULL, PETSC_NULL, PETSC_NULL, PETSC_NULL); CHKERRQ(ierr);
+    ierr = create_2d_da(da_new, da_dof, width); CHKERRQ(ierr);
+  }
+
+  if (localp) {
+    ierr = DMCreateLocalVector(da_new, &v_new); CHKERRQ(ierr);
+  } else {
+    ierr = DMCreateGlobalVector(da_new, &v_new); CHKERRQ(ierr);
+  }
+
+  ierr = grid->redistribute_vec(da, v, da_new, v_new, localp); CHKERRQ(ierr);
+
+  ierr = VecDestroy(&v); CHKERRQ(ierr);
+  if (shared_da == false) {
+    ierr = DMDestroy(&da); CHKERRQ(ierr);
+  }
+
+  da = da_new;
+  v = v_new;
+  ghost_state->valid = false;
+
   return 0;
 }
 
@@ -90,6 +90,18 @@ class LocalInterpCtx;
  ierr = var.endGhostComm(); CHKERRQ(ierr);
  \endcode
 
+ An IceModelVec keeps track of whether its ghosts are up to date: they are
+ after a ghost update and after set(), and they are not after begin_access()
+ (which allows writing; get_array() calls it). Methods writing to the
+ internal Vec (copy_from(), set_component(), get_component(), read(), etc.)
+ update this state, too. beginGhostComm() and endGhostComm() do nothing if
+ ghosts are up to date (unless the grid_elide_ghost_updates flag is off), so
+ use begin_read_access() instead of begin_access() in code that does not
+ modify a field to avoid unnecessary ghost updates later. (Fields are
+ modified on all processors at once, so processors agree on whether an
+ update is needed.) Debugging builds check that skipped updates would not
+ have changed any ghost values.
+
  \section imv_io Reading and writing variables
 
  PISM can read variables either from files with data on a grid matching the
@@ -211,6 +223,7 @@ public:
 
   virtual PetscErrorCode  begin_access();
   virtual PetscErrorCode  end_access();
+  PetscErrorCode          begin_read_access();
   virtual PetscErrorCode  beginGhostComm();
   virtual PetscErrorCode  endGhostComm();
   virtual PetscErrorCode  beginGhostComm(IceModelVec &destination);
@@ -218,9 +231,17 @@ public:
 
   virtual PetscErrorCode  set(PetscScalar c);
 
+  virtual PetscErrorCode  redistribute(DM da2_old);
+
   virtual int get_state_counter() const;
   virtual void inc_state_counter();
 
+  //! True if ghost values are known to be up to date.
+  bool ghosts_are_valid() const { return localp && ghost_state->valid; }
+  //! \brief Marks ghosts as up to date (after computing them locally) or out of
+  //! date (after modifying values without begin_access()).
+  void set_ghosts_valid(bool flag) { ghost_state->valid = flag; }
+
   bool   report_range;                 //!< If true, report range when regridding.
   bool   write_in_glaciological_units, //!< \brief If true, data is written to
   //!< a file in "human-friendly" units.
@@ -256,6 +277,14 @@ protected:
   int access_counter;		// used in begin_access() and end_access()
   int state_counter;            //!< Internal IceModelVec "revision number"
 
+  //! Ghost update state; a pointer because shallow copies share it.
+  struct GhostState {
+    bool valid;                 //!< true if ghosts are up to date
+    bool update_elided;         //!< true if the current beginGhostComm() did nothing
+  };
+  GhostState *ghost_state;
+  bool elide_ghost_update();
+
   virtual PetscErrorCode create_2d_da(DM &result, PetscInt da_dof, PetscInt stencil_width);
   virtual PetscErrorCode destroy();
   virtual PetscErrorCode checkAllocated();
@@ -266,6 +295,8 @@ protected:
   void check_array_indices(int i, int j);
   virtual PetscErrorCode reset_attrs(int N);
   virtual PetscErrorCode get_interp_context(string filename, LocalInterpCtx* &lic);
+
+  friend class PISMGhostCommGroup;
 };
 
 
@@ -623,16 +654,55 @@ public:
   // note the IceModelVec3 with this method must be *local* while imv3_source must be *global*
   virtual PetscErrorCode beginGhostCommTransfer(IceModelVec3D &imv3_source);
   virtual PetscErrorCode endGhostCommTransfer(IceModelVec3D &imv3_source);
+  virtual PetscErrorCode beginGhostCommTransfer(IceModelVec3D &imv3_source, PetscInt levels_needed);
+  virtual PetscErrorCode endGhostCommTransfer(IceModelVec3D &imv3_source, PetscInt levels_needed);
   virtual PetscScalar    getValZ(PetscInt i, PetscInt j, PetscScalar z);
   virtual PetscErrorCode isLegalLevel(PetscScalar z);
+
+  virtual PetscErrorCode redistribute(DM da2_old);
+
+  virtual PetscErrorCode range(PetscReal &min, PetscReal &max);
+  virtual PetscErrorCode norm(NormType n, PetscReal &out);
+  using IceModelVec::write;
+  virtual PetscErrorCode write(string filename, PISM_IO_Type nctype);
+  virtual PetscErrorCode read(string filename, unsigned int time);
+  virtual PetscErrorCode regrid(string filename, bool critical, int start = 0);
+  virtual PetscErrorCode regrid(string filename, PetscScalar default_value);
+
+  //! \brief Returns the number of levels allocated in each column (at least
+  //! get_nlevels()).
+  int get_capacity() { return capacity; }
 protected:
   virtual PetscErrorCode allocate(IceGrid &mygrid, string my_short_name,
                                   bool has_ghosts, vector<double> levels, int stencil_width = 1);
   virtual PetscErrorCode destroy();
   virtual PetscErrorCode has_nan();
 
+  //! \brief Number of levels allocated in each column; levels from n_levels
+  //! to capacity - 1 are room for the extension of the vertical grid (see
+  //! IceModelVec3::extend_vertically()).
+  int capacity;
+  PetscErrorCode pack_levels(Vec result);
+  PetscErrorCode unpack_levels(Vec source);
+
   Vec sounding_buffer;
   map<string,PetscViewer> *sounding_viewers;
+
+  //! \brief Storage used to communicate the bottom levels of columns only;
+  //! see beginGhostCommTransfer(IceModelVec3D&, PetscInt).
+  struct LevelComm {
+    DM  da;                     //!< 2D DA with `dof` degrees of freedom (or PETSC_NULL)
+    Vec global, local;
+    PetscInt dof;               //!< number of levels communicated
+    bool reduced;               //!< false if all the levels are communicated
+  };
+  LevelComm *level_comm;        //!< shared by shallow copies
+
+  PetscErrorCode destroy_level_comm();
+
+  bool uses_grid_levels;        //!< true if zlevels are the storage levels of the grid
+  PetscInt level_below(PetscScalar z) const;
+  PetscScalar interpolate_column(const PetscScalar *column, PetscScalar z) const;
 };
 
 
@@ -663,9 +733,11 @@ public:
 
   PetscErrorCode  getHorSlice(Vec &gslice, PetscScalar z); // used in iMmatlab.cc
   PetscErrorCode  getHorSlice(IceModelVec2S &gslice, PetscScalar z);
+  PetscErrorCode  getHorSlice(PetscScalar **slice_val, PetscScalar z);
   PetscErrorCode  getSurfaceValues(Vec &gsurf, IceModelVec2S &myH); // used in iMviewers.cc
   PetscErrorCode  getSurfaceValues(IceModelVec2S &gsurf, IceModelVec2S &myH);
   PetscErrorCode  getSurfaceValues(IceModelVec2S &gsurf, PetscScalar **H);
+  PetscErrorCode  getSurfaceValues(PetscScalar **surf_val, PetscScalar **H);
   PetscErrorCode  extend_vertically(int old_Mz, PetscScalar fill_value);
   PetscErrorCode  extend_vertically(int old_Mz, IceModelVec2S &fill_values);
 protected:
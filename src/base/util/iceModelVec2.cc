@@ -97,6 +97,7 @@ PetscErrorCode IceModelVec2S::get_from_proc0(Vec onp0, VecScatter ctx, Vec g2, V
   ierr =   DMDANaturalToGlobalEnd(grid->da2, g2natural, INSERT_VALUES, g2); CHKERRQ(ierr);
   ierr =   DMGlobalToLocalBegin(da, g2,               INSERT_VALUES, v);  CHKERRQ(ierr);
   ierr =     DMGlobalToLocalEnd(da, g2,               INSERT_VALUES, v);  CHKERRQ(ierr);
+  ghost_state->valid = true;
 
   return 0;
 }
@@ -581,6 +582,8 @@ PetscErrorCode IceModelVec2::set_component(int N, Vec source) {
   ierr = DMDAVecRestoreArray(grid->da2, source, &tmp_src); CHKERRQ(ierr);
   ierr = DMDAVecRestoreArrayDOF(da, v, &tmp_v); CHKERRQ(ierr);
 
+  ghost_state->valid = false;
+
   return 0;
 }
 
@@ -589,6 +592,9 @@ PetscErrorCode IceModelVec2::get_component(int n, IceModelVec2S &result) {
 
   ierr = IceModelVec2::get_component(n, result.v); CHKERRQ(ierr);
 
+  // only owned values were copied
+  result.ghost_state->valid = false;
+
   return 0;
 }
 
@@ -627,6 +633,7 @@ PetscErrorCode  IceModelVec2::create(IceGrid &my_grid, string my_name, bool loca
   } else {
     ierr = DMCreateGlobalVector(da, &v); CHKERRQ(ierr);
   }
+  grid->add_vec(this);
 
   localp = local;
   name = my_name;
@@ -670,8 +677,10 @@ static PetscErrorCode multiply_2d(IceModelVec2S* const x, IceModelVec2S* const y
 
   IceGrid *grid = z->get_grid();
 
-  ierr = x->begin_access(); CHKERRQ(ierr);
-  ierr = y->begin_access(); CHKERRQ(ierr);
+  bool ghosts_valid = x->ghosts_are_valid() && y->ghosts_are_valid();
+
+  ierr = x->begin_read_access(); CHKERRQ(ierr);
+  ierr = y->begin_read_access(); CHKERRQ(ierr);
   ierr = z->begin_access(); CHKERRQ(ierr);
   for (PetscInt   i = grid->xs - ghosts; i < grid->xs+grid->xm + ghosts; ++i) {
     for (PetscInt j = grid->ys - ghosts; j < grid->ys+grid->ym + ghosts; ++j) {
@@ -682,6 +691,9 @@ static PetscErrorCode multiply_2d(IceModelVec2S* const x, IceModelVec2S* const y
   ierr = y->end_access(); CHKERRQ(ierr);
   ierr = x->end_access(); CHKERRQ(ierr);
 
+  if (ghosts > 0)
+    z->set_ghosts_valid(ghosts_valid);
+
   if (scatter) {
     ierr = z->beginGhostComm(); CHKERRQ(ierr);
     ierr = z->endGhostComm(); CHKERRQ(ierr);
@@ -730,6 +742,8 @@ PetscErrorCode  IceModelVec2Stag::begin_access() {
 
   access_counter++;
 
+  ghost_state->valid = false;
+
   return 0;
 }
 
@@ -115,6 +115,37 @@ PetscErrorCode IceModelVec2T::destroy() {
   return 0;
 }
 
+//! \brief Move the current field, all the records stored in memory and the
+//! interpolation context used to read more records to the new domain
+//! decomposition.
+PetscErrorCode IceModelVec2T::redistribute(DM da2_old) {
+  PetscErrorCode ierr;
+  DM da3_new;
+  Vec v3_new;
+
+  if (v == PETSC_NULL || shallow_copy)
+    return 0;
+
+  ierr = IceModelVec2S::redistribute(da2_old); CHKERRQ(ierr);
+
+  ierr = create_2d_da(da3_new, n_records, 1); CHKERRQ(ierr);
+  ierr = DMCreateGlobalVector(da3_new, &v3_new); CHKERRQ(ierr);
+
+  ierr = grid->redistribute_vec(da3, v3, da3_new, v3_new, false); CHKERRQ(ierr);
+
+  ierr = VecDestroy(&v3); CHKERRQ(ierr);
+  ierr = DMDestroy(&da3); CHKERRQ(ierr);
+  da3 = da3_new;
+  v3  = v3_new;
+
+  if (lic != NULL) {
+    delete lic;
+    ierr = get_interp_context(filename, lic); CHKERRQ(ierr);
+  }
+
+  return 0;
+}
+
 PetscErrorCode IceModelVec2T::get_array3(PetscScalar*** &a3) {
   PetscErrorCode ierr = begin_access(); CHKERRQ(ierr);
   a3 = (PetscScalar***) array3;
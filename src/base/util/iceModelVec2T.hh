@@ -121,6 +121,7 @@ public:
   virtual PetscErrorCode begin_access();
   virtual PetscErrorCode end_access();
   virtual PetscErrorCode init_interpolation(const PetscScalar *ts, unsigned int ts_length);
+  virtual PetscErrorCode redistribute(DM da2_old);
 
 protected:
   vector<double> time,		//!< all the times available in filename
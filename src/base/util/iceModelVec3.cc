@@ -24,6 +24,7 @@
 #include "PIO.hh"
 #include "iceModelVec.hh"
 #include "IceGrid.hh"
+#include "LocalInterpCtx.hh"
 
 // this file contains method for derived class IceModelVec3
 
@@ -33,6 +34,16 @@
 IceModelVec3D::IceModelVec3D() : IceModelVec() {
   sounding_buffer = PETSC_NULL;
   sounding_viewers = new map<string, PetscViewer>;
+
+  level_comm = new LevelComm;
+  level_comm->da = PETSC_NULL;
+  level_comm->global = PETSC_NULL;
+  level_comm->local = PETSC_NULL;
+  level_comm->dof = 0;
+  level_comm->reduced = false;
+
+  uses_grid_levels = false;
+  capacity = 0;
 }
 
 IceModelVec3D::~IceModelVec3D() {
@@ -45,10 +56,18 @@ IceModelVec3D::IceModelVec3D(const IceModelVec3D &other)
   : IceModelVec(other) {
   sounding_buffer = other.sounding_buffer;
   sounding_viewers = other.sounding_viewers;
+  level_comm = other.level_comm;
+  uses_grid_levels = other.uses_grid_levels;
+  capacity = other.capacity;
   shallow_copy = true;
 }
 
 //! Allocate a DA and a Vec from information in IceGrid.
+/*!
+ * Fields using the storage levels of the grid allocate `grid_Mz_capacity`
+ * levels (if this is more than the number of levels), leaving room for the
+ * extension of the grid by IceModel::check_maximum_thickness().
+ */
 PetscErrorCode  IceModelVec3D::allocate(IceGrid &my_grid, string my_name,
                                         bool local, vector<double> levels, int stencil_width) {
   PetscErrorCode ierr;
@@ -64,15 +83,21 @@ PetscErrorCode  IceModelVec3D::allocate(IceGrid &my_grid, string my_name,
 
   zlevels = levels;
   n_levels = (int)zlevels.size();
+  uses_grid_levels = (zlevels == grid->zlevels);
+
+  capacity = n_levels;
+  if (uses_grid_levels)
+    capacity = PetscMax(n_levels, static_cast<int>(grid->config.get("grid_Mz_capacity")));
 
   da_stencil_width = stencil_width;
-  ierr = create_2d_da(da, n_levels, da_stencil_width); CHKERRQ(ierr);
+  ierr = create_2d_da(da, capacity, da_stencil_width); CHKERRQ(ierr);
 
   if (local) {
     ierr = DMCreateLocalVector(da, &v); CHKERRQ(ierr);
   } else {
     ierr = DMCreateGlobalVector(da, &v); CHKERRQ(ierr);
   }
+  grid->add_vec(this);
 
   localp = local;
   name = my_name;
@@ -104,6 +129,265 @@ PetscErrorCode IceModelVec3D::destroy() {
     sounding_buffer = PETSC_NULL;
   }
 
+  if (level_comm != NULL) {
+    ierr = destroy_level_comm(); CHKERRQ(ierr);
+    delete level_comm;
+    level_comm = NULL;
+  }
+
+  return 0;
+}
+
+PetscErrorCode IceModelVec3D::destroy_level_comm() {
+  PetscErrorCode ierr;
+
+  if (level_comm->da != PETSC_NULL) {
+    ierr = VecDestroy(&level_comm->global); CHKERRQ(ierr);
+    ierr = VecDestroy(&level_comm->local); CHKERRQ(ierr);
+    ierr = DMDestroy(&level_comm->da); CHKERRQ(ierr);
+    level_comm->global = PETSC_NULL;
+    level_comm->local = PETSC_NULL;
+    level_comm->da = PETSC_NULL;
+  }
+  level_comm->dof = 0;
+
+  return 0;
+}
+
+//! \brief Move data to the new domain decomposition. Storage used by the
+//! reduced ghost communication is re-allocated on the next use.
+PetscErrorCode IceModelVec3D::redistribute(DM da2_old) {
+  PetscErrorCode ierr;
+
+  if (!shallow_copy && level_comm != NULL) {
+    ierr = destroy_level_comm(); CHKERRQ(ierr);
+  }
+
+  ierr = IceModelVec::redistribute(da2_old); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! \brief Copies the levels in use (not the room for the grid extension) of
+//! owned columns to a global Vec created using grid->get_dm(n_levels, ...).
+PetscErrorCode IceModelVec3D::pack_levels(Vec result) {
+  PetscErrorCode ierr;
+  DM da_packed;
+  PetscScalar ***packed;
+
+  ierr = grid->get_dm(n_levels, da_stencil_width, da_packed); CHKERRQ(ierr);
+
+  ierr = DMDAVecGetArrayDOF(da_packed, result, &packed); CHKERRQ(ierr);
+  ierr = begin_read_access(); CHKERRQ(ierr);
+  PetscScalar ***arr = (PetscScalar***) array;
+  for (PetscInt i = grid->xs; i < grid->xs + grid->xm; ++i) {
+    for (PetscInt j = grid->ys; j < grid->ys + grid->ym; ++j) {
+      ierr = PetscMemcpy(packed[i][j], arr[i][j], n_levels * sizeof(PetscScalar)); CHKERRQ(ierr);
+    }
+  }
+  ierr = end_access(); CHKERRQ(ierr);
+  ierr = DMDAVecRestoreArrayDOF(da_packed, result, &packed); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! \brief Copies values from a Vec filled by pack_levels() (or read from a
+//! file) to owned columns and updates ghosts (if any).
+PetscErrorCode IceModelVec3D::unpack_levels(Vec source) {
+  PetscErrorCode ierr;
+  DM da_packed;
+  PetscScalar ***packed;
+
+  ierr = grid->get_dm(n_levels, da_stencil_width, da_packed); CHKERRQ(ierr);
+
+  ierr = DMDAVecGetArrayDOF(da_packed, source, &packed); CHKERRQ(ierr);
+  ierr = begin_access(); CHKERRQ(ierr);
+  PetscScalar ***arr = (PetscScalar***) array;
+  for (PetscInt i = grid->xs; i < grid->xs + grid->xm; ++i) {
+    for (PetscInt j = grid->ys; j < grid->ys + grid->ym; ++j) {
+      ierr = PetscMemcpy(arr[i][j], packed[i][j], n_levels * sizeof(PetscScalar)); CHKERRQ(ierr);
+    }
+  }
+  ierr = end_access(); CHKERRQ(ierr);
+  ierr = DMDAVecRestoreArrayDOF(da_packed, source, &packed); CHKERRQ(ierr);
+
+  if (localp) {
+    ierr = beginGhostComm(); CHKERRQ(ierr);
+    ierr = endGhostComm(); CHKERRQ(ierr);
+  }
+
+  return 0;
+}
+
+//! Writes an IceModelVec3D to a NetCDF file, skipping unused levels.
+PetscErrorCode IceModelVec3D::write(string filename, PISM_IO_Type nctype) {
+  PetscErrorCode ierr;
+
+  if (capacity == n_levels)
+    return IceModelVec::write(filename, nctype);
+
+  DM da_packed;
+  Vec g;
+  ierr = grid->get_dm(n_levels, da_stencil_width, da_packed); CHKERRQ(ierr);
+  ierr = DMCreateGlobalVector(da_packed, &g); CHKERRQ(ierr);
+
+  ierr = pack_levels(g); CHKERRQ(ierr);
+
+  vars[0].time_independent = time_independent;
+  ierr = vars[0].write(filename, nctype, write_in_glaciological_units, g); CHKERRQ(ierr);
+
+  ierr = VecDestroy(&g); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! Reads an IceModelVec3D from a NetCDF file (see IceModelVec::read()).
+PetscErrorCode IceModelVec3D::read(string filename, unsigned int time) {
+  PetscErrorCode ierr;
+
+  if (capacity == n_levels)
+    return IceModelVec::read(filename, time);
+
+  if (getVerbosityLevel() > 3) {
+    ierr = PetscPrintf(grid->com, "  Reading %s...\n", name.c_str()); CHKERRQ(ierr);
+  }
+
+  DM da_packed;
+  Vec g;
+  ierr = grid->get_dm(n_levels, da_stencil_width, da_packed); CHKERRQ(ierr);
+  ierr = DMCreateGlobalVector(da_packed, &g); CHKERRQ(ierr);
+
+  ierr = vars[0].read(filename, time, g); CHKERRQ(ierr);
+  ierr = unpack_levels(g); CHKERRQ(ierr);
+
+  ierr = VecDestroy(&g); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! Regrids an IceModelVec3D (see IceModelVec::regrid(string, bool, int)).
+PetscErrorCode IceModelVec3D::regrid(string filename, bool critical, int start) {
+  PetscErrorCode ierr;
+
+  if (capacity == n_levels)
+    return IceModelVec::regrid(filename, critical, start);
+
+  LocalInterpCtx *lic = NULL;
+  ierr = get_interp_context(filename, lic); CHKERRQ(ierr);
+
+  if (lic != NULL) {
+    lic->start[0] = start;
+    lic->report_range = report_range;
+  }
+
+  DM da_packed;
+  Vec g;
+  ierr = grid->get_dm(n_levels, da_stencil_width, da_packed); CHKERRQ(ierr);
+  ierr = DMCreateGlobalVector(da_packed, &g); CHKERRQ(ierr);
+
+  ierr = vars[0].regrid(filename, lic, critical, false, 0.0, g); CHKERRQ(ierr);
+  ierr = unpack_levels(g); CHKERRQ(ierr);
+
+  ierr = VecDestroy(&g); CHKERRQ(ierr);
+
+  delete lic;
+
+  return 0;
+}
+
+//! Regrids an IceModelVec3D (see IceModelVec::regrid(string, PetscScalar)).
+PetscErrorCode IceModelVec3D::regrid(string filename, PetscScalar default_value) {
+  PetscErrorCode ierr;
+
+  if (capacity == n_levels)
+    return IceModelVec::regrid(filename, default_value);
+
+  LocalInterpCtx *lic = NULL;
+  ierr = get_interp_context(filename, lic); CHKERRQ(ierr);
+
+  if (lic != NULL) {
+    lic->report_range = report_range;
+  }
+
+  DM da_packed;
+  Vec g;
+  ierr = grid->get_dm(n_levels, da_stencil_width, da_packed); CHKERRQ(ierr);
+  ierr = DMCreateGlobalVector(da_packed, &g); CHKERRQ(ierr);
+
+  ierr = vars[0].regrid(filename, lic, false, true, default_value, g); CHKERRQ(ierr);
+  ierr = unpack_levels(g); CHKERRQ(ierr);
+
+  ierr = VecDestroy(&g); CHKERRQ(ierr);
+
+  delete lic;
+
+  return 0;
+}
+
+//! Result: min <- min(v[j]), max <- max(v[j]), over the levels in use.
+PetscErrorCode IceModelVec3D::range(PetscReal &min, PetscReal &max) {
+  PetscErrorCode ierr;
+
+  if (capacity == n_levels)
+    return IceModelVec::range(min, max);
+
+  PetscReal my_min = 1.0e300, my_max = -1.0e300;
+  ierr = begin_read_access(); CHKERRQ(ierr);
+  PetscScalar ***arr = (PetscScalar***) array;
+  for (PetscInt i = grid->xs; i < grid->xs + grid->xm; ++i) {
+    for (PetscInt j = grid->ys; j < grid->ys + grid->ym; ++j) {
+      for (PetscInt k = 0; k < n_levels; ++k) {
+        my_min = PetscMin(my_min, arr[i][j][k]);
+        my_max = PetscMax(my_max, arr[i][j][k]);
+      }
+    }
+  }
+  ierr = end_access(); CHKERRQ(ierr);
+
+  ierr = PISMGlobalMin(&my_min, &min, grid->com); CHKERRQ(ierr);
+  ierr = PISMGlobalMax(&my_max, &max, grid->com); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! Computes the norm of an IceModelVec3D over the levels in use.
+PetscErrorCode IceModelVec3D::norm(NormType n, PetscReal &out) {
+  PetscErrorCode ierr;
+
+  if (capacity == n_levels)
+    return IceModelVec::norm(n, out);
+
+  if (n != NORM_1 && n != NORM_2 && n != NORM_INFINITY) {
+    SETERRQ1(grid->com, 2, "IceModelVec3D::norm(...): NormType not supported (called as %s.norm(...))\n",
+             name.c_str());
+  }
+
+  PetscReal my_norm = 0.0;
+  ierr = begin_read_access(); CHKERRQ(ierr);
+  PetscScalar ***arr = (PetscScalar***) array;
+  for (PetscInt i = grid->xs; i < grid->xs + grid->xm; ++i) {
+    for (PetscInt j = grid->ys; j < grid->ys + grid->ym; ++j) {
+      for (PetscInt k = 0; k < n_levels; ++k) {
+        const PetscReal a = PetscAbs(arr[i][j][k]);
+        if (n == NORM_1)
+          my_norm += a;
+        else if (n == NORM_2)
+          my_norm += a * a;
+        else
+          my_norm = PetscMax(my_norm, a);
+      }
+    }
+  }
+  ierr = end_access(); CHKERRQ(ierr);
+
+  if (n == NORM_INFINITY) {
+    ierr = PISMGlobalMax(&my_norm, &out, grid->com); CHKERRQ(ierr);
+  } else {
+    ierr = PISMGlobalSum(&my_norm, &out, grid->com); CHKERRQ(ierr);
+    if (n == NORM_2)
+      out = sqrt(out);
+  }
+
   return 0;
 }
 
@@ -122,6 +406,8 @@ PetscErrorCode  IceModelVec3D::begin_access() {
 
   access_counter++;
 
+  ghost_state->valid = false;
+
   return 0;
 }
 
@@ -175,6 +461,126 @@ PetscErrorCode  IceModelVec3D::endGhostCommTransfer(IceModelVec3D &imv3_source)
   ierr = checkAllocated(); CHKERRQ(ierr);
   ierr = imv3_source.checkAllocated(); CHKERRQ(ierr);
   ierr = DMGlobalToLocalEnd(da, imv3_source.v, INSERT_VALUES, v); CHKERRQ(ierr);
+  ghost_state->valid = (access_counter == 0);
+  grid->ghost_updates++;
+  return 0;
+}
+
+//! \brief Starts the communication of ghost points, sending only the bottom
+//! levels of each column.
+/*!
+ * Works like beginGhostCommTransfer(IceModelVec3D&), but assumes that values
+ * in every column are constant above the level `levels_needed - 1` on this
+ * processor. Processors agree on the number of levels to send (the maximum
+ * over all of them, rounded up to reduce the number of times storage has to
+ * be re-allocated), and ghost columns are filled above it using the value at
+ * the top level received.
+ *
+ * Has to be followed by endGhostCommTransfer(imv3_source, levels_needed).
+ */
+PetscErrorCode IceModelVec3D::beginGhostCommTransfer(IceModelVec3D &imv3_source,
+                                                     PetscInt levels_needed) {
+  PetscErrorCode ierr;
+  // round the number of levels up to a multiple of this to avoid
+  // re-creating the DA every time the ice gets thicker by a level
+  const PetscInt level_chunk = 8;
+
+  if (!localp) {
+    SETERRQ1(grid->com, 1,"makes no sense to communicate ghosts for GLOBAL IceModelVec3!\n"
+               "  (has name='%s')\n", name.c_str());
+  }
+  if (imv3_source.localp) {
+    SETERRQ1(grid->com, 2,"source IceModelVec3 must be GLOBAL! (has name='%s')\n",
+               imv3_source.name.c_str());
+  }
+  ierr = checkAllocated(); CHKERRQ(ierr);
+  ierr = imv3_source.checkAllocated(); CHKERRQ(ierr);
+
+  PetscScalar my_levels = levels_needed, levels;
+  ierr = PISMGlobalMax(&my_levels, &levels, grid->com); CHKERRQ(ierr);
+
+  PetscInt n_comm = level_chunk * ((static_cast<PetscInt>(levels) + level_chunk - 1) / level_chunk);
+  n_comm = PetscMax(1, PetscMin(n_comm, n_levels));
+
+  if (n_comm == n_levels) {
+    // nothing to save; communicate all the levels
+    level_comm->reduced = false;
+    ierr = beginGhostCommTransfer(imv3_source); CHKERRQ(ierr);
+    return 0;
+  }
+  level_comm->reduced = true;
+
+  if (level_comm->dof != n_comm) {
+    ierr = destroy_level_comm(); CHKERRQ(ierr);
+    ierr = create_2d_da(level_comm->da, n_comm, da_stencil_width); CHKERRQ(ierr);
+    ierr = DMCreateGlobalVector(level_comm->da, &level_comm->global); CHKERRQ(ierr);
+    ierr = DMCreateLocalVector(level_comm->da, &level_comm->local); CHKERRQ(ierr);
+    level_comm->dof = n_comm;
+  }
+
+  PetscScalar ***buffer;
+  ierr = DMDAVecGetArrayDOF(level_comm->da, level_comm->global, &buffer); CHKERRQ(ierr);
+  ierr = imv3_source.begin_access(); CHKERRQ(ierr);
+  PetscScalar ***source = (PetscScalar***) imv3_source.array;
+  for (PetscInt i = grid->xs; i < grid->xs + grid->xm; ++i) {
+    for (PetscInt j = grid->ys; j < grid->ys + grid->ym; ++j) {
+      ierr = PetscMemcpy(buffer[i][j], source[i][j], n_comm * sizeof(PetscScalar)); CHKERRQ(ierr);
+    }
+  }
+  ierr = imv3_source.end_access(); CHKERRQ(ierr);
+  ierr = DMDAVecRestoreArrayDOF(level_comm->da, level_comm->global, &buffer); CHKERRQ(ierr);
+
+  ierr = DMGlobalToLocalBegin(level_comm->da, level_comm->global,
+                              INSERT_VALUES, level_comm->local); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! \brief Ends the communication started by
+//! beginGhostCommTransfer(IceModelVec3D&, PetscInt).
+PetscErrorCode IceModelVec3D::endGhostCommTransfer(IceModelVec3D &imv3_source,
+                                                   PetscInt /*levels_needed*/) {
+  PetscErrorCode ierr;
+
+  if (level_comm->reduced == false) {
+    ierr = endGhostCommTransfer(imv3_source); CHKERRQ(ierr);
+    return 0;
+  }
+
+  ierr = DMGlobalToLocalEnd(level_comm->da, level_comm->global,
+                            INSERT_VALUES, level_comm->local); CHKERRQ(ierr);
+
+  const PetscInt n_comm = level_comm->dof,
+    xs = grid->xs, xm = grid->xm, ys = grid->ys, ym = grid->ym,
+    w = da_stencil_width;
+  PetscScalar ***buffer;
+  ierr = DMDAVecGetArrayDOF(level_comm->da, level_comm->local, &buffer); CHKERRQ(ierr);
+  ierr = imv3_source.begin_access(); CHKERRQ(ierr);
+  ierr = begin_access(); CHKERRQ(ierr);
+  PetscScalar ***source = (PetscScalar***) imv3_source.array,
+    ***result = (PetscScalar***) array;
+  for (PetscInt i = xs - w; i < xs + xm + w; ++i) {
+    for (PetscInt j = ys - w; j < ys + ym + w; ++j) {
+      if (i >= xs && i < xs + xm && j >= ys && j < ys + ym) {
+        // owned column: copy all the levels
+        ierr = PetscMemcpy(result[i][j], source[i][j], n_levels * sizeof(PetscScalar)); CHKERRQ(ierr);
+        continue;
+      }
+
+      // ghost column: levels received, then the constant above
+      ierr = PetscMemcpy(result[i][j], buffer[i][j], n_comm * sizeof(PetscScalar)); CHKERRQ(ierr);
+      for (PetscInt k = n_comm; k < n_levels; ++k)
+        result[i][j][k] = buffer[i][j][n_comm - 1];
+    }
+  }
+  ierr = end_access(); CHKERRQ(ierr);
+  ierr = imv3_source.end_access(); CHKERRQ(ierr);
+  ierr = DMDAVecRestoreArrayDOF(level_comm->da, level_comm->local, &buffer); CHKERRQ(ierr);
+
+  level_comm->reduced = false;
+  ghost_state->valid = (access_counter == 0);
+  grid->ghost_updates++;
+
   return 0;
 }
 
@@ -233,6 +639,32 @@ PetscErrorCode IceModelVec3D::setColumn(PetscInt i, PetscInt j, PetscScalar c) {
 }
 
 
+//! \brief Returns the index `k` of the level such that `zlevels[k] < z <=
+//! zlevels[k+1]`, for `z` strictly between the bottom and the top levels.
+PetscInt IceModelVec3D::level_below(PetscScalar z) const {
+  if (uses_grid_levels)
+    return grid->level_below(z);
+
+  PetscInt mcurr = 0;
+  while (zlevels[mcurr+1] < z) mcurr++;
+  return mcurr;
+}
+
+//! \brief Returns the value in a column (in the storage of this IceModelVec)
+//! at the level z, using linear interpolation.
+PetscScalar IceModelVec3D::interpolate_column(const PetscScalar *column, PetscScalar z) const {
+  if (z >= zlevels.back())
+    return column[n_levels - 1];
+  else if (z <= zlevels.front())
+    return column[0];
+
+  const PetscInt mcurr = level_below(z);
+
+  const PetscScalar incr = (z - zlevels[mcurr]) / (zlevels[mcurr+1] - zlevels[mcurr]);
+  const PetscScalar valm = column[mcurr];
+  return valm + incr * (column[mcurr+1] - valm);
+}
+
 //! Return value of scalar quantity at level z (m) above base of ice (by linear interpolation).
 PetscScalar IceModelVec3D::getValZ(PetscInt i, PetscInt j, PetscScalar z) {
 #if (PISM_DEBUG==1)
@@ -253,17 +685,7 @@ PetscScalar IceModelVec3D::getValZ(PetscInt i, PetscInt j, PetscScalar z) {
 #endif
 
   PetscScalar ***arr = (PetscScalar***) array;
-  if (z >= zlevels.back())
-    return arr[i][j][n_levels - 1];
-  else if (z <= zlevels.front())
-    return arr[i][j][0];
-
-  PetscInt mcurr = 0;
-  while (zlevels[mcurr+1] < z) mcurr++;
-
-  const PetscScalar incr = (z - zlevels[mcurr]) / (zlevels[mcurr+1] - zlevels[mcurr]);
-  const PetscScalar valm = arr[i][j][mcurr];
-  return valm + incr * (arr[i][j][mcurr+1] - valm);
+  return interpolate_column(arr[i][j], z);
 }
 
 
@@ -291,9 +713,7 @@ PetscErrorCode   IceModelVec3::getPlaneStarZ(PetscInt i, PetscInt j, PetscScalar
     kbz = 0;
     incr = 0.0;
   } else {
-    kbz = 0;
-    while (zlevels[kbz+1] < z)
-      kbz++;
+    kbz = level_below(z);
 
     incr = (z - zlevels[kbz]) / (zlevels[kbz+1] - zlevels[kbz]);
   }
@@ -478,15 +898,9 @@ PetscErrorCode  IceModelVec3::getHorSlice(Vec &gslice, PetscScalar z) {
   PetscErrorCode ierr;
   PetscScalar    **slice_val;
 
-  ierr = begin_access(); CHKERRQ(ierr);
   ierr = DMDAVecGetArray(grid->da2, gslice, &slice_val); CHKERRQ(ierr);
-  for (PetscInt i=grid->xs; i<grid->xs+grid->xm; i++) {
-    for (PetscInt j=grid->ys; j<grid->ys+grid->ym; j++) {
-      slice_val[i][j] = getValZ(i,j,z);
-    }
-  }
+  ierr = getHorSlice(slice_val, z); CHKERRQ(ierr);
   ierr = DMDAVecRestoreArray(grid->da2, gslice, &slice_val); CHKERRQ(ierr);
-  ierr = end_access(); CHKERRQ(ierr);
 
   return 0;
 }
@@ -500,14 +914,42 @@ PetscErrorCode  IceModelVec3::getHorSlice(IceModelVec2S &gslice, PetscScalar z)
   PetscErrorCode ierr;
   PetscScalar    **slice_val;
 
-  ierr = begin_access(); CHKERRQ(ierr);
   ierr = gslice.get_array(slice_val); CHKERRQ(ierr);
+  ierr = getHorSlice(slice_val, z); CHKERRQ(ierr);
+  ierr = gslice.end_access(); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! \brief Copies a horizontal slice at level z into a 2D array (indexed
+//! using grid->xs, etc).
+/*!
+ * The interval containing `z` and the interpolation weight are the same in
+ * all columns, so they are computed once.
+ */
+PetscErrorCode  IceModelVec3::getHorSlice(PetscScalar **slice_val, PetscScalar z) {
+  PetscErrorCode ierr;
+
+  PetscInt k = 0;
+  PetscScalar incr = 0.0;
+  if (z >= zlevels.back()) {
+    k = n_levels - 1;
+  } else if (z > zlevels.front()) {
+    k = level_below(z);
+    incr = (z - zlevels[k]) / (zlevels[k+1] - zlevels[k]);
+  }
+
+  ierr = begin_read_access(); CHKERRQ(ierr);
+  PetscScalar ***arr = (PetscScalar***) array;
   for (PetscInt i=grid->xs; i<grid->xs+grid->xm; i++) {
     for (PetscInt j=grid->ys; j<grid->ys+grid->ym; j++) {
-      slice_val[i][j] = getValZ(i,j,z);
+      const PetscScalar *column = arr[i][j];
+      if (k < n_levels - 1)
+        slice_val[i][j] = column[k] + incr * (column[k+1] - column[k]);
+      else
+        slice_val[i][j] = column[k];
     }
   }
-  ierr = gslice.end_access(); CHKERRQ(ierr);
   ierr = end_access(); CHKERRQ(ierr);
 
   return 0;
@@ -531,17 +973,11 @@ PetscErrorCode  IceModelVec3::getSurfaceValues(IceModelVec2S &gsurf, IceModelVec
 PetscErrorCode  IceModelVec3::getSurfaceValues(Vec &gsurf, IceModelVec2S &myH) {
   PetscErrorCode ierr;
   PetscScalar    **H, **surf_val;
-  ierr = begin_access(); CHKERRQ(ierr);
   ierr = DMDAVecGetArray(grid->da2, gsurf, &surf_val); CHKERRQ(ierr);
   ierr = myH.get_array(H); CHKERRQ(ierr);
-  for (PetscInt i=grid->xs; i<grid->xs+grid->xm; i++) {
-    for (PetscInt j=grid->ys; j<grid->ys+grid->ym; j++) {
-      surf_val[i][j] = getValZ(i,j,H[i][j]);
-    }
-  }
+  ierr = getSurfaceValues(surf_val, H); CHKERRQ(ierr);
   ierr = myH.end_access(); CHKERRQ(ierr);
   ierr = DMDAVecRestoreArray(grid->da2, gsurf, &surf_val); CHKERRQ(ierr);
-  ierr = end_access(); CHKERRQ(ierr);
   return 0;
 }
 
@@ -550,14 +986,29 @@ PetscErrorCode  IceModelVec3::getSurfaceValues(IceModelVec2S &gsurf, PetscScalar
   PetscErrorCode ierr;
   PetscScalar    **surf_val;
 
-  ierr = begin_access(); CHKERRQ(ierr);
   ierr = gsurf.get_array(surf_val); CHKERRQ(ierr);
+  ierr = getSurfaceValues(surf_val, H); CHKERRQ(ierr);
+  ierr = gsurf.end_access(); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! \brief Computes values at heights H[i][j] in all the owned columns,
+//! storing them in surf_val (which may be the same array as H).
+/*!
+ * Uses the level lookup of the grid (see IceGrid::level_below()) instead of
+ * calling getValZ() at every point.
+ */
+PetscErrorCode  IceModelVec3::getSurfaceValues(PetscScalar **surf_val, PetscScalar **H) {
+  PetscErrorCode ierr;
+
+  ierr = begin_read_access(); CHKERRQ(ierr);
+  PetscScalar ***arr = (PetscScalar***) array;
   for (PetscInt i=grid->xs; i<grid->xs+grid->xm; i++) {
     for (PetscInt j=grid->ys; j<grid->ys+grid->ym; j++) {
-      surf_val[i][j] = getValZ(i,j,H[i][j]);
+      surf_val[i][j] = interpolate_column(arr[i][j], H[i][j]);
     }
   }
-  ierr = gsurf.end_access(); CHKERRQ(ierr);
   ierr = end_access(); CHKERRQ(ierr);
 
   return 0;
@@ -654,6 +1105,10 @@ PetscErrorCode IceModelVec3::extend_vertically(int old_Mz, IceModelVec2S &fill_v
 }
 
 //! Handles the memory allocation/deallocation and copying. Does not fill the values of the new layer.
+/*!
+ * No memory is allocated (and nothing is copied) if the new levels fit in the
+ * room allocated for them (see IceModelVec3D::allocate()).
+ */
 PetscErrorCode IceModelVec3::extend_vertically_private(int old_Mz) {
   PetscErrorCode ierr;
   Vec v_new;
@@ -663,10 +1118,25 @@ PetscErrorCode IceModelVec3::extend_vertically_private(int old_Mz) {
 
   zlevels = grid->zlevels;
   n_levels = (int)zlevels.size();
+  uses_grid_levels = true;
   for (int i = 0; i < dof; ++i)
     vars[0].set_levels(zlevels);
 
-  ierr = create_2d_da(da_new, n_levels, da_stencil_width); CHKERRQ(ierr);
+  // de-allocate the sounding buffer because we'll need a bigger one
+  if (sounding_buffer != PETSC_NULL) {
+    ierr = VecDestroy(&sounding_buffer); CHKERRQ(ierr);
+    sounding_buffer = PETSC_NULL;
+  }
+
+  if (n_levels <= capacity) {
+    // new levels are already allocated
+    ghost_state->valid = false;
+    return 0;
+  }
+
+  capacity = n_levels;
+
+  ierr = create_2d_da(da_new, capacity, da_stencil_width); CHKERRQ(ierr);
   
   if (localp) {
     ierr = DMCreateLocalVector(da_new, &v_new); CHKERRQ(ierr);
@@ -691,16 +1161,11 @@ PetscErrorCode IceModelVec3::extend_vertically_private(int old_Mz) {
   // Deallocate old DA and Vec:
   ierr = VecDestroy(&v); CHKERRQ(ierr);
   v = v_new;
+  ghost_state->valid = false;
 
   ierr = DMDestroy(&da); CHKERRQ(ierr);
   da = da_new;
 
-  // de-allocate the sounding buffer because we'll need a bigger one
-  if (sounding_buffer != NULL) {
-    ierr = VecDestroy(&sounding_buffer); CHKERRQ(ierr);
-    sounding_buffer = PETSC_NULL;
-  }
-
   return 0;
 }
 
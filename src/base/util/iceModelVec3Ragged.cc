@@ -0,0 +1,418 @@
+// Copyright (C) 2012 PISM Authors
+//
+// This file is part of PISM.
+//
+// PISM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 2 of the License, or (at your option) any later
+// version.
+//
+// PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License
+// along with PISM; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include "iceModelVec3Ragged.hh"
+#include "IceGrid.hh"
+
+IceModelVec3Ragged::IceModelVec3Ragged() {
+  grid = NULL;
+  width = 1;
+  layout_xs = layout_xm = layout_ys = layout_ym = 0;
+  v = PETSC_NULL;
+  v_local = PETSC_NULL;
+  array = NULL;
+  access_counter = 0;
+  n_owned = n_local = 0;
+}
+
+IceModelVec3Ragged::~IceModelVec3Ragged() {
+  destroy();
+}
+
+PetscErrorCode IceModelVec3Ragged::destroy() {
+  PetscErrorCode ierr;
+
+  if (v != PETSC_NULL) {
+    ierr = VecDestroy(&v); CHKERRQ(ierr);
+    v = PETSC_NULL;
+  }
+
+  return 0;
+}
+
+//! \brief Allocate storage; every column stores one level (set to zero).
+PetscErrorCode IceModelVec3Ragged::create(IceGrid &my_grid, string my_name, int stencil_width) {
+  PetscErrorCode ierr;
+
+  if (v != PETSC_NULL)
+    SETERRQ1(my_grid.com, 1, "IceModelVec3Ragged with name='%s' already allocated\n", my_name.c_str());
+
+  grid  = &my_grid;
+  name  = my_name;
+  width = stencil_width;
+
+  ierr = column_capacity.create(my_grid, my_name + "_capacity", true, width); CHKERRQ(ierr);
+  ierr = column_offset.create(my_grid, my_name + "_offset", true, width); CHKERRQ(ierr);
+
+  ierr = column_capacity.set(1.0); CHKERRQ(ierr);
+  ierr = set_layout(false); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! \brief Change column lengths to store levels up to the surface of ice of
+//! thickness `thickness` plus `margin` levels above.
+/*!
+ * If `staggered` is true, the column (i,j) is sized using the maximum
+ * thickness at (i,j), (i+1,j) and (i,j+1), i.e. so that it can store
+ * quantities at staggered grid points (i+1/2,j) and (i,j+1/2). Then ghosts of
+ * `thickness` have to be up to date.
+ *
+ * If `preserve_values` is true, values in levels stored both before and
+ * after the call are preserved, unless the grid was re-partitioned since the
+ * last call. All values are set to zero otherwise.
+ *
+ * Storage (and the ghost scatter) is re-created only if some column length
+ * changes; otherwise the current layout is kept.
+ */
+PetscErrorCode IceModelVec3Ragged::reshape(IceModelVec2S &thickness, int margin, bool staggered,
+                                           bool preserve_values) {
+  PetscErrorCode ierr;
+
+  if (access_counter != 0)
+    SETERRQ1(grid->com, 1, "IceModelVec3Ragged::reshape(): %s is being accessed", name.c_str());
+
+  // the current layout can be re-used if the grid was not re-partitioned and
+  // no column changes its length (on any processor)
+  int changed = (v == PETSC_NULL ||
+                 layout_xs != grid->xs || layout_xm != grid->xm ||
+                 layout_ys != grid->ys || layout_ym != grid->ym);
+
+  ierr = thickness.begin_access(); CHKERRQ(ierr);
+  ierr = column_capacity.begin_access(); CHKERRQ(ierr);
+  for (PetscInt i = grid->xs; i < grid->xs + grid->xm; ++i) {
+    for (PetscInt j = grid->ys; j < grid->ys + grid->ym; ++j) {
+      PetscScalar H = thickness(i, j);
+      if (staggered)
+        H = PetscMax(H, PetscMax(thickness(i + 1, j), thickness(i, j + 1)));
+
+      const PetscInt n = PetscMin(grid->Mz, grid->kBelowHeight(PetscMax(H, 0.0)) + 1 + margin);
+      column_capacity(i, j) = n;
+
+      if (changed == 0 && n != capacity[column(i, j)])
+        changed = 1;
+    }
+  }
+  ierr = column_capacity.end_access(); CHKERRQ(ierr);
+  ierr = thickness.end_access(); CHKERRQ(ierr);
+
+  int changed_global = 1;
+  ierr = MPI_Allreduce(&changed, &changed_global, 1, MPI_INT, MPI_MAX, grid->com); CHKERRQ(ierr);
+
+  if (changed_global == 0) {
+    if (preserve_values == false) {
+      ierr = set(0.0); CHKERRQ(ierr);
+    }
+    return 0;
+  }
+
+  ierr = set_layout(preserve_values); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! \brief Re-allocate storage after the grid was re-partitioned.
+/*!
+ * Stored values are lost: every column stores one level (set to zero) until
+ * the next call to reshape().
+ */
+PetscErrorCode IceModelVec3Ragged::redistribute() {
+  PetscErrorCode ierr;
+
+  if (access_counter != 0)
+    SETERRQ1(grid->com, 1, "IceModelVec3Ragged::redistribute(): %s is being accessed", name.c_str());
+
+  ierr = column_capacity.set(1.0); CHKERRQ(ierr);
+  ierr = set_layout(false); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! \brief Re-allocate storage using column lengths in `column_capacity`
+//! (owned values only).
+PetscErrorCode IceModelVec3Ragged::set_layout(bool preserve_values) {
+  PetscErrorCode ierr;
+
+  preserve_values = preserve_values && v != PETSC_NULL &&
+    layout_xs == grid->xs && layout_xm == grid->xm &&
+    layout_ys == grid->ys && layout_ym == grid->ym;
+
+  Vec v_old = v;
+  vector<PetscInt> capacity_old = capacity, offset_old = offset;
+
+  layout_xs = grid->xs;
+  layout_xm = grid->xm;
+  layout_ys = grid->ys;
+  layout_ym = grid->ym;
+
+  ierr = column_capacity.beginGhostComm(); CHKERRQ(ierr);
+  ierr = column_capacity.endGhostComm(); CHKERRQ(ierr);
+
+  // global offsets of owned columns
+  n_owned = 0;
+  ierr = column_capacity.begin_access(); CHKERRQ(ierr);
+  for (PetscInt i = grid->xs; i < grid->xs + grid->xm; ++i)
+    for (PetscInt j = grid->ys; j < grid->ys + grid->ym; ++j)
+      n_owned += static_cast<PetscInt>(column_capacity(i, j));
+
+  PetscInt owned_end = 0;
+  ierr = MPI_Scan(&n_owned, &owned_end, 1, MPIU_INT, MPI_SUM, grid->com); CHKERRQ(ierr);
+
+  ierr = column_offset.begin_access(); CHKERRQ(ierr);
+  PetscInt global_offset = owned_end - n_owned;
+  for (PetscInt i = grid->xs; i < grid->xs + grid->xm; ++i) {
+    for (PetscInt j = grid->ys; j < grid->ys + grid->ym; ++j) {
+      column_offset(i, j) = global_offset;
+      global_offset += static_cast<PetscInt>(column_capacity(i, j));
+    }
+  }
+  ierr = column_offset.end_access(); CHKERRQ(ierr);
+
+  ierr = column_offset.beginGhostComm(); CHKERRQ(ierr);
+  ierr = column_offset.endGhostComm(); CHKERRQ(ierr);
+
+  // local layout: owned columns first, then ghosts
+  const int n_columns = (grid->xm + 2 * width) * (grid->ym + 2 * width);
+  capacity.resize(n_columns);
+  offset.resize(n_columns);
+
+  vector<PetscInt> ghosts;
+  n_local = 0;
+
+  ierr = column_offset.begin_access(); CHKERRQ(ierr);
+  for (PetscInt i = grid->xs; i < grid->xs + grid->xm; ++i) {
+    for (PetscInt j = grid->ys; j < grid->ys + grid->ym; ++j) {
+      const int c = column(i, j);
+      capacity[c] = static_cast<PetscInt>(column_capacity(i, j));
+      offset[c]   = n_local;
+      n_local += capacity[c];
+    }
+  }
+
+  for (PetscInt i = grid->xs - width; i < grid->xs + grid->xm + width; ++i) {
+    for (PetscInt j = grid->ys - width; j < grid->ys + grid->ym + width; ++j) {
+      if (i >= grid->xs && i < grid->xs + grid->xm &&
+          j >= grid->ys && j < grid->ys + grid->ym)
+        continue;               // owned column
+
+      const int c = column(i, j);
+      const PetscInt start = static_cast<PetscInt>(column_offset(i, j));
+      capacity[c] = static_cast<PetscInt>(column_capacity(i, j));
+      offset[c]   = n_local;
+      n_local += capacity[c];
+
+      for (PetscInt k = 0; k < capacity[c]; ++k)
+        ghosts.push_back(start + k);
+    }
+  }
+  ierr = column_offset.end_access(); CHKERRQ(ierr);
+  ierr = column_capacity.end_access(); CHKERRQ(ierr);
+
+  ierr = VecCreateGhost(grid->com, n_owned, PETSC_DECIDE,
+                        ghosts.size(), ghosts.empty() ? PETSC_NULL : &ghosts[0],
+                        &v); CHKERRQ(ierr);
+
+  if (preserve_values) {
+    Vec old_local;
+    PetscScalar *old_array;
+
+    ierr = VecGhostGetLocalForm(v_old, &old_local); CHKERRQ(ierr);
+    ierr = VecGetArray(old_local, &old_array); CHKERRQ(ierr);
+    ierr = begin_access(); CHKERRQ(ierr);
+    for (PetscInt i = grid->xs; i < grid->xs + grid->xm; ++i) {
+      for (PetscInt j = grid->ys; j < grid->ys + grid->ym; ++j) {
+        const int c = column(i, j);
+        for (PetscInt k = 0; k < capacity[c]; ++k)
+          array[offset[c] + k] = old_array[offset_old[c] + PetscMin(k, capacity_old[c] - 1)];
+      }
+    }
+    ierr = end_access(); CHKERRQ(ierr);
+    ierr = VecRestoreArray(old_local, &old_array); CHKERRQ(ierr);
+    ierr = VecGhostRestoreLocalForm(v_old, &old_local); CHKERRQ(ierr);
+
+    ierr = update_ghosts(); CHKERRQ(ierr);
+  } else {
+    ierr = set(0.0); CHKERRQ(ierr);
+  }
+
+  if (v_old != PETSC_NULL) {
+    ierr = VecDestroy(&v_old); CHKERRQ(ierr);
+  }
+
+  return 0;
+}
+
+PetscErrorCode IceModelVec3Ragged::begin_access() {
+  PetscErrorCode ierr;
+
+  if (access_counter == 0) {
+    ierr = VecGhostGetLocalForm(v, &v_local); CHKERRQ(ierr);
+    ierr = VecGetArray(v_local, &array); CHKERRQ(ierr);
+  }
+  access_counter++;
+
+  return 0;
+}
+
+PetscErrorCode IceModelVec3Ragged::end_access() {
+  PetscErrorCode ierr;
+
+  access_counter--;
+  if (access_counter < 0)
+    SETERRQ1(grid->com, 1, "IceModelVec3Ragged::end_access(): access_counter < 0 (%s)", name.c_str());
+
+  if (access_counter == 0) {
+    ierr = VecRestoreArray(v_local, &array); CHKERRQ(ierr);
+    ierr = VecGhostRestoreLocalForm(v, &v_local); CHKERRQ(ierr);
+    array = NULL;
+  }
+
+  return 0;
+}
+
+//! Update values in ghost columns.
+PetscErrorCode IceModelVec3Ragged::update_ghosts() {
+  PetscErrorCode ierr;
+
+  if (access_counter != 0)
+    SETERRQ1(grid->com, 1, "IceModelVec3Ragged::update_ghosts(): %s is being accessed", name.c_str());
+
+  ierr = VecGhostUpdateBegin(v, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+  ierr = VecGhostUpdateEnd(v, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! Set all the stored values (including ghosts) to `c`.
+PetscErrorCode IceModelVec3Ragged::set(PetscScalar c) {
+  PetscErrorCode ierr;
+  Vec local;
+
+  ierr = VecGhostGetLocalForm(v, &local); CHKERRQ(ierr);
+  ierr = VecSet(local, c); CHKERRQ(ierr);
+  ierr = VecGhostRestoreLocalForm(v, &local); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! \brief Copy values from a dense field; levels above the ones stored in
+//! this field are ignored.
+PetscErrorCode IceModelVec3Ragged::copy_from(IceModelVec3 &source) {
+  PetscErrorCode ierr;
+  PetscScalar *src, *dst;
+  PetscInt n;
+
+  ierr = source.begin_access(); CHKERRQ(ierr);
+  ierr = begin_access(); CHKERRQ(ierr);
+  for (PetscInt i = grid->xs; i < grid->xs + grid->xm; ++i) {
+    for (PetscInt j = grid->ys; j < grid->ys + grid->ym; ++j) {
+      ierr = source.getInternalColumn(i, j, &src); CHKERRQ(ierr);
+      ierr = getInternalColumn(i, j, &dst, n); CHKERRQ(ierr);
+      for (PetscInt k = 0; k < n; ++k)
+        dst[k] = src[k];
+    }
+  }
+  ierr = end_access(); CHKERRQ(ierr);
+  ierr = source.end_access(); CHKERRQ(ierr);
+
+  ierr = update_ghosts(); CHKERRQ(ierr);
+
+  return 0;
+}
+
+//! \brief Copy values to a dense field, filling levels above the stored ones
+//! with the value at the top stored level. Updates ghosts of `destination`.
+PetscErrorCode IceModelVec3Ragged::copy_to(IceModelVec3 &destination) {
+  PetscErrorCode ierr;
+  PetscScalar *dst;
+
+  ierr = destination.begin_access(); CHKERRQ(ierr);
+  ierr = begin_access(); CHKERRQ(ierr);
+  for (PetscInt i = grid->xs; i < grid->xs + grid->xm; ++i) {
+    for (PetscInt j = grid->ys; j < grid->ys + grid->ym; ++j) {
+      ierr = destination.getInternalColumn(i, j, &dst); CHKERRQ(ierr);
+      for (PetscInt k = 0; k < grid->Mz; ++k)
+        dst[k] = (*this)(i, j, k);
+    }
+  }
+  ierr = end_access(); CHKERRQ(ierr);
+  ierr = destination.end_access(); CHKERRQ(ierr);
+
+  if (destination.has_ghosts()) {
+    ierr = destination.beginGhostComm(); CHKERRQ(ierr);
+    ierr = destination.endGhostComm(); CHKERRQ(ierr);
+  }
+
+  return 0;
+}
+
+//! \brief Get a pointer to the stored levels of the column (i,j) and the
+//! number `n` of these levels.
+PetscErrorCode IceModelVec3Ragged::getInternalColumn(PetscInt i, PetscInt j,
+                                                     PetscScalar **values, PetscInt &n) {
+  const int c = column(i, j);
+  *values = &array[offset[c]];
+  n = capacity[c];
+  return 0;
+}
+
+//! \brief Set stored levels of the column (i,j) from `values`, an array of
+//! (at least) n_stored(i,j) numbers.
+PetscErrorCode IceModelVec3Ragged::setInternalColumn(PetscInt i, PetscInt j,
+                                                     const PetscScalar *values) {
+  const int c = column(i, j);
+  PetscScalar *column_values = &array[offset[c]];
+  for (PetscInt k = 0; k < capacity[c]; ++k)
+    column_values[k] = values[k];
+  return 0;
+}
+
+PetscErrorCode IceModelVec3Ragged::setColumn(PetscInt i, PetscInt j, PetscScalar value) {
+  const int c = column(i, j);
+  PetscScalar *column_values = &array[offset[c]];
+  for (PetscInt k = 0; k < capacity[c]; ++k)
+    column_values[k] = value;
+  return 0;
+}
+
+//! \brief Return values on the fine computational grid, using linear
+//! interpolation. Same as IceModelVec3::getValColumnPL().
+PetscErrorCode IceModelVec3Ragged::getValColumn(PetscInt i, PetscInt j, PetscInt ks,
+                                                PetscScalar *result) {
+  vector<double> &zlevels = grid->zlevels, &zlevels_fine = grid->zlevels_fine;
+
+  for (PetscInt k = 0; k < grid->Mz_fine; k++) {
+    const PetscInt m = grid->ice_storage2fine[k];
+
+    if (k > ks || m == grid->Mz - 1) {
+      result[k] = (*this)(i, j, m);
+      continue;
+    }
+
+    const PetscScalar incr = (zlevels_fine[k] - zlevels[m]) / (zlevels[m+1] - zlevels[m]);
+    const PetscScalar valm = (*this)(i, j, m);
+    result[k] = valm + incr * ((*this)(i, j, m + 1) - valm);
+  }
+
+  return 0;
+}
+
+//! Number of values (in owned and ghost columns) stored on this processor.
+PetscInt IceModelVec3Ragged::local_size() const {
+  return n_local;
+}
@@ -0,0 +1,114 @@
+// Copyright (C) 2012 PISM Authors
+//
+// This file is part of PISM.
+//
+// PISM is free software; you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 2 of the License, or (at your option) any later
+// version.
+//
+// PISM is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License
+// along with PISM; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#ifndef __IceModelVec3Ragged_hh
+#define __IceModelVec3Ragged_hh
+
+#include <vector>
+#include "iceModelVec.hh"
+
+//! \brief A 3D field storing only the levels up to the ice surface (plus a
+//! margin) in each column.
+/*!
+  IceModelVec3 stores all grid.Mz levels in every column, but in most columns
+  the ice occupies the bottom part of the computational box and all the
+  levels above the surface contain the same value. This class stores levels
+  0, ..., n_stored(i,j) - 1 of the column (i,j); values above are equal to
+  the value at the top stored level.
+
+  Column lengths are set by reshape() using the ice thickness. Levels of a
+  column are adjacent in memory. Owned columns are stored in a ghosted PETSc
+  Vec (in storage order), followed by ghost columns; update_ghosts() copies
+  values from processors owning ghost columns.
+
+  Use copy_from() and copy_to() to convert from and to IceModelVec3 (for
+  I/O, for example).
+
+  As with IceModelVec3, calls to accessors have to be surrounded by
+  begin_access() and end_access().
+ */
+class IceModelVec3Ragged {
+public:
+  IceModelVec3Ragged();
+  ~IceModelVec3Ragged();
+
+  PetscErrorCode create(IceGrid &grid, string name, int stencil_width = 1);
+  PetscErrorCode reshape(IceModelVec2S &thickness, int margin, bool staggered = false,
+                         bool preserve_values = true);
+  PetscErrorCode redistribute();
+
+  PetscErrorCode begin_access();
+  PetscErrorCode end_access();
+  PetscErrorCode update_ghosts();
+
+  PetscErrorCode set(PetscScalar c);
+  PetscErrorCode copy_from(IceModelVec3 &source);
+  PetscErrorCode copy_to(IceModelVec3 &destination);
+
+  PetscErrorCode getInternalColumn(PetscInt i, PetscInt j, PetscScalar **values, PetscInt &n);
+  PetscErrorCode setInternalColumn(PetscInt i, PetscInt j, const PetscScalar *values);
+  PetscErrorCode setColumn(PetscInt i, PetscInt j, PetscScalar c);
+  PetscErrorCode getValColumn(PetscInt i, PetscInt j, PetscInt ks, PetscScalar *result);
+
+  //! Number of levels stored in the column (i,j).
+  inline PetscInt n_stored(PetscInt i, PetscInt j) const {
+    return capacity[column(i, j)];
+  }
+
+  //! Value at the level k of the column (i,j), for any k between 0 and grid.Mz - 1.
+  inline PetscScalar operator()(PetscInt i, PetscInt j, PetscInt k) const {
+    const int c = column(i, j);
+    return array[offset[c] + PetscMin(k, capacity[c] - 1)];
+  }
+
+  PetscInt local_size() const;
+  string get_name() const { return name; }
+
+protected:
+  IceGrid *grid;
+  string name;
+  int width;                    //!< stencil width
+  int layout_xs, layout_xm, layout_ys, layout_ym; //!< decomposition used by the layout
+
+  Vec v;                        //!< owned values; ghosted
+  Vec v_local;                  //!< local form of v (owned and ghost values)
+  PetscScalar *array;           //!< values in the local form of v
+  int access_counter;
+
+  //! number of stored levels and position in the local form of each column
+  //! (including ghosts)
+  vector<PetscInt> capacity, offset;
+  PetscInt n_owned,             //!< number of owned values
+    n_local;                    //!< number of owned and ghost values
+
+  IceModelVec2S column_capacity, // temporary storage used by reshape()
+    column_offset;
+
+  inline int column(PetscInt i, PetscInt j) const {
+    return (i - layout_xs + width) * (layout_ym + 2 * width) + (j - layout_ys + width);
+  }
+
+  PetscErrorCode set_layout(bool preserve_values);
+  PetscErrorCode destroy();
+private:
+  // the Vec is owned by this object: disable copying
+  IceModelVec3Ragged(const IceModelVec3Ragged &);
+  IceModelVec3Ragged& operator=(const IceModelVec3Ragged &);
+};
+
+#endif /* __IceModelVec3Ragged_hh */
@@ -56,8 +56,11 @@ PetscErrorCode add_2d(IceModelVec* const x_in, PetscScalar alpha, IceModelVec* c
 
   IceGrid *grid = z->get_grid();
 
-  ierr = x->begin_access(); CHKERRQ(ierr);
-  ierr = y->begin_access(); CHKERRQ(ierr);
+  // ghosts of z computed locally are up to date if ghosts of x and y are
+  bool ghosts_valid = x->ghosts_are_valid() && y->ghosts_are_valid();
+
+  ierr = x->begin_read_access(); CHKERRQ(ierr);
+  ierr = y->begin_read_access(); CHKERRQ(ierr);
   ierr = z->begin_access(); CHKERRQ(ierr);
   for (PetscInt   i = grid->xs - ghosts; i < grid->xs+grid->xm + ghosts; ++i) {
     for (PetscInt j = grid->ys - ghosts; j < grid->ys+grid->ym + ghosts; ++j) {
@@ -68,6 +71,9 @@ PetscErrorCode add_2d(IceModelVec* const x_in, PetscScalar alpha, IceModelVec* c
   ierr = y->end_access(); CHKERRQ(ierr);
   ierr = x->end_access(); CHKERRQ(ierr);
 
+  if (ghosts > 0)
+    z->set_ghosts_valid(ghosts_valid);
+
   if (scatter) {
     ierr = z->beginGhostComm(); CHKERRQ(ierr);
     ierr = z->endGhostComm(); CHKERRQ(ierr);
@@ -94,7 +100,9 @@ PetscErrorCode copy_2d(IceModelVec* const source,
 
   IceGrid *grid = z->get_grid();
 
-  ierr = x->begin_access(); CHKERRQ(ierr);
+  bool ghosts_valid = x->ghosts_are_valid();
+
+  ierr = x->begin_read_access(); CHKERRQ(ierr);
   ierr = z->begin_access(); CHKERRQ(ierr);
   for (PetscInt   i = grid->xs - ghosts; i < grid->xs+grid->xm + ghosts; ++i) {
     for (PetscInt j = grid->ys - ghosts; j < grid->ys+grid->ym + ghosts; ++j) {
@@ -104,6 +112,9 @@ PetscErrorCode copy_2d(IceModelVec* const source,
   ierr = z->end_access(); CHKERRQ(ierr);
   ierr = x->end_access(); CHKERRQ(ierr);
 
+  if (ghosts > 0)
+    z->set_ghosts_valid(ghosts_valid);
+
   if (scatter) {
     ierr = z->beginGhostComm(); CHKERRQ(ierr);
     ierr = z->endGhostComm(); CHKERRQ(ierr);
@@ -562,6 +562,16 @@ PetscErrorCode set_config_from_options(MPI_Comm /*com*/, NCConfigVariable &confi
   // Sub-models
   ierr = config.flag_from_option("blatter", "do_blatter"); CHKERRQ(ierr);
   ierr = config.flag_from_option("age", "do_age"); CHKERRQ(ierr);
+  ierr = config.flag_from_option("age_with_enthalpy", "do_age_with_enthalpy"); CHKERRQ(ierr);
+  ierr = config.flag_from_option("age_semi_lagrangian", "age_semi_lagrangian"); CHKERRQ(ierr);
+  ierr = config.scalar_from_option("age_semi_lagrangian_interval", "age_semi_lagrangian_interval"); CHKERRQ(ierr);
+  ierr = config.scalar_from_option("age_semi_lagrangian_halo_width", "age_semi_lagrangian_halo_width"); CHKERRQ(ierr);
+  ierr = config.flag_from_option("tracers", "do_tracers"); CHKERRQ(ierr);
+  ierr = config.string_from_option("tracer_file", "tracer_file"); CHKERRQ(ierr);
+  ierr = config.scalar_from_option("tracer_output_interval", "tracer_output_interval"); CHKERRQ(ierr);
+  ierr = config.scalar_from_option("tracer_seed_interval", "tracer_seed_interval"); CHKERRQ(ierr);
+  ierr = config.scalar_from_option("tracer_seed_levels", "tracer_seed_levels"); CHKERRQ(ierr);
+  ierr = config.scalar_from_option("tracer_seed_stride", "tracer_seed_stride"); CHKERRQ(ierr);
   ierr = config.flag_from_option("mass", "do_mass_conserve"); CHKERRQ(ierr);
   ierr = config.flag_from_option("energy", "do_energy"); CHKERRQ(ierr);
   ierr = config.flag_from_option("sia", "do_sia"); CHKERRQ(ierr);
@@ -596,13 +606,30 @@ PetscErrorCode set_config_from_options(MPI_Comm /*com*/, NCConfigVariable &confi
 
   ierr = config.flag_from_option("grain_size_age_coupling", "compute_grain_size_using_age"); CHKERRQ(ierr);
 
+  ierr = config.flag_from_option("flow_law_table", "flow_law_use_table"); CHKERRQ(ierr);
+  ierr = config.scalar_from_option("flow_law_table_tolerance", "flow_law_table_tolerance"); CHKERRQ(ierr);
+
   // SSA
   // Decide on the algorithm for solving the SSA
   ierr = config.keyword_from_option("ssa_method", "ssa_method", "fd,fem"); CHKERRQ(ierr);
 
+  ierr = config.keyword_from_option("ssa_pc", "ssa_preconditioner", "default,mg"); CHKERRQ(ierr);
+  ierr = config.scalar_from_option("ssa_mg_levels", "ssa_mg_levels"); CHKERRQ(ierr);
+  ierr = config.scalar_from_option("ssa_mg_coarse_size", "ssa_mg_coarse_size"); CHKERRQ(ierr);
+  ierr = config.scalar_from_option("ssa_extrapolation_order", "ssa_extrapolation_order"); CHKERRQ(ierr);
+
   ierr = config.scalar_from_option("ssa_eps",  "epsilon_ssa"); CHKERRQ(ierr);
   ierr = config.scalar_from_option("ssa_maxi", "max_iterations_ssafd"); CHKERRQ(ierr);
   ierr = config.scalar_from_option("ssa_rtol", "ssafd_relative_convergence"); CHKERRQ(ierr);
+  ierr = config.keyword_from_option("ssafd_solver", "ssafd_nonlinear_solver",
+                                    "picard,newton,jfnk"); CHKERRQ(ierr);
+  ierr = config.scalar_from_option("ssafd_picard_iterations", "ssafd_picard_iterations"); CHKERRQ(ierr);
+  ierr = config.scalar_from_option("ssafd_newton_rtol", "ssafd_newton_relative_tolerance"); CHKERRQ(ierr);
+  ierr = config.flag_from_option("ssafd_ksp_forcing", "ssafd_ksp_forcing"); CHKERRQ(ierr);
+  ierr = config.scalar_from_option("ssafd_ksp_forcing_max", "ssafd_ksp_forcing_max"); CHKERRQ(ierr);
+  ierr = config.flag_from_option("ssafd_restricted_domain", "ssafd_restricted_domain"); CHKERRQ(ierr);
+  ierr = config.scalar_from_option("ssafd_restricted_buffer", "ssafd_restricted_buffer"); CHKERRQ(ierr);
+  ierr = config.scalar_from_option("ssafd_restricted_tauc_max", "ssafd_restricted_tauc_max"); CHKERRQ(ierr);
 
   ierr = config.flag_from_option("ssa_dirichlet_bc", "ssa_dirichlet_bc"); CHKERRQ(ierr);
   ierr = config.flag_from_option("cfbc", "calving_front_stress_boundary_condition"); CHKERRQ(ierr);
@@ -683,6 +710,19 @@ PetscErrorCode set_config_from_options(MPI_Comm /*com*/, NCConfigVariable &confi
   ierr = config.flag_from_option("mesh_refinement", "mesh_refinement"); CHKERRQ(ierr);
   ierr = config.flag_from_option("do_glmask", "do_glmask"); CHKERRQ(ierr);
   ierr = config.scalar_from_option("refinement_factor", "refinement_factor"); CHKERRQ(ierr);
+  ierr = config.flag_from_option("refinement_patches", "mesh_refinement_patches"); CHKERRQ(ierr);
+  ierr = config.scalar_from_option("refinement_patch_size", "refinement_patch_size"); CHKERRQ(ierr);
+
+  // Domain decomposition
+  ierr = config.flag_from_option("balanced_decomposition", "grid_balanced_decomposition"); CHKERRQ(ierr);
+  ierr = config.flag_from_option("dynamic_repartitioning", "grid_dynamic_repartitioning"); CHKERRQ(ierr);
+  ierr = config.flag_from_option("overlap_communication", "grid_overlap_communication"); CHKERRQ(ierr);
+  ierr = config.flag_from_option("elide_ghost_updates", "grid_elide_ghost_updates"); CHKERRQ(ierr);
+  ierr = config.scalar_from_option("column_threads", "grid_column_threads"); CHKERRQ(ierr);
+  ierr = config.scalar_from_option("Mz_capacity", "grid_Mz_capacity"); CHKERRQ(ierr);
+  ierr = config.flag_from_option("storage_column_systems", "grid_storage_column_systems"); CHKERRQ(ierr);
+  ierr = config.scalar_from_option("repartitioning_interval", "grid_repartitioning_interval"); CHKERRQ(ierr);
+  ierr = config.scalar_from_option("repartitioning_threshold", "grid_repartitioning_threshold"); CHKERRQ(ierr);
 
   // Output
   ierr = config.flag_from_option("climatic_mass_balance_cumulative", "compute_cumulative_climatic_mass_balance"); CHKERRQ(ierr);
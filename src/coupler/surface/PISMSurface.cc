@@ -120,6 +120,16 @@ PetscErrorCode PISMSurfaceModel::write_variables(set<string> vars, string filena
   return 0;
 }
 
+PetscErrorCode PISMSurfaceModel::redistribute() {
+  PetscErrorCode ierr;
+
+  if (atmosphere != NULL) {
+    ierr = atmosphere->redistribute(); CHKERRQ(ierr);
+  }
+
+  return 0;
+}
+
 PetscErrorCode PISMSurfaceModel::max_timestep(PetscReal my_t, PetscReal &my_dt, bool &restrict) {
   PetscErrorCode ierr;
 
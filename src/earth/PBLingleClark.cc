@@ -134,6 +134,28 @@ PetscErrorCode PBLingleClark::deallocate() {
   return 0;
 }
 
+//! \brief Re-create Vecs used to transfer data to and from processor 0 after
+//! a change of the domain decomposition.
+/*!
+ * Vecs on processor 0 (and the state of the bed deformation model using
+ * them) do not depend on the domain decomposition and are kept.
+ */
+PetscErrorCode PBLingleClark::redistribute() {
+  PetscErrorCode ierr;
+  Vec tmp;
+
+  ierr = VecDestroy(&g2); CHKERRQ(ierr);
+  ierr = VecDestroy(&g2natural); CHKERRQ(ierr);
+  ierr = VecScatterDestroy(&scatter); CHKERRQ(ierr);
+
+  ierr = DMCreateGlobalVector(grid.da2, &g2); CHKERRQ(ierr);
+  ierr = DMDACreateNaturalVector(grid.da2, &g2natural); CHKERRQ(ierr);
+  ierr = VecScatterCreateToZero(g2natural, &scatter, &tmp); CHKERRQ(ierr);
+  ierr = VecDestroy(&tmp); CHKERRQ(ierr);
+
+  return 0;
+}
+
 //! Initialize the Lingle-Clark bed deformation model using uplift.
 PetscErrorCode PBLingleClark::init(PISMVars &vars) {
   PetscErrorCode ierr;
@@ -72,6 +72,7 @@ public:
 
   PetscErrorCode init(PISMVars &vars);
   PetscErrorCode update(PetscReal my_t, PetscReal my_dt);
+  PetscErrorCode redistribute();
 protected:
   PetscErrorCode correct_topg();
   PetscErrorCode allocate();
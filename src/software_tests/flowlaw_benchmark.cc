@@ -0,0 +1,241 @@
+// Copyright (C) 2012 Constantine Khroulev
+//
+// This file is part of Pism.
+//
+// Pism is free software; you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the Free Software
+// Foundation; either version 2 of the License, or (at your option) any later
+// version.
+//
+// Pism is distributed in the hope that it will be useful, but WITHOUT ANY
+// WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+// details.
+//
+// You should have received a copy of the GNU General Public License
+// along with Pism; if not, write to the Free Software
+// Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+#include <petsc.h>
+#include <vector>
+#include "pism_const.hh"
+#include "flowlaw_factory.hh"
+#include "flowlaw_kernels.hh"
+#include "NCVariable.hh"
+#include "enthalpyConverter.hh"
+#include "pism_options.hh"
+
+static char help[] =
+  "Times the loops over levels evaluating IceFlowLaw::flow() and\n"
+  "IceFlowLaw::hardness_parameter() (as in SIAFD) using virtual methods and\n"
+  "using the non-virtual kernel selected by IceFlowLawKernels.\n"
+  "Use -flow_law to choose the flow law, -columns and -Mz to set the size\n"
+  "and -repeat to set the number of repetitions.\n";
+
+//! Evaluates flow() in a column, as in SIAFD::compute_diffusive_flux().
+class FlowColumn {
+public:
+  template <class F>
+  double operator()(const F &flow_law) const {
+    for (int k = 0; k <= ks; ++k) {
+      const double depth = thk - zlevels[k],
+        pressure = rho_g * depth;
+      result[k] = flow_law.flow(alpha * pressure, E[k], pressure, grain_size);
+    }
+    return 0.0;
+  }
+
+  int ks;
+  const double *zlevels, *E;
+  double thk, alpha, rho_g, grain_size;
+  double *result;
+};
+
+//! Evaluates hardness_parameter() in a column, as in SIAFD::compute_sigma().
+class HardnessColumn {
+public:
+  template <class F>
+  double operator()(const F &flow_law) const {
+    for (int k = 0; k <= ks; ++k) {
+      const double pressure = flow_law.getPressureFromDepth(thk - zlevels[k]);
+      result[k] = flow_law.hardness_parameter(E[k], pressure);
+    }
+    return 0.0;
+  }
+
+  int ks;
+  const double *zlevels, *E;
+  double thk;
+  double *result;
+};
+
+//! Loops over all the columns, returning the time spent and storing the sum of
+//! results in each column in `checksum`.
+template <class Op>
+static PetscErrorCode run(const IceFlowLawKernels &kernels, bool use_virtual,
+                          Op &op, int repeat,
+                          const std::vector<double> &thk,
+                          const std::vector<double> &E, int Mz, double dz,
+                          std::vector<double> &checksum, PetscLogDouble &elapsed) {
+  PetscErrorCode ierr;
+  PetscLogDouble start, end;
+  std::vector<double> result(Mz);
+  const int N = thk.size();
+
+  op.result = &result[0];
+
+  ierr = PetscGetTime(&start); CHKERRQ(ierr);
+  for (int r = 0; r < repeat; ++r) {
+    for (int n = 0; n < N; ++n) {
+      op.thk = thk[n];
+      op.ks  = PetscMin(static_cast<int>(floor(thk[n] / dz)), Mz - 1);
+      op.E   = &E[n * Mz];
+
+      if (use_virtual)
+        kernels.apply_virtual(op);
+      else
+        kernels.apply(op);
+
+      if (r == 0) {
+        double sum = 0.0;
+        for (int k = 0; k <= op.ks; ++k)
+          sum += result[k];
+        checksum[n] = sum;
+      }
+    }
+  }
+  ierr = PetscGetTime(&end); CHKERRQ(ierr);
+
+  elapsed = end - start;
+
+  return 0;
+}
+
+//! Returns the maximum relative difference between two checksums.
+static double max_difference(const std::vector<double> &a, const std::vector<double> &b) {
+  double result = 0.0;
+  for (unsigned int n = 0; n < a.size(); ++n) {
+    if (a[n] != 0.0)
+      result = PetscMax(result, PetscAbs((a[n] - b[n]) / a[n]));
+    else
+      result = PetscMax(result, PetscAbs(b[n]));
+  }
+  return result;
+}
+
+int main(int argc, char *argv[]) {
+  PetscErrorCode  ierr;
+
+  MPI_Comm    com;
+  PetscMPIInt rank, size;
+
+  ierr = PetscInitialize(&argc, &argv, PETSC_NULL, help); CHKERRQ(ierr);
+
+  com = PETSC_COMM_WORLD;
+  ierr = MPI_Comm_rank(com, &rank); CHKERRQ(ierr);
+  ierr = MPI_Comm_size(com, &size); CHKERRQ(ierr);
+
+  /* This explicit scoping forces destructors to be called before PetscFinalize() */
+  {
+    NCConfigVariable config, overrides;
+    ierr = init_config(com, rank, config, overrides); CHKERRQ(ierr);
+
+    EnthalpyConverter EC(config);
+
+    IceFlowLaw *flow_law = NULL;
+    IceFlowLawFactory ice_factory(com, NULL, config, &EC);
+
+    ice_factory.setType(ICE_GPBLD); // set the default type
+
+    ierr = ice_factory.setFromOptions(); CHKERRQ(ierr);
+    ierr = ice_factory.create(&flow_law); CHKERRQ(ierr);
+
+    // The default corresponds to the icy part of a 5 km Greenland grid.
+    PetscInt N = 70000, Mz = 101, repeat = 5;
+    bool flag;
+    ierr = PISMOptionsInt("-columns", "number of columns", N, flag); CHKERRQ(ierr);
+    ierr = PISMOptionsInt("-Mz", "number of vertical levels", Mz, flag); CHKERRQ(ierr);
+    ierr = PISMOptionsInt("-repeat", "number of repetitions", repeat, flag); CHKERRQ(ierr);
+
+    if (N < 1 || Mz < 2 || repeat < 1) {
+      PetscPrintf(com, "flowlaw_benchmark ERROR: -columns, -Mz and -repeat have to be positive.\n");
+      PISMEnd();
+    }
+
+    const double Lz = 4000.0, dz = Lz / (Mz - 1),
+      rho_g = config.get("ice_density") * config.get("standard_gravity");
+
+    std::vector<double> zlevels(Mz), thk(N), E(N * Mz);
+    for (int k = 0; k < Mz; ++k)
+      zlevels[k] = k * dz;
+
+    // Columns with thicknesses between 10 m and 3500 m, the surface
+    // temperature between -35 and -5 degrees C and a temperate layer at the
+    // base of thick columns.
+    for (int n = 0; n < N; ++n) {
+      const double s = (n % 997) / 996.0;
+      thk[n] = 10.0 + 3490.0 * s;
+      const double T_s = config.get("water_melting_point_temperature") - 35.0 + 30.0 * (1.0 - s);
+
+      for (int k = 0; k < Mz; ++k) {
+        const double depth = PetscMax(thk[n] - zlevels[k], 0.0),
+          p = EC.getPressureFromDepth(depth),
+          T_m = EC.getMeltingTemp(p);
+        double T = T_s + (T_m - T_s) * (depth / thk[n]), omega = 0.0;
+
+        if (thk[n] > 2500.0 && zlevels[k] < 200.0) {
+          T = T_m;
+          omega = 0.01 * (1.0 - zlevels[k] / 200.0);
+        }
+
+        ierr = EC.getEnthPermissive(T, omega, p, E[n * Mz + k]); CHKERRQ(ierr);
+      }
+    }
+
+    IceFlowLawKernels kernels(*flow_law);
+
+    ierr = PetscPrintf(com,
+                       "flow law kernel: \"%s\"\n"
+                       "columns = %d, Mz = %d, repetitions = %d\n",
+                       kernels.name(), N, Mz, repeat); CHKERRQ(ierr);
+
+    std::vector<double> checksum_virtual(N), checksum_kernel(N);
+    PetscLogDouble t_virtual, t_kernel;
+
+    FlowColumn flow;
+    flow.zlevels    = &zlevels[0];
+    flow.alpha      = 0.01;      // surface slope
+    flow.rho_g      = rho_g;
+    flow.grain_size = config.get("ice_grain_size");
+
+    ierr = run(kernels, true, flow, repeat, thk, E, Mz, dz,
+               checksum_virtual, t_virtual); CHKERRQ(ierr);
+    ierr = run(kernels, false, flow, repeat, thk, E, Mz, dz,
+               checksum_kernel, t_kernel); CHKERRQ(ierr);
+
+    ierr = PetscPrintf(com,
+                       "flow():               virtual %8.4f s, kernel %8.4f s, speedup %5.2f,"
+                       " max. relative difference %.3e\n",
+                       t_virtual, t_kernel, t_virtual / t_kernel,
+                       max_difference(checksum_virtual, checksum_kernel)); CHKERRQ(ierr);
+
+    HardnessColumn hardness;
+    hardness.zlevels = &zlevels[0];
+
+    ierr = run(kernels, true, hardness, repeat, thk, E, Mz, dz,
+               checksum_virtual, t_virtual); CHKERRQ(ierr);
+    ierr = run(kernels, false, hardness, repeat, thk, E, Mz, dz,
+               checksum_kernel, t_kernel); CHKERRQ(ierr);
+
+    ierr = PetscPrintf(com,
+                       "hardness_parameter(): virtual %8.4f s, kernel %8.4f s, speedup %5.2f,"
+                       " max. relative difference %.3e\n",
+                       t_virtual, t_kernel, t_virtual / t_kernel,
+                       max_difference(checksum_virtual, checksum_kernel)); CHKERRQ(ierr);
+
+    delete flow_law;
+  } // end explicit scope
+
+  ierr = PetscFinalize(); CHKERRQ(ierr);
+  return 0;
+}
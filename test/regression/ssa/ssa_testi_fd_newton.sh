@@ -0,0 +1,34 @@
+#!/bin/bash
+
+# SSAFD verification test I regression test: compares the solution computed
+# using -ssafd_solver newton to the one computed using Picard iterations
+
+PISM_PATH=$1
+MPIEXEC=$2
+MPIEXEC_COMMAND="$MPIEXEC -n 2"
+
+# List of files to remove when done:
+files="foo.nc foo.nc~ bar.nc bar.nc~"
+
+rm -f $files
+
+set -e
+set -x
+
+OPTS="-verbose 1 -ssa_method fd -ssa_rtol 5e-07 -ksp_rtol 1e-12 -Mx 5 -My 61"
+
+# do stuff
+$MPIEXEC_COMMAND $PISM_PATH/ssa_testi $OPTS -o foo.nc
+$MPIEXEC_COMMAND $PISM_PATH/ssa_testi $OPTS -ssafd_solver newton -ssafd_newton_rtol 1e-10 -o bar.nc
+
+set +e
+
+# Check results (velocities are in m/year):
+$PISM_PATH/nccmp.py -t 1e-2 -v u_ssa,v_ssa foo.nc bar.nc
+
+if [ $? != 0 ];
+then
+    exit 1
+fi
+
+rm -f $files; exit 0
@@ -0,0 +1,75 @@
+#!/bin/bash
+
+PISM_PATH=$1
+MPIEXEC=$2
+
+# Test name:
+echo "Test #29: verif tests K and O: column systems on the storage grid vs. the fine grid."
+# The list of files to delete when done.
+files="test_29-K-fine.nc test_29-K-storage.nc test_29-O-fine.nc test_29-O-storage.nc
+       test_29-K-errors-fine.nc test_29-K-errors-storage.nc test_29-O-errors-fine.nc test_29-O-errors-storage.nc
+       test_29-K-quadratic.nc test_29-O-quadratic.nc"
+
+rm -f $files
+
+set -e -x
+
+# With equal vertical spacing the storage grid is the fine grid, so both
+# column system modes have to give the same results.
+for test in K O;
+do
+    OPTS="-test $test -Mx 4 -My 4 -Mz 41 -Mbz 11 -y 3000.0 -Lbz 1000 -z_spacing equal -max_dt 60.0 -verbose 1 -o_size small"
+    $PISM_PATH/pismv $OPTS -o test_29-$test-fine.nc
+    $PISM_PATH/pismv $OPTS -storage_column_systems -o test_29-$test-storage.nc
+done
+
+# With quadratic spacing and Mz = 21 the fine grid has many more levels than
+# the storage grid, so the storage mode uses a different (non-uniform)
+# discretization. Save reported errors to compare them below.
+for test in K O;
+do
+    OPTS="-test $test -Mx 4 -My 4 -Mz 21 -Mbz 11 -y 3000.0 -Lbz 1000 -z_spacing quadratic -max_dt 60.0 -verbose 1 -o_size small -o test_29-$test-quadratic.nc"
+    $PISM_PATH/pismv $OPTS -report_file test_29-$test-errors-fine.nc
+    $PISM_PATH/pismv $OPTS -storage_column_systems -report_file test_29-$test-errors-storage.nc
+done
+
+set +e
+
+# Compare:
+for test in K O;
+do
+    $PISM_PATH/nccmp.py -t 1e-9 -v temp,litho_temp test_29-$test-fine.nc test_29-$test-storage.nc
+    if [ $? != 0 ];
+    then
+        exit 1
+    fi
+done
+
+# Errors (in Kelvin) in the storage mode may not exceed errors in the fine
+# grid mode by more than 50% plus 0.05 K:
+for test in K O;
+do
+    python - test_29-$test-errors-fine.nc test_29-$test-errors-storage.nc <<EOF
+from sys import argv, exit, stderr
+try:
+    from netCDF3 import Dataset as NC
+except:
+    from netCDF4 import Dataset as NC
+
+fine = NC(argv[1])
+storage = NC(argv[2])
+for name in ['maximum_temperature', 'average_temperature',
+             'maximum_bedrock_temperature', 'average_bedrock_temperature']:
+    e_fine = abs(fine.variables[name][-1])
+    e_storage = abs(storage.variables[name][-1])
+    stderr.write("%s: fine grid %f, storage grid %f\\n" % (name, e_fine, e_storage))
+    if e_storage > 1.5 * e_fine + 0.05:
+        exit(1)
+EOF
+    if [ $? != 0 ];
+    then
+        exit 1
+    fi
+done
+
+rm -f $files; exit 0
@@ -0,0 +1,44 @@
+#!/bin/bash
+
+PISM_PATH=$1
+MPIEXEC=$2
+
+# Test name:
+echo "Test #30: automatic vertical grid extension with spare storage levels (-Mz_capacity)."
+# The list of files to delete when done.
+files="foo.nc foo-capacity.nc bar.nc baz.nc"
+
+rm -f $files
+
+set -x -e
+
+OPTS="-My 121 -Mx 61 -eisII A -y 1000 -Mmax 0.925 -z_spacing equal"
+
+echo "run with Lz set too low:"
+$MPIEXEC -n 2 $PISM_PATH/pisms -Lz 900 -o foo.nc $OPTS
+
+echo "run with Lz set too low, extending the grid in place:"
+$MPIEXEC -n 2 $PISM_PATH/pisms -Lz 900 -Mz_capacity 64 -o foo-capacity.nc $OPTS
+
+echo "run with Lz set just right:"
+$MPIEXEC -n 2 $PISM_PATH/pisms -Mz 33 -Lz 960 -o bar.nc $OPTS
+
+echo "regrid from the grid extended in place onto the one in bar.nc:"
+$MPIEXEC -n 2 $PISM_PATH/pismr -i bar.nc -regrid_file foo-capacity.nc -regrid_vars enthalpy -y 0 -o baz.nc -Mz_capacity 64
+
+set +e
+
+# compare results
+$PISM_PATH/nccmp.py -v enthalpy,thk foo.nc foo-capacity.nc
+if [ $? != 0 ];
+then
+    exit 1
+fi
+
+$PISM_PATH/nccmp.py -v enthalpy bar.nc baz.nc
+if [ $? != 0 ];
+then
+    exit 1
+fi
+
+rm -f $files; exit 0
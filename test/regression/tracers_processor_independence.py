@@ -0,0 +1,63 @@
+#!/usr/bin/env python
+
+from sys import exit, argv, stderr
+from os import system
+from numpy import abs, lexsort
+
+try:
+    from netCDF3 import Dataset as NC
+except:
+    from netCDF4 import Dataset as NC
+
+pism_path=argv[1]
+mpiexec=argv[2]
+
+stderr.write("Testing: tracer particle trajectories do not depend on the number of processors.\n")
+
+def run(n):
+    cmd = "%s -n %d %s/pismv -test G -Mx 31 -My 31 -Mz 31 -y 200 -verbose 1 -o foo%d.nc -tracers -tracer_seed_stride 2 -tracer_seed_levels 3 -tracer_output_interval 0 -tracer_file tracers%d.nc" % (mpiexec, n, pism_path, n, n)
+    stderr.write(cmd + '\n')
+
+    e = system(cmd)
+    if e != 0:
+        exit(1)
+
+    nc = NC("tracers%d.nc" % n)
+    t = nc.variables['t'][:]
+    particle_id = nc.variables['particle_id'][:]
+
+    # the order of observations written at the same time depends on the
+    # domain decomposition
+    order = lexsort((particle_id, t))
+
+    result = {}
+    for name in ['t', 'particle_id', 'x', 'y', 'z', 'temp_max']:
+        result[name] = nc.variables[name][:][order]
+    nc.close()
+
+    return result
+
+serial = run(1)
+
+for n in [2, 3, 4]:
+    parallel = run(n)
+
+    if serial['t'].size != parallel['t'].size:
+        stderr.write("number of observations differs: %d (1 processor), %d (%d processors)\n" %
+                     (serial['t'].size, parallel['t'].size, n))
+        exit(1)
+
+    for name in ['t', 'particle_id']:
+        if any(serial[name] != parallel[name]):
+            stderr.write("%s differs on %d processors\n" % (name, n))
+            exit(1)
+
+    for name in ['x', 'y', 'z', 'temp_max']:
+        delta = abs(serial[name] - parallel[name]).max()
+        scale = max(abs(serial[name]).max(), 1.0)
+        stderr.write("%d processors: max. difference in %s = %e\n" % (n, name, delta))
+        if delta > 1e-6 * scale:
+            exit(1)
+
+system("rm -f foo1.nc foo2.nc foo3.nc foo4.nc tracers1.nc tracers2.nc tracers3.nc tracers4.nc")
+exit(0)
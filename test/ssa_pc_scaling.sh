@@ -0,0 +1,52 @@
+#!/bin/bash
+
+# SSA preconditioner scaling benchmark: solves verification test I and the
+# plug flow test at increasing resolution using the default preconditioner and
+# the multigrid one (-ssa_pc mg), with both SSA solvers, and reports the total
+# number of KSP iterations and the wall-clock time of each run.
+#
+# Usage: ssa_pc_scaling.sh PISM_PATH MPIEXEC N_PROCESSORS ["list of grid sizes"]
+#
+# Grid sizes have to be divisible by a power of two for the multigrid
+# preconditioner to have more than one level (see SSA::mg_levels()).
+
+PISM_PATH=$1
+MPIEXEC=$2
+NPROCS=${3:-1}
+SIZES=${4:-"64 128 256 512"}
+
+MPIEXEC_COMMAND="$MPIEXEC -n $NPROCS"
+
+# List of files to remove when done:
+files="foo.nc foo.nc~ ssa_pc_scaling_out.txt"
+
+rm -f $files
+
+OPTS="-verbose 1 -o foo.nc -ksp_converged_reason"
+
+printf "%-14s %-4s %-8s %6s %10s %10s\n" test ssa pc M ksp_its time_s
+for test in ssa_testi ssa_test_plug; do
+    for method in fd fem; do
+        for M in $SIZES; do
+            for pc in default mg; do
+                start=$(date +%s.%N)
+                $MPIEXEC_COMMAND $PISM_PATH/$test -Mx $M -My $M -ssa_method $method -ssa_pc $pc \
+                    $OPTS > ssa_pc_scaling_out.txt 2>&1
+                status=$?
+                end=$(date +%s.%N)
+
+                if [ $status != 0 ]; then
+                    printf "%-14s %-4s %-8s %6d %10s\n" $test $method $pc $M failed
+                    continue
+                fi
+
+                # sum iteration counts of all linear solves
+                its=$(awk '/Linear solve/ {sum += $NF} END {print sum + 0}' ssa_pc_scaling_out.txt)
+                printf "%-14s %-4s %-8s %6d %10d %10.2f\n" $test $method $pc $M $its \
+                    $(echo "$end - $start" | bc)
+            done
+        done
+    done
+done
+
+rm -f $files; exit 0